@@ -0,0 +1,107 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __KM_BLKCACHE_H
+#define __KM_BLKCACHE_H
+
+#include <stdint.h>
+
+#include "blkdev.h"
+#include "jerryscript.h"
+
+/**
+ * Block cache. Sits between a file system and its block device as a block
+ * device itself, and keeps recently used lines (a block or a part of a
+ * block) in RAM:
+ *
+ * - lines are evicted in LRU order, within the budget given at creation.
+ * - a read continuing the previous one reads the following lines ahead,
+ *   with a single device call.
+ * - writes stay in the cache (write-back) until flushed by sync(), by an
+ *   eviction of a dirty line or by km_blkcache_flush(). Dirty lines are
+ *   written in ascending order, adjacent lines with a single device call.
+ * - requests larger than half of the cache go directly to the device.
+ *
+ * Lookup is a linear scan, so it is meant for tens of lines.
+ */
+
+typedef struct {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+  uint32_t read_aheads;  // lines read ahead
+  uint32_t write_backs;  // dirty lines written to the device
+  uint32_t reads;        // read() calls to the device
+  uint32_t writes;       // prog() calls to the device
+} km_blkcache_stats_t;
+
+typedef struct {
+  uint32_t line;  // block * lines_per_block + index in the block
+  uint32_t used;  // tick of the last use
+  uint8_t flags;
+} km_blkcache_entry_t;
+
+typedef struct {
+  km_blkdev_t blkdev;  // operations through the cache
+  km_blkdev_t *dev;    // cached device
+  uint32_t block_count;
+  uint32_t line_size;
+  uint32_t lines_per_block;
+  uint32_t count;       // number of lines
+  uint32_t batch;       // lines of batch_buffer
+  uint32_t read_ahead;  // lines to read ahead
+  uint32_t tick;
+  uint32_t next_line;  // line following the last read
+  km_blkcache_entry_t *entries;
+  uint8_t *data;          // count * line_size
+  uint8_t *batch_buffer;  // for read-ahead and write-back of adjacent lines
+  km_blkcache_stats_t stats;
+} km_blkcache_t;
+
+// minimum lines written back with a single device call
+#define KM_BLKCACHE_MIN_BATCH 4
+// lines to read ahead by default
+#define KM_BLKCACHE_DEFAULT_READ_AHEAD 4
+
+/**
+ * Create a cache of size bytes for the (initialized) device. line_size must
+ * divide the block size. Returns NULL if the geometry is invalid or out of
+ * memory.
+ */
+km_blkcache_t *km_blkcache_create(km_blkdev_t *dev, uint32_t line_size,
+                                  uint32_t size, uint32_t read_ahead);
+
+/**
+ * Write the dirty lines back to the device (without syncing the device)
+ */
+int km_blkcache_flush(km_blkcache_t *cache);
+
+/**
+ * Free the cache. Dirty lines are discarded, so flush before.
+ */
+void km_blkcache_free(km_blkcache_t *cache);
+
+/**
+ * Create a JS object of the cache size and counters
+ */
+jerry_value_t km_blkcache_create_stats_object(km_blkcache_t *cache);
+
+#endif /* __KM_BLKCACHE_H */
@@ -0,0 +1,104 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __KM_BLKDEV_H
+#define __KM_BLKDEV_H
+
+#include <stdint.h>
+
+#include "jerryscript.h"
+
+/**
+ * Native block device. Builtin block devices (Flash, SDCard) attach one to
+ * their JS object, so the file systems can call them directly instead of
+ * going through the JS protocol (read(), write() and ioctl()). A driver
+ * embeds km_blkdev_t as the first member of its own struct.
+ */
+
+typedef struct km_blkdev_s km_blkdev_t;
+
+// ioctl() operations (same as the JS block device protocol)
+enum km_blkdev_ioctl_op {
+  KM_BLKDEV_INIT = 1,
+  KM_BLKDEV_SHUTDOWN = 2,
+  KM_BLKDEV_SYNC = 3,
+  KM_BLKDEV_BLOCK_COUNT = 4,
+  KM_BLKDEV_BLOCK_SIZE = 5,
+  KM_BLKDEV_ERASE = 6,
+  KM_BLKDEV_BUFFER_SIZE = 7,
+};
+
+/**
+ * Block device operations. read() and prog() transfer size bytes from the
+ * offset in the block, and may span the following blocks when the offset is
+ * 0 and size is a multiple of the block size. All return 0 (ioctl: the
+ * result) or a negative error.
+ */
+typedef struct {
+  int (*read)(km_blkdev_t *dev, uint32_t block, uint32_t offset,
+              uint8_t *buffer, uint32_t size);
+  int (*prog)(km_blkdev_t *dev, uint32_t block, uint32_t offset,
+              const uint8_t *buffer, uint32_t size);
+  int (*erase)(km_blkdev_t *dev, uint32_t block, uint32_t count);
+  int (*sync)(km_blkdev_t *dev);
+  int (*ioctl)(km_blkdev_t *dev, int op, int arg);
+} km_blkdev_ops_t;
+
+struct km_blkdev_s {
+  const km_blkdev_ops_t *ops;
+};
+
+/**
+ * Native info of the objects having a km_blkdev_t. The native pointer is
+ * freed with free() when the object is collected.
+ */
+extern const jerry_object_native_info_t km_blkdev_native_info;
+
+/**
+ * Attach a (malloc'ed) native block device to the JS object
+ */
+void km_blkdev_attach(jerry_value_t obj, km_blkdev_t *dev);
+
+/**
+ * Get the native block device of the JS object, or NULL if the object is a
+ * user-defined block device.
+ */
+km_blkdev_t *km_blkdev_get(jerry_value_t obj);
+
+/**
+ * Get a native block device for the JS object: its own one for builtin
+ * block devices, or a new one calling read(), write() and ioctl() of the
+ * object for user-defined block devices. Release with km_blkdev_close().
+ */
+km_blkdev_t *km_blkdev_open(jerry_value_t obj);
+
+/**
+ * Release a block device returned by km_blkdev_open()
+ */
+void km_blkdev_close(km_blkdev_t *dev);
+
+/**
+ * Run an ioctl() operation. KM_BLKDEV_SYNC and KM_BLKDEV_ERASE (arg is the
+ * block number) are dispatched to sync() and erase().
+ */
+int km_blkdev_ioctl(km_blkdev_t *dev, int op, int arg);
+
+#endif /* __KM_BLKDEV_H */
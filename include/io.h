@@ -26,6 +26,7 @@
 #include <stdint.h>
 
 #include "jerryscript.h"
+#include "kaluma_config.h"
 #include "utils.h"
 
 typedef struct km_io_loop_s km_io_loop_t;
@@ -37,6 +38,7 @@ typedef struct km_io_watch_handle_s km_io_watch_handle_t;
 typedef struct km_io_uart_handle_s km_io_uart_handle_t;
 typedef struct km_io_idle_handle_s km_io_idle_handle_t;
 typedef struct km_io_stream_handle_s km_io_stream_handle_t;
+typedef struct km_io_check_handle_s km_io_check_handle_t;
 
 /* handle flags */
 
@@ -55,7 +57,9 @@ typedef enum km_io_type {
   KM_IO_WATCH,
   KM_IO_UART,
   KM_IO_IDLE,
-  KM_IO_STREAM
+  KM_IO_STREAM,
+  KM_IO_CHECK,
+  KM_IO_TYPE_MAX
 } km_io_type_t;
 
 typedef void (*km_io_close_cb)(km_io_handle_t *);
@@ -68,10 +72,29 @@ struct km_io_handle_s {
   km_io_close_cb close_cb;
 };
 
+/* handle id: generation (upper bits) and slot index (lower 16 bits) */
+
+#define KM_IO_SLOT_BITS 16
+#define KM_IO_SLOT_MAX (1 << KM_IO_SLOT_BITS)
+#define KM_IO_SLOT_GEN_MAX 0x7FFF  // keep ids positive as a JS int
+#define KM_IO_INVALID_ID 0
+
+typedef struct {
+  km_io_handle_t *handle;  // NULL if the slot is free
+  uint16_t gen;
+  uint32_t next_free;  // next free slot (if free)
+} km_io_slot_t;
+
+/* number of handles allocated at once in a pool slab */
+
+#define KM_IO_POOL_SLAB_COUNT 16
+
 /* timer handle types */
 
 typedef void (*km_io_timer_cb)(km_io_timer_handle_t *);
 
+#define KM_IO_TIMER_NOT_QUEUED 0xFFFFFFFF
+
 struct km_io_timer_handle_s {
   km_io_handle_t base;
   km_io_timer_cb timer_cb;
@@ -79,7 +102,9 @@ struct km_io_timer_handle_s {
   uint64_t clamped_timeout;
   uint64_t interval;
   bool repeat;
-  uint32_t tag;  // for application use
+  uint32_t tag;        // for application use
+  uint32_t seq;        // tie-breaker for timers with the same timeout
+  uint32_t heap_index; // position in the timer heap (if queued)
 };
 
 /* TTY handle types */
@@ -150,18 +175,113 @@ struct km_io_stream_handle_s {
   km_io_stream_read_cb read_cb;
 };
 
+/* check handle type (callbacks run once, after the I/O phases) */
+
+typedef void (*km_io_check_cb)(km_io_check_handle_t *);
+
+struct km_io_check_handle_s {
+  km_io_handle_t base;
+  km_io_check_cb check_cb;
+  jerry_value_t check_js_cb;
+  uint32_t seq;  // to run only the handles queued before the check phase
+};
+
+/* job (microtask) runner, called after callbacks */
+
+typedef void (*km_io_jobs_cb)();
+
+/* GPIO interrupt event queue */
+
+/* number of events the queue can hold (must be a power of 2) */
+
+#define KM_IO_IRQ_QUEUE_SIZE 64
+
+typedef struct {
+  uint8_t pin;
+  uint8_t events;
+  uint64_t time;  // microseconds
+} km_io_irq_event_t;
+
+typedef void (*km_io_irq_cb)(km_io_irq_event_t *, size_t);
+
+/**
+ * Single-producer (ISR) / single-consumer (loop) ring of interrupt events.
+ * head is written only by the producer and tail only by the consumer.
+ */
+typedef struct {
+  km_io_irq_event_t events[KM_IO_IRQ_QUEUE_SIZE];
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  volatile uint32_t overflow;  // events dropped because the queue was full
+  uint32_t overflow_base;      // overflow count at the last cleanup
+  km_io_irq_cb irq_cb;
+} km_io_irq_queue_t;
+
+/* loop statistics */
+
+#ifdef KM_IO_STATS
+
+typedef enum {
+  KM_IO_PHASE_IRQ,
+  KM_IO_PHASE_TIMER,
+  KM_IO_PHASE_TTY,
+  KM_IO_PHASE_WATCH,
+  KM_IO_PHASE_UART,
+  KM_IO_PHASE_CHECK,
+  KM_IO_PHASE_IDLE,
+  KM_IO_PHASE_CLOSING,
+  KM_IO_PHASE_CUSTOM,
+  KM_IO_PHASE_WAIT,
+  KM_IO_PHASE_MAX
+} km_io_phase_t;
+
+/* timer lateness buckets: <=1, <=2, <=4, ... <=64, >64 msec */
+
+#define KM_IO_LATENESS_BUCKETS 8
+
+typedef struct {
+  uint64_t start_time;                        // msec, at the last reset
+  uint32_t iterations;
+  uint64_t phase_time[KM_IO_PHASE_MAX];       // usec
+  uint32_t phase_max[KM_IO_PHASE_MAX];        // usec, longest single run
+  uint32_t callbacks[KM_IO_PHASE_MAX];        // number of callbacks called
+  uint32_t callback_max;                      // usec, longest callback
+  uint32_t lateness[KM_IO_LATENESS_BUCKETS];  // timer lateness histogram
+  uint64_t lateness_max;                      // msec
+} km_io_stats_t;
+
+#endif /* KM_IO_STATS */
+
 /* loop type */
 
+/* maximum time to wait for events in a loop iteration (msec) */
+
+#define KM_IO_MAX_WAIT_TIME 1000
+
 struct km_io_loop_s {
   bool stop_flag;
   uint64_t time;
-  km_list_t timer_handles;
+  km_io_timer_handle_t **timer_heap;  // min-heap ordered by clamped_timeout
+  uint32_t timer_count;
+  uint32_t timer_capacity;
+  uint32_t timer_seq;
   km_list_t tty_handles;
   km_list_t watch_handles;
   km_list_t uart_handles;
   km_list_t idle_handles;
   km_list_t stream_handles;
+  km_list_t check_handles;
+  uint32_t check_seq;
   km_list_t closing_handles;
+  km_io_slot_t *slots;  // id -> handle table
+  uint32_t slot_capacity;
+  uint32_t slot_free;  // head of the free slot list
+  km_io_irq_queue_t irq_queue;
+  km_io_jobs_cb jobs_cb;
+  bool jobs_pending;
+#ifdef KM_IO_STATS
+  km_io_stats_t stats;
+#endif
 };
 
 /* loop functions */
@@ -169,18 +289,24 @@ struct km_io_loop_s {
 void km_io_init();
 void km_io_cleanup();
 void km_io_run(bool infinite);
+#ifdef KM_IO_STATS
+km_io_stats_t *km_io_stats_get();
+void km_io_stats_reset();
+#endif
 
 /* general handle functions */
 
+void *km_io_handle_alloc(km_io_type_t type);
+void km_io_handle_free(km_io_handle_t *handle);
 void km_io_handle_init(km_io_handle_t *handle, km_io_type_t type);
 void km_io_handle_close(km_io_handle_t *handle, km_io_close_cb close_cb);
-km_io_handle_t *km_io_handle_get_by_id(uint32_t id, km_list_t *handle_list);
+km_io_handle_t *km_io_handle_get_by_id(uint32_t id, km_io_type_t type);
 
 /* timer functions */
 
 void km_io_timer_init(km_io_timer_handle_t *timer);
-void km_io_timer_start(km_io_timer_handle_t *timer, km_io_timer_cb timer_cb,
-                       uint64_t interval, bool repeat);
+int km_io_timer_start(km_io_timer_handle_t *timer, km_io_timer_cb timer_cb,
+                      uint64_t interval, bool repeat);
 void km_io_timer_stop(km_io_timer_handle_t *timer);
 km_io_timer_handle_t *km_io_timer_get_by_id(uint32_t id);
 void km_io_timer_cleanup();
@@ -219,6 +345,28 @@ void km_io_idle_stop(km_io_idle_handle_t *idle);
 km_io_idle_handle_t *km_io_idle_get_by_id(uint32_t id);
 void km_io_idle_cleanup();
 
+/* check functions */
+
+void km_io_check_init(km_io_check_handle_t *check);
+void km_io_check_start(km_io_check_handle_t *check, km_io_check_cb check_cb);
+void km_io_check_stop(km_io_check_handle_t *check);
+km_io_check_handle_t *km_io_check_get_by_id(uint32_t id);
+void km_io_check_cleanup();
+
+/* job runner functions */
+
+void km_io_jobs_start(km_io_jobs_cb jobs_cb);
+void km_io_jobs_schedule();
+
+/* GPIO interrupt queue functions */
+
+void km_io_irq_start(km_io_irq_cb irq_cb);
+void km_io_irq_stop();
+bool km_io_irq_push(uint8_t pin, uint8_t events);
+uint32_t km_io_irq_pending();
+uint32_t km_io_irq_get_overflow();
+void km_io_irq_cleanup();
+
 /* stream functions */
 
 void km_io_stream_init(km_io_stream_handle_t *stream);
@@ -238,6 +238,15 @@
   jerry_release_value(name##_p);                                          \
   jerry_release_value(name##_n);
 
+// cached property keys
+/**
+ * Return a cached key for the property name. The key is owned by the cache
+ * (do not release it) and is valid until km_runtime_cleanup(), or only until
+ * the next call if the cache is out of memory.
+ */
+jerry_value_t jerryxx_key(const char *name);
+void jerryxx_key_cleanup();
+
 // functions for setting property
 void jerryxx_set_property(jerry_value_t object, const char *name,
                           jerry_value_t value);
@@ -247,6 +256,10 @@ void jerryxx_set_property_string(jerry_value_t object, const char *name,
                                  char *value);
 void jerryxx_set_property_function(jerry_value_t object, const char *name,
                                    jerry_external_handler_t fn);
+void jerryxx_set_property_by_key(jerry_value_t object, jerry_value_t key,
+                                 jerry_value_t value);
+void jerryxx_set_property_number_by_key(jerry_value_t object,
+                                        jerry_value_t key, double value);
 
 // function for define own property
 void jerryxx_define_own_property(jerry_value_t object, const char *name,
@@ -259,6 +272,12 @@ double jerryxx_get_property_number(jerry_value_t object, const char *name,
                                    double default_value);
 bool jerryxx_get_property_boolean(jerry_value_t object, const char *name,
                                   bool default_value);
+double jerryxx_get_property_number_by_key(jerry_value_t object,
+                                          jerry_value_t key,
+                                          double default_value);
+bool jerryxx_get_property_boolean_by_key(jerry_value_t object,
+                                         jerry_value_t key,
+                                         bool default_value);
 
 // array functions
 uint8_t *jerryxx_get_typedarray_buffer(jerry_value_t object);
@@ -48,6 +48,7 @@
 #define MSTR_DETACH_INTERRUPT "detachInterrupt"
 #define MSTR_ENABLE_INTERRUPTS "enableInterrupts"
 #define MSTR_DISABLE_INTERRUPTS "disableInterrupts"
+#define MSTR_GET_INTERRUPT_OVERFLOW "getInterruptOverflow"
 #define MSTR_PULSE_READ "pulseRead"
 #define MSTR_TIMEOUT "timeout"
 #define MSTR_START_STATE "startState"
@@ -70,6 +71,9 @@
 #define MSTR_SET_INTERVAL "setInterval"
 #define MSTR_CLEAR_TIMEOUT "clearTimeout"
 #define MSTR_CLEAR_INTERVAL "clearInterval"
+#define MSTR_SET_IMMEDIATE "setImmediate"
+#define MSTR_CLEAR_IMMEDIATE "clearImmediate"
+#define MSTR_QUEUE_MICROTASK "queueMicrotask"
 #define MSTR_DELAY "delay"
 #define MSTR_MILLIS "millis"
 #define MSTR_DELAY_MICROSECONDS "delayMicroseconds"
@@ -90,6 +94,8 @@
 #define MSTR_PLATFORM "platform"
 #define MSTR_VERSION "version"
 #define MSTR_MEMORY_USAGE "memoryUsage"
+#define MSTR_LOOP_STATS "loopStats"
+#define MSTR_RESET_LOOP_STATS "resetLoopStats"
 #define MSTR_BINDING "binding"
 #define MSTR_BUILTIN_MODULES "builtin_modules"
 #define MSTR_GET_BUILTIN_MODULE "getBuiltinModule"
@@ -167,6 +173,10 @@
 #define MSTR_RSSI "rssi"
 #define MSTR_CHANNEL "channel"
 
+/* block device */
+#define MSTR_READ "read"
+#define MSTR_IOCTL "ioctl"
+
 #define MSTR_HEAP___STDIN "__stdin"
 #define MSTR_HEAP___STDOUT "__stdout"
 #define MSTR_HEAP_TOTAL "heapTotal"
@@ -43,6 +43,14 @@ void km_system_cleanup();
  */
 void km_delay(uint32_t msec);
 
+/**
+ * Wait until an event (e.g. interrupt or TTY input) occurs or timeout expires.
+ * It may return earlier than the timeout.
+ *
+ * @param {uint32_t} msec maximum time to wait in milliseconds
+ */
+void km_wait_event(uint32_t msec);
+
 /**
  * Return current time (UNIX timestamp in milliseconds)
  */
@@ -27,6 +27,40 @@
 #include "board.h"
 #include "flash.h"
 
+/**
+ * User program image on flash:
+ *
+ *   +---------------------+ <- start of KALUMA_PROG_SECTOR_BASE
+ *   | km_prog_header_t    |
+ *   +---------------------+ <- km_prog_addr()
+ *   | payload (size)      |    JS source or JerryScript snapshot
+ *   +---------------------+
+ *
+ * The header is programmed last, so a partially written image is seen as
+ * erased. An image without header (null-terminated JS source) is also
+ * accepted for compatibility.
+ */
+
+#define KM_PROG_MAGIC 0x504D4B2E  // ".KMP"
+#define KM_PROG_VERSION 1
+
+typedef enum {
+  KM_PROG_FORMAT_NONE = 0,
+  KM_PROG_FORMAT_SOURCE = 1,
+  KM_PROG_FORMAT_SNAPSHOT = 2,
+} km_prog_format_t;
+
+typedef struct {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t format;  // km_prog_format_t
+  uint16_t reserved;
+  uint32_t size;  // payload size
+  uint32_t crc;   // CRC-32 of payload
+} km_prog_header_t;
+
+#define KM_PROG_HEADER_SIZE sizeof(km_prog_header_t)
+
 void km_prog_clear();
 void km_prog_begin();
 int km_prog_write(uint8_t *buffer, int size);
@@ -34,5 +68,7 @@ int km_prog_end();
 uint32_t km_prog_get_size();
 uint32_t km_prog_max_size();
 uint8_t *km_prog_addr();
+km_prog_format_t km_prog_get_format();
+int km_prog_verify();
 
 #endif /* __KM_PROG_H */
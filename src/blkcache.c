@@ -0,0 +1,394 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "blkcache.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+#include "jerryxx.h"
+
+#define ENTRY_VALID 0x01
+#define ENTRY_DIRTY 0x02
+
+static uint8_t *entry_data(km_blkcache_t *cache, km_blkcache_entry_t *e) {
+  return cache->data + (e - cache->entries) * cache->line_size;
+}
+
+static km_blkcache_entry_t *find_entry(km_blkcache_t *cache, uint32_t line) {
+  for (uint32_t i = 0; i < cache->count; i++) {
+    km_blkcache_entry_t *e = &cache->entries[i];
+    if ((e->flags & ENTRY_VALID) && e->line == line) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Drop the lines in [line, line + n) without writing them back
+ */
+static void drop_entries(km_blkcache_t *cache, uint32_t line, uint32_t n) {
+  for (uint32_t i = 0; i < cache->count; i++) {
+    km_blkcache_entry_t *e = &cache->entries[i];
+    if (e->line >= line && e->line - line < n) {
+      e->flags = 0;
+    }
+  }
+}
+
+/**
+ * Number of lines from the line (at most n) which can be transferred by a
+ * single device call: lines within a block, or whole blocks.
+ */
+static uint32_t run_limit(km_blkcache_t *cache, uint32_t line, uint32_t n) {
+  uint32_t max;
+  if (cache->lines_per_block == 1) {
+    max = cache->block_count - line;
+  } else {
+    max = cache->lines_per_block - line % cache->lines_per_block;
+  }
+  return n < max ? n : max;
+}
+
+static int dev_read(km_blkcache_t *cache, uint32_t line, uint32_t n,
+                    uint8_t *buffer) {
+  cache->stats.reads++;
+  return cache->dev->ops->read(
+      cache->dev, line / cache->lines_per_block,
+      (line % cache->lines_per_block) * cache->line_size, buffer,
+      n * cache->line_size);
+}
+
+static int dev_prog(km_blkcache_t *cache, uint32_t line, uint32_t n,
+                    const uint8_t *buffer) {
+  cache->stats.writes++;
+  return cache->dev->ops->prog(
+      cache->dev, line / cache->lines_per_block,
+      (line % cache->lines_per_block) * cache->line_size, buffer,
+      n * cache->line_size);
+}
+
+/**
+ * Take an entry for the line, evicting the least recently used one. If the
+ * victim is dirty, all dirty lines are written back first.
+ */
+static int alloc_entry(km_blkcache_t *cache, uint32_t line,
+                       km_blkcache_entry_t **entry) {
+  km_blkcache_entry_t *victim = NULL;
+  for (uint32_t i = 0; i < cache->count; i++) {
+    km_blkcache_entry_t *e = &cache->entries[i];
+    if (!(e->flags & ENTRY_VALID)) {
+      victim = e;
+      break;
+    }
+    if (victim == NULL || e->used - victim->used > UINT32_MAX / 2) {
+      victim = e;  // used earlier (tick wraps around)
+    }
+  }
+  if (victim->flags & ENTRY_VALID) {
+    if (victim->flags & ENTRY_DIRTY) {
+      int ret = km_blkcache_flush(cache);
+      if (ret < 0) return ret;
+    }
+    cache->stats.evictions++;
+  }
+  victim->line = line;
+  victim->used = ++cache->tick;
+  victim->flags = ENTRY_VALID;
+  *entry = victim;
+  return 0;
+}
+
+/**
+ * Take an entry for the line and fill it from the device
+ */
+static int load_entry(km_blkcache_t *cache, uint32_t line,
+                      km_blkcache_entry_t **entry) {
+  int ret = alloc_entry(cache, line, entry);
+  if (ret < 0) return ret;
+  ret = dev_read(cache, line, 1, entry_data(cache, *entry));
+  if (ret < 0) {
+    (*entry)->flags = 0;
+  }
+  return ret;
+}
+
+/**
+ * Read the lines following the line ahead, up to the first cached one
+ */
+static void read_ahead(km_blkcache_t *cache, uint32_t line) {
+  if (line >= cache->block_count * cache->lines_per_block) return;
+  uint32_t n = run_limit(cache, line, cache->read_ahead);
+  for (uint32_t i = 0; i < n; i++) {
+    if (find_entry(cache, line + i) != NULL) {
+      n = i;
+      break;
+    }
+  }
+  if (n == 0) return;
+  // take the entries first, as write-back of evicted lines uses batch_buffer
+  for (uint32_t i = 0; i < n; i++) {
+    km_blkcache_entry_t *e;
+    if (alloc_entry(cache, line + i, &e) < 0) {
+      drop_entries(cache, line, i + 1);
+      return;
+    }
+  }
+  bool ok = dev_read(cache, line, n, cache->batch_buffer) == 0;
+  for (uint32_t i = 0; i < n; i++) {
+    km_blkcache_entry_t *e = find_entry(cache, line + i);
+    if (ok) {
+      memcpy(entry_data(cache, e), cache->batch_buffer + i * cache->line_size,
+             cache->line_size);
+    } else {
+      e->flags = 0;
+    }
+  }
+  if (ok) cache->stats.read_aheads += n;
+}
+
+static int blkcache_read(km_blkdev_t *dev, uint32_t block, uint32_t offset,
+                         uint8_t *buffer, uint32_t size) {
+  km_blkcache_t *cache = (km_blkcache_t *)dev;
+  uint32_t line_size = cache->line_size;
+  uint32_t line = block * cache->lines_per_block + offset / line_size;
+  uint32_t off = offset % line_size;
+  bool sequential = line == cache->next_line ||
+                    (off > 0 && line + 1 == cache->next_line);
+  while (size > 0) {
+    uint32_t n = line_size - off < size ? line_size - off : size;
+    km_blkcache_entry_t *e = find_entry(cache, line);
+    if (e != NULL) {
+      cache->stats.hits++;
+      e->used = ++cache->tick;
+    } else if (off == 0 && size >= line_size) {
+      // read the missing whole lines directly into the buffer
+      uint32_t m = 1;
+      uint32_t max = run_limit(cache, line, size / line_size);
+      while (m < max && find_entry(cache, line + m) == NULL) m++;
+      int ret = dev_read(cache, line, m, buffer);
+      if (ret < 0) return ret;
+      cache->stats.misses += m;
+      if (m <= cache->count / 2) {
+        for (uint32_t i = 0; i < m; i++) {
+          ret = alloc_entry(cache, line + i, &e);
+          if (ret < 0) return ret;
+          memcpy(entry_data(cache, e), buffer + i * line_size, line_size);
+        }
+      }
+      n = m * line_size;
+      buffer += n;
+      size -= n;
+      line += m;
+      continue;
+    } else {
+      cache->stats.misses++;
+      int ret = load_entry(cache, line, &e);
+      if (ret < 0) return ret;
+    }
+    memcpy(buffer, entry_data(cache, e) + off, n);
+    buffer += n;
+    size -= n;
+    off += n;
+    if (off == line_size) {
+      off = 0;
+      line++;
+    }
+  }
+  cache->next_line = off > 0 ? line + 1 : line;
+  if (sequential && cache->read_ahead > 0) {
+    read_ahead(cache, cache->next_line);
+  }
+  return 0;
+}
+
+static int blkcache_prog(km_blkdev_t *dev, uint32_t block, uint32_t offset,
+                         const uint8_t *buffer, uint32_t size) {
+  km_blkcache_t *cache = (km_blkcache_t *)dev;
+  uint32_t line_size = cache->line_size;
+  uint32_t line = block * cache->lines_per_block + offset / line_size;
+  uint32_t off = offset % line_size;
+  while (size > 0) {
+    uint32_t n = line_size - off < size ? line_size - off : size;
+    if (off == 0 && size >= line_size) {
+      uint32_t m = run_limit(cache, line, size / line_size);
+      if (m > cache->count / 2) {
+        // write through, the cached lines are overwritten
+        drop_entries(cache, line, m);
+        int ret = dev_prog(cache, line, m, buffer);
+        if (ret < 0) return ret;
+        n = m * line_size;
+        buffer += n;
+        size -= n;
+        line += m;
+        continue;
+      }
+    }
+    km_blkcache_entry_t *e = find_entry(cache, line);
+    if (e != NULL) {
+      cache->stats.hits++;
+      e->used = ++cache->tick;
+    } else {
+      cache->stats.misses++;
+      int ret = n == line_size ? alloc_entry(cache, line, &e)
+                               : load_entry(cache, line, &e);
+      if (ret < 0) return ret;
+    }
+    memcpy(entry_data(cache, e) + off, buffer, n);
+    e->flags |= ENTRY_DIRTY;
+    buffer += n;
+    size -= n;
+    off += n;
+    if (off == line_size) {
+      off = 0;
+      line++;
+    }
+  }
+  return 0;
+}
+
+static int blkcache_erase(km_blkdev_t *dev, uint32_t block, uint32_t count) {
+  km_blkcache_t *cache = (km_blkcache_t *)dev;
+  drop_entries(cache, block * cache->lines_per_block,
+               count * cache->lines_per_block);
+  return cache->dev->ops->erase(cache->dev, block, count);
+}
+
+static int blkcache_sync(km_blkdev_t *dev) {
+  km_blkcache_t *cache = (km_blkcache_t *)dev;
+  int ret = km_blkcache_flush(cache);
+  if (ret < 0) return ret;
+  return cache->dev->ops->sync(cache->dev);
+}
+
+static int blkcache_ioctl(km_blkdev_t *dev, int op, int arg) {
+  km_blkcache_t *cache = (km_blkcache_t *)dev;
+  int flush_ret = 0;
+  if (op == KM_BLKDEV_INIT || op == KM_BLKDEV_SHUTDOWN) {
+    flush_ret = km_blkcache_flush(cache);
+  }
+  // the device op still runs so a failed write-back doesn't skip shutdown
+  int ret = km_blkdev_ioctl(cache->dev, op, arg);
+  if (op == KM_BLKDEV_INIT) {
+    drop_entries(cache, 0, UINT32_MAX);
+    cache->next_line = UINT32_MAX;
+  }
+  return flush_ret < 0 ? flush_ret : ret;
+}
+
+static const km_blkdev_ops_t blkcache_ops = {
+    .read = blkcache_read,
+    .prog = blkcache_prog,
+    .erase = blkcache_erase,
+    .sync = blkcache_sync,
+    .ioctl = blkcache_ioctl,
+};
+
+km_blkcache_t *km_blkcache_create(km_blkdev_t *dev, uint32_t line_size,
+                                  uint32_t size, uint32_t read_ahead) {
+  int block_size = km_blkdev_ioctl(dev, KM_BLKDEV_BLOCK_SIZE, 0);
+  int block_count = km_blkdev_ioctl(dev, KM_BLKDEV_BLOCK_COUNT, 0);
+  if (block_size <= 0 || block_count <= 0 || line_size == 0 ||
+      block_size % line_size != 0 || size < line_size) {
+    return NULL;
+  }
+  km_blkcache_t *cache = (km_blkcache_t *)calloc(1, sizeof(km_blkcache_t));
+  if (cache == NULL) return NULL;
+  cache->blkdev.ops = &blkcache_ops;
+  cache->dev = dev;
+  cache->block_count = block_count;
+  cache->line_size = line_size;
+  cache->lines_per_block = block_size / line_size;
+  cache->count = size / line_size;
+  cache->batch = read_ahead > KM_BLKCACHE_MIN_BATCH ? read_ahead
+                                                   : KM_BLKCACHE_MIN_BATCH;
+  if (cache->batch > cache->count) cache->batch = cache->count;
+  cache->read_ahead = read_ahead < cache->batch ? read_ahead : cache->batch;
+  cache->next_line = UINT32_MAX;
+  cache->entries = calloc(cache->count, sizeof(km_blkcache_entry_t));
+  cache->data = malloc(cache->count * line_size);
+  cache->batch_buffer = malloc(cache->batch * line_size);
+  if (cache->entries == NULL || cache->data == NULL ||
+      cache->batch_buffer == NULL) {
+    km_blkcache_free(cache);
+    return NULL;
+  }
+  return cache;
+}
+
+int km_blkcache_flush(km_blkcache_t *cache) {
+  while (true) {
+    // the dirty line of the lowest address
+    km_blkcache_entry_t *first = NULL;
+    for (uint32_t i = 0; i < cache->count; i++) {
+      km_blkcache_entry_t *e = &cache->entries[i];
+      if (!(e->flags & ENTRY_DIRTY)) continue;
+      if (first == NULL || e->line < first->line) first = e;
+    }
+    if (first == NULL) return 0;
+    // write with the adjacent dirty lines
+    uint32_t line = first->line;
+    uint32_t max = run_limit(cache, line, cache->batch);
+    uint32_t n = 1;
+    while (n < max) {
+      km_blkcache_entry_t *e = find_entry(cache, line + n);
+      if (e == NULL || !(e->flags & ENTRY_DIRTY)) break;
+      if (n == 1) {
+        memcpy(cache->batch_buffer, entry_data(cache, first),
+               cache->line_size);
+      }
+      memcpy(cache->batch_buffer + n * cache->line_size, entry_data(cache, e),
+             cache->line_size);
+      n++;
+    }
+    int ret = dev_prog(cache, line, n,
+                       n == 1 ? entry_data(cache, first) : cache->batch_buffer);
+    if (ret < 0) return ret;
+    for (uint32_t i = 0; i < n; i++) {
+      find_entry(cache, line + i)->flags &= ~ENTRY_DIRTY;
+    }
+    cache->stats.write_backs += n;
+  }
+}
+
+void km_blkcache_free(km_blkcache_t *cache) {
+  free(cache->batch_buffer);
+  free(cache->data);
+  free(cache->entries);
+  free(cache);
+}
+
+jerry_value_t km_blkcache_create_stats_object(km_blkcache_t *cache) {
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, "size", cache->count * cache->line_size);
+  jerryxx_set_property_number(obj, "lineSize", cache->line_size);
+  jerryxx_set_property_number(obj, "hits", cache->stats.hits);
+  jerryxx_set_property_number(obj, "misses", cache->stats.misses);
+  jerryxx_set_property_number(obj, "evictions", cache->stats.evictions);
+  jerryxx_set_property_number(obj, "readAheads", cache->stats.read_aheads);
+  jerryxx_set_property_number(obj, "writeBacks", cache->stats.write_backs);
+  jerryxx_set_property_number(obj, "reads", cache->stats.reads);
+  jerryxx_set_property_number(obj, "writes", cache->stats.writes);
+  return obj;
+}
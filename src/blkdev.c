@@ -0,0 +1,163 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "blkdev.h"
+
+#include <stdlib.h>
+
+#include "err.h"
+#include "jerryxx.h"
+#include "magic_strings.h"
+
+/**
+ * Native block device of a user-defined JS block device
+ */
+typedef struct {
+  km_blkdev_t blkdev;
+  jerry_value_t obj;
+} js_blkdev_t;
+
+static void km_blkdev_freecb(void *native_p) { free(native_p); }
+
+const jerry_object_native_info_t km_blkdev_native_info = {
+    .free_cb = km_blkdev_freecb};
+
+void km_blkdev_attach(jerry_value_t obj, km_blkdev_t *dev) {
+  jerry_set_object_native_pointer(obj, dev, &km_blkdev_native_info);
+}
+
+km_blkdev_t *km_blkdev_get(jerry_value_t obj) {
+  void *native_p;
+  if (jerry_get_object_native_pointer(obj, &native_p,
+                                      &km_blkdev_native_info)) {
+    return (km_blkdev_t *)native_p;
+  }
+  return NULL;
+}
+
+int km_blkdev_ioctl(km_blkdev_t *dev, int op, int arg) {
+  switch (op) {
+    case KM_BLKDEV_SYNC:
+      return dev->ops->sync(dev);
+    case KM_BLKDEV_ERASE:
+      return dev->ops->erase(dev, (uint32_t)arg, 1);
+    default:
+      return dev->ops->ioctl(dev, op, arg);
+  }
+}
+
+/**
+ * Call a method of the JS block device with (block, buffer, offset)
+ */
+static int js_blkdev_transfer(js_blkdev_t *dev, const char *method,
+                              uint32_t block, uint32_t offset,
+                              uint8_t *buffer, uint32_t size) {
+  jerry_value_t arraybuffer =
+      jerry_create_arraybuffer_external(size, buffer, NULL);
+  jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
+      JERRY_TYPEDARRAY_UINT8, arraybuffer);
+  jerry_value_t fn = jerry_get_property(dev->obj, jerryxx_key(method));
+  jerry_value_t block_js = jerry_create_number(block);
+  jerry_value_t offset_js = jerry_create_number(offset);
+  jerry_value_t args[3] = {block_js, buffer_js, offset_js};
+  jerry_value_t ret = jerry_call_function(fn, dev->obj, args, 3);
+  int err = jerry_value_is_error(ret) ? EIO : 0;
+  jerry_release_value(ret);
+  jerry_release_value(offset_js);
+  jerry_release_value(block_js);
+  jerry_release_value(fn);
+  jerry_release_value(buffer_js);
+  jerry_release_value(arraybuffer);
+  return err;
+}
+
+static int js_blkdev_ioctl(km_blkdev_t *dev, int op, int arg) {
+  jerry_value_t obj = ((js_blkdev_t *)dev)->obj;
+  jerry_value_t fn = jerry_get_property(obj, jerryxx_key(MSTR_IOCTL));
+  jerry_value_t op_js = jerry_create_number(op);
+  jerry_value_t arg_js = jerry_create_number(arg);
+  jerry_value_t args[2] = {op_js, arg_js};
+  jerry_value_t ret = jerry_call_function(fn, obj, args, 2);
+  int ret_value = 0;
+  if (jerry_value_is_error(ret)) {
+    ret_value = EIO;
+  } else if (jerry_value_is_number(ret)) {
+    ret_value = (int)jerry_get_number_value(ret);
+  }
+  jerry_release_value(ret);
+  jerry_release_value(arg_js);
+  jerry_release_value(op_js);
+  jerry_release_value(fn);
+  return ret_value;
+}
+
+static int js_blkdev_read(km_blkdev_t *dev, uint32_t block, uint32_t offset,
+                          uint8_t *buffer, uint32_t size) {
+  return js_blkdev_transfer((js_blkdev_t *)dev, MSTR_READ, block, offset,
+                            buffer, size);
+}
+
+static int js_blkdev_prog(km_blkdev_t *dev, uint32_t block, uint32_t offset,
+                          const uint8_t *buffer, uint32_t size) {
+  return js_blkdev_transfer((js_blkdev_t *)dev, MSTR_WRITE, block, offset,
+                            (uint8_t *)buffer, size);
+}
+
+static int js_blkdev_erase(km_blkdev_t *dev, uint32_t block, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    int ret = js_blkdev_ioctl(dev, KM_BLKDEV_ERASE, block + i);
+    if (ret < 0) return ret;
+  }
+  return 0;
+}
+
+static int js_blkdev_sync(km_blkdev_t *dev) {
+  return js_blkdev_ioctl(dev, KM_BLKDEV_SYNC, 0);
+}
+
+static const km_blkdev_ops_t js_blkdev_ops = {
+    .read = js_blkdev_read,
+    .prog = js_blkdev_prog,
+    .erase = js_blkdev_erase,
+    .sync = js_blkdev_sync,
+    .ioctl = js_blkdev_ioctl,
+};
+
+km_blkdev_t *km_blkdev_open(jerry_value_t obj) {
+  km_blkdev_t *dev = km_blkdev_get(obj);
+  if (dev != NULL) {
+    return dev;
+  }
+  js_blkdev_t *js_dev = (js_blkdev_t *)malloc(sizeof(js_blkdev_t));
+  if (js_dev == NULL) {
+    return NULL;
+  }
+  js_dev->blkdev.ops = &js_blkdev_ops;
+  js_dev->obj = jerry_acquire_value(obj);
+  return &js_dev->blkdev;
+}
+
+void km_blkdev_close(km_blkdev_t *dev) {
+  if (dev != NULL && dev->ops == &js_blkdev_ops) {
+    jerry_release_value(((js_blkdev_t *)dev)->obj);
+    free(dev);
+  }
+}
@@ -330,7 +330,9 @@ JERRYXX_FUN(pulse_write_fn) {
   return jerry_create_number(length);
 }
 
-static void watch_close_cb(km_io_handle_t *handle) { free(handle); }
+static void watch_close_cb(km_io_handle_t *handle) {
+  km_io_handle_free(handle);
+}
 
 static void set_watch_cb(km_io_watch_handle_t *watch) {
   if (jerry_value_is_function(watch->watch_js_cb)) {
@@ -363,8 +365,15 @@ JERRYXX_FUN(set_watch_fn) {
   km_io_watch_mode_t events =
       JERRYXX_GET_ARG_NUMBER_OPT(2, KM_IO_WATCH_MODE_CHANGE);
   uint32_t debounce = JERRYXX_GET_ARG_NUMBER_OPT(3, 0);
-  km_io_watch_handle_t *watch = malloc(sizeof(km_io_watch_handle_t));
+  km_io_watch_handle_t *watch = km_io_handle_alloc(KM_IO_WATCH);
+  if (watch == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   km_io_watch_init(watch);
+  if (watch->base.id == KM_IO_INVALID_ID) {  // no free slot
+    km_io_handle_free((km_io_handle_t *)watch);
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   watch->watch_js_cb = jerry_acquire_value(callback);
   km_io_watch_start(watch, set_watch_cb, pin, events, debounce);
   return jerry_create_number(watch->base.id);
@@ -423,24 +432,37 @@ static void register_global_digital_io() {
 
 static jerry_value_t irq_js_cb[GPIO_MAX];
 
+/**
+ * Called in interrupt context: only queue the event, the callbacks are
+ * called later from the I/O loop (see irq_dispatch_cb).
+ */
 static void irq_cb(uint8_t pin, km_gpio_io_mode_t mode) {
-  jerry_value_t cb = irq_js_cb[pin];
-  if (jerry_value_is_function(cb)) {
-    jerry_value_t this_val = jerry_create_undefined();
-    jerry_value_t arg_pin = jerry_create_number(pin);
-    jerry_value_t arg_mode = jerry_create_number(mode);
-    jerry_value_t args_p[2] = {arg_pin, arg_mode};
-    jerry_value_t ret_val = jerry_call_function(cb, this_val, args_p, 2);
-    if (jerry_value_is_error(ret_val)) {
-      // print error
-      jerryxx_print_error(ret_val, true);
+  km_io_irq_push(pin, (uint8_t)mode);
+}
+
+static void irq_dispatch_cb(km_io_irq_event_t *events, size_t count) {
+  jerry_value_t this_val = jerry_create_undefined();
+  for (size_t i = 0; i < count; i++) {
+    km_io_irq_event_t *event = &events[i];
+    if (event->pin >= GPIO_MAX) continue;
+    jerry_value_t cb = irq_js_cb[event->pin];
+    if (jerry_value_is_function(cb)) {
+      jerry_value_t arg_pin = jerry_create_number(event->pin);
+      jerry_value_t arg_mode = jerry_create_number(event->events);
+      jerry_value_t arg_time = jerry_create_number((double)event->time);
+      jerry_value_t args_p[3] = {arg_pin, arg_mode, arg_time};
+      jerry_value_t ret_val = jerry_call_function(cb, this_val, args_p, 3);
+      if (jerry_value_is_error(ret_val)) {
+        // print error
+        jerryxx_print_error(ret_val, true);
+      }
+      jerry_release_value(arg_pin);
+      jerry_release_value(arg_mode);
+      jerry_release_value(arg_time);
+      jerry_release_value(ret_val);
     }
-    jerry_release_value(arg_pin);
-    jerry_release_value(arg_mode);
-    jerry_release_value(ret_val);
-    jerry_release_value(this_val);
   }
-  jerry_release_value(cb);
+  jerry_release_value(this_val);
 }
 
 JERRYXX_FUN(attach_interrupt_fn) {
@@ -458,7 +480,9 @@ JERRYXX_FUN(attach_interrupt_fn) {
     return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *)errmsg);
   }
   if (jerry_value_is_function(callback)) {
+    jerry_release_value(irq_js_cb[pin]);
     irq_js_cb[pin] = jerry_acquire_value(callback);
+    km_io_irq_start(irq_dispatch_cb);
     km_gpio_irq_set_callback(irq_cb);
   }
   if (km_gpio_irq_attach(pin, events) < 0) {
@@ -484,6 +508,7 @@ JERRYXX_FUN(detach_interrupt_fn) {
 }
 
 JERRYXX_FUN(enable_interrupts_fn) {
+  km_io_irq_start(irq_dispatch_cb);
   km_gpio_irq_set_callback(irq_cb);
   km_gpio_irq_enable();
   return jerry_create_undefined();
@@ -495,7 +520,15 @@ JERRYXX_FUN(disable_interrupts_fn) {
   return jerry_create_undefined();
 }
 
+JERRYXX_FUN(get_interrupt_overflow_fn) {
+  return jerry_create_number(km_io_irq_get_overflow());
+}
+
 static void register_global_interrupts() {
+  // callbacks of the previous VM context are no longer valid
+  for (int i = 0; i < GPIO_MAX; i++) {
+    irq_js_cb[i] = 0;
+  }
   jerry_value_t global = jerry_get_global_object();
   jerryxx_set_property_function(global, MSTR_ATTACH_INTERRUPT,
                                 attach_interrupt_fn);
@@ -505,6 +538,8 @@ static void register_global_interrupts() {
                                 enable_interrupts_fn);
   jerryxx_set_property_function(global, MSTR_DISABLE_INTERRUPTS,
                                 disable_interrupts_fn);
+  jerryxx_set_property_function(global, MSTR_GET_INTERRUPT_OVERFLOW,
+                                get_interrupt_overflow_fn);
   jerry_release_value(global);
 }
 
@@ -514,7 +549,9 @@ static void register_global_interrupts() {
 /*                                                                          */
 /****************************************************************************/
 
-static void timer_close_cb(km_io_handle_t *handle) { free(handle); }
+static void timer_close_cb(km_io_handle_t *handle) {
+  km_io_handle_free(handle);
+}
 
 static void set_timer_cb(km_io_timer_handle_t *timer) {
   if (jerry_value_is_function(timer->timer_js_cb)) {
@@ -545,10 +582,22 @@ JERRYXX_FUN(set_timeout_fn) {
   JERRYXX_CHECK_ARG_NUMBER(1, "delay");
   jerry_value_t callback = JERRYXX_GET_ARG(0);
   uint64_t delay = (uint64_t)JERRYXX_GET_ARG_NUMBER(1);
-  km_io_timer_handle_t *timer = malloc(sizeof(km_io_timer_handle_t));
+  km_io_timer_handle_t *timer = km_io_handle_alloc(KM_IO_TIMER);
+  if (timer == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   km_io_timer_init(timer);
+  if (timer->base.id == KM_IO_INVALID_ID) {  // no free slot
+    km_io_handle_free((km_io_handle_t *)timer);
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   timer->timer_js_cb = jerry_acquire_value(callback);
-  km_io_timer_start(timer, set_timer_cb, delay, false);
+  int ret = km_io_timer_start(timer, set_timer_cb, delay, false);
+  if (ret < 0) {
+    jerry_release_value(timer->timer_js_cb);
+    km_io_handle_close((km_io_handle_t *)timer, timer_close_cb);
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
   return jerry_create_number(timer->base.id);
 }
 
@@ -557,10 +606,22 @@ JERRYXX_FUN(set_interval_fn) {
   JERRYXX_CHECK_ARG_NUMBER(1, "delay");
   jerry_value_t callback = JERRYXX_GET_ARG(0);
   uint64_t delay = (uint64_t)JERRYXX_GET_ARG_NUMBER(1);
-  km_io_timer_handle_t *timer = malloc(sizeof(km_io_timer_handle_t));
+  km_io_timer_handle_t *timer = km_io_handle_alloc(KM_IO_TIMER);
+  if (timer == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   km_io_timer_init(timer);
+  if (timer->base.id == KM_IO_INVALID_ID) {  // no free slot
+    km_io_handle_free((km_io_handle_t *)timer);
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   timer->timer_js_cb = jerry_acquire_value(callback);
-  km_io_timer_start(timer, set_timer_cb, delay, true);
+  int ret = km_io_timer_start(timer, set_timer_cb, delay, true);
+  if (ret < 0) {
+    jerry_release_value(timer->timer_js_cb);
+    km_io_handle_close((km_io_handle_t *)timer, timer_close_cb);
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
   return jerry_create_number(timer->base.id);
 }
 
@@ -600,12 +661,97 @@ JERRYXX_FUN(micros_fn) {
   return jerry_create_number(usec);
 }
 
+static void immediate_close_cb(km_io_handle_t *handle) {
+  km_io_handle_free(handle);
+}
+
+static void set_immediate_cb(km_io_check_handle_t *check) {
+  jerry_value_t this_val = jerry_create_undefined();
+  jerry_value_t ret_val =
+      jerry_call_function(check->check_js_cb, this_val, NULL, 0);
+  if (jerry_value_is_error(ret_val)) {
+    // print error
+    jerryxx_print_error(ret_val, true);
+  }
+  jerry_release_value(ret_val);
+  jerry_release_value(this_val);
+  jerry_release_value(check->check_js_cb);
+  km_io_handle_close((km_io_handle_t *)check, immediate_close_cb);
+}
+
+JERRYXX_FUN(set_immediate_fn) {
+  JERRYXX_CHECK_ARG_FUNCTION(0, "callback");
+  jerry_value_t callback = JERRYXX_GET_ARG(0);
+  km_io_check_handle_t *check = km_io_handle_alloc(KM_IO_CHECK);
+  if (check == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  km_io_check_init(check);
+  if (check->base.id == KM_IO_INVALID_ID) {  // no free slot
+    km_io_handle_free((km_io_handle_t *)check);
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  check->check_js_cb = jerry_acquire_value(callback);
+  km_io_check_start(check, set_immediate_cb);
+  return jerry_create_number(check->base.id);
+}
+
+JERRYXX_FUN(clear_immediate_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "id");
+  int id = (int)JERRYXX_GET_ARG_NUMBER(0);
+  km_io_check_handle_t *check = km_io_check_get_by_id(id);
+  if (check != NULL) {
+    jerry_release_value(check->check_js_cb);
+    km_io_check_stop(check);
+    km_io_handle_close((km_io_handle_t *)check, immediate_close_cb);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Report an error thrown in a queueMicrotask() callback
+ */
+JERRYXX_FUN(microtask_error_fn) {
+  jerry_value_t error =
+      jerry_create_error_from_value(JERRYXX_GET_ARG(0), false);
+  jerryxx_print_error(error, true);
+  jerry_release_value(error);
+  return jerry_create_undefined();
+}
+
+JERRYXX_FUN(queue_microtask_fn) {
+  JERRYXX_CHECK_ARG_FUNCTION(0, "callback");
+  jerry_value_t callback = JERRYXX_GET_ARG(0);
+  // Promise.resolve().then(callback).then(undefined, microtask_error_fn)
+  jerry_value_t undefined = jerry_create_undefined();
+  jerry_value_t promise = jerry_create_promise();
+  jerry_value_t ret = jerry_resolve_or_reject_promise(promise, undefined, true);
+  jerry_release_value(ret);
+  jerry_value_t then_fn = jerryxx_get_property(promise, "then");
+  jerry_value_t reaction = jerry_call_function(then_fn, promise, &callback, 1);
+  jerry_value_t error_fn = jerry_create_external_function(microtask_error_fn);
+  jerry_value_t args_p[2] = {undefined, error_fn};
+  ret = jerry_call_function(then_fn, reaction, args_p, 2);
+  jerry_release_value(ret);
+  jerry_release_value(error_fn);
+  jerry_release_value(reaction);
+  jerry_release_value(then_fn);
+  jerry_release_value(promise);
+  jerry_release_value(undefined);
+  return jerry_create_undefined();
+}
+
 static void register_global_timers() {
   jerry_value_t global = jerry_get_global_object();
   jerryxx_set_property_function(global, MSTR_SET_TIMEOUT, set_timeout_fn);
   jerryxx_set_property_function(global, MSTR_SET_INTERVAL, set_interval_fn);
   jerryxx_set_property_function(global, MSTR_CLEAR_TIMEOUT, clear_timer_fn);
   jerryxx_set_property_function(global, MSTR_CLEAR_INTERVAL, clear_timer_fn);
+  jerryxx_set_property_function(global, MSTR_SET_IMMEDIATE, set_immediate_fn);
+  jerryxx_set_property_function(global, MSTR_CLEAR_IMMEDIATE,
+                                clear_immediate_fn);
+  jerryxx_set_property_function(global, MSTR_QUEUE_MICROTASK,
+                                queue_microtask_fn);
   jerryxx_set_property_function(global, MSTR_DELAY, delay_fn);
   jerryxx_set_property_function(global, MSTR_MILLIS, millis_fn);
   jerryxx_set_property_function(global, MSTR_DELAY_MICROSECONDS,
@@ -704,10 +850,22 @@ JERRYXX_FUN(tone_fn) {
     }
     // setup timer for duration
     if (duration > 0) {
-      km_io_timer_handle_t *timer = malloc(sizeof(km_io_timer_handle_t));
+      km_io_timer_handle_t *timer = km_io_handle_alloc(KM_IO_TIMER);
+      if (timer == NULL) {
+        km_pwm_stop(pin);
+        return jerry_create_error_from_value(create_system_error(ENOMEM),
+                                             true);
+      }
       km_io_timer_init(timer);
       timer->tag = pin;
-      km_io_timer_start(timer, tone_timeout_cb, duration, false);
+      ret = timer->base.id == KM_IO_INVALID_ID  // no free slot
+                ? ENOMEM
+                : km_io_timer_start(timer, tone_timeout_cb, duration, false);
+      if (ret < 0) {
+        km_io_handle_close((km_io_handle_t *)timer, timer_close_cb);
+        km_pwm_stop(pin);
+        return jerry_create_error_from_value(create_system_error(ret), true);
+      }
     }
     return jerry_create_undefined();
   }
@@ -864,6 +1022,54 @@ JERRYXX_FUN(process_memory_usage_fn) {
   return jerry_create_undefined();
 }
 
+#ifdef KM_IO_STATS
+static const char *loop_phase_names[KM_IO_PHASE_MAX] = {
+    "irq",   "timer", "tty",     "watch",  "uart",
+    "check", "idle",  "closing", "custom", "wait"};
+
+JERRYXX_FUN(process_loop_stats_fn) {
+  km_io_stats_t *stats = km_io_stats_get();
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, "elapsed",
+                              km_gettime() - stats->start_time);
+  jerryxx_set_property_number(obj, "iterations", stats->iterations);
+  jerry_value_t phases = jerry_create_object();
+  jerry_value_t callbacks = jerry_create_object();
+  for (int i = 0; i < KM_IO_PHASE_MAX; i++) {
+    jerry_value_t phase = jerry_create_object();
+    jerryxx_set_property_number(phase, "time", stats->phase_time[i]);
+    jerryxx_set_property_number(phase, "max", stats->phase_max[i]);
+    jerryxx_set_property(phases, loop_phase_names[i], phase);
+    jerry_release_value(phase);
+    if (i != KM_IO_PHASE_CUSTOM && i != KM_IO_PHASE_WAIT) {
+      jerryxx_set_property_number(callbacks, loop_phase_names[i],
+                                  stats->callbacks[i]);
+    }
+  }
+  jerryxx_set_property(obj, "phases", phases);
+  jerryxx_set_property(obj, "callbacks", callbacks);
+  jerryxx_set_property_number(obj, "callbackMax", stats->callback_max);
+  jerry_release_value(phases);
+  jerry_release_value(callbacks);
+  jerry_value_t lateness = jerry_create_array(KM_IO_LATENESS_BUCKETS);
+  for (int i = 0; i < KM_IO_LATENESS_BUCKETS; i++) {
+    jerry_value_t value = jerry_create_number(stats->lateness[i]);
+    jerry_value_t ret = jerry_set_property_by_index(lateness, i, value);
+    jerry_release_value(ret);
+    jerry_release_value(value);
+  }
+  jerryxx_set_property(obj, "timerLateness", lateness);
+  jerryxx_set_property_number(obj, "timerLatenessMax", stats->lateness_max);
+  jerry_release_value(lateness);
+  return obj;
+}
+
+JERRYXX_FUN(process_reset_loop_stats_fn) {
+  km_io_stats_reset();
+  return jerry_create_undefined();
+}
+#endif /* KM_IO_STATS */
+
 // process.stdin getter
 JERRYXX_FUN(process_stdin_getter_fn) {
   jerry_value_t stream = jerryxx_call_require("stream");
@@ -909,6 +1115,12 @@ static void register_global_process_object() {
   jerryxx_set_property_string(process, MSTR_VERSION, KALUMA_VERSION);
   jerryxx_set_property_function(process, MSTR_MEMORY_USAGE,
                                 process_memory_usage_fn);
+#ifdef KM_IO_STATS
+  jerryxx_set_property_function(process, MSTR_LOOP_STATS,
+                                process_loop_stats_fn);
+  jerryxx_set_property_function(process, MSTR_RESET_LOOP_STATS,
+                                process_reset_loop_stats_fn);
+#endif
 
   // add `process.binding` function and it's properties
   jerry_value_t binding_fn = jerry_create_external_function(process_binding_fn);
@@ -22,9 +22,12 @@
 #include "io.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "err.h"
 #include "gpio.h"
 #include "system.h"
 #include "tty.h"
@@ -38,15 +41,219 @@ static void km_io_timer_run();
 static void km_io_tty_run();
 static void km_io_watch_run();
 static void km_io_uart_run();
+static void km_io_irq_run();
+static void km_io_check_run();
 static void km_io_idle_run();
-static void km_io_idle_run();
+static void km_io_jobs_run();
+
+/* loop statistics */
+
+#ifdef KM_IO_STATS
+
+static uint32_t km_io_stats_elapsed(uint64_t start) {
+  uint64_t now = km_micro_gettime();
+  if (now < start) {
+    return (uint32_t)((km_micro_maxtime() - start) + now);
+  }
+  return (uint32_t)(now - start);
+}
+
+static void km_io_stats_phase(km_io_phase_t phase, void (*phase_fn)()) {
+  uint64_t start = km_micro_gettime();
+  phase_fn();
+  uint32_t elapsed = km_io_stats_elapsed(start);
+  loop.stats.phase_time[phase] += elapsed;
+  if (elapsed > loop.stats.phase_max[phase]) {
+    loop.stats.phase_max[phase] = elapsed;
+  }
+}
+
+static void km_io_stats_callback(km_io_phase_t phase, uint64_t start) {
+  uint32_t elapsed = km_io_stats_elapsed(start);
+  loop.stats.callbacks[phase]++;
+  if (elapsed > loop.stats.callback_max) {
+    loop.stats.callback_max = elapsed;
+  }
+}
+
+static void km_io_stats_lateness(km_io_timer_handle_t *timer) {
+  uint64_t now = km_gettime();
+  uint64_t lateness =
+      now > timer->clamped_timeout ? now - timer->clamped_timeout : 0;
+  int i = 0;
+  while (i < KM_IO_LATENESS_BUCKETS - 1 && lateness > (1u << i)) {
+    i++;
+  }
+  loop.stats.lateness[i]++;
+  if (lateness > loop.stats.lateness_max) {
+    loop.stats.lateness_max = lateness;
+  }
+}
+
+km_io_stats_t *km_io_stats_get() { return &loop.stats; }
+
+void km_io_stats_reset() {
+  memset(&loop.stats, 0, sizeof(km_io_stats_t));
+  loop.stats.start_time = km_gettime();
+}
+
+#define KM_IO_PHASE(phase, phase_fn) km_io_stats_phase(phase, phase_fn)
+#define KM_IO_CALLBACK(phase, call)        \
+  do {                                     \
+    uint64_t __start = km_micro_gettime(); \
+    call;                                  \
+    km_io_stats_callback(phase, __start);  \
+    km_io_jobs_run();                      \
+  } while (0)
+#define KM_IO_TIMER_LATENESS(timer) km_io_stats_lateness(timer)
+
+#else
+
+#define KM_IO_PHASE(phase, phase_fn) phase_fn()
+#define KM_IO_CALLBACK(phase, call) \
+  do {                              \
+    call;                           \
+    km_io_jobs_run();               \
+  } while (0)
+#define KM_IO_TIMER_LATENESS(timer)
+
+#endif /* KM_IO_STATS */
+
+/* handle pools */
+
+typedef struct km_io_pool_slab_s {
+  struct km_io_pool_slab_s *next;
+  uint64_t align;  // handles follow this header
+} km_io_pool_slab_t;
+
+typedef struct {
+  void *free_list;
+  km_io_pool_slab_t *slabs;
+  uint32_t used;
+} km_io_pool_t;
+
+static km_io_pool_t pools[KM_IO_TYPE_MAX];
+
+static const size_t pool_block_size[KM_IO_TYPE_MAX] = {
+    [KM_IO_TIMER] = sizeof(km_io_timer_handle_t),
+    [KM_IO_TTY] = sizeof(km_io_tty_handle_t),
+    [KM_IO_WATCH] = sizeof(km_io_watch_handle_t),
+    [KM_IO_UART] = sizeof(km_io_uart_handle_t),
+    [KM_IO_IDLE] = sizeof(km_io_idle_handle_t),
+    [KM_IO_STREAM] = sizeof(km_io_stream_handle_t),
+    [KM_IO_CHECK] = sizeof(km_io_check_handle_t),
+};
+
+#define KM_IO_POOL_BLOCK_SIZE(type) ((pool_block_size[type] + 7) & ~7)
+
+static bool km_io_pool_grow(km_io_pool_t *pool, km_io_type_t type) {
+  size_t block_size = KM_IO_POOL_BLOCK_SIZE(type);
+  km_io_pool_slab_t *slab = malloc(offsetof(km_io_pool_slab_t, align) +
+                                   block_size * KM_IO_POOL_SLAB_COUNT);
+  if (slab == NULL) {
+    return false;
+  }
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  uint8_t *block = (uint8_t *)&slab->align;
+  for (int i = 0; i < KM_IO_POOL_SLAB_COUNT; i++) {
+    *(void **)block = pool->free_list;
+    pool->free_list = block;
+    block += block_size;
+  }
+  return true;
+}
+
+/**
+ * Release the slabs of the pools which have no handle in use
+ */
+static void km_io_pool_trim() {
+  for (int i = 0; i < KM_IO_TYPE_MAX; i++) {
+    km_io_pool_t *pool = &pools[i];
+    if (pool->used == 0) {
+      while (pool->slabs != NULL) {
+        km_io_pool_slab_t *next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+      }
+      pool->free_list = NULL;
+    }
+  }
+}
+
+/* handle slot table */
+
+static uint32_t km_io_slot_alloc(km_io_handle_t *handle) {
+  if (loop.slot_free >= loop.slot_capacity) {
+    uint32_t capacity = loop.slot_capacity > 0 ? loop.slot_capacity * 2 : 16;
+    if (capacity > KM_IO_SLOT_MAX) {
+      capacity = KM_IO_SLOT_MAX;
+    }
+    if (capacity == loop.slot_capacity) {
+      return KM_IO_INVALID_ID;  // slot table is full
+    }
+    km_io_slot_t *slots = realloc(loop.slots, sizeof(km_io_slot_t) * capacity);
+    if (slots == NULL) {
+      return KM_IO_INVALID_ID;
+    }
+    for (uint32_t i = loop.slot_capacity; i < capacity; i++) {
+      slots[i].handle = NULL;
+      slots[i].gen = 1;
+      slots[i].next_free = i + 1;
+    }
+    loop.slot_free = loop.slot_capacity;
+    loop.slots = slots;
+    loop.slot_capacity = capacity;
+  }
+  uint32_t index = loop.slot_free;
+  km_io_slot_t *slot = &loop.slots[index];
+  loop.slot_free = slot->next_free;
+  slot->handle = handle;
+  return ((uint32_t)slot->gen << KM_IO_SLOT_BITS) | index;
+}
+
+static void km_io_slot_release(km_io_handle_t *handle) {
+  uint32_t index = handle->id & (KM_IO_SLOT_MAX - 1);
+  if (handle->id == KM_IO_INVALID_ID || index >= loop.slot_capacity) {
+    return;
+  }
+  km_io_slot_t *slot = &loop.slots[index];
+  if (slot->handle != handle) {
+    return;  // already released
+  }
+  slot->handle = NULL;
+  slot->gen = slot->gen < KM_IO_SLOT_GEN_MAX ? slot->gen + 1 : 1;
+  slot->next_free = loop.slot_free;
+  loop.slot_free = index;
+}
 
 /* general handle functions */
 
-uint32_t handle_id_count = 0;
+/**
+ * Allocate a handle of the given type from the pool. The handle should be
+ * freed by km_io_handle_free().
+ */
+void *km_io_handle_alloc(km_io_type_t type) {
+  km_io_pool_t *pool = &pools[type];
+  if (pool->free_list == NULL && !km_io_pool_grow(pool, type)) {
+    return NULL;
+  }
+  void *block = pool->free_list;
+  pool->free_list = *(void **)block;
+  pool->used++;
+  return block;
+}
+
+void km_io_handle_free(km_io_handle_t *handle) {
+  km_io_pool_t *pool = &pools[handle->type];
+  km_io_slot_release(handle);
+  *(void **)handle = pool->free_list;
+  pool->free_list = handle;
+  pool->used--;
+}
 
 void km_io_handle_init(km_io_handle_t *handle, km_io_type_t type) {
-  handle->id = handle_id_count++;
+  handle->id = km_io_slot_alloc(handle);
   handle->type = type;
   handle->flags = 0;
   handle->close_cb = NULL;
@@ -55,18 +262,26 @@ void km_io_handle_init(km_io_handle_t *handle, km_io_type_t type) {
 void km_io_handle_close(km_io_handle_t *handle, km_io_close_cb close_cb) {
   KM_IO_SET_FLAG_ON(handle->flags, KM_IO_FLAG_CLOSING);
   handle->close_cb = close_cb;
+  km_io_slot_release(handle);  // not found by id from now on
   km_list_append(&loop.closing_handles, (km_list_node_t *)handle);
 }
 
-km_io_handle_t *km_io_handle_get_by_id(uint32_t id, km_list_t *handle_list) {
-  km_io_handle_t *handle = (km_io_handle_t *)handle_list->head;
-  while (handle != NULL) {
-    if (handle->id == id) {
-      return handle;
-    }
-    handle = (km_io_handle_t *)((km_list_node_t *)handle)->next;
+/**
+ * Find an active handle of the given type by id
+ */
+km_io_handle_t *km_io_handle_get_by_id(uint32_t id, km_io_type_t type) {
+  uint32_t index = id & (KM_IO_SLOT_MAX - 1);
+  if (index >= loop.slot_capacity) {
+    return NULL;
+  }
+  km_io_slot_t *slot = &loop.slots[index];
+  km_io_handle_t *handle = slot->handle;
+  if (handle == NULL || slot->gen != (id >> KM_IO_SLOT_BITS) ||
+      handle->type != type ||
+      !KM_IO_HAS_FLAG(handle->flags, KM_IO_FLAG_ACTIVE)) {
+    return NULL;
   }
-  return NULL;
+  return handle;
 }
 
 static void km_io_update_time() { loop.time = km_gettime(); }
@@ -76,7 +291,7 @@ static void km_io_handle_closing() {
     km_io_handle_t *handle = (km_io_handle_t *)loop.closing_handles.head;
     km_list_remove(&loop.closing_handles, (km_list_node_t *)handle);
     if (handle->close_cb) {
-      handle->close_cb(handle);
+      KM_IO_CALLBACK(KM_IO_PHASE_CLOSING, handle->close_cb(handle));
     }
   }
 }
@@ -86,103 +301,264 @@ static void km_io_handle_closing() {
 void km_io_init() {
   loop.stop_flag = false;
   km_io_update_time();
+  loop.timer_heap = NULL;
+  loop.timer_count = 0;
+  loop.timer_capacity = 0;
+  loop.timer_seq = 0;
   km_list_init(&loop.tty_handles);
-  km_list_init(&loop.timer_handles);
   km_list_init(&loop.watch_handles);
   km_list_init(&loop.uart_handles);
   km_list_init(&loop.idle_handles);
   km_list_init(&loop.stream_handles);
+  km_list_init(&loop.check_handles);
+  loop.check_seq = 0;
   km_list_init(&loop.closing_handles);
+  loop.slots = NULL;
+  loop.slot_capacity = 0;
+  loop.slot_free = 0;
+  loop.irq_queue.head = 0;
+  loop.irq_queue.tail = 0;
+  loop.irq_queue.overflow = 0;
+  loop.irq_queue.overflow_base = 0;
+  loop.irq_queue.irq_cb = NULL;
+  loop.jobs_cb = NULL;
+  loop.jobs_pending = false;
+#ifdef KM_IO_STATS
+  km_io_stats_reset();
+#endif
 }
 
 void km_io_cleanup() {
   km_io_timer_cleanup();
   km_io_watch_cleanup();
   km_io_uart_cleanup();
+  km_io_irq_cleanup();
   // km_io_idle_cleanup();
   // Do not cleanup tty I/O to keep terminal communication
   km_io_stream_cleanup();
+  km_io_check_cleanup();
+  km_io_pool_trim();
+}
+
+/**
+ * Compute how long the loop can wait for events (in msec) before the next
+ * timer expires. Watch handles are polled (for debouncing) and closing
+ * handles must be processed, so the loop doesn't wait if there are any.
+ * Idle handles run once after the other phases in each iteration, so they
+ * don't prevent waiting.
+ */
+static uint32_t km_io_wait_timeout() {
+  if (loop.closing_handles.head != NULL || loop.watch_handles.head != NULL ||
+      loop.check_handles.head != NULL || loop.jobs_pending ||
+      km_io_irq_pending() > 0) {
+    return 0;
+  }
+  uint64_t timeout = KM_IO_MAX_WAIT_TIME;
+  if (loop.timer_count > 0) {
+    // timer expires when loop.time > clamped_timeout
+    uint64_t expire = loop.timer_heap[0]->clamped_timeout + 1;
+    uint64_t now = km_gettime();
+    if (expire <= now) {
+      return 0;
+    }
+    if (expire - now < timeout) {
+      timeout = expire - now;
+    }
+  }
+  return (uint32_t)timeout;
+}
+
+static void km_io_custom_run() {
+  km_custom_infinite_loop();
+  // target specific loop may call JS (e.g. network callbacks)
+  km_io_jobs_run();
+}
+
+static void km_io_wait() {
+  uint32_t timeout = km_io_wait_timeout();
+  if (timeout > 0) {
+    km_wait_event(timeout);
+  }
 }
 
 void km_io_run(bool infinite) {
   while (loop.stop_flag == false) {
     km_io_update_time();
-    km_io_timer_run();
-    km_io_tty_run();
-    km_io_watch_run();
-    km_io_uart_run();
-    km_io_idle_run();
-    km_io_handle_closing();
-    km_custom_infinite_loop();
+    if (loop.jobs_pending) {
+      km_io_jobs_run();
+    }
+    KM_IO_PHASE(KM_IO_PHASE_IRQ, km_io_irq_run);
+    KM_IO_PHASE(KM_IO_PHASE_TIMER, km_io_timer_run);
+    KM_IO_PHASE(KM_IO_PHASE_TTY, km_io_tty_run);
+    KM_IO_PHASE(KM_IO_PHASE_WATCH, km_io_watch_run);
+    KM_IO_PHASE(KM_IO_PHASE_UART, km_io_uart_run);
+    KM_IO_PHASE(KM_IO_PHASE_CHECK, km_io_check_run);
+    KM_IO_PHASE(KM_IO_PHASE_IDLE, km_io_idle_run);
+    KM_IO_PHASE(KM_IO_PHASE_CLOSING, km_io_handle_closing);
+    KM_IO_PHASE(KM_IO_PHASE_CUSTOM, km_io_custom_run);
+#ifdef KM_IO_STATS
+    loop.stats.iterations++;
+#endif
 
     // quite if there no IO handles
     if (!infinite) {
-      if (loop.timer_handles.head == NULL && loop.watch_handles.head == NULL &&
-          loop.uart_handles.head == NULL && loop.closing_handles.head == NULL) {
+      if (loop.timer_count == 0 && loop.watch_handles.head == NULL &&
+          loop.uart_handles.head == NULL && loop.closing_handles.head == NULL &&
+          loop.check_handles.head == NULL && km_io_irq_pending() == 0) {
         loop.stop_flag = true;
       }
     }
+
+    // sleep until the next timer or an I/O event
+    if (loop.stop_flag == false) {
+      KM_IO_PHASE(KM_IO_PHASE_WAIT, km_io_wait);
+    }
   }
 }
 
 /* timer functions */
 
-uint32_t timer_count = 0;
+static bool km_io_timer_less(km_io_timer_handle_t *a, km_io_timer_handle_t *b) {
+  if (a->clamped_timeout == b->clamped_timeout) {
+    return (int32_t)(a->seq - b->seq) < 0;
+  }
+  return a->clamped_timeout < b->clamped_timeout;
+}
+
+static void km_io_timer_heap_set(uint32_t index, km_io_timer_handle_t *timer) {
+  loop.timer_heap[index] = timer;
+  timer->heap_index = index;
+}
+
+static void km_io_timer_heap_sift_up(uint32_t index) {
+  km_io_timer_handle_t *timer = loop.timer_heap[index];
+  while (index > 0) {
+    uint32_t parent = (index - 1) / 2;
+    if (!km_io_timer_less(timer, loop.timer_heap[parent])) {
+      break;
+    }
+    km_io_timer_heap_set(index, loop.timer_heap[parent]);
+    index = parent;
+  }
+  km_io_timer_heap_set(index, timer);
+}
+
+static void km_io_timer_heap_sift_down(uint32_t index) {
+  km_io_timer_handle_t *timer = loop.timer_heap[index];
+  while (true) {
+    uint32_t child = index * 2 + 1;
+    if (child >= loop.timer_count) {
+      break;
+    }
+    if (child + 1 < loop.timer_count &&
+        km_io_timer_less(loop.timer_heap[child + 1], loop.timer_heap[child])) {
+      child++;
+    }
+    if (!km_io_timer_less(loop.timer_heap[child], timer)) {
+      break;
+    }
+    km_io_timer_heap_set(index, loop.timer_heap[child]);
+    index = child;
+  }
+  km_io_timer_heap_set(index, timer);
+}
+
+static int km_io_timer_heap_push(km_io_timer_handle_t *timer) {
+  if (loop.timer_count == loop.timer_capacity) {
+    uint32_t capacity = loop.timer_capacity > 0 ? loop.timer_capacity * 2 : 16;
+    km_io_timer_handle_t **heap =
+        realloc(loop.timer_heap, capacity * sizeof(km_io_timer_handle_t *));
+    if (heap == NULL) {
+      return ENOMEM;
+    }
+    loop.timer_heap = heap;
+    loop.timer_capacity = capacity;
+  }
+  loop.timer_count++;
+  km_io_timer_heap_set(loop.timer_count - 1, timer);
+  km_io_timer_heap_sift_up(loop.timer_count - 1);
+  return 0;
+}
+
+static void km_io_timer_heap_remove(km_io_timer_handle_t *timer) {
+  uint32_t index = timer->heap_index;
+  timer->heap_index = KM_IO_TIMER_NOT_QUEUED;
+  loop.timer_count--;
+  if (index < loop.timer_count) {
+    km_io_timer_heap_set(index, loop.timer_heap[loop.timer_count]);
+    km_io_timer_heap_sift_down(index);
+    km_io_timer_heap_sift_up(index);
+  }
+}
 
 void km_io_timer_init(km_io_timer_handle_t *timer) {
   km_io_handle_init((km_io_handle_t *)timer, KM_IO_TIMER);
   timer->timer_cb = NULL;
+  timer->heap_index = KM_IO_TIMER_NOT_QUEUED;
 }
 
-void km_io_timer_start(km_io_timer_handle_t *timer, km_io_timer_cb timer_cb,
-                       uint64_t interval, bool repeat) {
-  KM_IO_SET_FLAG_ON(timer->base.flags, KM_IO_FLAG_ACTIVE);
+int km_io_timer_start(km_io_timer_handle_t *timer, km_io_timer_cb timer_cb,
+                      uint64_t interval, bool repeat) {
   timer->timer_cb = timer_cb;
   timer->clamped_timeout = loop.time + interval;
   timer->interval = interval;
   timer->repeat = repeat;
-  km_list_append(&loop.timer_handles, (km_list_node_t *)timer);
+  timer->seq = loop.timer_seq++;
+  if (timer->heap_index != KM_IO_TIMER_NOT_QUEUED) {
+    km_io_timer_heap_remove(timer);
+  }
+  int ret = km_io_timer_heap_push(timer);
+  if (ret < 0) {
+    KM_IO_SET_FLAG_OFF(timer->base.flags, KM_IO_FLAG_ACTIVE);
+    return ret;
+  }
+  KM_IO_SET_FLAG_ON(timer->base.flags, KM_IO_FLAG_ACTIVE);
+  return 0;
 }
 
 void km_io_timer_stop(km_io_timer_handle_t *timer) {
   KM_IO_SET_FLAG_OFF(timer->base.flags, KM_IO_FLAG_ACTIVE);
-  km_list_remove(&loop.timer_handles, (km_list_node_t *)timer);
+  if (timer->heap_index != KM_IO_TIMER_NOT_QUEUED) {
+    km_io_timer_heap_remove(timer);
+  }
 }
 
 km_io_timer_handle_t *km_io_timer_get_by_id(uint32_t id) {
-  return (km_io_timer_handle_t *)km_io_handle_get_by_id(id,
-                                                        &loop.timer_handles);
+  return (km_io_timer_handle_t *)km_io_handle_get_by_id(id, KM_IO_TIMER);
 }
 
 void km_io_timer_cleanup() {
-  km_io_timer_handle_t *handle =
-      (km_io_timer_handle_t *)loop.timer_handles.head;
-  while (handle != NULL) {
-    km_io_timer_handle_t *next =
-        (km_io_timer_handle_t *)((km_list_node_t *)handle)->next;
-    free(handle);
-    handle = next;
+  for (uint32_t i = 0; i < loop.timer_count; i++) {
+    km_io_handle_free((km_io_handle_t *)loop.timer_heap[i]);
   }
-  km_list_init(&loop.timer_handles);
+  free(loop.timer_heap);
+  loop.timer_heap = NULL;
+  loop.timer_count = 0;
+  loop.timer_capacity = 0;
 }
 
 static void km_io_timer_run() {
-  km_io_timer_handle_t *handle =
-      (km_io_timer_handle_t *)loop.timer_handles.head;
-  while (handle != NULL) {
-    if (KM_IO_HAS_FLAG(handle->base.flags, KM_IO_FLAG_ACTIVE)) {
+  while (loop.timer_count > 0) {
+    km_io_timer_handle_t *handle = loop.timer_heap[0];
+    if (handle->clamped_timeout >= loop.time) {
+      break;
+    }
+    KM_IO_TIMER_LATENESS(handle);
+    if (handle->repeat) {
+      handle->clamped_timeout = handle->clamped_timeout + handle->interval;
+      // skip missed intervals so the timer fires at most once per iteration
       if (handle->clamped_timeout < loop.time) {
-        if (handle->repeat) {
-          handle->clamped_timeout = handle->clamped_timeout + handle->interval;
-        } else {
-          KM_IO_SET_FLAG_OFF(handle->base.flags, KM_IO_FLAG_ACTIVE);
-        }
-        if (handle->timer_cb) {
-          handle->timer_cb(handle);
-        }
+        handle->clamped_timeout = loop.time;
       }
+      handle->seq = loop.timer_seq++;
+      km_io_timer_heap_sift_down(0);
+    } else {
+      KM_IO_SET_FLAG_OFF(handle->base.flags, KM_IO_FLAG_ACTIVE);
+      km_io_timer_heap_remove(handle);
+    }
+    if (handle->timer_cb) {
+      KM_IO_CALLBACK(KM_IO_PHASE_TIMER, handle->timer_cb(handle));
     }
-    handle = (km_io_timer_handle_t *)((km_list_node_t *)handle)->next;
   }
 }
 
@@ -209,7 +585,7 @@ void km_io_tty_cleanup() {
   while (handle != NULL) {
     km_io_tty_handle_t *next =
         (km_io_tty_handle_t *)((km_list_node_t *)handle)->next;
-    free(handle);
+    km_io_handle_free((km_io_handle_t *)handle);
     handle = next;
   }
   km_list_init(&loop.tty_handles);
@@ -226,7 +602,7 @@ static void km_io_tty_run() {
         //}
         uint8_t buf[len];
         km_tty_read(buf, len);
-        handle->read_cb(buf, len);
+        KM_IO_CALLBACK(KM_IO_PHASE_TTY, handle->read_cb(buf, len));
       }
     }
     handle = (km_io_tty_handle_t *)((km_list_node_t *)handle)->next;
@@ -260,8 +636,7 @@ void km_io_watch_stop(km_io_watch_handle_t *watch) {
 }
 
 km_io_watch_handle_t *km_io_watch_get_by_id(uint32_t id) {
-  return (km_io_watch_handle_t *)km_io_handle_get_by_id(id,
-                                                        &loop.watch_handles);
+  return (km_io_watch_handle_t *)km_io_handle_get_by_id(id, KM_IO_WATCH);
 }
 
 void km_io_watch_cleanup() {
@@ -270,7 +645,7 @@ void km_io_watch_cleanup() {
   while (handle != NULL) {
     km_io_watch_handle_t *next =
         (km_io_watch_handle_t *)((km_list_node_t *)handle)->next;
-    free(handle);
+    km_io_handle_free((km_io_handle_t *)handle);
     handle = next;
   }
   km_list_init(&loop.watch_handles);
@@ -290,7 +665,7 @@ static void km_io_watch_run() {
       if ((handle->watch_cb) &&
           (((handle->mode == KM_IO_WATCH_MODE_LOW_LEVEL) && (reading == 0)) ||
            ((handle->mode == KM_IO_WATCH_MODE_HIGH_LEVEL) && (reading == 1)))) {
-        handle->watch_cb(handle);
+        KM_IO_CALLBACK(KM_IO_PHASE_WATCH, handle->watch_cb(handle));
       } else if (handle->debounce_time > 0 &&
                  elapsed_time >= handle->debounce_delay) {
         if (reading != handle->val) {
@@ -298,17 +673,17 @@ static void km_io_watch_run() {
           switch (handle->mode) {
             case KM_IO_WATCH_MODE_CHANGE:
               if (handle->watch_cb) {
-                handle->watch_cb(handle);
+                KM_IO_CALLBACK(KM_IO_PHASE_WATCH, handle->watch_cb(handle));
               }
               break;
             case KM_IO_WATCH_MODE_RISING:
               if (handle->val == 1 && handle->watch_cb) {
-                handle->watch_cb(handle);
+                KM_IO_CALLBACK(KM_IO_PHASE_WATCH, handle->watch_cb(handle));
               }
               break;
             case KM_IO_WATCH_MODE_FALLING:
               if (handle->val == 0 && handle->watch_cb) {
-                handle->watch_cb(handle);
+                KM_IO_CALLBACK(KM_IO_PHASE_WATCH, handle->watch_cb(handle));
               }
               break;
             default:
@@ -345,7 +720,7 @@ void km_io_uart_read_stop(km_io_uart_handle_t *uart) {
 }
 
 km_io_uart_handle_t *km_io_uart_get_by_id(uint32_t id) {
-  return (km_io_uart_handle_t *)km_io_handle_get_by_id(id, &loop.uart_handles);
+  return (km_io_uart_handle_t *)km_io_handle_get_by_id(id, KM_IO_UART);
 }
 
 void km_io_uart_cleanup() {
@@ -353,7 +728,7 @@ void km_io_uart_cleanup() {
   while (handle != NULL) {
     km_io_uart_handle_t *next =
         (km_io_uart_handle_t *)((km_list_node_t *)handle)->next;
-    free(handle);
+    km_io_handle_free((km_io_handle_t *)handle);
     handle = next;
   }
   km_list_init(&loop.uart_handles);
@@ -368,7 +743,7 @@ static void km_io_uart_run() {
         if (len > 0) {
           uint8_t buf[len];
           km_uart_read(handle->port, buf, len);
-          handle->read_cb(handle, buf, len);
+          KM_IO_CALLBACK(KM_IO_PHASE_UART, handle->read_cb(handle, buf, len));
         }
       }
     }
@@ -395,7 +770,7 @@ void km_io_idle_stop(km_io_idle_handle_t *idle) {
 }
 
 km_io_idle_handle_t *km_io_idle_get_by_id(uint32_t id) {
-  return (km_io_idle_handle_t *)km_io_handle_get_by_id(id, &loop.idle_handles);
+  return (km_io_idle_handle_t *)km_io_handle_get_by_id(id, KM_IO_IDLE);
 }
 
 void km_io_idle_cleanup() {
@@ -403,7 +778,7 @@ void km_io_idle_cleanup() {
   while (handle != NULL) {
     km_io_idle_handle_t *next =
         (km_io_idle_handle_t *)((km_list_node_t *)handle)->next;
-    free(handle);
+    km_io_handle_free((km_io_handle_t *)handle);
     handle = next;
   }
   km_list_init(&loop.idle_handles);
@@ -414,13 +789,162 @@ static void km_io_idle_run() {
   while (handle != NULL) {
     if (KM_IO_HAS_FLAG(handle->base.flags, KM_IO_FLAG_ACTIVE)) {
       if (handle->idle_cb) {
-        handle->idle_cb(handle);
+        KM_IO_CALLBACK(KM_IO_PHASE_IDLE, handle->idle_cb(handle));
       }
     }
     handle = (km_io_idle_handle_t *)((km_list_node_t *)handle)->next;
   }
 }
 
+/* check functions */
+
+void km_io_check_init(km_io_check_handle_t *check) {
+  km_io_handle_init((km_io_handle_t *)check, KM_IO_CHECK);
+  check->check_cb = NULL;
+}
+
+void km_io_check_start(km_io_check_handle_t *check, km_io_check_cb check_cb) {
+  KM_IO_SET_FLAG_ON(check->base.flags, KM_IO_FLAG_ACTIVE);
+  check->check_cb = check_cb;
+  check->seq = loop.check_seq++;
+  km_list_append(&loop.check_handles, (km_list_node_t *)check);
+}
+
+void km_io_check_stop(km_io_check_handle_t *check) {
+  if (KM_IO_HAS_FLAG(check->base.flags, KM_IO_FLAG_ACTIVE)) {
+    KM_IO_SET_FLAG_OFF(check->base.flags, KM_IO_FLAG_ACTIVE);
+    km_list_remove(&loop.check_handles, (km_list_node_t *)check);
+  }
+}
+
+km_io_check_handle_t *km_io_check_get_by_id(uint32_t id) {
+  return (km_io_check_handle_t *)km_io_handle_get_by_id(id, KM_IO_CHECK);
+}
+
+void km_io_check_cleanup() {
+  km_io_check_handle_t *handle =
+      (km_io_check_handle_t *)loop.check_handles.head;
+  while (handle != NULL) {
+    km_io_check_handle_t *next =
+        (km_io_check_handle_t *)((km_list_node_t *)handle)->next;
+    km_io_handle_free((km_io_handle_t *)handle);
+    handle = next;
+  }
+  km_list_init(&loop.check_handles);
+}
+
+/**
+ * Run the check handles queued before this phase started, once each.
+ * Handles queued by the callbacks run in the next iteration, so the other
+ * phases can't be starved.
+ */
+static void km_io_check_run() {
+  uint32_t limit = loop.check_seq;
+  while (loop.check_handles.head != NULL) {
+    km_io_check_handle_t *handle =
+        (km_io_check_handle_t *)loop.check_handles.head;
+    if ((int32_t)(handle->seq - limit) >= 0) {
+      break;
+    }
+    km_io_check_stop(handle);
+    if (handle->check_cb) {
+      KM_IO_CALLBACK(KM_IO_PHASE_CHECK, handle->check_cb(handle));
+    }
+  }
+}
+
+/* job runner functions */
+
+/**
+ * Set the job runner, which is called after every callback (and once at
+ * the start of an iteration if scheduled), as callbacks may have queued
+ * jobs such as promise reactions.
+ */
+void km_io_jobs_start(km_io_jobs_cb jobs_cb) { loop.jobs_cb = jobs_cb; }
+
+/**
+ * Request to run jobs in the next iteration (e.g. after running a script
+ * outside of the loop)
+ */
+void km_io_jobs_schedule() { loop.jobs_pending = true; }
+
+static void km_io_jobs_run() {
+  loop.jobs_pending = false;
+  if (loop.jobs_cb) {
+    loop.jobs_cb();
+  }
+}
+
+/* GPIO interrupt queue functions */
+
+void km_io_irq_start(km_io_irq_cb irq_cb) { loop.irq_queue.irq_cb = irq_cb; }
+
+void km_io_irq_stop() { loop.irq_queue.irq_cb = NULL; }
+
+/**
+ * Push an interrupt event to the queue. This is called from interrupt
+ * context, so it must not allocate memory or touch the JS VM. Returns false
+ * if the event is dropped because the queue is full.
+ */
+bool km_io_irq_push(uint8_t pin, uint8_t events) {
+  km_io_irq_queue_t *queue = &loop.irq_queue;
+  uint32_t head = queue->head;
+  uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+  if (head - tail >= KM_IO_IRQ_QUEUE_SIZE) {
+    queue->overflow++;
+    return false;
+  }
+  km_io_irq_event_t *event =
+      &queue->events[head & (KM_IO_IRQ_QUEUE_SIZE - 1)];
+  event->pin = pin;
+  event->events = events;
+  event->time = km_micro_gettime();
+  __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+uint32_t km_io_irq_pending() {
+  return __atomic_load_n(&loop.irq_queue.head, __ATOMIC_ACQUIRE) -
+         loop.irq_queue.tail;
+}
+
+uint32_t km_io_irq_get_overflow() {
+  return loop.irq_queue.overflow - loop.irq_queue.overflow_base;
+}
+
+void km_io_irq_cleanup() {
+  // discard pending events (only the consumer side is touched here, since
+  // an interrupt may still be pushing)
+  loop.irq_queue.irq_cb = NULL;
+  __atomic_store_n(&loop.irq_queue.tail,
+                   __atomic_load_n(&loop.irq_queue.head, __ATOMIC_ACQUIRE),
+                   __ATOMIC_RELEASE);
+  loop.irq_queue.overflow_base = loop.irq_queue.overflow;
+}
+
+/**
+ * Dispatch the events queued before this phase started, in contiguous
+ * batches. Events pushed while dispatching are left for the next iteration
+ * so a fast signal can't starve the other phases.
+ */
+static void km_io_irq_run() {
+  km_io_irq_queue_t *queue = &loop.irq_queue;
+  uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+  while (queue->tail != head) {
+    uint32_t index = queue->tail & (KM_IO_IRQ_QUEUE_SIZE - 1);
+    uint32_t count = head - queue->tail;
+    if (count > KM_IO_IRQ_QUEUE_SIZE - index) {
+      count = KM_IO_IRQ_QUEUE_SIZE - index;  // up to the end of the ring
+    }
+    if (queue->irq_cb) {
+      KM_IO_CALLBACK(KM_IO_PHASE_IRQ,
+                     queue->irq_cb(&queue->events[index], count));
+    }
+    // release the slots after dispatching
+    __atomic_store_n(&queue->tail, queue->tail + count, __ATOMIC_RELEASE);
+  }
+}
+
 /* stream function */
 
 void km_io_stream_init(km_io_stream_handle_t *stream) {
@@ -452,7 +976,7 @@ void km_io_stream_cleanup() {
   while (handle != NULL) {
     km_io_stream_handle_t *next =
         (km_io_stream_handle_t *)((km_list_node_t *)handle)->next;
-    free(handle);
+    km_io_handle_free((km_io_handle_t *)handle);
     handle = next;
   }
   km_list_init(&loop.stream_handles);
@@ -30,30 +30,125 @@
 #include "repl.h"
 #include "tty.h"
 
+/**
+ * Property key cache. Keys are looked up by the name's content, so names
+ * from any storage can be used. Names passed to the jerryxx helpers are
+ * cached until the cache is full (the rest use a temporary key), while
+ * jerryxx_key() always caches.
+ */
+#define JERRYXX_KEY_BUCKETS 64
+#define JERRYXX_KEY_CACHE_MAX 128
+
+typedef struct jerryxx_key_entry_s {
+  struct jerryxx_key_entry_s *next;
+  uint32_t hash;
+  jerry_value_t key;
+  char name[];
+} jerryxx_key_entry_t;
+
+static jerryxx_key_entry_t *key_buckets[JERRYXX_KEY_BUCKETS];
+static uint16_t key_count = 0;
+// uncached key returned on out of memory, released on the next one
+static jerry_value_t key_spare;
+static bool key_spare_used = false;
+
+static uint32_t key_hash(const char *name, size_t *len) {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  const char *p = name;
+  while (*p) {
+    hash = (hash ^ (uint8_t)*p++) * 16777619u;
+  }
+  *len = p - name;
+  return hash;
+}
+
+static jerryxx_key_entry_t *key_lookup(const char *name, bool force) {
+  size_t len;
+  uint32_t hash = key_hash(name, &len);
+  jerryxx_key_entry_t **bucket = &key_buckets[hash % JERRYXX_KEY_BUCKETS];
+  for (jerryxx_key_entry_t *e = *bucket; e != NULL; e = e->next) {
+    if (e->hash == hash && strcmp(e->name, name) == 0) {
+      return e;
+    }
+  }
+  if (!force && key_count >= JERRYXX_KEY_CACHE_MAX) {
+    return NULL;
+  }
+  jerryxx_key_entry_t *e = malloc(sizeof(jerryxx_key_entry_t) + len + 1);
+  if (e == NULL) {
+    return NULL;
+  }
+  memcpy(e->name, name, len + 1);
+  e->hash = hash;
+  e->key = jerry_create_string((const jerry_char_t *)name);
+  e->next = *bucket;
+  *bucket = e;
+  key_count++;
+  return e;
+}
+
+/**
+ * Return a key for name which should be released by the caller
+ */
+static jerry_value_t key_acquire(const char *name) {
+  jerryxx_key_entry_t *e = key_lookup(name, false);
+  if (e != NULL) {
+    return jerry_acquire_value(e->key);
+  }
+  return jerry_create_string((const jerry_char_t *)name);
+}
+
+jerry_value_t jerryxx_key(const char *name) {
+  jerryxx_key_entry_t *e = key_lookup(name, true);
+  if (e != NULL) {
+    return e->key;
+  }
+  // out of memory
+  if (key_spare_used) {
+    jerry_release_value(key_spare);
+  }
+  key_spare = jerry_create_string((const jerry_char_t *)name);
+  key_spare_used = true;
+  return key_spare;
+}
+
+void jerryxx_key_cleanup() {
+  for (int i = 0; i < JERRYXX_KEY_BUCKETS; i++) {
+    jerryxx_key_entry_t *e = key_buckets[i];
+    while (e != NULL) {
+      jerryxx_key_entry_t *next = e->next;
+      jerry_release_value(e->key);
+      free(e);
+      e = next;
+    }
+    key_buckets[i] = NULL;
+  }
+  key_count = 0;
+  if (key_spare_used) {
+    jerry_release_value(key_spare);
+    key_spare_used = false;
+  }
+}
+
 void jerryxx_set_property(jerry_value_t object, const char *name,
                           jerry_value_t value) {
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
-  jerry_value_t ret = jerry_set_property(object, prop, value);
-  jerry_release_value(ret);
+  jerry_value_t prop = key_acquire(name);
+  jerryxx_set_property_by_key(object, prop, value);
   jerry_release_value(prop);
 }
 
 void jerryxx_set_property_number(jerry_value_t object, const char *name,
                                  double value) {
-  jerry_value_t val = jerry_create_number(value);
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
-  jerry_value_t ret = jerry_set_property(object, prop, val);
-  jerry_release_value(ret);
+  jerry_value_t prop = key_acquire(name);
+  jerryxx_set_property_number_by_key(object, prop, value);
   jerry_release_value(prop);
-  jerry_release_value(val);
 }
 
 void jerryxx_set_property_string(jerry_value_t object, const char *name,
                                  char *value) {
   jerry_value_t val = jerry_create_string((const jerry_char_t *)value);
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
-  jerry_value_t ret = jerry_set_property(object, prop, val);
-  jerry_release_value(ret);
+  jerry_value_t prop = key_acquire(name);
+  jerryxx_set_property_by_key(object, prop, val);
   jerry_release_value(prop);
   jerry_release_value(val);
 }
@@ -61,13 +156,26 @@ void jerryxx_set_property_string(jerry_value_t object, const char *name,
 void jerryxx_set_property_function(jerry_value_t object, const char *name,
                                    jerry_external_handler_t fn) {
   jerry_value_t ext_fn = jerry_create_external_function(fn);
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
-  jerry_value_t ret = jerry_set_property(object, prop, ext_fn);
-  jerry_release_value(ret);
+  jerry_value_t prop = key_acquire(name);
+  jerryxx_set_property_by_key(object, prop, ext_fn);
   jerry_release_value(prop);
   jerry_release_value(ext_fn);
 }
 
+void jerryxx_set_property_by_key(jerry_value_t object, jerry_value_t key,
+                                 jerry_value_t value) {
+  jerry_value_t ret = jerry_set_property(object, key, value);
+  jerry_release_value(ret);
+}
+
+void jerryxx_set_property_number_by_key(jerry_value_t object,
+                                        jerry_value_t key, double value) {
+  jerry_value_t val = jerry_create_number(value);
+  jerry_value_t ret = jerry_set_property(object, key, val);
+  jerry_release_value(ret);
+  jerry_release_value(val);
+}
+
 void jerryxx_define_own_property(jerry_value_t object, const char *name,
                                  jerry_external_handler_t getter,
                                  jerry_external_handler_t setter) {
@@ -84,14 +192,14 @@ void jerryxx_define_own_property(jerry_value_t object, const char *name,
     prop.setter = jerry_create_external_function(setter);
     prop.is_writable = true;
   }
-  jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+  jerry_value_t prop_name = key_acquire(name);
   jerry_define_own_property(object, prop_name, &prop);
   jerry_release_value(prop_name);
   jerry_free_property_descriptor_fields(&prop);
 }
 
 jerry_value_t jerryxx_get_property(jerry_value_t object, const char *name) {
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
+  jerry_value_t prop = key_acquire(name);
   jerry_value_t ret = jerry_get_property(object, prop);
   jerry_release_value(prop);
   return ret;
@@ -99,27 +207,42 @@ jerry_value_t jerryxx_get_property(jerry_value_t object, const char *name) {
 
 double jerryxx_get_property_number(jerry_value_t object, const char *name,
                                    double default_value) {
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
-  jerry_value_t ret = jerry_get_property(object, prop);
+  jerry_value_t prop = key_acquire(name);
+  double value =
+      jerryxx_get_property_number_by_key(object, prop, default_value);
+  jerry_release_value(prop);
+  return value;
+}
+
+bool jerryxx_get_property_boolean(jerry_value_t object, const char *name,
+                                  bool default_value) {
+  jerry_value_t prop = key_acquire(name);
+  bool value = jerryxx_get_property_boolean_by_key(object, prop, default_value);
+  jerry_release_value(prop);
+  return value;
+}
+
+double jerryxx_get_property_number_by_key(jerry_value_t object,
+                                          jerry_value_t key,
+                                          double default_value) {
+  jerry_value_t ret = jerry_get_property(object, key);
   double value = default_value;
   if (jerry_value_is_number(ret)) {
     value = jerry_get_number_value(ret);
   }
   jerry_release_value(ret);
-  jerry_release_value(prop);
   return value;
 }
 
-bool jerryxx_get_property_boolean(jerry_value_t object, const char *name,
-                                  bool default_value) {
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
-  jerry_value_t ret = jerry_get_property(object, prop);
+bool jerryxx_get_property_boolean_by_key(jerry_value_t object,
+                                         jerry_value_t key,
+                                         bool default_value) {
+  jerry_value_t ret = jerry_get_property(object, key);
   bool value = default_value;
   if (jerry_value_is_boolean(ret)) {
     value = jerry_get_boolean_value(ret);
   }
   jerry_release_value(ret);
-  jerry_release_value(prop);
   return value;
 }
 
@@ -133,7 +256,7 @@ uint8_t *jerryxx_get_typedarray_buffer(jerry_value_t object) {
 }
 
 bool jerryxx_delete_property(jerry_value_t object, const char *name) {
-  jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
+  jerry_value_t prop = key_acquire(name);
   bool ret = jerry_delete_property(object, prop);
   jerry_release_value(prop);
   return ret;
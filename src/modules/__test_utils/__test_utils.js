@@ -1,3 +1,5 @@
+const test_utils_native = process.binding(process.binding.__test_utils);
+
 class RAMBlockDev {
   constructor(size = 4096, count = 16, bufsz = 256) {
     this.blocksize = size;
@@ -48,3 +50,10 @@ class RAMBlockDev {
 }
 
 exports.RAMBlockDev = RAMBlockDev;
+exports.simulateInterrupt = test_utils_native.simulateInterrupt;
+exports.flashStats = test_utils_native.flashStats;
+exports.resetFlashStats = test_utils_native.resetFlashStats;
+exports.attachSDCard = test_utils_native.attachSDCard;
+exports.detachSDCard = test_utils_native.detachSDCard;
+exports.sdcardStats = test_utils_native.sdcardStats;
+exports.resetSDCardStats = test_utils_native.resetSDCardStats;
@@ -22,4 +22,12 @@
 #ifndef ____TEST_UTILS_MAGIC_STRINGS_H
 #define ____TEST_UTILS_MAGIC_STRINGS_H
 
+#define MSTR___TEST_UTILS_SIMULATE_INTERRUPT "simulateInterrupt"
+#define MSTR___TEST_UTILS_FLASH_STATS "flashStats"
+#define MSTR___TEST_UTILS_RESET_FLASH_STATS "resetFlashStats"
+#define MSTR___TEST_UTILS_ATTACH_SDCARD "attachSDCard"
+#define MSTR___TEST_UTILS_DETACH_SDCARD "detachSDCard"
+#define MSTR___TEST_UTILS_SDCARD_STATS "sdcardStats"
+#define MSTR___TEST_UTILS_RESET_SDCARD_STATS "resetSDCardStats"
+
 #endif /* ____TEST_UTILS_MAGIC_STRINGS_H */
@@ -0,0 +1,2 @@
+list(APPEND SOURCES ${SRC_DIR}/modules/__test_utils/module___test_utils.c)
+include_directories(${SRC_DIR}/modules/__test_utils)
@@ -0,0 +1,175 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include "__test_utils_magic_strings.h"
+#include "board.h"
+#include "flash_sim.h"
+#include "gpio_sim.h"
+#include "jerryscript.h"
+#include "jerryxx.h"
+#include "sdcard_sim.h"
+
+/**
+ * simulateInterrupt(pin, events[, count])
+ * args:
+ *   pin: {number}
+ *   events: {number} FALLING or RISING
+ *   count: {number} number of edges to raise, default: 1
+ * returns:
+ *   {number} number of interrupts raised
+ */
+JERRYXX_FUN(simulate_interrupt_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "pin");
+  JERRYXX_CHECK_ARG_NUMBER(1, "events");
+  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "count");
+  uint8_t pin = (uint8_t)JERRYXX_GET_ARG_NUMBER(0);
+  uint8_t events = (uint8_t)JERRYXX_GET_ARG_NUMBER(1);
+  uint32_t count = (uint32_t)JERRYXX_GET_ARG_NUMBER_OPT(2, 1);
+  uint32_t raised = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    raised += km_gpio_sim_irq(pin, events);
+  }
+  return jerry_create_number(raised);
+}
+
+/**
+ * flashStats()
+ * returns:
+ *   {object} flash operation statistics since start or the last reset, and
+ *     erase counts of all sectors
+ */
+JERRYXX_FUN(flash_stats_fn) {
+  km_flash_sim_stats_t stats;
+  km_flash_sim_get_stats(&stats);
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, "erases", stats.erases);
+  jerryxx_set_property_number(obj, "programs", stats.programs);
+  jerryxx_set_property_number(obj, "bytesProgrammed", stats.bytes_programmed);
+  jerryxx_set_property_number(obj, "busyTime", stats.busy_time);
+  jerryxx_set_property(obj, "persistent",
+                       jerry_create_boolean(km_flash_sim_is_persistent()));
+  jerry_value_t counts = jerry_create_array(KALUMA_FLASH_SECTOR_COUNT);
+  for (int i = 0; i < KALUMA_FLASH_SECTOR_COUNT; i++) {
+    jerry_value_t value = jerry_create_number(km_flash_sim_erase_count(i));
+    jerry_value_t ret = jerry_set_property_by_index(counts, i, value);
+    jerry_release_value(ret);
+    jerry_release_value(value);
+  }
+  jerryxx_set_property(obj, "eraseCounts", counts);
+  jerry_release_value(counts);
+  return obj;
+}
+
+/**
+ * resetFlashStats()
+ */
+JERRYXX_FUN(reset_flash_stats_fn) {
+  km_flash_sim_reset_stats();
+  return jerry_create_undefined();
+}
+
+/**
+ * attachSDCard(bus, cs, blockCount)
+ * args:
+ *   bus: {number} SPI bus
+ *   cs: {number} chip select pin
+ *   blockCount: {number} number of 512-byte blocks (rounded up to 1024)
+ */
+JERRYXX_FUN(attach_sdcard_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "bus");
+  JERRYXX_CHECK_ARG_NUMBER(1, "cs");
+  JERRYXX_CHECK_ARG_NUMBER(2, "blockCount");
+  uint8_t bus = (uint8_t)JERRYXX_GET_ARG_NUMBER(0);
+  uint8_t cs = (uint8_t)JERRYXX_GET_ARG_NUMBER(1);
+  uint32_t block_count = (uint32_t)JERRYXX_GET_ARG_NUMBER(2);
+  if (km_sdcard_sim_attach(bus, cs, block_count) < 0) {
+    return jerry_create_error(JERRY_ERROR_COMMON,
+                              (const jerry_char_t *)"Failed to attach SD card");
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * detachSDCard()
+ */
+JERRYXX_FUN(detach_sdcard_fn) {
+  km_sdcard_sim_detach();
+  return jerry_create_undefined();
+}
+
+/**
+ * sdcardStats()
+ * returns:
+ *   {object} SD card command and transfer statistics since attach or the
+ *     last reset
+ */
+JERRYXX_FUN(sdcard_stats_fn) {
+  km_sdcard_sim_stats_t stats;
+  km_sdcard_sim_get_stats(&stats);
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, "commands", stats.commands);
+  jerryxx_set_property_number(obj, "singleReads", stats.single_reads);
+  jerryxx_set_property_number(obj, "multiReads", stats.multi_reads);
+  jerryxx_set_property_number(obj, "singleWrites", stats.single_writes);
+  jerryxx_set_property_number(obj, "multiWrites", stats.multi_writes);
+  jerryxx_set_property_number(obj, "preErases", stats.pre_erases);
+  jerryxx_set_property_number(obj, "blocksRead", stats.blocks_read);
+  jerryxx_set_property_number(obj, "blocksWritten", stats.blocks_written);
+  jerryxx_set_property_number(obj, "transfers", stats.transfers);
+  jerryxx_set_property_number(obj, "bytes", stats.bytes);
+  jerryxx_set_property_number(obj, "busTime", stats.bus_time);
+  jerryxx_set_property_number(obj, "clock", stats.clock);
+  jerryxx_set_property(obj, "highSpeed",
+                       jerry_create_boolean(stats.high_speed));
+  return obj;
+}
+
+/**
+ * resetSDCardStats()
+ */
+JERRYXX_FUN(reset_sdcard_stats_fn) {
+  km_sdcard_sim_reset_stats();
+  return jerry_create_undefined();
+}
+
+/**
+ * Initialize '__test_utils' module
+ */
+jerry_value_t module___test_utils_init() {
+  jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_SIMULATE_INTERRUPT,
+                                simulate_interrupt_fn);
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_FLASH_STATS,
+                                flash_stats_fn);
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_RESET_FLASH_STATS,
+                                reset_flash_stats_fn);
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_ATTACH_SDCARD,
+                                attach_sdcard_fn);
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_DETACH_SDCARD,
+                                detach_sdcard_fn);
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_SDCARD_STATS,
+                                sdcard_stats_fn);
+  jerryxx_set_property_function(exports, MSTR___TEST_UTILS_RESET_SDCARD_STATS,
+                                reset_sdcard_stats_fn);
+  return exports;
+}
@@ -1,4 +1,5 @@
 var EventEmitter = require('events').EventEmitter;
+var {Buffer} = require('buffer');
 
 /**
  * ATCommand class.
@@ -23,7 +24,7 @@ class ATCommand extends EventEmitter {
       interval: 100
     }, options);
     this.handler = (data) => {
-      var s = String.fromCharCode.apply(null, data);
+      var s = Buffer.prototype.toString.call(data, 'latin1');
       if (this.options.debug) {
         print(`\x1b[37m${s.replace(/\r/gi, '<CR>').replace(/\n/gi, '<LN>\n')}\x1b[0m`); // gray color
       }
@@ -0,0 +1,266 @@
+const buffer_native = process.binding(process.binding.buffer);
+
+// type of readInt()/writeInt(): size in bytes | flags
+const SIGNED = 0x10;
+const BE = 0x20;
+const FLOAT = 0x40;
+
+const INT_TYPES = {
+  UInt8: 1,
+  Int8: 1 | SIGNED,
+  UInt16LE: 2,
+  UInt16BE: 2 | BE,
+  Int16LE: 2 | SIGNED,
+  Int16BE: 2 | SIGNED | BE,
+  UInt32LE: 4,
+  UInt32BE: 4 | BE,
+  Int32LE: 4 | SIGNED,
+  Int32BE: 4 | SIGNED | BE,
+  FloatLE: 4 | FLOAT,
+  FloatBE: 4 | FLOAT | BE,
+  DoubleLE: 8 | FLOAT,
+  DoubleBE: 8 | FLOAT | BE,
+};
+
+const ENCODINGS = ['utf8', 'utf-8', 'ascii', 'latin1', 'binary', 'hex', 'base64'];
+
+/**
+ * Buffer class. A Uint8Array with binary helpers implemented in native.
+ */
+class Buffer extends Uint8Array {
+  /**
+   * Allocate a zero-filled buffer
+   * @param {number} size
+   * @param {number|string} fill
+   * @param {string} encoding
+   * @return {Buffer}
+   */
+  static alloc(size, fill, encoding) {
+    const buf = new Buffer(size);
+    if (typeof fill === 'number') {
+      buf.fill(fill);
+    } else if (typeof fill === 'string' && fill.length > 0) {
+      const pattern = Buffer.from(fill, encoding);
+      // e.g. invalid hex decodes to nothing: leave zero-filled
+      for (let i = 0; pattern.length > 0 && i < size; i += pattern.length) {
+        buf.set(pattern.subarray(0, size - i), i);
+      }
+    }
+    return buf;
+  }
+
+  /**
+   * Allocate a buffer
+   * @param {number} size
+   * @return {Buffer}
+   */
+  static allocUnsafe(size) {
+    return new Buffer(size);
+  }
+
+  /**
+   * Create a buffer from a string, an array, a Uint8Array (copied) or an
+   * ArrayBuffer (shared)
+   * @param {string|Array|Uint8Array|ArrayBuffer} value
+   * @param {string|number} encodingOrOffset
+   * @param {number} length
+   * @return {Buffer}
+   */
+  static from(value, encodingOrOffset, length) {
+    if (typeof value === 'string') {
+      return new Buffer(buffer_native.fromString(value, encodingOrOffset));
+    }
+    if (value instanceof ArrayBuffer) {
+      const offset = encodingOrOffset || 0;
+      if (length === undefined) length = value.byteLength - offset;
+      return new Buffer(value, offset, length);
+    }
+    const buf = new Buffer(value.length);
+    buf.set(value);
+    return buf;
+  }
+
+  /**
+   * Concatenate buffers
+   * @param {Array<Uint8Array>} list
+   * @param {number} totalLength
+   * @return {Buffer}
+   */
+  static concat(list, totalLength) {
+    return new Buffer(buffer_native.concat(list, totalLength));
+  }
+
+  /**
+   * Byte length of a string in the encoding
+   * @param {string|Uint8Array|ArrayBuffer} value
+   * @param {string} encoding
+   * @return {number}
+   */
+  static byteLength(value, encoding) {
+    if (typeof value === 'string') {
+      return buffer_native.byteLength(value, encoding);
+    }
+    return value.byteLength;
+  }
+
+  /**
+   * Compare two buffers
+   * @param {Uint8Array} a
+   * @param {Uint8Array} b
+   * @return {number} -1, 0 or 1
+   */
+  static compare(a, b) {
+    return buffer_native.compare(a, b);
+  }
+
+  /**
+   * @param {*} obj
+   * @return {boolean}
+   */
+  static isBuffer(obj) {
+    return obj instanceof Buffer;
+  }
+
+  /**
+   * @param {string} encoding
+   * @return {boolean}
+   */
+  static isEncoding(encoding) {
+    return (
+      typeof encoding === 'string' &&
+      ENCODINGS.indexOf(encoding.toLowerCase()) > -1
+    );
+  }
+
+  /**
+   * Decode to a string
+   * @param {string} encoding
+   * @param {number} start
+   * @param {number} end
+   * @return {string}
+   */
+  toString(encoding, start, end) {
+    return buffer_native.toString(this, encoding, start, end);
+  }
+
+  /**
+   * Write a string
+   * @param {string} string
+   * @param {number} offset
+   * @param {number} length
+   * @param {string} encoding
+   * @return {number} number of bytes written
+   */
+  write(string, offset, length, encoding) {
+    if (typeof offset === 'string') {
+      encoding = offset;
+      offset = undefined;
+      length = undefined;
+    } else if (typeof length === 'string') {
+      encoding = length;
+      length = undefined;
+    }
+    return buffer_native.write(this, string, offset, length, encoding);
+  }
+
+  /**
+   * @param {number|string|Uint8Array} value
+   * @param {number} byteOffset
+   * @param {string} encoding
+   * @return {number} index of value, or -1
+   */
+  indexOf(value, byteOffset, encoding) {
+    if (typeof byteOffset === 'string') {
+      encoding = byteOffset;
+      byteOffset = undefined;
+    }
+    return buffer_native.indexOf(this, value, byteOffset, encoding);
+  }
+
+  /**
+   * @param {number|string|Uint8Array} value
+   * @param {number} byteOffset
+   * @param {string} encoding
+   * @return {boolean}
+   */
+  includes(value, byteOffset, encoding) {
+    return this.indexOf(value, byteOffset, encoding) > -1;
+  }
+
+  /**
+   * Return a buffer sharing the same memory (no copy)
+   * @param {number} start
+   * @param {number} end
+   * @return {Buffer}
+   */
+  subarray(start, end) {
+    const len = this.length;
+    start = start === undefined ? 0 : Math.trunc(start) || 0;
+    end = end === undefined ? len : Math.trunc(end) || 0;
+    if (start < 0) start = Math.max(len + start, 0);
+    if (end < 0) end = Math.max(len + end, 0);
+    start = Math.min(start, len);
+    end = Math.min(Math.max(end, start), len);
+    return new Buffer(this.buffer, this.byteOffset + start, end - start);
+  }
+
+  /**
+   * Same as subarray() (no copy)
+   * @param {number} start
+   * @param {number} end
+   * @return {Buffer}
+   */
+  slice(start, end) {
+    return this.subarray(start, end);
+  }
+
+  /**
+   * @param {Uint8Array} other
+   * @return {boolean}
+   */
+  equals(other) {
+    return buffer_native.compare(this, other) === 0;
+  }
+
+  /**
+   * @param {Uint8Array} target
+   * @return {number} -1, 0 or 1
+   */
+  compare(target) {
+    return buffer_native.compare(this, target);
+  }
+
+  /**
+   * Copy to the target
+   * @param {Uint8Array} target
+   * @param {number} targetStart
+   * @param {number} sourceStart
+   * @param {number} sourceEnd
+   * @return {number} number of bytes copied
+   */
+  copy(target, targetStart = 0, sourceStart = 0, sourceEnd = this.length) {
+    const src = this.subarray(
+      sourceStart,
+      Math.min(sourceEnd, sourceStart + target.length - targetStart)
+    );
+    target.set(src, targetStart);
+    return src.length;
+  }
+
+  toJSON() {
+    return { type: 'Buffer', data: Array.prototype.slice.call(this) };
+  }
+}
+
+// readUInt8(), readInt16LE(), writeUInt32BE(), ...
+Object.keys(INT_TYPES).forEach((name) => {
+  const type = INT_TYPES[name];
+  Buffer.prototype['read' + name] = function (offset = 0) {
+    return buffer_native.readInt(this, offset, type);
+  };
+  Buffer.prototype['write' + name] = function (value, offset = 0) {
+    return buffer_native.writeInt(this, value, offset, type);
+  };
+});
+
+exports.Buffer = Buffer;
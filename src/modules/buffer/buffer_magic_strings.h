@@ -0,0 +1,37 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __BUFFER_MAGIC_STRINGS_H
+#define __BUFFER_MAGIC_STRINGS_H
+
+#define MSTR_BUFFER_BUFFER_ "buffer"
+
+#define MSTR_BUFFER_BYTE_LENGTH "byteLength"
+#define MSTR_BUFFER_FROM_STRING "fromString"
+#define MSTR_BUFFER_CONCAT "concat"
+#define MSTR_BUFFER_INDEX_OF "indexOf"
+#define MSTR_BUFFER_TO_STRING "toString"
+#define MSTR_BUFFER_WRITE "write"
+#define MSTR_BUFFER_COMPARE "compare"
+#define MSTR_BUFFER_READ_INT "readInt"
+#define MSTR_BUFFER_WRITE_INT "writeInt"
+
+#endif /* __BUFFER_MAGIC_STRINGS_H */
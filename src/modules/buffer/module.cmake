@@ -0,0 +1,2 @@
+list(APPEND SOURCES ${SRC_DIR}/modules/buffer/module_buffer.c)
+include_directories(${SRC_DIR}/modules/buffer)
@@ -0,0 +1,652 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "module_buffer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base64.h"
+#include "buffer_magic_strings.h"
+#include "jerryscript.h"
+#include "jerryxx.h"
+#include "magic_strings.h"
+
+typedef enum {
+  BUFFER_ENCODING_UTF8,
+  BUFFER_ENCODING_ASCII,
+  BUFFER_ENCODING_LATIN1,
+  BUFFER_ENCODING_HEX,
+  BUFFER_ENCODING_BASE64,
+  BUFFER_ENCODING_UNKNOWN,
+} buffer_encoding_t;
+
+/* type of readInt()/writeInt(): size in bytes | flags */
+#define BUFFER_TYPE_SIZE_MASK 0x0F
+#define BUFFER_TYPE_SIGNED 0x10
+#define BUFFER_TYPE_BE 0x20
+#define BUFFER_TYPE_FLOAT 0x40
+
+/**
+ * Get the data pointer and byte length of a typed array
+ */
+static uint8_t *buffer_pointer(jerry_value_t array, jerry_length_t *length) {
+  jerry_length_t offset = 0;
+  jerry_value_t arrbuf = jerry_get_typedarray_buffer(array, &offset, length);
+  uint8_t *pointer = jerry_get_arraybuffer_pointer(arrbuf);
+  jerry_release_value(arrbuf);
+  return pointer + offset;
+}
+
+/**
+ * Get encoding from an optional argument (utf8 by default)
+ */
+static buffer_encoding_t buffer_get_encoding(const jerry_value_t args_p[],
+                                             const jerry_length_t args_cnt,
+                                             int index) {
+  if (args_cnt <= index || !jerry_value_is_string(args_p[index])) {
+    return BUFFER_ENCODING_UTF8;
+  }
+  jerry_char_t name[16];
+  jerry_size_t len = jerry_substring_to_char_buffer(args_p[index], 0, 15,
+                                                    name, sizeof(name) - 1);
+  name[len] = '\0';
+  for (int i = 0; i < len; i++) {
+    if (name[i] >= 'A' && name[i] <= 'Z') name[i] += 'a' - 'A';
+  }
+  const char *s = (const char *)name;
+  if (strcmp(s, "utf8") == 0 || strcmp(s, "utf-8") == 0) {
+    return BUFFER_ENCODING_UTF8;
+  } else if (strcmp(s, "ascii") == 0) {
+    return BUFFER_ENCODING_ASCII;
+  } else if (strcmp(s, "latin1") == 0 || strcmp(s, "binary") == 0) {
+    return BUFFER_ENCODING_LATIN1;
+  } else if (strcmp(s, "hex") == 0) {
+    return BUFFER_ENCODING_HEX;
+  } else if (strcmp(s, "base64") == 0) {
+    return BUFFER_ENCODING_BASE64;
+  }
+  return BUFFER_ENCODING_UNKNOWN;
+}
+
+static int hex_value(uint8_t ch) {
+  if (ch >= '0' && ch <= '9') return ch - '0';
+  if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+  if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+  return -1;
+}
+
+/**
+ * Encode a string to bytes. Returns an allocated buffer (NULL if the result
+ * is empty) and its length in *len.
+ */
+static uint8_t *buffer_encode(jerry_value_t str, buffer_encoding_t encoding,
+                              size_t *len) {
+  uint8_t *data = NULL;
+  *len = 0;
+  if (encoding == BUFFER_ENCODING_UTF8) {
+    jerry_size_t size = jerry_get_utf8_string_size(str);
+    if (size > 0 && (data = malloc(size)) != NULL) {
+      *len = jerry_string_to_utf8_char_buffer(str, data, size);
+    }
+    return data;
+  }
+  // others are decoded from CESU-8 (one UTF-16 code unit per sequence)
+  jerry_size_t size = jerry_get_string_size(str);
+  if (size == 0 || (data = malloc(size)) == NULL) {
+    return NULL;
+  }
+  size = jerry_string_to_char_buffer(str, data, size);
+  size_t n = 0;
+  if (encoding == BUFFER_ENCODING_HEX) {
+    for (size_t i = 0; i + 1 < size; i += 2) {
+      int hi = hex_value(data[i]);
+      int lo = hex_value(data[i + 1]);
+      if (hi < 0 || lo < 0) break;
+      data[n++] = (hi << 4) | lo;
+    }
+  } else if (encoding == BUFFER_ENCODING_BASE64) {
+    size_t decoded_len = 0;
+    uint8_t *decoded = km_base64_decode(data, size, &decoded_len);
+    free(data);
+    *len = decoded != NULL ? decoded_len : 0;
+    return decoded;
+  } else {  // latin1, ascii: low byte of each code unit
+    size_t i = 0;
+    while (i < size) {
+      uint8_t ch = data[i];
+      uint32_t unit = ch;
+      if (ch >= 0xE0 && i + 2 < size) {
+        unit = ((ch & 0x0F) << 12) | ((data[i + 1] & 0x3F) << 6) |
+               (data[i + 2] & 0x3F);
+        i += 3;
+      } else if (ch >= 0xC0 && i + 1 < size) {
+        unit = ((ch & 0x1F) << 6) | (data[i + 1] & 0x3F);
+        i += 2;
+      } else {
+        i++;
+      }
+      data[n++] = (uint8_t)unit;
+    }
+  }
+  *len = n;
+  return data;
+}
+
+/**
+ * Length of a valid UTF-8 sequence at p, or 0 if invalid
+ */
+static size_t utf8_sequence_length(const uint8_t *p, size_t remain) {
+  uint8_t ch = p[0];
+  if (ch < 0x80) return 1;
+  size_t n;
+  uint32_t cp;
+  if ((ch & 0xE0) == 0xC0) {
+    n = 2;
+    cp = ch & 0x1F;
+  } else if ((ch & 0xF0) == 0xE0) {
+    n = 3;
+    cp = ch & 0x0F;
+  } else if ((ch & 0xF8) == 0xF0) {
+    n = 4;
+    cp = ch & 0x07;
+  } else {
+    return 0;
+  }
+  if (n > remain) return 0;
+  for (size_t i = 1; i < n; i++) {
+    if ((p[i] & 0xC0) != 0x80) return 0;
+    cp = (cp << 6) | (p[i] & 0x3F);
+  }
+  if ((n == 2 && cp < 0x80) || (n == 3 && cp < 0x800) ||
+      (n == 4 && (cp < 0x10000 || cp > 0x10FFFF)) ||
+      (cp >= 0xD800 && cp <= 0xDFFF)) {
+    return 0;  // overlong, out of range or surrogate
+  }
+  return n;
+}
+
+/**
+ * Create a string from UTF-8 bytes. Invalid sequences are replaced with
+ * U+FFFD.
+ */
+static jerry_value_t buffer_create_utf8_string(const uint8_t *data,
+                                               size_t len) {
+  size_t i = 0;
+  size_t n;
+  while (i < len && (n = utf8_sequence_length(data + i, len - i)) > 0) {
+    i += n;
+  }
+  if (i == len) {
+    return jerry_create_string_sz_from_utf8(data, len);
+  }
+  uint8_t *valid = malloc(len * 3);
+  if (valid == NULL) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Out of memory.");
+  }
+  size_t j = 0;
+  i = 0;
+  while (i < len) {
+    n = utf8_sequence_length(data + i, len - i);
+    if (n > 0) {
+      memcpy(valid + j, data + i, n);
+      i += n;
+      j += n;
+    } else {
+      valid[j++] = 0xEF;
+      valid[j++] = 0xBF;
+      valid[j++] = 0xBD;
+      i++;
+    }
+  }
+  jerry_value_t str = jerry_create_string_sz_from_utf8(valid, j);
+  free(valid);
+  return str;
+}
+
+/**
+ * Decode bytes to a string
+ */
+static jerry_value_t buffer_decode(const uint8_t *data, size_t len,
+                                   buffer_encoding_t encoding) {
+  if (len == 0) {
+    return jerry_create_string((const jerry_char_t *)"");
+  }
+  if (encoding == BUFFER_ENCODING_UTF8) {
+    return buffer_create_utf8_string(data, len);
+  } else if (encoding == BUFFER_ENCODING_BASE64) {
+    size_t encoded_len = 0;
+    uint8_t *encoded = km_base64_encode(data, len, &encoded_len);
+    if (encoded == NULL) {
+      return jerry_create_error(JERRY_ERROR_RANGE,
+                                (const jerry_char_t *)"Out of memory.");
+    }
+    // strip the line feeds km_base64_encode() inserts
+    size_t n = 0;
+    for (size_t i = 0; i < encoded_len && encoded[i] != '\0'; i++) {
+      if (encoded[i] != '\n') encoded[n++] = encoded[i];
+    }
+    jerry_value_t str = jerry_create_string_sz(encoded, n);
+    free(encoded);
+    return str;
+  }
+  size_t size = len;
+  if (encoding == BUFFER_ENCODING_HEX) {
+    size = len * 2;
+  } else if (encoding == BUFFER_ENCODING_LATIN1) {
+    for (size_t i = 0; i < len; i++) {
+      if (data[i] >= 0x80) size++;
+    }
+  }
+  uint8_t *out = malloc(size);
+  if (out == NULL) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Out of memory.");
+  }
+  size_t n = 0;
+  if (encoding == BUFFER_ENCODING_HEX) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++) {
+      out[n++] = digits[data[i] >> 4];
+      out[n++] = digits[data[i] & 0x0F];
+    }
+  } else if (encoding == BUFFER_ENCODING_LATIN1) {
+    for (size_t i = 0; i < len; i++) {
+      if (data[i] < 0x80) {
+        out[n++] = data[i];
+      } else {
+        out[n++] = 0xC0 | (data[i] >> 6);
+        out[n++] = 0x80 | (data[i] & 0x3F);
+      }
+    }
+  } else {  // ascii
+    for (size_t i = 0; i < len; i++) {
+      out[n++] = data[i] & 0x7F;
+    }
+  }
+  jerry_value_t str = jerry_create_string_sz_from_utf8(out, n);
+  free(out);
+  return str;
+}
+
+/**
+ * Find needle in haystack from the offset. Returns -1 if not found.
+ */
+static int32_t buffer_search(const uint8_t *haystack, size_t haystack_len,
+                             const uint8_t *needle, size_t needle_len,
+                             size_t offset) {
+  if (needle_len == 0) {
+    return offset < haystack_len ? offset : haystack_len;
+  }
+  while (offset + needle_len <= haystack_len) {
+    const uint8_t *p = memchr(haystack + offset, needle[0],
+                              haystack_len - offset - needle_len + 1);
+    if (p == NULL) break;
+    if (memcmp(p + 1, needle + 1, needle_len - 1) == 0) {
+      return p - haystack;
+    }
+    offset = (p - haystack) + 1;
+  }
+  return -1;
+}
+
+static jerry_value_t create_encoding_error() {
+  return jerry_create_error(JERRY_ERROR_TYPE,
+                            (const jerry_char_t *)"Unknown encoding.");
+}
+
+/**
+ * byteLength(string, encoding)
+ */
+JERRYXX_FUN(buffer_byte_length_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "string")
+  jerry_value_t str = JERRYXX_GET_ARG(0);
+  buffer_encoding_t encoding = buffer_get_encoding(args_p, args_cnt, 1);
+  switch (encoding) {
+    case BUFFER_ENCODING_UTF8:
+      return jerry_create_number(jerry_get_utf8_string_size(str));
+    case BUFFER_ENCODING_ASCII:
+    case BUFFER_ENCODING_LATIN1:
+      return jerry_create_number(jerry_get_string_length(str));
+    case BUFFER_ENCODING_UNKNOWN:
+      return create_encoding_error();
+    default: {
+      size_t len = 0;
+      uint8_t *data = buffer_encode(str, encoding, &len);
+      free(data);
+      return jerry_create_number(len);
+    }
+  }
+}
+
+/**
+ * fromString(string, encoding)
+ * returns: {ArrayBuffer}
+ */
+JERRYXX_FUN(buffer_from_string_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "string")
+  jerry_value_t str = JERRYXX_GET_ARG(0);
+  buffer_encoding_t encoding = buffer_get_encoding(args_p, args_cnt, 1);
+  if (encoding == BUFFER_ENCODING_UNKNOWN) {
+    return create_encoding_error();
+  }
+  if (encoding == BUFFER_ENCODING_UTF8) {
+    // encode directly into the array buffer
+    jerry_size_t size = jerry_get_utf8_string_size(str);
+    jerry_value_t arrbuf = jerry_create_arraybuffer(size);
+    if (size > 0) {
+      jerry_string_to_utf8_char_buffer(
+          str, jerry_get_arraybuffer_pointer(arrbuf), size);
+    }
+    return arrbuf;
+  }
+  size_t len = 0;
+  uint8_t *data = buffer_encode(str, encoding, &len);
+  jerry_value_t arrbuf = jerry_create_arraybuffer(len);
+  if (len > 0) {
+    memcpy(jerry_get_arraybuffer_pointer(arrbuf), data, len);
+  }
+  free(data);
+  return arrbuf;
+}
+
+/**
+ * concat(list, totalLength)
+ * returns: {ArrayBuffer}
+ */
+JERRYXX_FUN(buffer_concat_fn) {
+  JERRYXX_CHECK_ARG_ARRAY(0, "list")
+  jerry_value_t list = JERRYXX_GET_ARG(0);
+  uint32_t count = jerry_get_array_length(list);
+  size_t total = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    jerry_value_t item = jerry_get_property_by_index(list, i);
+    bool is_typedarray = jerry_value_is_typedarray(item);
+    if (is_typedarray) {
+      jerry_length_t length = 0;
+      buffer_pointer(item, &length);
+      total += length;
+    }
+    jerry_release_value(item);
+    if (!is_typedarray) {
+      return jerry_create_error(
+          JERRY_ERROR_TYPE,
+          (const jerry_char_t *)"The list must contain only Uint8Array.");
+    }
+  }
+  if (JERRYXX_HAS_ARG(1) && jerry_value_is_number(JERRYXX_GET_ARG(1))) {
+    double total_length = JERRYXX_GET_ARG_NUMBER(1);
+    total = total_length > 0 ? (size_t)total_length : 0;
+  }
+  jerry_value_t arrbuf = jerry_create_arraybuffer(total);
+  uint8_t *dst = jerry_get_arraybuffer_pointer(arrbuf);
+  size_t pos = 0;
+  for (uint32_t i = 0; i < count && pos < total; i++) {
+    jerry_value_t item = jerry_get_property_by_index(list, i);
+    jerry_length_t length = 0;
+    uint8_t *src = buffer_pointer(item, &length);
+    if (length > total - pos) length = total - pos;
+    memcpy(dst + pos, src, length);
+    pos += length;
+    jerry_release_value(item);
+  }
+  if (pos < total) {
+    memset(dst + pos, 0, total - pos);
+  }
+  return arrbuf;
+}
+
+/**
+ * indexOf(buffer, value, byteOffset, encoding)
+ */
+JERRYXX_FUN(buffer_index_of_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "buffer")
+  JERRYXX_CHECK_ARG(1, "value")
+  jerry_length_t len = 0;
+  uint8_t *buf = buffer_pointer(JERRYXX_GET_ARG(0), &len);
+  jerry_value_t value = JERRYXX_GET_ARG(1);
+  double byte_offset = 0;
+  if (JERRYXX_HAS_ARG(2) && jerry_value_is_number(JERRYXX_GET_ARG(2))) {
+    byte_offset = JERRYXX_GET_ARG_NUMBER(2);
+  }
+  if (byte_offset < 0) byte_offset += len;
+  if (byte_offset < 0 || isnan(byte_offset)) byte_offset = 0;
+  if (byte_offset > len) return jerry_create_number(-1);
+  size_t offset = (size_t)byte_offset;
+
+  int32_t index = -1;
+  if (jerry_value_is_number(value)) {
+    uint8_t ch = (uint8_t)(int32_t)jerry_get_number_value(value);
+    uint8_t *p = memchr(buf + offset, ch, len - offset);
+    index = p != NULL ? p - buf : -1;
+  } else if (jerry_value_is_typedarray(value)) {
+    jerry_length_t needle_len = 0;
+    uint8_t *needle = buffer_pointer(value, &needle_len);
+    index = buffer_search(buf, len, needle, needle_len, offset);
+  } else if (jerry_value_is_string(value)) {
+    buffer_encoding_t encoding = buffer_get_encoding(args_p, args_cnt, 3);
+    if (encoding == BUFFER_ENCODING_UNKNOWN) {
+      return create_encoding_error();
+    }
+    size_t needle_len = 0;
+    uint8_t *needle = buffer_encode(value, encoding, &needle_len);
+    index = buffer_search(buf, len, needle, needle_len, offset);
+    free(needle);
+  } else {
+    return jerry_create_error(
+        JERRY_ERROR_TYPE,
+        (const jerry_char_t *)"The value must be number, string or Uint8Array.");
+  }
+  return jerry_create_number(index);
+}
+
+/**
+ * toString(buffer, encoding, start, end)
+ */
+JERRYXX_FUN(buffer_to_string_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "buffer")
+  jerry_length_t len = 0;
+  uint8_t *buf = buffer_pointer(JERRYXX_GET_ARG(0), &len);
+  buffer_encoding_t encoding = buffer_get_encoding(args_p, args_cnt, 1);
+  if (encoding == BUFFER_ENCODING_UNKNOWN) {
+    return create_encoding_error();
+  }
+  double start = 0;
+  double end = len;
+  if (JERRYXX_HAS_ARG(2) && jerry_value_is_number(JERRYXX_GET_ARG(2))) {
+    start = JERRYXX_GET_ARG_NUMBER(2);
+  }
+  if (JERRYXX_HAS_ARG(3) && jerry_value_is_number(JERRYXX_GET_ARG(3))) {
+    end = JERRYXX_GET_ARG_NUMBER(3);
+  }
+  if (!(start > 0)) start = 0;
+  if (end > len) end = len;
+  if (!(end > start)) {
+    return jerry_create_string((const jerry_char_t *)"");
+  }
+  return buffer_decode(buf + (size_t)start, (size_t)end - (size_t)start,
+                       encoding);
+}
+
+/**
+ * write(buffer, string, offset, length, encoding)
+ * returns: {number} number of bytes written
+ */
+JERRYXX_FUN(buffer_write_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "buffer")
+  JERRYXX_CHECK_ARG_STRING(1, "string")
+  jerry_length_t len = 0;
+  uint8_t *buf = buffer_pointer(JERRYXX_GET_ARG(0), &len);
+  double offset = 0;
+  if (JERRYXX_HAS_ARG(2) && jerry_value_is_number(JERRYXX_GET_ARG(2))) {
+    offset = JERRYXX_GET_ARG_NUMBER(2);
+  }
+  if (!(offset >= 0) || offset > len) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Offset out of range.");
+  }
+  double length = len - offset;
+  if (JERRYXX_HAS_ARG(3) && jerry_value_is_number(JERRYXX_GET_ARG(3))) {
+    length = JERRYXX_GET_ARG_NUMBER(3);
+  }
+  if (!(length >= 0)) length = 0;
+  if (length > len - offset) length = len - offset;
+  buffer_encoding_t encoding = buffer_get_encoding(args_p, args_cnt, 4);
+  if (encoding == BUFFER_ENCODING_UNKNOWN) {
+    return create_encoding_error();
+  }
+  size_t data_len = 0;
+  uint8_t *data = buffer_encode(JERRYXX_GET_ARG(1), encoding, &data_len);
+  if (data_len > (size_t)length) data_len = (size_t)length;
+  if (data_len > 0) {
+    memcpy(buf + (size_t)offset, data, data_len);
+  }
+  free(data);
+  return jerry_create_number(data_len);
+}
+
+/**
+ * compare(a, b)
+ */
+JERRYXX_FUN(buffer_compare_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "a")
+  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "b")
+  jerry_length_t a_len = 0;
+  jerry_length_t b_len = 0;
+  uint8_t *a = buffer_pointer(JERRYXX_GET_ARG(0), &a_len);
+  uint8_t *b = buffer_pointer(JERRYXX_GET_ARG(1), &b_len);
+  int ret = memcmp(a, b, a_len < b_len ? a_len : b_len);
+  if (ret == 0) ret = a_len - b_len;
+  return jerry_create_number(ret < 0 ? -1 : (ret > 0 ? 1 : 0));
+}
+
+/**
+ * Copy n bytes, in reverse order if be is set
+ */
+static void buffer_copy_order(uint8_t *dst, const uint8_t *src, size_t n,
+                           bool be) {
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = be ? src[n - 1 - i] : src[i];
+  }
+}
+
+/**
+ * readInt(buffer, offset, type)
+ */
+JERRYXX_FUN(buffer_read_int_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "buffer")
+  JERRYXX_CHECK_ARG_NUMBER(1, "offset")
+  JERRYXX_CHECK_ARG_NUMBER(2, "type")
+  jerry_length_t len = 0;
+  uint8_t *buf = buffer_pointer(JERRYXX_GET_ARG(0), &len);
+  double offset = JERRYXX_GET_ARG_NUMBER(1);
+  uint8_t type = (uint8_t)JERRYXX_GET_ARG_NUMBER(2);
+  size_t size = type & BUFFER_TYPE_SIZE_MASK;
+  if (!(offset >= 0) || offset + size > len) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Offset out of range.");
+  }
+  uint8_t bytes[8];
+  buffer_copy_order(bytes, buf + (size_t)offset, size, type & BUFFER_TYPE_BE);
+  if (type & BUFFER_TYPE_FLOAT) {
+    if (size == 4) {
+      float f;
+      memcpy(&f, bytes, 4);
+      return jerry_create_number(f);
+    }
+    double d;
+    memcpy(&d, bytes, 8);
+    return jerry_create_number(d);
+  }
+  uint32_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value |= (uint32_t)bytes[i] << (i * 8);
+  }
+  if (type & BUFFER_TYPE_SIGNED) {
+    uint32_t sign = 1u << (size * 8 - 1);
+    if (size < 4 && (value & sign)) value |= ~((sign << 1) - 1);
+    return jerry_create_number((int32_t)value);
+  }
+  return jerry_create_number(value);
+}
+
+/**
+ * writeInt(buffer, value, offset, type)
+ * returns: {number} offset plus the number of bytes written
+ */
+JERRYXX_FUN(buffer_write_int_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "buffer")
+  JERRYXX_CHECK_ARG_NUMBER(1, "value")
+  JERRYXX_CHECK_ARG_NUMBER(2, "offset")
+  JERRYXX_CHECK_ARG_NUMBER(3, "type")
+  jerry_length_t len = 0;
+  uint8_t *buf = buffer_pointer(JERRYXX_GET_ARG(0), &len);
+  double value = JERRYXX_GET_ARG_NUMBER(1);
+  double offset = JERRYXX_GET_ARG_NUMBER(2);
+  uint8_t type = (uint8_t)JERRYXX_GET_ARG_NUMBER(3);
+  size_t size = type & BUFFER_TYPE_SIZE_MASK;
+  if (!(offset >= 0) || offset + size > len) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Offset out of range.");
+  }
+  uint8_t bytes[8];
+  if (type & BUFFER_TYPE_FLOAT) {
+    if (size == 4) {
+      float f = (float)value;
+      memcpy(bytes, &f, 4);
+    } else {
+      memcpy(bytes, &value, 8);
+    }
+  } else {
+    uint32_t v = isfinite(value) ? (uint32_t)(int64_t)value : 0;
+    for (size_t i = 0; i < size; i++) {
+      bytes[i] = (v >> (i * 8)) & 0xFF;
+    }
+  }
+  buffer_copy_order(buf + (size_t)offset, bytes, size, type & BUFFER_TYPE_BE);
+  return jerry_create_number(offset + size);
+}
+
+/**
+ * Initialize 'buffer' module
+ */
+jerry_value_t module_buffer_init() {
+  jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property_function(exports, MSTR_BUFFER_BYTE_LENGTH,
+                                buffer_byte_length_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_FROM_STRING,
+                                buffer_from_string_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_CONCAT, buffer_concat_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_INDEX_OF,
+                                buffer_index_of_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_TO_STRING,
+                                buffer_to_string_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_WRITE, buffer_write_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_COMPARE,
+                                buffer_compare_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_READ_INT,
+                                buffer_read_int_fn);
+  jerryxx_set_property_function(exports, MSTR_BUFFER_WRITE_INT,
+                                buffer_write_int_fn);
+  return exports;
+}
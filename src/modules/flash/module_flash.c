@@ -22,7 +22,9 @@
 #include "module_flash.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "blkdev.h"
 #include "board.h"
 #include "err.h"
 #include "flash.h"
@@ -31,6 +33,77 @@
 #include "jerryxx.h"
 #include "magic_strings.h"
 
+typedef struct {
+  km_blkdev_t blkdev;
+  uint32_t base;
+  uint32_t count;
+} flash_blkdev_t;
+
+static int flash_blkdev_read(km_blkdev_t *dev, uint32_t block,
+                             uint32_t offset, uint8_t *buffer,
+                             uint32_t size) {
+  flash_blkdev_t *flash = (flash_blkdev_t *)dev;
+  if (block + (offset + size - 1) / KALUMA_FLASH_SECTOR_SIZE >=
+      flash->count) {
+    return EINVAL;
+  }
+  memcpy(buffer,
+         km_flash_addr + (flash->base + block) * KALUMA_FLASH_SECTOR_SIZE +
+             offset,
+         size);
+  return 0;
+}
+
+static int flash_blkdev_prog(km_blkdev_t *dev, uint32_t block,
+                             uint32_t offset, const uint8_t *buffer,
+                             uint32_t size) {
+  flash_blkdev_t *flash = (flash_blkdev_t *)dev;
+  if (block + (offset + size - 1) / KALUMA_FLASH_SECTOR_SIZE >=
+      flash->count) {
+    return EINVAL;
+  }
+  return km_flash_program(flash->base + block, offset, (uint8_t *)buffer,
+                          size) < 0
+             ? EIO
+             : 0;
+}
+
+static int flash_blkdev_erase(km_blkdev_t *dev, uint32_t block,
+                              uint32_t count) {
+  flash_blkdev_t *flash = (flash_blkdev_t *)dev;
+  if (block + count > flash->count) {
+    return EINVAL;
+  }
+  return km_flash_erase(flash->base + block, count) < 0 ? EIO : 0;
+}
+
+static int flash_blkdev_sync(km_blkdev_t *dev) { return 0; }
+
+static int flash_blkdev_ioctl(km_blkdev_t *dev, int op, int arg) {
+  flash_blkdev_t *flash = (flash_blkdev_t *)dev;
+  switch (op) {
+    case KM_BLKDEV_INIT:
+    case KM_BLKDEV_SHUTDOWN:
+      return 0;
+    case KM_BLKDEV_BLOCK_COUNT:
+      return flash->count;
+    case KM_BLKDEV_BLOCK_SIZE:
+      return KALUMA_FLASH_SECTOR_SIZE;
+    case KM_BLKDEV_BUFFER_SIZE:  // = flash page size
+      return 256;
+    default:
+      return -1;
+  }
+}
+
+static const km_blkdev_ops_t flash_blkdev_ops = {
+    .read = flash_blkdev_read,
+    .prog = flash_blkdev_prog,
+    .erase = flash_blkdev_erase,
+    .sync = flash_blkdev_sync,
+    .ioctl = flash_blkdev_ioctl,
+};
+
 /**
  * Flash (block device) constructor
  * args:
@@ -49,6 +122,16 @@ JERRYXX_FUN(flash_ctor_fn) {
   jerryxx_set_property_number(JERRYXX_GET_THIS, "base", base);
   jerryxx_set_property_number(JERRYXX_GET_THIS, "count", count);
   jerryxx_set_property_number(JERRYXX_GET_THIS, "size", size);
+
+  // native block device for the file systems
+  flash_blkdev_t *flash = (flash_blkdev_t *)malloc(sizeof(flash_blkdev_t));
+  if (flash == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  flash->blkdev.ops = &flash_blkdev_ops;
+  flash->base = base;
+  flash->count = count;
+  km_blkdev_attach(JERRYXX_GET_THIS, &flash->blkdev);
   return jerry_create_undefined();
 }
 
@@ -67,6 +150,7 @@ JERRYXX_FUN(flash_read_fn) {
   int block = JERRYXX_GET_ARG_NUMBER(0);
   jerry_value_t buffer = JERRYXX_GET_ARG(1);
   int offset = JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
+  JERRYXX_GET_NATIVE_HANDLE(dev, km_blkdev_t, km_blkdev_native_info);
 
   // get buffer pointer
   jerry_length_t buffer_length = 0;
@@ -76,14 +160,13 @@ JERRYXX_FUN(flash_read_fn) {
   uint8_t *buffer_pointer = jerry_get_arraybuffer_pointer(arrbuf);
   jerry_release_value(arrbuf);
 
-  // printf("bd.read(%d, %d, %d)\r\n", block, buffer_length, offset);
-
   // read from flash
-  int base = jerryxx_get_property_number(JERRYXX_GET_THIS, "base", 0);
-  int size = jerryxx_get_property_number(JERRYXX_GET_THIS, "size", 0);
-  const uint8_t *addr = km_flash_addr;
-  for (int i = 0; i < buffer_length; i++) {
-    buffer_pointer[i] = addr[((base + block) * size) + offset + i];
+  int ret = buffer_length > 0
+                ? dev->ops->read(dev, block, offset,
+                                 buffer_pointer + buffer_offset, buffer_length)
+                : 0;
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
   }
   return jerry_create_undefined();
 }
@@ -103,6 +186,7 @@ JERRYXX_FUN(flash_write_fn) {
   int block = JERRYXX_GET_ARG_NUMBER(0);
   jerry_value_t buffer = JERRYXX_GET_ARG(1);
   int offset = JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
+  JERRYXX_GET_NATIVE_HANDLE(dev, km_blkdev_t, km_blkdev_native_info);
 
   // get buffer pointer
   jerry_length_t buffer_length = 0;
@@ -112,11 +196,14 @@ JERRYXX_FUN(flash_write_fn) {
   uint8_t *buffer_pointer = jerry_get_arraybuffer_pointer(arrbuf);
   jerry_release_value(arrbuf);
 
-  // printf("bd.write(%d, %d, %d)\r\n", block, buffer_length, offset);
-
-  // write to buffer
-  int base = jerryxx_get_property_number(JERRYXX_GET_THIS, "base", 0);
-  km_flash_program(base + block, offset, buffer_pointer, buffer_length);
+  // write to flash
+  int ret = buffer_length > 0
+                ? dev->ops->prog(dev, block, offset,
+                                 buffer_pointer + buffer_offset, buffer_length)
+                : 0;
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
   return jerry_create_undefined();
 }
 
@@ -132,31 +219,8 @@ JERRYXX_FUN(flash_ioctl_fn) {
   JERRYXX_CHECK_ARG_NUMBER_OPT(1, "arg")
   int op = JERRYXX_GET_ARG_NUMBER(0);
   int arg = JERRYXX_GET_ARG_NUMBER_OPT(1, 0);
-  int base = (int)jerryxx_get_property_number(JERRYXX_GET_THIS, "base", 0);
-
-  // printf("bd.ioctl(%d, %d)\r\n", op, arg);
-
-  switch (op) {
-    case 1:  // init
-      return jerry_create_number(0);
-    case 2:  // shutdown
-      return jerry_create_number(0);
-    case 3:  // sync
-      return jerry_create_number(0);
-    case 4:  // block count
-      return jerry_create_number(
-          jerryxx_get_property_number(JERRYXX_GET_THIS, "count", 0));
-    case 5:  // block size
-      return jerry_create_number(
-          jerryxx_get_property_number(JERRYXX_GET_THIS, "size", 0));
-    case 6:  // erase block
-      km_flash_erase(base + arg, 1);
-      return jerry_create_number(0);
-    case 7:  // buffer size (= flash page size)
-      return jerry_create_number(256);
-    default:
-      return jerry_create_number(-1);
-  }
+  JERRYXX_GET_NATIVE_HANDLE(dev, km_blkdev_t, km_blkdev_native_info);
+  return jerry_create_number(km_blkdev_ioctl(dev, op, arg));
 }
 
 /**
@@ -1,5 +1,6 @@
 process.binding(process.binding.fs); // init native fs
 const __path = require("path");
+const { Buffer } = require("buffer");
 
 class Stats {
   constructor() {
@@ -131,8 +132,17 @@ function mkfs(blkdev, fstype) {
  * @param {BlockDevice} blkdev
  * @param {string} fstype
  * @param {boolean} mkfs
+ * @param {object} options
+ * @param {number} options.cacheSize bytes of block cache (default: 0)
+ * @param {number} options.readAhead lines the block cache reads ahead
+ * @param {number} options.bufferSize littlefs: bytes of each buffer
+ * @param {number} options.lookaheadSize littlefs: bytes of lookahead buffer
+ * @param {number} options.blockCycles littlefs: erase cycles per metadata
+ * @param {number} options.inlineMax littlefs: max bytes of inline files
+ * @param {number} options.attrMax littlefs: max bytes of attributes
+ * @param {number} options.nameMax littlefs: max bytes of file names
  */
-function mount(path, blkdev, fstype, mkfs) {
+function mount(path, blkdev, fstype, mkfs, options) {
   path = __path.normalize(path);
   const _parent = __path.join(path, "..");
   if (_parent !== "/") {
@@ -147,7 +157,7 @@ function mount(path, blkdev, fstype, mkfs) {
   if (!fsctr) {
     throw new SystemError(-22); // EINVAL (?)
   }
-  const vfs = new fsctr(blkdev);
+  const vfs = new fsctr(blkdev, options);
 
   // try to mount (try mkfs if mount failed)
   try {
@@ -183,6 +193,67 @@ function unmount(path) {
   }
 }
 
+/**
+ * Write back the block cache of the mounted VFS and sync the block device
+ * @param {string} path
+ */
+function flush(path) {
+  path = __path.normalize(path);
+  const vfs = __mounts.find((v) => v.path === path);
+  if (!vfs) {
+    throw new SystemError(-2); // ENOENT
+  }
+  vfs.flush();
+}
+
+/**
+ * Block cache counters of the mounted VFS
+ * @param {string} path
+ * @returns {object} undefined if the VFS has no block cache
+ */
+function cacheStats(path) {
+  path = __path.normalize(path);
+  const vfs = __mounts.find((v) => v.path === path);
+  if (!vfs) {
+    throw new SystemError(-2); // ENOENT
+  }
+  return vfs.cacheStats();
+}
+
+/**
+ * Block usage of the mounted VFS
+ * @param {string} path
+ * @returns {object} {bsize, blocks, bfree, bavail}
+ */
+function statfs(path) {
+  path = __path.normalize(path);
+  const vfs = __mounts.find((v) => v.path === path);
+  if (!vfs) {
+    throw new SystemError(-2); // ENOENT
+  }
+  if (!vfs.statfs) {
+    throw new SystemError(-38); // ENOSYS
+  }
+  return vfs.statfs();
+}
+
+/**
+ * Do the housekeeping of the mounted VFS (e.g. finding free blocks) ahead,
+ * instead of on a later write
+ * @param {string} path
+ */
+function gc(path) {
+  path = __path.normalize(path);
+  const vfs = __mounts.find((v) => v.path === path);
+  if (!vfs) {
+    throw new SystemError(-2); // ENOENT
+  }
+  if (!vfs.gc) {
+    throw new SystemError(-38); // ENOSYS
+  }
+  vfs.gc();
+}
+
 /**
  * Return current working directory
  * @returns {string}
@@ -272,13 +343,13 @@ function read(fd, ...args) {
   throw new SystemError(-9); // EBADF
 }
 
-function readFile(path) {
+function readFile(path, encoding) {
   const _stat = stat(path);
-  const buffer = new Uint8Array(_stat.size);
+  const buffer = Buffer.allocUnsafe(_stat.size);
   const fd = open(path, "r");
   read(fd, buffer, 0, buffer.length, 0);
   close(fd);
-  return buffer;
+  return encoding ? buffer.toString(encoding) : buffer;
 }
 
 function write(fd, ...args) {
@@ -289,7 +360,10 @@ function write(fd, ...args) {
   throw new SystemError(-9); // EBADF
 }
 
-function writeFile(path, data) {
+function writeFile(path, data, encoding) {
+  if (typeof data === "string") {
+    data = Buffer.from(data, encoding);
+  }
   const fd = open(path, "w");
   write(fd, data, 0, data.length, 0);
   close(fd);
@@ -391,6 +465,10 @@ exports.unregister = unregister;
 exports.mkfs = mkfs;
 exports.mount = mount;
 exports.unmount = unmount;
+exports.flush = flush;
+exports.cacheStats = cacheStats;
+exports.statfs = statfs;
+exports.gc = gc;
 exports.chdir = chdir;
 exports.cwd = cwd;
 exports.close = close;
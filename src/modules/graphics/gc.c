@@ -28,6 +28,7 @@
 
 #include "gc.h"
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -64,6 +65,84 @@ void gc_fill_screen(gc_handle_t *handle, uint16_t color) {
   handle->fill_screen_cb(handle, color);
 }
 
+/**
+ * @brief  Copy a rect of the source context to (dx, dy). The source may be
+ *         the context itself, overlapping rects are copied safely. Buffers
+ *         of the same format and rotation are copied row by row in device
+ *         space, others pixel by pixel.
+ * @param  handle  Graphic context handle (destination)
+ * @param  src     Graphic context handle of the source
+ */
+void gc_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                  int16_t sy, int16_t w, int16_t h, int16_t dx, int16_t dy) {
+  int32_t x0 = sx, y0 = sy, x1 = dx, y1 = dy, _w = w, _h = h;
+  // clip to the source and then to the destination
+  if (x0 < 0) {
+    x1 -= x0;
+    _w += x0;
+    x0 = 0;
+  }
+  if (y0 < 0) {
+    y1 -= y0;
+    _h += y0;
+    y0 = 0;
+  }
+  if (x1 < 0) {
+    x0 -= x1;
+    _w += x1;
+    x1 = 0;
+  }
+  if (y1 < 0) {
+    y0 -= y1;
+    _h += y1;
+    y1 = 0;
+  }
+  _w = MIN(_w, MIN(src->width - x0, handle->width - x1));
+  _h = MIN(_h, MIN(src->height - y0, handle->height - y1));
+  if (_w <= 0 || _h <= 0) {
+    return;
+  }
+  if (handle->copy_rect_cb != NULL &&
+      handle->copy_rect_cb == src->copy_rect_cb &&
+      handle->rotation == src->rotation) {
+    int16_t src_x = x0, src_y = y0, dst_x = x1, dst_y = y1;
+    int16_t src_w = _w, src_h = _h, dst_w = _w, dst_h = _h;
+    gc_clip_to_device(src, &src_x, &src_y, &src_w, &src_h);
+    gc_clip_to_device(handle, &dst_x, &dst_y, &dst_w, &dst_h);
+    handle->copy_rect_cb(handle, src, src_x, src_y, src_w, src_h, dst_x,
+                         dst_y);
+    return;
+  }
+  for (int16_t j = 0; j < _h; j++) {
+    for (int16_t i = 0; i < _w; i++) {
+      uint16_t color = 0;
+      src->get_pixel_cb(src, x0 + i, y0 + j, &color);
+      handle->set_pixel_cb(handle, x1 + i, y1 + j, color);
+    }
+  }
+}
+
+/**
+ * @brief  Scroll the screen by (dx, dy) and fill the uncovered area
+ * @param  handle  Graphic context handle
+ * @param  color   Color of the uncovered area
+ */
+void gc_scroll(gc_handle_t *handle, int16_t dx, int16_t dy, uint16_t color) {
+  int16_t w = handle->width;
+  int16_t h = handle->height;
+  gc_copy_rect(handle, handle, 0, 0, w, h, dx, dy);
+  if (dx > 0) {
+    handle->fill_rect_cb(handle, 0, 0, dx, h, color);
+  } else if (dx < 0) {
+    handle->fill_rect_cb(handle, w + dx, 0, -dx, h, color);
+  }
+  if (dy > 0) {
+    handle->fill_rect_cb(handle, 0, 0, w, dy, color);
+  } else if (dy < 0) {
+    handle->fill_rect_cb(handle, 0, h + dy, w, -dy, color);
+  }
+}
+
 /**
  * @brief  Set screen rotation
  * @param  handle    Graphic context handle
@@ -92,6 +171,161 @@ void gc_set_rotation(gc_handle_t *handle, uint8_t rotation) {
  */
 uint8_t gc_get_rotation(gc_handle_t *handle) { return handle->rotation; }
 
+/**
+ * @brief  Clip a rectangle to the screen and map it to the device space, so
+ *         that primitives can fill device rows without per-pixel rotation.
+ * @param  handle  Graphic context handle
+ * @param  x, y, w, h  Rectangle in screen space, replaced with the device space
+ * @return false if nothing to draw
+ */
+bool gc_clip_to_device(gc_handle_t *handle, int16_t *x, int16_t *y, int16_t *w,
+                       int16_t *h) {
+  int32_t x0 = MAX(*x, 0);
+  int32_t y0 = MAX(*y, 0);
+  int32_t x1 = (int32_t)*x + *w;
+  int32_t y1 = (int32_t)*y + *h;
+  if (x1 > handle->width) x1 = handle->width;
+  if (y1 > handle->height) y1 = handle->height;
+  if (x0 >= x1 || y0 >= y1) {
+    return false;
+  }
+  switch (handle->rotation) {
+    case 1:
+      *x = handle->device_width - y1;
+      *y = x0;
+      *w = y1 - y0;
+      *h = x1 - x0;
+      break;
+    case 2:
+      *x = handle->device_width - x1;
+      *y = handle->device_height - y1;
+      *w = x1 - x0;
+      *h = y1 - y0;
+      break;
+    case 3:
+      *x = y0;
+      *y = handle->device_height - x1;
+      *w = y1 - y0;
+      *h = x1 - x0;
+      break;
+    default:
+      *x = x0;
+      *y = y0;
+      *w = x1 - x0;
+      *h = y1 - y0;
+      break;
+  }
+  return true;
+}
+
+/**
+ * @brief  Clip rows in device space to the band in the buffer
+ * @param  handle  Graphic context handle
+ * @param  y, h  Rows in device space, replaced with the rows in the buffer
+ * @return false if no rows in the band
+ */
+bool gc_clip_to_band(gc_handle_t *handle, int16_t *y, int16_t *h) {
+  int16_t y0 = MAX(*y, handle->band.y) - handle->band.y;
+  int16_t y1 = MIN(*y + *h, handle->band.y + handle->band.height) -
+               handle->band.y;
+  if (y0 >= y1) {
+    return false;
+  }
+  *y = y0;
+  *h = y1 - y0;
+  return true;
+}
+
+/**
+ * @brief  Save the drawing state (rotation, colors and font)
+ * @param  handle  Graphic context handle
+ */
+void gc_save_state(gc_handle_t *handle, gc_state_t *state) {
+  state->rotation = handle->rotation;
+  state->color = handle->color;
+  state->fill_color = handle->fill_color;
+  state->font = handle->font;
+  state->font_color = handle->font_color;
+  state->font_background = handle->font_background;
+  state->font_background_color = handle->font_background_color;
+  state->font_scale_x = handle->font_scale_x;
+  state->font_scale_y = handle->font_scale_y;
+}
+
+/**
+ * @brief  Restore the drawing state saved by gc_save_state()
+ * @param  handle  Graphic context handle
+ */
+void gc_restore_state(gc_handle_t *handle, gc_state_t *state) {
+  gc_set_rotation(handle, state->rotation);
+  handle->color = state->color;
+  handle->fill_color = state->fill_color;
+  handle->font = state->font;
+  handle->font_color = state->font_color;
+  handle->font_background = state->font_background;
+  handle->font_background_color = state->font_background_color;
+  handle->font_scale_x = state->font_scale_x;
+  handle->font_scale_y = state->font_scale_y;
+}
+
+/**
+ * @brief  Add a rectangle in device space to the dirty region
+ * @param  handle  Graphic context handle
+ */
+void gc_mark_dirty(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
+                   int16_t h) {
+  if (handle->dirty_x0 >= handle->dirty_x1) {
+    handle->dirty_x0 = x;
+    handle->dirty_y0 = y;
+    handle->dirty_x1 = x + w;
+    handle->dirty_y1 = y + h;
+    return;
+  }
+  if (x < handle->dirty_x0) handle->dirty_x0 = x;
+  if (y < handle->dirty_y0) handle->dirty_y0 = y;
+  if (x + w > handle->dirty_x1) handle->dirty_x1 = x + w;
+  if (y + h > handle->dirty_y1) handle->dirty_y1 = y + h;
+}
+
+/**
+ * @brief  Mark the whole device dirty
+ * @param  handle  Graphic context handle
+ */
+void gc_mark_dirty_all(gc_handle_t *handle) {
+  handle->dirty_x0 = 0;
+  handle->dirty_y0 = 0;
+  handle->dirty_x1 = handle->device_width;
+  handle->dirty_y1 = handle->device_height;
+}
+
+/**
+ * @brief  Reset the dirty region
+ * @param  handle  Graphic context handle
+ */
+void gc_clear_dirty(gc_handle_t *handle) {
+  handle->dirty_x0 = 0;
+  handle->dirty_y0 = 0;
+  handle->dirty_x1 = 0;
+  handle->dirty_y1 = 0;
+}
+
+/**
+ * @brief  Get the dirty region in device space
+ * @param  handle  Graphic context handle
+ * @return false if nothing is dirty
+ */
+bool gc_get_dirty(gc_handle_t *handle, int16_t *x, int16_t *y, int16_t *w,
+                  int16_t *h) {
+  if (handle->dirty_x0 >= handle->dirty_x1) {
+    return false;
+  }
+  *x = handle->dirty_x0;
+  *y = handle->dirty_y0;
+  *w = handle->dirty_x1 - handle->dirty_x0;
+  *h = handle->dirty_y1 - handle->dirty_y0;
+  return true;
+}
+
 /**
  * @brief Set stoke color
  * @param handle Graphic context handle
@@ -148,8 +382,11 @@ uint16_t gc_get_pixel(gc_handle_t *handle, int16_t x, int16_t y) {
   return color;
 }
 
+#define GC_LINE_RUN_MIN 4  // shorter runs are cheaper pixel by pixel
+
 /**
- * @brief Draw line (Bresenham's algorithm)
+ * @brief Draw line (Bresenham's algorithm). Pixels are drawn in runs of the
+ *   major axis (horizontal or vertical lines).
  * @param handle Graphic context handle
  * @param x0
  * @param y0
@@ -177,13 +414,22 @@ void gc_draw_line(gc_handle_t *handle, int16_t x0, int16_t y0, int16_t x1,
   } else {
     ystep = -1;
   }
+  int16_t run = x0;
   for (; x0 <= x1; x0++) {
-    if (steep) {
-      handle->set_pixel_cb(handle, y0, x0, handle->color);
-    } else {
-      handle->set_pixel_cb(handle, x0, y0, handle->color);
-    }
     err -= dy;
+    if (err < 0 || x0 == x1) {
+      if (x0 - run < GC_LINE_RUN_MIN) {
+        for (; run <= x0; run++) {
+          handle->set_pixel_cb(handle, steep ? y0 : run, steep ? run : y0,
+                               handle->color);
+        }
+      } else if (steep) {
+        handle->draw_vline_cb(handle, y0, run, x0 - run + 1, handle->color);
+      } else {
+        handle->draw_hline_cb(handle, run, y0, x0 - run + 1, handle->color);
+      }
+      run = x0 + 1;
+    }
     if (err < 0) {
       y0 += ystep;
       err += dx;
@@ -420,6 +666,379 @@ void gc_fill_circle(gc_handle_t *handle, int16_t x, int16_t y, int16_t r) {
 void gc_fill_ellipse(gc_handle_t *handle, int16_t x0, int16_t y0, int16_t x1,
                      int16_t y1) {}
 
+/* ************************************************************************** */
+/*                                  POLYGONS                                  */
+/* ************************************************************************** */
+
+/**
+ * Vertices are in 24.8 fixed point, x of edges in 16.16 fixed point. A pixel
+ * is filled if its center is inside (non-zero winding rule), so a polygon of
+ * the corners of a rect fills the same pixels as fillRect.
+ */
+#define GC_SUBPIXEL 256
+
+typedef struct {
+  int32_t x;   // x at the center of the current scanline
+  int32_t dx;  // x step per scanline
+  int16_t y0;  // first scanline
+  int16_t y1;  // scanline after the last
+  int8_t dir;  // +1 downward, -1 upward
+} gc_edge_t;
+
+typedef struct {
+  gc_edge_t *edges;
+  uint32_t count;
+  uint32_t size;
+} gc_edge_table_t;
+
+/**
+ * Add the edge from (xa, ya) to (xb, yb) in 24.8 fixed point
+ */
+static void gc_edge_add(gc_edge_table_t *et, int32_t xa, int32_t ya,
+                        int32_t xb, int32_t yb) {
+  int8_t dir = 1;
+  if (ya > yb) {
+    int32_t t = xa;
+    xa = xb;
+    xb = t;
+    t = ya;
+    ya = yb;
+    yb = t;
+    dir = -1;
+  }
+  // scanlines of which the center (y + 0.5) is in [ya, yb)
+  int32_t y0 = (ya - GC_SUBPIXEL / 2 + GC_SUBPIXEL - 1) >> 8;
+  int32_t y1 = (yb - GC_SUBPIXEL / 2 + GC_SUBPIXEL - 1) >> 8;
+  if (y0 >= y1 || y1 <= INT16_MIN || y0 >= INT16_MAX || et->count >= et->size) {
+    return;
+  }
+  gc_edge_t *edge = &et->edges[et->count++];
+  int64_t cy = (int64_t)y0 * GC_SUBPIXEL + GC_SUBPIXEL / 2 - ya;
+  int64_t dx = (int64_t)(xb - xa) * 65536 / (yb - ya);
+  edge->dx = (int32_t)MAX(MIN(dx, INT32_MAX), INT32_MIN);
+  edge->x = xa * 256 + (int32_t)((int64_t)(xb - xa) * cy * 256 / (yb - ya));
+  edge->y0 = (int16_t)MAX(y0, INT16_MIN);
+  edge->y1 = (int16_t)MIN(y1, INT16_MAX);
+  edge->dir = dir;
+}
+
+/**
+ * Add the edges of the closed polygon of n points (x, y in 24.8 fixed point)
+ */
+static void gc_edge_add_polygon(gc_edge_table_t *et, const int32_t *points,
+                                uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) {
+    uint16_t j = i + 1 < n ? i + 1 : 0;
+    gc_edge_add(et, points[i * 2], points[i * 2 + 1], points[j * 2],
+                points[j * 2 + 1]);
+  }
+}
+
+/**
+ * Fill the edge table with horizontal spans (scanline rasterization)
+ */
+static void gc_edge_fill(gc_handle_t *handle, gc_edge_table_t *et,
+                         uint16_t color) {
+  int16_t height = handle->height;
+  if (et->count == 0 || height <= 0) {
+    return;
+  }
+  // bucket the edges by the first scanline in the screen
+  uint32_t *bucket = (uint32_t *)calloc(height + 1, sizeof(uint32_t));
+  gc_edge_t **sorted = (gc_edge_t **)malloc(et->count * sizeof(gc_edge_t *));
+  gc_edge_t **active = (gc_edge_t **)malloc(et->count * sizeof(gc_edge_t *));
+  if (bucket == NULL || sorted == NULL || active == NULL) {
+    free(bucket);
+    free(sorted);
+    free(active);
+    return;
+  }
+  int16_t y_end = 0;
+  for (uint32_t i = 0; i < et->count; i++) {
+    gc_edge_t *edge = &et->edges[i];
+    if (edge->y1 > 0 && edge->y0 < height) {
+      bucket[MAX(edge->y0, 0) + 1]++;
+      y_end = MAX(y_end, MIN(edge->y1, height));
+    }
+  }
+  for (int16_t y = 0; y < height; y++) {
+    bucket[y + 1] += bucket[y];
+  }
+  for (uint32_t i = 0; i < et->count; i++) {
+    gc_edge_t *edge = &et->edges[i];
+    if (edge->y1 > 0 && edge->y0 < height) {
+      if (edge->y0 < 0) {  // clipped at the top
+        edge->x += (int32_t)((int64_t)edge->dx * -edge->y0);
+        edge->y0 = 0;
+      }
+      sorted[bucket[edge->y0]++] = edge;
+    }
+  }
+  // bucket[y] is now the end of the edges starting at y
+  uint32_t next = 0;
+  uint32_t n = 0;
+  for (int16_t y = 0; y < y_end; y++) {
+    // add the edges starting at the scanline, drop finished ones
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      if (active[i]->y1 > y) {
+        active[k++] = active[i];
+      }
+    }
+    n = k;
+    while (next < bucket[y]) {
+      active[n++] = sorted[next++];
+    }
+    // insertion sort by x (the order hardly changes between scanlines)
+    for (uint32_t i = 1; i < n; i++) {
+      gc_edge_t *edge = active[i];
+      uint32_t j = i;
+      while (j > 0 && active[j - 1]->x > edge->x) {
+        active[j] = active[j - 1];
+        j--;
+      }
+      active[j] = edge;
+    }
+    // spans of non-zero winding, pixels of which the center is in [xa, xb)
+    int32_t winding = 0;
+    int32_t xa = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      int32_t prev = winding;
+      winding += active[i]->dir;
+      if (prev == 0 && winding != 0) {
+        xa = MAX((active[i]->x + 0x7FFF) >> 16, 0);
+      } else if (prev != 0 && winding == 0) {
+        int32_t xb = MIN((active[i]->x + 0x7FFF) >> 16, handle->width);
+        if (xb > xa) {
+          handle->draw_hline_cb(handle, xa, y, xb - xa, color);
+        }
+      }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      active[i]->x += active[i]->dx;
+    }
+  }
+  free(bucket);
+  free(sorted);
+  free(active);
+}
+
+/**
+ * @brief Draw filled polygon (non-zero winding rule)
+ * @param handle Graphic context handle
+ * @param points x and y of n vertices
+ * @param n Number of vertices
+ */
+void gc_fill_polygon(gc_handle_t *handle, const int16_t *points, uint16_t n) {
+  if (n < 3) {
+    return;
+  }
+  gc_edge_table_t et = {.count = 0, .size = n};
+  int32_t *fixed = (int32_t *)malloc(n * 2 * sizeof(int32_t));
+  et.edges = (gc_edge_t *)malloc(n * sizeof(gc_edge_t));
+  if (fixed != NULL && et.edges != NULL) {
+    for (uint32_t i = 0; i < n * 2u; i++) {
+      fixed[i] = points[i] * GC_SUBPIXEL;
+    }
+    gc_edge_add_polygon(&et, fixed, n);
+    gc_edge_fill(handle, &et, handle->fill_color);
+  }
+  free(fixed);
+  free(et.edges);
+}
+
+/**
+ * @brief Draw filled triangle
+ * @param handle Graphic context handle
+ */
+void gc_fill_triangle(gc_handle_t *handle, int16_t x0, int16_t y0, int16_t x1,
+                      int16_t y1, int16_t x2, int16_t y2) {
+  int16_t points[] = {x0, y0, x1, y1, x2, y2};
+  gc_fill_polygon(handle, points, 3);
+}
+
+/**
+ * Add the convex polygon of 24.8 fixed point points to the edge table in the
+ * same direction as the others, so that overlapping parts don't cancel out.
+ */
+static void gc_edge_add_convex(gc_edge_table_t *et, int32_t *points,
+                               uint16_t n) {
+  int64_t area = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    uint16_t j = i + 1 < n ? i + 1 : 0;
+    area += (int64_t)points[i * 2] * points[j * 2 + 1] -
+            (int64_t)points[j * 2] * points[i * 2 + 1];
+  }
+  if (area < 0) {
+    for (uint16_t i = 0; i < n / 2; i++) {
+      uint16_t j = n - 1 - i;
+      int32_t x = points[i * 2];
+      int32_t y = points[i * 2 + 1];
+      points[i * 2] = points[j * 2];
+      points[i * 2 + 1] = points[j * 2 + 1];
+      points[j * 2] = x;
+      points[j * 2 + 1] = y;
+    }
+  }
+  gc_edge_add_polygon(et, points, n);
+}
+
+/**
+ * @brief Draw polyline. Lines thicker than 1 pixel are filled as a quad per
+ *   segment with round joins (bevel joins for slight turns), all in one pass
+ *   of spans.
+ * @param handle Graphic context handle
+ * @param points x and y of n vertices (pixel coordinates)
+ * @param n Number of vertices
+ * @param thickness Line thickness in pixels
+ */
+void gc_draw_polyline(gc_handle_t *handle, const int16_t *points, uint16_t n,
+                      uint16_t thickness) {
+  if (n < 2) {
+    return;
+  }
+  if (thickness <= 1) {
+    for (uint16_t i = 0; i + 1 < n; i++) {
+      gc_draw_line(handle, points[i * 2], points[i * 2 + 1], points[i * 2 + 2],
+                   points[i * 2 + 3]);
+    }
+    return;
+  }
+  // joins are polygons of k vertices within 1/4 pixel of the circle
+  float half = thickness / 2.0f;
+  uint16_t k = (uint16_t)MIN(
+      MAX(ceilf((float)M_PI / acosf(1.0f - 0.25f / half)), 8), 64);
+  int32_t join[64 * 2];
+  gc_edge_table_t et = {.count = 0, .size = (n - 1) * 4 + (n - 2) * k};
+  et.edges = (gc_edge_t *)malloc(et.size * sizeof(gc_edge_t));
+  if (et.edges == NULL) {
+    return;
+  }
+  float pdx = 0, pdy = 0;  // direction of the previous segment
+  for (uint16_t i = 0; i + 1 < n; i++) {
+    // centers of the pixels in 24.8 fixed point
+    int32_t ax = points[i * 2] * GC_SUBPIXEL + GC_SUBPIXEL / 2;
+    int32_t ay = points[i * 2 + 1] * GC_SUBPIXEL + GC_SUBPIXEL / 2;
+    int32_t bx = points[i * 2 + 2] * GC_SUBPIXEL + GC_SUBPIXEL / 2;
+    int32_t by = points[i * 2 + 3] * GC_SUBPIXEL + GC_SUBPIXEL / 2;
+    float dx = (float)(bx - ax);
+    float dy = (float)(by - ay);
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len == 0) {
+      continue;
+    }
+    dx /= len;
+    dy /= len;
+    // round join, or bevel join if the turn is too small to see the difference
+    if (pdx != 0 || pdy != 0) {
+      float cross = pdx * dy - pdy * dx;
+      if (pdx * dx + pdy * dy < 0 || fabsf(cross) * half > 0.5f) {
+        for (uint16_t j = 0; j < k; j++) {
+          float a = 2.0f * (float)M_PI * j / k;
+          join[j * 2] = ax + (int32_t)(cosf(a) * half * GC_SUBPIXEL);
+          join[j * 2 + 1] = ay + (int32_t)(sinf(a) * half * GC_SUBPIXEL);
+        }
+        gc_edge_add_polygon(&et, join, k);
+      } else if (cross != 0) {
+        int32_t nx0 = (int32_t)(-pdy * half * GC_SUBPIXEL);
+        int32_t ny0 = (int32_t)(pdx * half * GC_SUBPIXEL);
+        int32_t nx1 = (int32_t)(-dy * half * GC_SUBPIXEL);
+        int32_t ny1 = (int32_t)(dx * half * GC_SUBPIXEL);
+        int32_t bevel[] = {ax + nx0, ay + ny0, ax + nx1, ay + ny1,
+                           ax - nx0, ay - ny0, ax - nx1, ay - ny1};
+        gc_edge_add_convex(&et, bevel, 4);
+      }
+    }
+    pdx = dx;
+    pdy = dy;
+    int32_t nx = (int32_t)(-dy * half * GC_SUBPIXEL);
+    int32_t ny = (int32_t)(dx * half * GC_SUBPIXEL);
+    // extend the ends by half a pixel to cover the end pixels as drawLine
+    int32_t ex = (int32_t)(dx * GC_SUBPIXEL / 2);
+    int32_t ey = (int32_t)(dy * GC_SUBPIXEL / 2);
+    if (i == 0) {
+      ax -= ex;
+      ay -= ey;
+    }
+    if (i + 2 == n) {
+      bx += ex;
+      by += ey;
+    }
+    int32_t quad[] = {ax + nx, ay + ny, bx + nx, by + ny,
+                      bx - nx, by - ny, ax - nx, ay - ny};
+    gc_edge_add_convex(&et, quad, 4);
+  }
+  gc_edge_fill(handle, &et, handle->color);
+  free(et.edges);
+}
+
+/**
+ * @brief Draw arc. Angles are in degrees, clockwise from 3 o'clock.
+ * @param handle Graphic context handle
+ * @param x Center x
+ * @param y Center y
+ * @param r Radius (center of the stroke)
+ * @param start_angle
+ * @param end_angle
+ * @param thickness Line thickness in pixels
+ */
+void gc_draw_arc(gc_handle_t *handle, int16_t x, int16_t y, int16_t r,
+                 float start_angle, float end_angle, uint16_t thickness) {
+  if (r <= 0 || end_angle == start_angle) {
+    return;
+  }
+  if (end_angle < start_angle) {
+    float t = start_angle;
+    start_angle = end_angle;
+    end_angle = t;
+  }
+  float sweep = MIN(end_angle - start_angle, 360.0f) * (float)M_PI / 180.0f;
+  float start = start_angle * (float)M_PI / 180.0f;
+  // segments short enough to keep the chord within 1/4 pixel of the arc
+  uint16_t segments = (uint16_t)MIN(
+      MAX(ceilf(sweep / (2.0f * acosf(1.0f - 0.25f / (r + thickness)))), 1),
+      512);
+  if (thickness <= 1) {
+    int16_t px = x + (int16_t)lroundf(r * cosf(start));
+    int16_t py = y + (int16_t)lroundf(r * sinf(start));
+    for (uint16_t i = 1; i <= segments; i++) {
+      float a = start + sweep * i / segments;
+      int16_t qx = x + (int16_t)lroundf(r * cosf(a));
+      int16_t qy = y + (int16_t)lroundf(r * sinf(a));
+      gc_draw_line(handle, px, py, qx, qy);
+      px = qx;
+      py = qy;
+    }
+    return;
+  }
+  // ring sector: outer arc forward, inner arc backward
+  uint16_t n = (segments + 1) * 2;
+  int32_t *ring = (int32_t *)malloc(n * 2 * sizeof(int32_t));
+  gc_edge_table_t et = {.count = 0, .size = n};
+  et.edges = (gc_edge_t *)malloc(n * sizeof(gc_edge_t));
+  if (ring != NULL && et.edges != NULL) {
+    float cx = (x + 0.5f) * GC_SUBPIXEL;
+    float cy = (y + 0.5f) * GC_SUBPIXEL;
+    float outer = (r + thickness / 2.0f) * GC_SUBPIXEL;
+    float inner = MAX(r - thickness / 2.0f, 0) * GC_SUBPIXEL;
+    for (uint16_t i = 0; i <= segments; i++) {
+      float a = start + sweep * i / segments;
+      float c = cosf(a);
+      float s = sinf(a);
+      int32_t *po = ring + i * 2;
+      int32_t *pi = ring + (n - 1 - i) * 2;
+      po[0] = (int32_t)(cx + outer * c);
+      po[1] = (int32_t)(cy + outer * s);
+      pi[0] = (int32_t)(cx + inner * c);
+      pi[1] = (int32_t)(cy + inner * s);
+    }
+    gc_edge_add_polygon(&et, ring, n);
+    gc_edge_fill(handle, &et, handle->color);
+  }
+  free(ring);
+  free(et.edges);
+}
+
 /**
  * @brief
  */
@@ -442,6 +1061,16 @@ void gc_set_font_color(gc_handle_t *handle, uint16_t color) {
  */
 uint16_t gc_get_font_color(gc_handle_t *handle) { return handle->font_color; }
 
+/**
+ * @brief  Set the background color of text cells
+ * @param  enabled  false to draw text transparently
+ */
+void gc_set_font_background(gc_handle_t *handle, bool enabled,
+                            uint16_t color) {
+  handle->font_background = enabled;
+  handle->font_background_color = color;
+}
+
 /**
  * @brief
  */
@@ -450,153 +1079,514 @@ void gc_set_font_scale(gc_handle_t *handle, uint8_t scale_x, uint8_t scale_y) {
   handle->font_scale_y = scale_y;
 }
 
+/* ************************************************************************** */
+/*                                 GLYPH CACHE                                */
+/* ************************************************************************** */
+
+#define GC_GLYPH_CACHE_SETS 8  // power of 2
+#define GC_GLYPH_CACHE_WAYS 4
+#define GC_GLYPH_RUNS_MAX 255
+
+/**
+ * Rect of lit pixels in a glyph (unscaled)
+ */
+typedef struct {
+  uint8_t x;
+  uint8_t y;
+  uint8_t w;
+  uint8_t h;
+} gc_glyph_run_t;
+
+/**
+ * Glyph expanded to runs, keyed by the font (bitmap and geometry) and the
+ * char
+ */
+typedef struct {
+  const uint8_t *bitmap;
+  const gc_font_glyph_t *glyphs;
+  uint8_t first;
+  uint8_t last;
+  uint8_t width;
+  uint8_t height;
+  uint8_t ch;
+  uint8_t count;
+  uint32_t stamp;  // last use, for LRU
+  gc_glyph_run_t *runs;
+} gc_glyph_entry_t;
+
+static gc_glyph_entry_t glyph_cache[GC_GLYPH_CACHE_SETS][GC_GLYPH_CACHE_WAYS];
+static uint32_t glyph_stamp = 0;
+static uint32_t glyph_hits = 0;
+static uint32_t glyph_misses = 0;
+static gc_glyph_run_t glyph_runs[GC_GLYPH_RUNS_MAX];  // expanding, ~1KB
+
+/**
+ * Test if a cache entry was expanded from the font (NULL for the default
+ * font)
+ */
+static bool glyph_font_match(gc_glyph_entry_t *entry, gc_font_t *font) {
+  if (font == NULL) {
+    return entry->bitmap == font_default_bitmap;
+  }
+  return entry->bitmap == font->bitmap && entry->glyphs == font->glyphs &&
+         entry->first == font->first && entry->last == font->last &&
+         entry->width == font->width && entry->height == font->height;
+}
+
 /**
- * @brief
+ * Get the bits and the size of a glyph. Returns NULL if the char is not in
+ * the font (font is NULL for the default font).
  */
-void gc_draw_char(gc_handle_t *handle, int16_t x, int16_t y, const char ch) {
-  uint8_t sx = handle->font_scale_x;
-  uint8_t sy = handle->font_scale_y;
-  if (handle->font == NULL) { /* default font */
-    if ((x >= handle->width) || (y >= handle->height) ||
-        ((x + 6 * sx - 1) < 0) || ((y + 8 * sy - 1) < 0))
-      return;
-    for (int8_t i = 0; i < 5; i++) {
-      uint8_t line = font_default_bitmap[ch * 5 + i];
-      for (int8_t j = 0; j < 8; j++, line >>= 1) {
-        if (line & 1) {
-          if (sx == 1 && sy == 1)
-            handle->set_pixel_cb(handle, x + i, y + j, handle->font_color);
-          else
-            handle->fill_rect_cb(handle, x + i * sx, y + j * sy, sx, sy,
-                                 handle->font_color);
-        }
+static const uint8_t *glyph_bits(gc_font_t *font, uint8_t ch, uint8_t *w,
+                                 uint8_t *h) {
+  if (font == NULL) {
+    *w = 5;
+    *h = 8;
+    return font_default_bitmap + ch * 5;
+  }
+  if (ch < font->first || ch > font->last) {
+    return NULL;
+  }
+  *w = font->width;
+  *h = font->height;
+  return font->bitmap + (ch - font->first) * (((*w + 7) / 8) * (*h));
+}
+
+/**
+ * Test a pixel of a glyph. The default font is in columns of 8 pixels (LSB
+ * at top) and custom fonts are in rows padded to bytes (MSB at left).
+ */
+static bool glyph_bit(gc_font_t *font, const uint8_t *bits, uint8_t w,
+                      uint8_t xx, uint8_t yy) {
+  if (font == NULL) {
+    return (bits[xx] >> yy) & 1;
+  }
+  return bits[yy * ((w + 7) / 8) + (xx / 8)] & (0x80 >> (xx & 7));
+}
+
+/**
+ * Expand a glyph to the runs of lit pixels in rows, merging a run into a run
+ * ending at the row above if it has the same x and width. Returns the number
+ * of runs, or max + 1 if it doesn't fit.
+ */
+static uint16_t glyph_expand(gc_font_t *font, const uint8_t *bits, uint8_t w,
+                             uint8_t h, gc_glyph_run_t *runs, uint16_t max) {
+  uint16_t count = 0;
+  for (uint8_t yy = 0; yy < h; yy++) {
+    uint16_t row = count;
+    uint8_t xx = 0;
+    while (xx < w) {
+      if (!glyph_bit(font, bits, w, xx, yy)) {
+        xx++;
+        continue;
       }
-    }
-  } else { /* custom font */
-    uint8_t w = handle->font->width;
-    uint8_t h = handle->font->height;
-    uint16_t sz = (((w + 7) / 8) * h);
-    uint16_t idx = ((uint8_t)ch) - handle->font->first;
-    uint16_t offset = idx * sz;
-    if ((x >= handle->width) || (y >= handle->height) ||
-        ((x + w * sx - 1) < 0) || ((y + h * sy - 1) < 0))
-      return;
-    uint8_t bit = 0;
-    uint8_t bits = handle->font->bitmap[offset];
-    for (uint8_t yy = 0; yy < h; yy++) {
-      for (uint8_t xx = 0; xx < w; xx++) {
-        if (bit > 7) {
-          bit = 0;
-          offset++;
-          bits = handle->font->bitmap[offset];
+      uint8_t x0 = xx;
+      while (xx < w && glyph_bit(font, bits, w, xx, yy)) xx++;
+      bool merged = false;
+      for (uint16_t i = 0; i < row; i++) {
+        if (runs[i].x == x0 && runs[i].w == xx - x0 &&
+            runs[i].y + runs[i].h == yy) {
+          runs[i].h++;
+          merged = true;
+          break;
         }
-        if (bits & 0x80) {
-          if (sx == 1 && sy == 1) {
-            handle->set_pixel_cb(handle, x + xx, y + yy, handle->font_color);
-          } else {
-            handle->fill_rect_cb(handle, x + xx * sx, y + yy * sy, sx, sy,
-                                 handle->font_color);
-          }
+      }
+      if (!merged) {
+        if (count == max) {
+          return max + 1;
         }
-        bits <<= 1;
-        bit++;
+        runs[count].x = x0;
+        runs[count].y = yy;
+        runs[count].w = xx - x0;
+        runs[count].h = 1;
+        count++;
       }
-      offset++;
-      bit = 0;
-      bits = handle->font->bitmap[offset];
     }
   }
+  return count;
 }
 
 /**
- * @brief
+ * Find the runs of a glyph in the cache, or expand and cache them in place
+ * of the least recently used entry of the set of the char. Returns NULL if
+ * the glyph has too many runs to cache.
  */
-void gc_draw_text(gc_handle_t *handle, int16_t x, int16_t y, const char *text) {
-  int16_t cursor_x = x;
-  int16_t cursor_y = y;
-  for (uint16_t i = 0; i < strlen(text); i++) {
-    char ch = text[i];
-    if (handle->font == NULL) { /* default font */
-      if (ch == '\n') {
-        cursor_x = x;
-        cursor_y += 8 * handle->font_scale_y;
-      } else if (ch != '\r') {
-        gc_draw_char(handle, cursor_x, cursor_y, ch);
-        cursor_x += 6 * handle->font_scale_x;
+static gc_glyph_entry_t *glyph_lookup(gc_font_t *font, uint8_t ch,
+                                      const uint8_t *bits, uint8_t w,
+                                      uint8_t h) {
+  gc_glyph_entry_t *set = glyph_cache[ch & (GC_GLYPH_CACHE_SETS - 1)];
+  gc_glyph_entry_t *lru = &set[0];
+  glyph_stamp++;
+  for (int i = 0; i < GC_GLYPH_CACHE_WAYS; i++) {
+    gc_glyph_entry_t *entry = &set[i];
+    if (entry->ch == ch && entry->bitmap != NULL &&
+        glyph_font_match(entry, font)) {
+      entry->stamp = glyph_stamp;
+      glyph_hits++;
+      return entry;
+    }
+    if (entry->stamp < lru->stamp) {
+      lru = entry;
+    }
+  }
+  glyph_misses++;
+  uint16_t count =
+      glyph_expand(font, bits, w, h, glyph_runs, GC_GLYPH_RUNS_MAX);
+  if (count > GC_GLYPH_RUNS_MAX) {
+    return NULL;
+  }
+  gc_glyph_run_t *copy = (gc_glyph_run_t *)malloc(
+      (count > 0 ? count : 1) * sizeof(gc_glyph_run_t));
+  if (copy == NULL) {
+    return NULL;
+  }
+  memcpy(copy, glyph_runs, count * sizeof(gc_glyph_run_t));
+  free(lru->runs);
+  if (font == NULL) {
+    lru->bitmap = font_default_bitmap;
+    lru->glyphs = NULL;
+    lru->first = 0;
+    lru->last = 0;
+    lru->width = 0;
+    lru->height = 0;
+  } else {
+    lru->bitmap = font->bitmap;
+    lru->glyphs = font->glyphs;
+    lru->first = font->first;
+    lru->last = font->last;
+    lru->width = font->width;
+    lru->height = font->height;
+  }
+  lru->ch = ch;
+  lru->count = count;
+  lru->stamp = glyph_stamp;
+  lru->runs = copy;
+  return lru;
+}
+
+/**
+ * @brief  Drop the cached glyphs of the font bitmap expanded with another
+ *         geometry, e.g. when a new font reuses the memory of a freed one.
+ *         Glyphs of the font itself are kept.
+ * @param  font  Font
+ */
+void gc_glyph_cache_invalidate(gc_font_t *font) {
+  for (int i = 0; i < GC_GLYPH_CACHE_SETS; i++) {
+    for (int j = 0; j < GC_GLYPH_CACHE_WAYS; j++) {
+      gc_glyph_entry_t *entry = &glyph_cache[i][j];
+      if (entry->bitmap == font->bitmap && !glyph_font_match(entry, font)) {
+        entry->bitmap = NULL;
+        entry->stamp = 0;
       }
-    } else { /* custom font */
-      if (ch == '\n') {
-        cursor_x = x;
-        cursor_y += handle->font->advance_y * handle->font_scale_y;
-      } else if (ch != '\r') {
-        gc_draw_char(handle, cursor_x, cursor_y, ch);
-        if (handle->font->glyphs != NULL) {
-          uint16_t idx = ((uint8_t)ch) - handle->font->first;
-          gc_font_glyph_t glyph = handle->font->glyphs[idx];
-          cursor_x += glyph.advance_x * handle->font_scale_x;
+    }
+  }
+}
+
+/**
+ * @brief  Get the glyph cache counters
+ * @param  hits  Returned number of glyphs drawn from the cache
+ * @param  misses  Returned number of glyphs expanded
+ */
+void gc_glyph_cache_stats(uint32_t *hits, uint32_t *misses) {
+  *hits = glyph_hits;
+  *misses = glyph_misses;
+}
+
+/**
+ * @brief  Draw a char with the font color
+ */
+void gc_draw_char(gc_handle_t *handle, int16_t x, int16_t y, const char ch) {
+  uint8_t sx = handle->font_scale_x;
+  uint8_t sy = handle->font_scale_y;
+  uint8_t w, h;
+  const uint8_t *bits = glyph_bits(handle->font, (uint8_t)ch, &w, &h);
+  if ((bits == NULL) || (x >= handle->width) || (y >= handle->height) ||
+      ((x + w * sx - 1) < 0) || ((y + h * sy - 1) < 0))
+    return;
+  uint16_t color = handle->font_color;
+  gc_glyph_entry_t *entry = glyph_lookup(handle->font, (uint8_t)ch, bits, w, h);
+  if (entry != NULL) {
+    bool unscaled = (sx == 1 && sy == 1);
+    for (uint8_t i = 0; i < entry->count; i++) {
+      gc_glyph_run_t *run = &entry->runs[i];
+      if (unscaled && run->w == 1 && run->h == 1) {
+        handle->set_pixel_cb(handle, x + run->x, y + run->y, color);
+      } else {
+        handle->fill_rect_cb(handle, x + run->x * sx, y + run->y * sy,
+                             run->w * sx, run->h * sy, color);
+      }
+    }
+  } else {  // too large to cache, draw the runs in rows
+    for (uint8_t yy = 0; yy < h; yy++) {
+      uint8_t xx = 0;
+      while (xx < w) {
+        if (glyph_bit(handle->font, bits, w, xx, yy)) {
+          uint8_t x0 = xx;
+          while (xx < w && glyph_bit(handle->font, bits, w, xx, yy)) xx++;
+          handle->fill_rect_cb(handle, x + x0 * sx, y + yy * sy,
+                               (xx - x0) * sx, sy, color);
         } else {
-          cursor_x += handle->font->advance_x * handle->font_scale_x;
+          xx++;
         }
       }
     }
   }
 }
 
-void gc_measure_text(gc_handle_t *handle, const char *text, uint16_t *w,
-                     uint16_t *h) {
+/**
+ * Lay out the text in a single pass, drawing each char (and the background
+ * of its cell) if draw is true. Returns the unscaled size of the text.
+ */
+static void gc_text(gc_handle_t *handle, int16_t x, int16_t y,
+                    const char *text, bool draw, uint16_t *w, uint16_t *h) {
+  gc_font_t *font = handle->font;
+  uint8_t sx = handle->font_scale_x;
+  uint8_t sy = handle->font_scale_y;
+  uint8_t advance_y = font == NULL ? 8 : font->advance_y;
   uint16_t _w = 0;
   uint16_t _h = 0;
   uint16_t cursor_x = 0;
   uint16_t cursor_y = 0;
-  for (uint16_t i = 0; i < strlen(text); i++) {
-    char ch = text[i];
-    if (handle->font == NULL) { /* default font */
-      if (ch == '\n') {
-        cursor_x = 0;
-        cursor_y += 8;
-      } else {
-        _w = MAX(_w, cursor_x + 6);
-        _h = MAX(_h, cursor_y + 8);
-        cursor_x += 6;
-      }
-    } else { /* custom font */
-      if (ch == '\n') {
-        cursor_x = 0;
-        cursor_y += handle->font->advance_y;
-      } else {
-        if (handle->font->glyphs != NULL) {
-          uint16_t idx = ((uint8_t)ch) - handle->font->first;
-          gc_font_glyph_t glyph = handle->font->glyphs[idx];
-          _w = MAX(_w, cursor_x + glyph.width);
-          _h = MAX(_h, cursor_y + glyph.height);
-          cursor_x += glyph.advance_x;
-        } else {
-          _w = MAX(_w, cursor_x + handle->font->width);
-          _h = MAX(_h, cursor_y + handle->font->height);
-          cursor_x += handle->font->advance_x;
-        }
+  for (const char *p = text; *p != '\0'; p++) {
+    uint8_t ch = (uint8_t)*p;
+    if (ch == '\n') {
+      cursor_x = 0;
+      cursor_y += advance_y;
+      continue;
+    } else if (ch == '\r') {
+      continue;
+    }
+    uint8_t advance_x, glyph_w, glyph_h;
+    if (font == NULL) {
+      advance_x = 6;
+      glyph_w = 6;
+      glyph_h = 8;
+    } else if (font->glyphs != NULL && ch >= font->first && ch <= font->last) {
+      gc_font_glyph_t *glyph = &font->glyphs[ch - font->first];
+      advance_x = glyph->advance_x;
+      glyph_w = glyph->width;
+      glyph_h = glyph->height;
+    } else {
+      advance_x = font->advance_x;
+      glyph_w = font->width;
+      glyph_h = font->height;
+    }
+    if (draw) {
+      int16_t px = x + cursor_x * sx;
+      int16_t py = y + cursor_y * sy;
+      if (handle->font_background) {
+        handle->fill_rect_cb(handle, px, py, advance_x * sx, advance_y * sy,
+                             handle->font_background_color);
       }
+      gc_draw_char(handle, px, py, ch);
     }
+    _w = MAX(_w, cursor_x + glyph_w);
+    _h = MAX(_h, cursor_y + glyph_h);
+    cursor_x += advance_x;
   }
+  *w = _w;
+  *h = _h;
+}
+
+/**
+ * @brief  Draw text with the font color (and the font background color)
+ */
+void gc_draw_text(gc_handle_t *handle, int16_t x, int16_t y, const char *text) {
+  uint16_t w, h;
+  gc_text(handle, x, y, text, true, &w, &h);
+}
+
+/**
+ * @brief  Measure the size of text in pixels
+ */
+void gc_measure_text(gc_handle_t *handle, const char *text, uint16_t *w,
+                     uint16_t *h) {
+  uint16_t _w, _h;
+  gc_text(handle, 0, 0, text, false, &_w, &_h);
   *w = _w * handle->font_scale_x;
   *h = _h * handle->font_scale_y;
 }
 
-static void gc_draw_bitmap_helper(gc_handle_t *handle, int16_t x, int16_t y,
-                                  int16_t w, int16_t h, int16_t xx, int16_t yy,
-                                  int8_t scale_x, int8_t scale_y, bool flip_x,
-                                  bool flip_y, uint16_t color) {
-  if (scale_x == 1 && scale_y == 1) {
-    int16_t px = x + (flip_x ? w - xx : xx);
-    int16_t py = y + (flip_y ? h - yy : yy);
-    handle->set_pixel_cb(handle, px, py, color);
-  } else {
-    int16_t px = x + (flip_x ? (w - xx) * scale_x : xx * scale_x);
-    int16_t py = y + (flip_y ? (h - yy) * scale_y : yy * scale_y);
-    handle->fill_rect_cb(handle, px, py, scale_x, scale_y, color);
+/**
+ * Color of a bitmap pixel. Returns false if the pixel is not drawn (unset
+ * bit of 1-bit bitmap or the transparent color).
+ */
+static inline bool gc_bitmap_pixel(const gc_bitmap_t *bitmap, int16_t xx,
+                                   int16_t yy, uint16_t *pixel) {
+  if (bitmap->bpp == 1) {
+    *pixel = bitmap->color;
+    return bitmap->data[yy * ((bitmap->width + 7) / 8) + (xx / 8)] &
+           (0x80 >> (xx & 7));
+  }
+  uint32_t idx = ((yy * bitmap->width) + xx) * 2;
+  *pixel = bitmap->data[idx] << 8 | bitmap->data[idx + 1];
+  return !bitmap->transparent || *pixel != bitmap->transparent_color;
+}
+
+/**
+ * Draw the w x h rect at (ox, oy) of a bitmap as horizontal runs of the
+ * same color through fill_rect_cb, for scaled bitmaps and the targets
+ * without a direct blitter.
+ */
+static void gc_draw_bitmap_runs(gc_handle_t *handle, int16_t x, int16_t y,
+                                const gc_bitmap_t *bitmap, int16_t ox,
+                                int16_t oy, int16_t w, int16_t h,
+                                uint8_t scale_x, uint8_t scale_y, bool flip_x,
+                                bool flip_y) {
+  for (int16_t yy = 0; yy < h; yy++) {
+    int16_t py = y + (flip_y ? h - 1 - yy : yy) * scale_y;
+    int16_t xx = 0;
+    while (xx < w) {
+      uint16_t pixel;
+      if (!gc_bitmap_pixel(bitmap, ox + xx, oy + yy, &pixel)) {
+        xx++;
+        continue;
+      }
+      int16_t x0 = xx;
+      uint16_t next;
+      xx++;
+      while (xx < w && gc_bitmap_pixel(bitmap, ox + xx, oy + yy, &next) &&
+             next == pixel) {
+        xx++;
+      }
+      int16_t px = x + (flip_x ? w - xx : x0) * scale_x;
+      handle->fill_rect_cb(handle, px, py, (xx - x0) * scale_x, scale_y,
+                           pixel);
+    }
   }
 }
 
+/**
+ * Draw the w x h rect at (ox, oy) of a bitmap unscaled, directly into a
+ * 16-bit or 1-bit buffer. The visible rect is clipped once, then each row
+ * is copied with the device pointer stepping along the rotated screen row.
+ * Returns false if the handle has no such buffer.
+ */
+static bool gc_draw_bitmap_direct(gc_handle_t *handle, int16_t x, int16_t y,
+                                  const gc_bitmap_t *bitmap, int16_t ox,
+                                  int16_t oy, int16_t w, int16_t h,
+                                  bool flip_x, bool flip_y) {
+  if (handle->copy_rect_cb == NULL ||
+      (handle->bpp != 16 && handle->bpp != 1)) {
+    return false;
+  }
+  // clip to the screen (x0, y0, x1, y1 in screen space, exclusive)
+  int16_t dw = handle->device_width;
+  int16_t dh = handle->device_height;
+  int32_t x0 = MAX(x, 0);
+  int32_t y0 = MAX(y, 0);
+  int32_t x1 = MIN((int32_t)x + w, handle->width);
+  int32_t y1 = MIN((int32_t)y + h, handle->height);
+  if (x0 >= x1 || y0 >= y1) {
+    return true;
+  }
+  int16_t mx = x0, my = y0, mw = x1 - x0, mh = y1 - y0;
+  gc_clip_to_device(handle, &mx, &my, &mw, &mh);
+  gc_mark_dirty(handle, mx, my, mw, mh);
+  // clip to the rows of the band, and get the device position of the
+  // screen origin and the steps of a screen pixel in x and y
+  int32_t b0 = handle->band.y;
+  int32_t b1 = handle->band.y + handle->band.height;
+  int32_t dx0, dy0, sxx, sxy, syx, syy;
+  switch (handle->rotation) {
+    case 1:  // (dw - 1 - y, x)
+      x0 = MAX(x0, b0);
+      x1 = MIN(x1, b1);
+      dx0 = dw - 1, dy0 = 0, sxx = 0, sxy = 1, syx = -1, syy = 0;
+      break;
+    case 2:  // (dw - 1 - x, dh - 1 - y)
+      y0 = MAX(y0, dh - b1);
+      y1 = MIN(y1, dh - b0);
+      dx0 = dw - 1, dy0 = dh - 1, sxx = -1, sxy = 0, syx = 0, syy = -1;
+      break;
+    case 3:  // (y, dh - 1 - x)
+      x0 = MAX(x0, dh - b1);
+      x1 = MIN(x1, dh - b0);
+      dx0 = 0, dy0 = dh - 1, sxx = 0, sxy = -1, syx = 1, syy = 0;
+      break;
+    default:
+      y0 = MAX(y0, b0);
+      y1 = MIN(y1, b1);
+      dx0 = 0, dy0 = 0, sxx = 1, sxy = 0, syx = 0, syy = 1;
+      break;
+  }
+  dy0 -= b0;
+  int16_t n = x1 - x0;
+  if (n <= 0) {
+    return true;
+  }
+  int16_t sstep = flip_x ? -1 : 1;
+  int16_t row_bytes = (bitmap->width + 7) / 8;
+  bool transparent = bitmap->transparent;
+  uint16_t transparent_color = bitmap->transparent_color;
+  uint8_t hi = bitmap->color >> 8;
+  uint8_t lo = bitmap->color & 0xFF;
+  for (int32_t py = y0; py < y1; py++) {
+    int16_t yy = oy + (flip_y ? (y + h - 1 - py) : (py - y));
+    int16_t xx = ox + (flip_x ? (x + w - 1 - x0) : (x0 - x));
+    int32_t dx = dx0 + sxx * x0 + syx * py;
+    int32_t dy = dy0 + sxy * x0 + syy * py;
+    if (handle->bpp == 16) {
+      int32_t step = (sxx + sxy * dw) * 2;
+      uint8_t *p = handle->buffer + (dy * dw + dx) * 2;
+      if (bitmap->bpp == 16) {
+        const uint8_t *s = bitmap->data + ((yy * bitmap->width) + xx) * 2;
+        if (step == 2 && sstep == 1) {
+          if (!transparent) {
+            memcpy(p, s, n * 2);  // same byte order (big-endian)
+            continue;
+          }
+          // copy the runs between the pixels of the transparent color
+          int16_t i = 0;
+          while (i < n) {
+            while (i < n && (s[i * 2] << 8 | s[i * 2 + 1]) == transparent_color)
+              i++;
+            int16_t i0 = i;
+            while (i < n && (s[i * 2] << 8 | s[i * 2 + 1]) != transparent_color)
+              i++;
+            memcpy(p + i0 * 2, s + i0 * 2, (i - i0) * 2);
+          }
+          continue;
+        }
+        for (int16_t i = 0; i < n; i++, p += step, s += sstep * 2) {
+          if (!transparent || (s[0] << 8 | s[1]) != transparent_color) {
+            p[0] = s[0];
+            p[1] = s[1];
+          }
+        }
+      } else {
+        const uint8_t *s = bitmap->data + yy * row_bytes;
+        for (int16_t i = 0; i < n; i++, p += step, xx += sstep) {
+          if (s[xx / 8] & (0x80 >> (xx & 7))) {
+            p[0] = hi;
+            p[1] = lo;
+          }
+        }
+      }
+    } else {
+      // a byte of the buffer holds 8 vertical pixels (a page)
+      for (int16_t i = 0; i < n; i++, dx += sxx, dy += sxy, xx += sstep) {
+        uint16_t pixel;
+        if (!gc_bitmap_pixel(bitmap, xx, yy, &pixel)) {
+          continue;
+        }
+        uint8_t *p = handle->buffer + (dy / 8) * dw + dx;
+        if (pixel) {
+          *p |= 1 << (dy & 7);
+        } else {
+          *p &= ~(1 << (dy & 7));
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief  Draw a bitmap (1-bit or 16-bit). Unscaled bitmaps are copied
+ *         directly into 16-bit and 1-bit buffers, others are drawn in runs
+ *         of the same color.
+ */
 void gc_draw_bitmap(gc_handle_t *handle, int16_t x, int16_t y, uint8_t *bitmap,
                     int16_t w, int16_t h, uint8_t bpp, uint16_t color,
                     bool transparent, uint16_t transparent_color,
@@ -605,43 +1595,165 @@ void gc_draw_bitmap(gc_handle_t *handle, int16_t x, int16_t y, uint8_t *bitmap,
   if ((x >= handle->width) || (y >= handle->height) ||
       ((x + (w * scale_x) - 1) < 0) || ((y + (h * scale_y) - 1) < 0))
     return;
-  if (bpp == 1) {
-    uint16_t offset = 0;
-    uint8_t bit = 0;
-    uint8_t bits = bitmap[offset];
-    for (int16_t yy = 0; yy < h; yy++) {
-      for (int16_t xx = 0; xx < w; xx++) {
-        if (bit > 7) {
-          bit = 0;
-          offset++;
-          bits = bitmap[offset];
-        }
-        if (bits & 0x80) {
-          gc_draw_bitmap_helper(handle, x, y, w, h, xx, yy, scale_x, scale_y,
-                                flip_x, flip_y, color);
-        }
-        bits <<= 1;
-        bit++;
-      }
-      offset++;
-      bit = 0;
-      bits = bitmap[offset];
-    }
-  } else if (bpp == 16) {
-    for (int16_t yy = 0; yy < h; yy++) {
-      for (int16_t xx = 0; xx < w; xx++) {
-        uint32_t idx = ((yy * w) + xx) * 2;
-        color = bitmap[idx] << 8 | bitmap[idx + 1];
-        if (transparent) {
-          if (color != transparent_color) {
-            gc_draw_bitmap_helper(handle, x, y, w, h, xx, yy, scale_x, scale_y,
-                                  flip_x, flip_y, color);
-          }
-        } else {
-          gc_draw_bitmap_helper(handle, x, y, w, h, xx, yy, scale_x, scale_y,
-                                flip_x, flip_y, color);
-        }
+  if (bpp != 1 && bpp != 16) {
+    return;
+  }
+  gc_bitmap_t bm = {bitmap, w, h, bpp, color, transparent, transparent_color};
+  if (scale_x == 1 && scale_y == 1 &&
+      gc_draw_bitmap_direct(handle, x, y, &bm, 0, 0, w, h, flip_x, flip_y)) {
+    return;
+  }
+  gc_draw_bitmap_runs(handle, x, y, &bm, 0, 0, w, h, scale_x, scale_y, flip_x,
+                      flip_y);
+}
+
+/* ************************************************************************** */
+/*                                   LAYERS                                   */
+/* ************************************************************************** */
+
+static int32_t floor_div(int32_t a, int32_t b) {
+  return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+/**
+ * Get the clip rect (x0, y0, x1, y1 exclusive) of a viewport on the screen.
+ * Returns false if it is empty.
+ */
+static bool gc_viewport_clip(gc_handle_t *handle, gc_viewport_t *view,
+                             int32_t *x0, int32_t *y0, int32_t *x1,
+                             int32_t *y1) {
+  *x0 = 0;
+  *y0 = 0;
+  *x1 = handle->width;
+  *y1 = handle->height;
+  if (view->width > 0 && view->height > 0) {
+    *x0 = MAX(*x0, view->x);
+    *y0 = MAX(*y0, view->y);
+    *x1 = MIN(*x1, (int32_t)view->x + view->width);
+    *y1 = MIN(*y1, (int32_t)view->y + view->height);
+  }
+  return *x0 < *x1 && *y0 < *y1;
+}
+
+/**
+ * Draw a cell of a sheet (tileset or sprite sheet) at (x, y), clipped to
+ * (x0, y0, x1, y1). Only the visible part of the cell is drawn.
+ */
+static void gc_draw_cell(gc_handle_t *handle, const gc_bitmap_t *sheet,
+                         int16_t cw, int16_t ch, uint16_t index, int32_t x,
+                         int32_t y, bool flip_x, bool flip_y, int32_t x0,
+                         int32_t y0, int32_t x1, int32_t y1) {
+  int16_t per_row = sheet->width / cw;
+  if (per_row == 0 || index >= (uint32_t)per_row * (sheet->height / ch)) {
+    return;
+  }
+  int32_t cx0 = MAX(x, x0);
+  int32_t cy0 = MAX(y, y0);
+  int32_t cx1 = MIN(x + cw, x1);
+  int32_t cy1 = MIN(y + ch, y1);
+  if (cx0 >= cx1 || cy0 >= cy1) {
+    return;
+  }
+  // the visible part in the sheet
+  int16_t ox = (index % per_row) * cw +
+               (flip_x ? (x + cw - cx1) : (cx0 - x));
+  int16_t oy = (index / per_row) * ch +
+               (flip_y ? (y + ch - cy1) : (cy0 - y));
+  int16_t w = cx1 - cx0;
+  int16_t h = cy1 - cy0;
+  if (!gc_draw_bitmap_direct(handle, cx0, cy0, sheet, ox, oy, w, h, flip_x,
+                             flip_y)) {
+    gc_draw_bitmap_runs(handle, cx0, cy0, sheet, ox, oy, w, h, 1, 1, flip_x,
+                        flip_y);
+  }
+}
+
+/**
+ * @brief  Draw the visible tiles of a tile map in its viewport
+ * @param  handle  Graphic context handle
+ * @param  map     Tile map
+ */
+void gc_draw_tilemap(gc_handle_t *handle, gc_tilemap_t *map) {
+  int16_t tw = map->tile_width;
+  int16_t th = map->tile_height;
+  int32_t x0, y0, x1, y1;
+  if (tw <= 0 || th <= 0 || map->columns <= 0 || map->rows <= 0 ||
+      !gc_viewport_clip(handle, &map->view, &x0, &y0, &x1, &y1)) {
+    return;
+  }
+  // screen position of the map origin
+  int32_t ox = (map->view.width > 0 ? map->view.x : 0) - map->view.scroll_x;
+  int32_t oy = (map->view.height > 0 ? map->view.y : 0) - map->view.scroll_y;
+  int32_t c0 = floor_div(x0 - ox, tw);
+  int32_t c1 = floor_div(x1 - 1 - ox, tw);
+  int32_t r0 = floor_div(y0 - oy, th);
+  int32_t r1 = floor_div(y1 - 1 - oy, th);
+  for (int32_t r = r0; r <= r1; r++) {
+    int32_t row = r;
+    if (map->wrap) {
+      row = ((r % map->rows) + map->rows) % map->rows;
+    } else if (row < 0 || row >= map->rows) {
+      continue;
+    }
+    for (int32_t c = c0; c <= c1; c++) {
+      int32_t col = c;
+      if (map->wrap) {
+        col = ((c % map->columns) + map->columns) % map->columns;
+      } else if (col < 0 || col >= map->columns) {
+        continue;
       }
+      uint32_t i = row * map->columns + col;
+      uint16_t index = map->tile_bytes == 2 ? ((uint16_t *)map->tiles)[i]
+                                            : ((uint8_t *)map->tiles)[i];
+      gc_draw_cell(handle, &map->tileset, tw, th, index, ox + c * tw,
+                   oy + r * th, false, false, x0, y0, x1, y1);
+    }
+  }
+}
+
+/**
+ * @brief  Draw the visible sprites of a sprite layer in its viewport, in
+ *         the order of z (the order in the layer for the same z)
+ * @param  handle  Graphic context handle
+ * @param  layer   Sprite layer
+ */
+void gc_draw_sprite_layer(gc_handle_t *handle, gc_sprite_layer_t *layer) {
+  int16_t fw = layer->frame_width;
+  int16_t fh = layer->frame_height;
+  int32_t x0, y0, x1, y1;
+  if (fw <= 0 || fh <= 0 || layer->count == 0 ||
+      !gc_viewport_clip(handle, &layer->view, &x0, &y0, &x1, &y1)) {
+    return;
+  }
+  uint16_t *order = (uint16_t *)malloc(layer->count * sizeof(uint16_t));
+  if (order == NULL) {
+    return;
+  }
+  // insertion sort of the visible sprites by z (stable)
+  uint16_t n = 0;
+  for (uint16_t i = 0; i < layer->count; i++) {
+    int16_t *sprite = layer->sprites + i * GC_SPRITE_FIELDS;
+    if (!(sprite[3] & GC_SPRITE_VISIBLE)) {
+      continue;
     }
+    uint16_t j = n++;
+    while (j > 0 && layer->sprites[order[j - 1] * GC_SPRITE_FIELDS + 4] >
+                        sprite[4]) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+  int32_t ox = (layer->view.width > 0 ? layer->view.x : 0) -
+               layer->view.scroll_x;
+  int32_t oy = (layer->view.height > 0 ? layer->view.y : 0) -
+               layer->view.scroll_y;
+  for (uint16_t k = 0; k < n; k++) {
+    int16_t *sprite = layer->sprites + order[k] * GC_SPRITE_FIELDS;
+    gc_draw_cell(handle, &layer->sheet, fw, fh, (uint16_t)sprite[2],
+                 ox + sprite[0], oy + sprite[1],
+                 sprite[3] & GC_SPRITE_FLIP_X, sprite[3] & GC_SPRITE_FLIP_Y,
+                 x0, y0, x1, y1);
   }
+  free(order);
 }
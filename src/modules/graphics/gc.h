@@ -41,6 +41,10 @@
 #define MAX(X, Y) ((X) > (Y) ? (X) : (Y))
 #endif
 
+#ifndef MIN
+#define MIN(X, Y) ((X) < (Y) ? (X) : (Y))
+#endif
+
 typedef struct gc_handle_s gc_handle_t;
 
 typedef void (*gc_set_pixel_cb)(gc_handle_t *, int16_t, int16_t, uint16_t);
@@ -52,6 +56,98 @@ typedef void (*gc_draw_vline_cb)(gc_handle_t *, int16_t, int16_t, int16_t,
 typedef void (*gc_fill_rect_cb)(gc_handle_t *, int16_t, int16_t, int16_t,
                                 int16_t, uint16_t);
 typedef void (*gc_fill_screen_cb)(gc_handle_t *, uint16_t);
+typedef void (*gc_copy_rect_cb)(gc_handle_t *, gc_handle_t *, int16_t,
+                                int16_t, int16_t, int16_t, int16_t, int16_t);
+
+/**
+ * Drawing state restored before replaying the display list of each band
+ */
+typedef struct {
+  uint8_t rotation;
+  uint16_t color;
+  uint16_t fill_color;
+  gc_font_t *font;
+  uint16_t font_color;
+  bool font_background;
+  uint16_t font_background_color;
+  uint8_t font_scale_x;
+  uint8_t font_scale_y;
+} gc_state_t;
+
+/**
+ * Band of device rows held in the buffer. A banded context records drawing
+ * calls and replays them for each band in display().
+ */
+typedef struct {
+  int16_t rows;    // rows per band, 0 if not banded
+  int16_t y;       // first device row in the buffer
+  int16_t height;  // device rows in the buffer
+  bool replaying;
+  bool changed;      // recorded since the last display()
+  gc_state_t state;  // state at the start of the display list
+} gc_band_t;
+
+/**
+ * Bitmap in 1-bit (rows padded to bytes, MSB at left) or 16-bit (big-endian)
+ */
+typedef struct {
+  uint8_t *data;
+  int16_t width;
+  int16_t height;
+  uint8_t bpp;
+  uint16_t color;  // color of the set bits of 1-bit bitmap
+  bool transparent;
+  uint16_t transparent_color;
+} gc_bitmap_t;
+
+/**
+ * Viewport of a layer. The layer is clipped to the rect (the whole screen
+ * if width is 0) and its point (scroll_x, scroll_y) is at the top-left.
+ */
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t width;
+  int16_t height;
+  int16_t scroll_x;
+  int16_t scroll_y;
+} gc_viewport_t;
+
+/**
+ * Tile map. Tiles are indexes of the cells (tile_width x tile_height, left
+ * to right and top to bottom) in the tileset. Indexes out of the tileset
+ * are empty.
+ */
+typedef struct {
+  gc_viewport_t view;
+  gc_bitmap_t tileset;
+  int16_t tile_width;
+  int16_t tile_height;
+  int16_t columns;
+  int16_t rows;
+  void *tiles;  // columns x rows of uint8_t or uint16_t
+  uint8_t tile_bytes;
+  bool wrap;  // repeat the map
+} gc_tilemap_t;
+
+#define GC_SPRITE_FIELDS 5  // x, y, frame, flags, z
+#define GC_SPRITE_VISIBLE 1
+#define GC_SPRITE_FLIP_X 2
+#define GC_SPRITE_FLIP_Y 4
+
+/**
+ * Sprite layer. Sprites are records of GC_SPRITE_FIELDS int16 values, frame
+ * is the index of the cell in the sheet and sprites of higher z are drawn
+ * above.
+ */
+typedef struct {
+  gc_viewport_t view;
+  gc_bitmap_t sheet;
+  int16_t frame_width;
+  int16_t frame_height;
+  int16_t *sprites;
+  uint16_t count;
+} gc_sprite_layer_t;
 
 /**
  * Graphic context native handle
@@ -64,23 +160,36 @@ struct gc_handle_s {
   uint8_t rotation;
   uint8_t bpp;
   uint8_t *buffer;
-  uint16_t buffer_size;
+  uint32_t buffer_size;
   uint16_t color;
   uint16_t fill_color;
   gc_font_t *font;
   uint16_t font_color;
+  bool font_background;
+  uint16_t font_background_color;
   uint8_t font_scale_x;
   uint8_t font_scale_y;
+  bool partial;      // track the dirty region for display()
+  int16_t dirty_x0;  // dirty region in device space (x1, y1 exclusive)
+  int16_t dirty_y0;
+  int16_t dirty_x1;
+  int16_t dirty_y1;
+  gc_band_t band;
   gc_set_pixel_cb set_pixel_cb;
   gc_get_pixel_cb get_pixel_cb;
   gc_draw_hline_cb draw_hline_cb;
   gc_draw_vline_cb draw_vline_cb;
   gc_fill_rect_cb fill_rect_cb;
   gc_fill_screen_cb fill_screen_cb;
+  gc_copy_rect_cb copy_rect_cb;  // NULL if not buffered
   jerry_value_t display_js_cb;
   jerry_value_t set_pixel_js_cb;
   jerry_value_t get_pixel_js_cb;
   jerry_value_t fill_rect_js_cb;
+  jerry_value_t fill_rects_js_cb;
+  jerry_value_t rects_js;  // Uint16Array of (x, y, w, h, color) records
+  uint16_t *rects;
+  uint16_t rects_count;
 };
 
 // primitive functions
@@ -115,8 +224,22 @@ int16_t gc_get_height(gc_handle_t *handle);
 uint16_t gc_color16(gc_handle_t *handle, uint8_t r, uint8_t g, uint8_t b);
 void gc_clear_screen(gc_handle_t *handle);
 void gc_fill_screen(gc_handle_t *handle, uint16_t color);
+void gc_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                  int16_t sy, int16_t w, int16_t h, int16_t dx, int16_t dy);
+void gc_scroll(gc_handle_t *handle, int16_t dx, int16_t dy, uint16_t color);
 void gc_set_rotation(gc_handle_t *handle, uint8_t rotation);
 uint8_t gc_get_rotation(gc_handle_t *handle);
+bool gc_clip_to_device(gc_handle_t *handle, int16_t *x, int16_t *y, int16_t *w,
+                       int16_t *h);
+void gc_mark_dirty(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
+                   int16_t h);
+void gc_mark_dirty_all(gc_handle_t *handle);
+bool gc_clip_to_band(gc_handle_t *handle, int16_t *y, int16_t *h);
+void gc_save_state(gc_handle_t *handle, gc_state_t *state);
+void gc_restore_state(gc_handle_t *handle, gc_state_t *state);
+void gc_clear_dirty(gc_handle_t *handle);
+bool gc_get_dirty(gc_handle_t *handle, int16_t *x, int16_t *y, int16_t *w,
+                  int16_t *h);
 void gc_set_color(gc_handle_t *handle, uint16_t color);
 uint16_t gc_get_color(gc_handle_t *handle);
 void gc_set_fill_color(gc_handle_t *handle, uint16_t color);
@@ -135,11 +258,22 @@ void gc_fill_rect(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
 void gc_fill_roundrect(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
                        int16_t h, int16_t r);
 void gc_fill_circle(gc_handle_t *handle, int16_t x, int16_t y, int16_t r);
+void gc_fill_polygon(gc_handle_t *handle, const int16_t *points, uint16_t n);
+void gc_fill_triangle(gc_handle_t *handle, int16_t x0, int16_t y0, int16_t x1,
+                      int16_t y1, int16_t x2, int16_t y2);
+void gc_draw_polyline(gc_handle_t *handle, const int16_t *points, uint16_t n,
+                      uint16_t thickness);
+void gc_draw_arc(gc_handle_t *handle, int16_t x, int16_t y, int16_t r,
+                 float start_angle, float end_angle, uint16_t thickness);
 void gc_set_font_color(gc_handle_t *handle, uint16_t color);
 uint16_t gc_get_font_color(gc_handle_t *handle);
+void gc_set_font_background(gc_handle_t *handle, bool enabled,
+                            uint16_t color);
 void gc_set_font(gc_handle_t *handle, gc_font_t *font);
 gc_font_t *gc_get_font(gc_handle_t *handle);
 void gc_set_font_scale(gc_handle_t *handle, uint8_t scale_x, uint8_t scale_y);
+void gc_glyph_cache_invalidate(gc_font_t *font);
+void gc_glyph_cache_stats(uint32_t *hits, uint32_t *misses);
 void gc_draw_char(gc_handle_t *handle, int16_t x, int16_t y, const char ch);
 void gc_draw_text(gc_handle_t *handle, int16_t x, int16_t y, const char *text);
 void gc_measure_text(gc_handle_t *handle, const char *text, uint16_t *w,
@@ -148,5 +282,7 @@ void gc_draw_bitmap(gc_handle_t *handle, int16_t x, int16_t y, uint8_t *bitmap,
                     int16_t w, int16_t h, uint8_t bpp, uint16_t color,
                     bool transparent, uint16_t transparent_color,
                     uint8_t scale_x, uint8_t scale_y, bool flip_x, bool flip_y);
+void gc_draw_tilemap(gc_handle_t *handle, gc_tilemap_t *map);
+void gc_draw_sprite_layer(gc_handle_t *handle, gc_sprite_layer_t *layer);
 
 #endif /* __GC_H */
@@ -23,6 +23,7 @@
 
 #include "gc_16bit_prims.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -34,6 +35,47 @@
  * Graphic primitive functions for 16-bits color graphic buffer
  */
 
+/**
+ * Two pixels of the color in the buffer's byte order (big-endian)
+ */
+static uint32_t color_pattern(uint16_t color) {
+  uint8_t bytes[4] = {color >> 8, color & 0xFF, color >> 8, color & 0xFF};
+  uint32_t pattern;
+  memcpy(&pattern, bytes, 4);
+  return pattern;
+}
+
+/**
+ * Fill n pixels from p with the color pattern, two pixels per word store
+ */
+static void fill_span(uint8_t *p, uint32_t n, uint32_t pattern) {
+  if ((uintptr_t)p & 1) {
+    for (; n > 0; n--, p += 2) {
+      memcpy(p, &pattern, 2);
+    }
+    return;
+  }
+  if (((uintptr_t)p & 3) && n > 0) {
+    *(uint16_t *)p = (uint16_t)pattern;
+    p += 2;
+    n--;
+  }
+  uint32_t *word = (uint32_t *)p;
+  for (; n >= 8; n -= 8) {
+    word[0] = pattern;
+    word[1] = pattern;
+    word[2] = pattern;
+    word[3] = pattern;
+    word += 4;
+  }
+  for (; n >= 2; n -= 2) {
+    *word++ = pattern;
+  }
+  if (n > 0) {
+    *(uint16_t *)word = (uint16_t)pattern;
+  }
+}
+
 void gc_prim_16bit_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
                              uint16_t color) {
   if ((x >= 0) && (x < handle->width) && (y >= 0) && (y < handle->height)) {
@@ -51,6 +93,11 @@ void gc_prim_16bit_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    gc_mark_dirty(handle, x, y, 1, 1);
+    y -= handle->band.y;
+    if ((y < 0) || (y >= handle->band.height)) {
+      return;
+    }
     uint32_t idx = ((y * handle->device_width) + x) * 2;
     handle->buffer[idx] = color >> 8;
     handle->buffer[idx + 1] = color & 0xFF;
@@ -74,6 +121,10 @@ void gc_prim_16bit_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    y -= handle->band.y;
+    if ((y < 0) || (y >= handle->band.height)) {
+      return;
+    }
     uint32_t idx = ((y * handle->device_width) + x) * 2;
     *color = handle->buffer[idx] << 8 | handle->buffer[idx + 1];
   }
@@ -81,31 +132,79 @@ void gc_prim_16bit_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
 
 void gc_prim_16bit_draw_vline(gc_handle_t *handle, int16_t x, int16_t y,
                               int16_t h, uint16_t color) {
-  for (int16_t i = y; i < y + h; i++) {
-    gc_prim_16bit_set_pixel(handle, x, i, color);
-  }
+  gc_prim_16bit_fill_rect(handle, x, y, 1, h, color);
 }
 
 void gc_prim_16bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
                               int16_t w, uint16_t color) {
-  for (int16_t i = x; i < x + w; i++) {
-    gc_prim_16bit_set_pixel(handle, i, y, color);
-  }
+  gc_prim_16bit_fill_rect(handle, x, y, w, 1, color);
 }
 
 void gc_prim_16bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
                              int16_t w, int16_t h, uint16_t color) {
-  for (int16_t i = x; i < x + w; i++) {
-    gc_prim_16bit_draw_vline(handle, i, y, h, color);
+  if (!gc_clip_to_device(handle, &x, &y, &w, &h)) {
+    return;
+  }
+  gc_mark_dirty(handle, x, y, w, h);
+  if (!gc_clip_to_band(handle, &y, &h)) {
+    return;
+  }
+  uint32_t pattern = color_pattern(color);
+  uint32_t stride = handle->device_width * 2;
+  uint8_t *row = handle->buffer + (y * stride) + (x * 2);
+  if (w == handle->device_width) {
+    // rows are contiguous
+    fill_span(row, (uint32_t)w * h, pattern);
+    return;
+  }
+  for (int16_t i = 0; i < h; i++) {
+    fill_span(row, w, pattern);
+    row += stride;
   }
 }
 
 void gc_prim_16bit_fill_screen(gc_handle_t *handle, uint16_t color) {
-  for (int16_t y = 0; y < handle->device_height; y++) {
-    for (int16_t x = 0; x < handle->device_width; x++) {
-      uint32_t idx = ((y * handle->device_width) + x) * 2;
-      handle->buffer[idx] = color >> 8;
-      handle->buffer[idx + 1] = color;
-    }
+  gc_mark_dirty_all(handle);
+  uint32_t size = handle->buffer_size;
+  uint32_t filled = MIN(size / 2, 32) * 2;
+  fill_span(handle->buffer, filled / 2, color_pattern(color));
+  // double the filled area until the whole buffer is filled
+  while (filled > 0 && filled < size) {
+    uint32_t n = MIN(filled, size - filled);
+    memcpy(handle->buffer + filled, handle->buffer, n);
+    filled += n;
+  }
+}
+
+/**
+ * @brief Primitive copy rectangle in device space (clipped). The source may
+ *        be the buffer itself, rows are copied in an overlap-safe order.
+ * @param handle Graphic context handle
+ * @param src Source graphic context handle of the same pixel format
+ */
+void gc_prim_16bit_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                             int16_t sy, int16_t w, int16_t h, int16_t dx,
+                             int16_t dy) {
+  gc_mark_dirty(handle, dx, dy, w, h);
+  int32_t dst_stride = handle->device_width * 2;
+  int32_t src_stride = src->device_width * 2;
+  uint8_t *d = handle->buffer + (dy * dst_stride) + (dx * 2);
+  uint8_t *s = src->buffer + (sy * src_stride) + (sx * 2);
+  if (w == handle->device_width && w == src->device_width) {
+    // rows are contiguous
+    memmove(d, s, (uint32_t)w * h * 2);
+    return;
+  }
+  if (handle->buffer == src->buffer && dy > sy) {
+    // copy bottom-up
+    d += (h - 1) * dst_stride;
+    s += (h - 1) * src_stride;
+    dst_stride = -dst_stride;
+    src_stride = -src_stride;
+  }
+  for (int16_t i = 0; i < h; i++) {
+    memmove(d, s, w * 2);
+    d += dst_stride;
+    s += src_stride;
   }
 }
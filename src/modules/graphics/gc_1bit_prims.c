@@ -58,6 +58,11 @@ void gc_prim_1bit_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    gc_mark_dirty(handle, x, y, 1, 1);
+    y -= handle->band.y;
+    if ((y < 0) || (y >= handle->band.height)) {
+      return;
+    }
     uint32_t idx = x + (y / 8) * handle->device_width;
     uint8_t mask = (1 << (y & 7));
     if (color) {
@@ -91,6 +96,11 @@ void gc_prim_1bit_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    y -= handle->band.y;
+    if ((y < 0) || (y >= handle->band.height)) {
+      *color = 0;
+      return;
+    }
     *color = (handle->buffer[x + (y / 8) * handle->device_width] &
               (1 << (y & 7))) > 0;
     return;
@@ -109,9 +119,7 @@ void gc_prim_1bit_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
  */
 void gc_prim_1bit_draw_vline(gc_handle_t *handle, int16_t x, int16_t y,
                              int16_t h, uint16_t color) {
-  for (int16_t i = y; i < y + h; i++) {
-    gc_prim_1bit_set_pixel(handle, x, i, color);
-  }
+  gc_prim_1bit_fill_rect(handle, x, y, 1, h, color);
 }
 
 /**
@@ -124,9 +132,7 @@ void gc_prim_1bit_draw_vline(gc_handle_t *handle, int16_t x, int16_t y,
  */
 void gc_prim_1bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
                              int16_t w, uint16_t color) {
-  for (int16_t i = x; i < x + w; i++) {
-    gc_prim_1bit_set_pixel(handle, i, y, color);
-  }
+  gc_prim_1bit_fill_rect(handle, x, y, w, 1, color);
 }
 
 /**
@@ -140,8 +146,28 @@ void gc_prim_1bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
  */
 void gc_prim_1bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
                             int16_t w, int16_t h, uint16_t color) {
-  for (int16_t i = x; i < x + w; i++) {
-    gc_prim_1bit_draw_vline(handle, i, y, h, color);
+  if (!gc_clip_to_device(handle, &x, &y, &w, &h)) {
+    return;
+  }
+  gc_mark_dirty(handle, x, y, w, h);
+  if (!gc_clip_to_band(handle, &y, &h)) {
+    return;
+  }
+  // a byte holds 8 vertical pixels (a page), fill page by page
+  int16_t first = y / 8;
+  int16_t last = (y + h - 1) / 8;
+  for (int16_t page = first; page <= last; page++) {
+    uint8_t mask = 0xFF;
+    if (page == first) mask &= 0xFF << (y & 7);
+    if (page == last) mask &= 0xFF >> (7 - ((y + h - 1) & 7));
+    uint8_t *p = handle->buffer + (page * handle->device_width) + x;
+    if (mask == 0xFF) {
+      memset(p, color ? 0xFF : 0x00, w);
+    } else if (color) {
+      for (int16_t i = 0; i < w; i++) p[i] |= mask;
+    } else {
+      for (int16_t i = 0; i < w; i++) p[i] &= ~mask;
+    }
   }
 }
 
@@ -151,11 +177,85 @@ void gc_prim_1bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
  * @param color
  */
 void gc_prim_1bit_fill_screen(gc_handle_t *handle, uint16_t color) {
-  for (int i = 0; i < handle->buffer_size; i++) {
-    if (color) {
-      handle->buffer[i] = 255;
-    } else {
-      handle->buffer[i] = 0;
+  gc_mark_dirty_all(handle);
+  memset(handle->buffer, color ? 0xFF : 0x00, handle->buffer_size);
+}
+
+/**
+ * @brief Primitive copy rectangle in device space (clipped). The source may
+ *        be the buffer itself, pages and pixels are copied in an
+ *        overlap-safe order.
+ * @param handle Graphic context handle
+ * @param src Source graphic context handle of the same pixel format
+ */
+void gc_prim_1bit_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                            int16_t sy, int16_t w, int16_t h, int16_t dx,
+                            int16_t dy) {
+  gc_mark_dirty(handle, dx, dy, w, h);
+  int16_t dw = handle->device_width;
+  int16_t sw = src->device_width;
+  bool same = (handle->buffer == src->buffer);
+  if (((sy - dy) & 7) == 0) {
+    // same bit offset in pages, copy page by page
+    if (w == dw && w == sw && (dy & 7) == 0 && (h & 7) == 0) {
+      memmove(handle->buffer + (dy / 8) * dw, src->buffer + (sy / 8) * sw,
+              (uint32_t)(h / 8) * dw);
+      return;
+    }
+    int16_t first = dy / 8;
+    int16_t last = (dy + h - 1) / 8;
+    int16_t step = 1;
+    if (same && dy > sy) {
+      SWAP_INT16(first, last)
+      step = -1;
+    }
+    for (int16_t page = first;; page += step) {
+      uint8_t mask = 0xFF;
+      if (page == dy / 8) mask &= 0xFF << (dy & 7);
+      if (page == (dy + h - 1) / 8) mask &= 0xFF >> (7 - ((dy + h - 1) & 7));
+      uint8_t *d = handle->buffer + (page * dw) + dx;
+      uint8_t *s = src->buffer + ((page + (sy - dy) / 8) * sw) + sx;
+      if (mask == 0xFF) {
+        memmove(d, s, w);
+      } else if (same && d > s) {
+        for (int16_t i = w - 1; i >= 0; i--) {
+          d[i] = (d[i] & ~mask) | (s[i] & mask);
+        }
+      } else {
+        for (int16_t i = 0; i < w; i++) {
+          d[i] = (d[i] & ~mask) | (s[i] & mask);
+        }
+      }
+      if (page == last) break;
+    }
+    return;
+  }
+  // bits are shifted between pages, copy pixel by pixel
+  int16_t x0 = 0, x1 = w, xstep = 1;
+  int16_t y0 = 0, y1 = h, ystep = 1;
+  if (same && dx > sx) {
+    x0 = w - 1;
+    x1 = -1;
+    xstep = -1;
+  }
+  if (same && dy > sy) {
+    y0 = h - 1;
+    y1 = -1;
+    ystep = -1;
+  }
+  for (int16_t j = y0; j != y1; j += ystep) {
+    int16_t sj = sy + j;
+    int16_t dj = dy + j;
+    uint8_t *s = src->buffer + (sj / 8) * sw + sx;
+    uint8_t *d = handle->buffer + (dj / 8) * dw + dx;
+    uint8_t smask = 1 << (sj & 7);
+    uint8_t dmask = 1 << (dj & 7);
+    for (int16_t i = x0; i != x1; i += xstep) {
+      if (s[i] & smask) {
+        d[i] |= dmask;
+      } else {
+        d[i] &= ~dmask;
+      }
     }
   }
 }
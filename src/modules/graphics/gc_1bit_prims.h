@@ -16,5 +16,8 @@ void gc_prim_1bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
 void gc_prim_1bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
                             int16_t w, int16_t h, uint16_t color);
 void gc_prim_1bit_fill_screen(gc_handle_t *handle, uint16_t color);
+void gc_prim_1bit_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                            int16_t sy, int16_t w, int16_t h, int16_t dx,
+                            int16_t dy);
 
 #endif /* __GC_1BIT_PRIMS_H */
@@ -93,6 +93,11 @@ void gc_prim_3bit_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    gc_mark_dirty(handle, x, y, 1, 1);
+    y -= handle->band.y;
+    if ((y < 0) || (y >= handle->band.height)) {
+      return;
+    }
     uint32_t idx = ((y * handle->device_width) + x) / 2;
     uint8_t convertedColor = color_to_3bit(color);
     bool highPixel = ((x & 1) != 0);
@@ -130,6 +135,11 @@ void gc_prim_3bit_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    y -= handle->band.y;
+    if ((y < 0) || (y >= handle->band.height)) {
+      *color = 0;
+      return;
+    }
     uint32_t idx = ((y * handle->device_width) + x) / 2;
 
     
@@ -155,9 +165,7 @@ void gc_prim_3bit_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
  */
 void gc_prim_3bit_draw_vline(gc_handle_t *handle, int16_t x, int16_t y,
                              int16_t h, uint16_t color) {
-  for (int16_t i = y; i < y + h; i++) {
-    gc_prim_3bit_set_pixel(handle, x, i, color);
-  }
+  gc_prim_3bit_fill_rect(handle, x, y, 1, h, color);
 }
 
 /**
@@ -170,9 +178,7 @@ void gc_prim_3bit_draw_vline(gc_handle_t *handle, int16_t x, int16_t y,
  */
 void gc_prim_3bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
                              int16_t w, uint16_t color) {
-  for (int16_t i = x; i < x + w; i++) {
-    gc_prim_3bit_set_pixel(handle, i, y, color);
-  }
+  gc_prim_3bit_fill_rect(handle, x, y, w, 1, color);
 }
 
 /**
@@ -186,8 +192,29 @@ void gc_prim_3bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
  */
 void gc_prim_3bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
                             int16_t w, int16_t h, uint16_t color) {
-  for (int16_t i = x; i < x + w; i++) {
-    gc_prim_3bit_draw_vline(handle, i, y, h, color);
+  if (!gc_clip_to_device(handle, &x, &y, &w, &h)) {
+    return;
+  }
+  gc_mark_dirty(handle, x, y, w, h);
+  if (!gc_clip_to_band(handle, &y, &h)) {
+    return;
+  }
+  uint8_t c = color_to_3bit(color);
+  uint8_t fill = c | (c << 3);
+  for (int16_t j = y; j < y + h; j++) {
+    uint8_t *row = handle->buffer + ((int32_t)j * handle->device_width) / 2;
+    int16_t i = x;
+    int16_t end = x + w;
+    if (i & 1) {  // leading odd pixel
+      row[i / 2] = (row[i / 2] & 0xF8) | c;
+      i++;
+    }
+    int16_t pairs = (end - i) / 2;
+    memset(row + (i / 2), fill, pairs);
+    i += pairs * 2;
+    if (i < end) {  // trailing even pixel
+      row[i / 2] = (row[i / 2] & 0xC7) | (c << 3);
+    }
   }
 }
 
@@ -197,14 +224,74 @@ void gc_prim_3bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
  * @param color
  */
 void gc_prim_3bit_fill_screen(gc_handle_t *handle, uint16_t color) {
+  gc_mark_dirty_all(handle);
+  uint8_t c = color_to_3bit(color);
+  memset(handle->buffer, c | (c << 3), handle->buffer_size);
+}
 
-  uint8_t tempColor = color_to_3bit(color);
-  uint8_t fillColor = (tempColor) | ((tempColor) << 3);
-  for (int16_t y = 0; y < handle->device_height; y++) {
-    uint32_t idx = (y * handle->device_width) / 2;
-    for (int16_t x = 0; x < (handle->device_width/2); x++) {
-      handle->buffer[idx + x] = fillColor;
+/**
+ * @brief Primitive copy rectangle in device space (clipped). The source may
+ *        be the buffer itself, rows and pixels are copied in an overlap-safe
+ *        order.
+ * @param handle Graphic context handle
+ * @param src Source graphic context handle of the same pixel format
+ */
+void gc_prim_3bit_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                            int16_t sy, int16_t w, int16_t h, int16_t dx,
+                            int16_t dy) {
+  gc_mark_dirty(handle, dx, dy, w, h);
+  int32_t dst_stride = handle->device_width / 2;
+  int32_t src_stride = src->device_width / 2;
+  bool same = (handle->buffer == src->buffer);
+  if (w == handle->device_width && w == src->device_width) {
+    // rows are contiguous
+    memmove(handle->buffer + dy * dst_stride, src->buffer + sy * src_stride,
+            (uint32_t)h * dst_stride);
+    return;
+  }
+  int16_t y0 = 0, y1 = h, ystep = 1;
+  if (same && dy > sy) {
+    y0 = h - 1;
+    y1 = -1;
+    ystep = -1;
+  }
+  for (int16_t j = y0; j != y1; j += ystep) {
+    uint8_t *s = src->buffer + (sy + j) * src_stride;
+    uint8_t *d = handle->buffer + (dy + j) * dst_stride;
+    if (((sx ^ dx) & 1) == 0) {
+      // same nibble order, copy the whole bytes at once and the odd pixels
+      // at both ends separately
+      int16_t lead = dx & 1;
+      int16_t bytes = (w - lead) / 2;
+      int16_t trail = (w - lead) & 1;
+      uint8_t first = s[sx / 2] & 0x07;
+      uint8_t end = s[(sx + w - 1) / 2] & 0x38;
+      memmove(d + (dx + lead) / 2, s + (sx + lead) / 2, bytes);
+      if (lead) {
+        d[dx / 2] = (d[dx / 2] & 0xF8) | first;
+      }
+      if (trail) {
+        uint8_t *p = d + (dx + w - 1) / 2;
+        *p = (*p & 0xC7) | end;
+      }
+    } else {
+      int16_t x0 = 0, x1 = w, xstep = 1;
+      if (same && dy == sy && dx > sx) {
+        x0 = w - 1;
+        x1 = -1;
+        xstep = -1;
+      }
+      for (int16_t i = x0; i != x1; i += xstep) {
+        int16_t si = sx + i;
+        int16_t di = dx + i;
+        uint8_t pixel = (si & 1) ? s[si / 2] & 0x07 : (s[si / 2] >> 3) & 0x07;
+        uint8_t *p = d + di / 2;
+        if (di & 1) {
+          *p = (*p & 0xF8) | pixel;
+        } else {
+          *p = (*p & 0xC7) | (pixel << 3);
+        }
+      }
     }
   }
-
 }
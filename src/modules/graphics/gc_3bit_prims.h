@@ -16,5 +16,8 @@ void gc_prim_3bit_draw_hline(gc_handle_t *handle, int16_t x, int16_t y,
 void gc_prim_3bit_fill_rect(gc_handle_t *handle, int16_t x, int16_t y,
                             int16_t w, int16_t h, uint16_t color);
 void gc_prim_3bit_fill_screen(gc_handle_t *handle, uint16_t color);
+void gc_prim_3bit_copy_rect(gc_handle_t *handle, gc_handle_t *src, int16_t sx,
+                            int16_t sy, int16_t w, int16_t h, int16_t dx,
+                            int16_t dy);
 
 #endif /* __GC_3BIT_PRIMS_H */
@@ -34,6 +34,89 @@
  * Graphic primitive functions for callback javascript functions
  */
 
+/**
+ * Call fillRects callback with the batched records
+ */
+void gc_prim_cb_flush(gc_handle_t *handle) {
+  if (handle->rects_count > 0) {
+    jerry_value_t this_val = jerry_create_undefined();
+    jerry_value_t arg_count = jerry_create_number(handle->rects_count);
+    jerry_value_t args[] = {handle->rects_js, arg_count};
+    jerry_value_t ret_val =
+        jerry_call_function(handle->fill_rects_js_cb, this_val, args, 2);
+    jerry_release_value(ret_val);
+    jerry_release_value(arg_count);
+    jerry_release_value(this_val);
+    handle->rects_count = 0;
+  }
+}
+
+/**
+ * Add a rect in device space to the batch, merged to the last rect if they
+ * make a rect of the same color (e.g. pixels of a line or a glyph row)
+ */
+static void push_rect(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
+                      int16_t h, uint16_t color) {
+  if (handle->rects_count > 0) {
+    uint16_t *last = handle->rects + (handle->rects_count - 1) * 5;
+    if (last[4] == color) {
+      if (last[1] == y && last[3] == h) {
+        if (last[0] + last[2] == x) {  // right
+          last[2] += w;
+          return;
+        }
+        if (x + w == last[0]) {  // left
+          last[0] = x;
+          last[2] += w;
+          return;
+        }
+      }
+      if (last[0] == x && last[2] == w) {
+        if (last[1] + last[3] == y) {  // below
+          last[3] += h;
+          return;
+        }
+        if (y + h == last[1]) {  // above
+          last[1] = y;
+          last[3] += h;
+          return;
+        }
+      }
+    }
+  }
+  if (handle->rects_count == GC_CB_RECTS_MAX) {
+    gc_prim_cb_flush(handle);
+  }
+  uint16_t *rect = handle->rects + handle->rects_count * 5;
+  rect[0] = x;
+  rect[1] = y;
+  rect[2] = w;
+  rect[3] = h;
+  rect[4] = color;
+  handle->rects_count++;
+}
+
+/**
+ * Call setPixel callback with a pixel in device space
+ */
+static void call_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
+                           uint16_t color) {
+  if (jerry_value_is_function(handle->set_pixel_js_cb)) {
+    jerry_value_t this_val = jerry_create_undefined();
+    jerry_value_t arg_x = jerry_create_number(x);
+    jerry_value_t arg_y = jerry_create_number(y);
+    jerry_value_t arg_color = jerry_create_number(color);
+    jerry_value_t args[] = {arg_x, arg_y, arg_color};
+    jerry_value_t ret_val =
+        jerry_call_function(handle->set_pixel_js_cb, this_val, args, 3);
+    jerry_release_value(ret_val);
+    jerry_release_value(arg_x);
+    jerry_release_value(arg_y);
+    jerry_release_value(arg_color);
+    jerry_release_value(this_val);
+  }
+}
+
 void gc_prim_cb_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
                           uint16_t color) {
   if ((x >= 0) && (x < handle->width) && (y >= 0) && (y < handle->height)) {
@@ -51,19 +134,10 @@ void gc_prim_cb_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
-    if (jerry_value_is_function(handle->set_pixel_js_cb)) {
-      jerry_value_t this_val = jerry_create_undefined();
-      jerry_value_t arg_x = jerry_create_number(x);
-      jerry_value_t arg_y = jerry_create_number(y);
-      jerry_value_t arg_color = jerry_create_number(color);
-      jerry_value_t args[] = {arg_x, arg_y, arg_color};
-      jerry_value_t ret_val =
-          jerry_call_function(handle->set_pixel_js_cb, this_val, args, 3);
-      jerry_release_value(ret_val);
-      jerry_release_value(arg_x);
-      jerry_release_value(arg_y);
-      jerry_release_value(arg_color);
-      jerry_release_value(this_val);
+    if (handle->rects != NULL) {
+      push_rect(handle, x, y, 1, 1, color);
+    } else {
+      call_set_pixel(handle, x, y, color);
     }
   }
 }
@@ -85,6 +159,7 @@ void gc_prim_cb_get_pixel(gc_handle_t *handle, int16_t x, int16_t y,
         y = handle->device_height - y - 1;
         break;
     }
+    gc_prim_cb_flush(handle);  // pending rects before reading
     if (jerry_value_is_function(handle->get_pixel_js_cb)) {
       jerry_value_t this_val = jerry_create_undefined();
       jerry_value_t arg_x = jerry_create_number(x);
@@ -115,53 +190,20 @@ void gc_prim_cb_draw_hline(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
 
 void gc_prim_cb_fill_rect(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
                           int16_t h, uint16_t color) {
-  int16_t x1 = x;
-  int16_t y1 = y;
-  int16_t x2 = x + w - 1;
-  int16_t y2 = y + h - 1;
-  // rotate
-  switch (handle->rotation) {
-    case 1:
-      SWAP_INT16(x1, y1)
-      SWAP_INT16(x2, y2)
-      x1 = handle->device_width - x1 - 1;
-      x2 = handle->device_width - x2 - 1;
-      break;
-    case 2:
-      x1 = handle->device_width - x1 - 1;
-      y1 = handle->device_height - y1 - 1;
-      x2 = handle->device_width - x2 - 1;
-      y2 = handle->device_height - y2 - 1;
-      break;
-    case 3:
-      SWAP_INT16(x1, y1)
-      SWAP_INT16(x2, y2)
-      y1 = handle->device_height - y1 - 1;
-      y2 = handle->device_height - y2 - 1;
-      break;
-  }
-  if (x1 > x2) {
-    SWAP_INT16(x1, x2)
+  if (!gc_clip_to_device(handle, &x, &y, &w, &h)) {
+    return;
   }
-  if (y1 > y2) {
-    SWAP_INT16(y1, y2)
+  if (handle->rects != NULL) {
+    push_rect(handle, x, y, w, h, color);
+    return;
   }
-  // clipping
-  if (x1 < 0) x1 = 0;
-  if (x1 >= handle->device_width) x1 = handle->device_width - 1;
-  if (y1 < 0) y1 = 0;
-  if (y1 >= handle->device_height) y1 = handle->device_height - 1;
-  if (x2 < 0) x2 = 0;
-  if (x2 >= handle->device_width) x2 = handle->device_width - 1;
-  if (y2 < 0) y2 = 0;
-  if (y2 >= handle->device_height) y2 = handle->device_height - 1;
   // draw
   if (jerry_value_is_function(handle->fill_rect_js_cb)) {
     jerry_value_t this_val = jerry_create_undefined();
-    jerry_value_t arg_x = jerry_create_number(x1);
-    jerry_value_t arg_y = jerry_create_number(y1);
-    jerry_value_t arg_w = jerry_create_number(x2 - x1 + 1);
-    jerry_value_t arg_h = jerry_create_number(y2 - y1 + 1);
+    jerry_value_t arg_x = jerry_create_number(x);
+    jerry_value_t arg_y = jerry_create_number(y);
+    jerry_value_t arg_w = jerry_create_number(w);
+    jerry_value_t arg_h = jerry_create_number(h);
     jerry_value_t arg_color = jerry_create_number(color);
     jerry_value_t args[] = {arg_x, arg_y, arg_w, arg_h, arg_color};
     jerry_value_t ret_val =
@@ -173,10 +215,15 @@ void gc_prim_cb_fill_rect(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
     jerry_release_value(arg_h);
     jerry_release_value(arg_color);
     jerry_release_value(this_val);
+  } else {  // no fillRect callback, fill with setPixel
+    for (int16_t j = y; j < y + h; j++) {
+      for (int16_t i = x; i < x + w; i++) {
+        call_set_pixel(handle, i, j, color);
+      }
+    }
   }
 }
 
 void gc_prim_cb_fill_screen(gc_handle_t *handle, uint16_t color) {
-  gc_prim_cb_fill_rect(handle, 0, 0, handle->device_width,
-                       handle->device_height, color);
+  gc_prim_cb_fill_rect(handle, 0, 0, handle->width, handle->height, color);
 }
@@ -4,6 +4,8 @@
 #include "font.h"
 #include "gc.h"
 
+#define GC_CB_RECTS_MAX 64  // records in the batch of fillRects callback
+
 // primitive functions for callback
 void gc_prim_cb_set_pixel(gc_handle_t *handle, int16_t x, int16_t y,
                           uint16_t color);
@@ -16,5 +18,6 @@ void gc_prim_cb_draw_hline(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
 void gc_prim_cb_fill_rect(gc_handle_t *handle, int16_t x, int16_t y, int16_t w,
                           int16_t h, uint16_t color);
 void gc_prim_cb_fill_screen(gc_handle_t *handle, uint16_t color);
+void gc_prim_cb_flush(gc_handle_t *handle);
 
 #endif /* __GC_CB_PRIMS_H */
@@ -25,9 +25,12 @@
 #define MSTR_GRAPHICS_GRAPHICS_CONTEXT "GraphicsContext"
 #define MSTR_GRAPHICS_BUFFERED_GRAPHICS_CONTEXT "BufferedGraphicsContext"
 #define MSTR_GRAPHICS_DISPLAY_CB "__display_cb"
+#define MSTR_GRAPHICS_DISPLAY_LIST "__display_list"
 #define MSTR_GRAPHICS_SETPIXEL_CB "__setPixel_cb"
 #define MSTR_GRAPHICS_GETPIXEL_CB "__getPixel_cb"
 #define MSTR_GRAPHICS_FILLRECT_CB "__fillRect_cb"
+#define MSTR_GRAPHICS_FILLRECTS_CB "__fillRects_cb"
+#define MSTR_GRAPHICS_RECTS "__rects"
 #define MSTR_GRAPHICS_WIDTH "width"
 #define MSTR_GRAPHICS_HEIGHT "height"
 #define MSTR_GRAPHICS_FIRST "first"
@@ -39,6 +42,15 @@
 #define MSTR_GRAPHICS_BUFFER "buffer"
 #define MSTR_GRAPHICS_ROTATION "rotation"
 #define MSTR_GRAPHICS_BPP "bpp"
+#define MSTR_GRAPHICS_PARTIAL "partial"
+#define MSTR_GRAPHICS_LENGTH "length"
+#define MSTR_GRAPHICS_GLYPH_CACHE_STATS "glyphCacheStats"
+#define MSTR_GRAPHICS_HITS "hits"
+#define MSTR_GRAPHICS_MISSES "misses"
+#define MSTR_GRAPHICS_BAND_HEIGHT "bandHeight"
+#define MSTR_GRAPHICS_X "x"
+#define MSTR_GRAPHICS_Y "y"
+#define MSTR_GRAPHICS_STRIDE "stride"
 #define MSTR_GRAPHICS_DATA "data"
 #define MSTR_GRAPHICS_SCALE_X "scaleX"
 #define MSTR_GRAPHICS_SCALE_Y "scaleY"
@@ -63,8 +75,13 @@
 #define MSTR_GRAPHICS_DRAW_LINE "drawLine"
 #define MSTR_GRAPHICS_DRAW_RECT "drawRect"
 #define MSTR_GRAPHICS_FILL_RECT "fillRect"
+#define MSTR_GRAPHICS_FILL_RECTS "fillRects"
 #define MSTR_GRAPHICS_DRAW_CIRCLE "drawCircle"
 #define MSTR_GRAPHICS_FILL_CIRCLE "fillCircle"
+#define MSTR_GRAPHICS_FILL_POLYGON "fillPolygon"
+#define MSTR_GRAPHICS_FILL_TRIANGLE "fillTriangle"
+#define MSTR_GRAPHICS_DRAW_POLYLINE "drawPolyline"
+#define MSTR_GRAPHICS_DRAW_ARC "drawArc"
 #define MSTR_GRAPHICS_DRAW_ROUNDRECT "drawRoundRect"
 #define MSTR_GRAPHICS_FILL_ROUNDRECT "fillRoundRect"
 #define MSTR_GRAPHICS_SET_FONT "setFont"
@@ -72,6 +89,34 @@
 #define MSTR_GRAPHICS_MEASURE_TEXT "measureText"
 #define MSTR_GRAPHICS_DRAW_BITMAP "drawBitmap"
 #define MSTR_GRAPHICS_DISPLAY "display"
+#define MSTR_GRAPHICS_INVALIDATE "invalidate"
+#define MSTR_GRAPHICS_SCROLL "scroll"
+#define MSTR_GRAPHICS_COPY_RECT "copyRect"
+#define MSTR_GRAPHICS_BLIT "blit"
+#define MSTR_GRAPHICS_TILE_MAP "TileMap"
+#define MSTR_GRAPHICS_SPRITE_LAYER "SpriteLayer"
+#define MSTR_GRAPHICS_DRAW_TILE_MAP "drawTileMap"
+#define MSTR_GRAPHICS_DRAW_SPRITE_LAYER "drawSpriteLayer"
+#define MSTR_GRAPHICS_TILESET "tileset"
+#define MSTR_GRAPHICS_TILES "tiles"
+#define MSTR_GRAPHICS_TILE_WIDTH "tileWidth"
+#define MSTR_GRAPHICS_TILE_HEIGHT "tileHeight"
+#define MSTR_GRAPHICS_COLUMNS "columns"
+#define MSTR_GRAPHICS_ROWS "rows"
+#define MSTR_GRAPHICS_WRAP "wrap"
+#define MSTR_GRAPHICS_SHEET "sheet"
+#define MSTR_GRAPHICS_SPRITES "sprites"
+#define MSTR_GRAPHICS_FRAME_WIDTH "frameWidth"
+#define MSTR_GRAPHICS_FRAME_HEIGHT "frameHeight"
+#define MSTR_GRAPHICS_COUNT "count"
+#define MSTR_GRAPHICS_SET_SCROLL "setScroll"
+#define MSTR_GRAPHICS_SET_VIEWPORT "setViewport"
+#define MSTR_GRAPHICS_SET_TILE "setTile"
+#define MSTR_GRAPHICS_GET_TILE "getTile"
+#define MSTR_GRAPHICS_SET_SPRITE "setSprite"
+#define MSTR_GRAPHICS_SPRITE_VISIBLE "VISIBLE"
+#define MSTR_GRAPHICS_SPRITE_FLIP_X "FLIP_X"
+#define MSTR_GRAPHICS_SPRITE_FLIP_Y "FLIP_Y"
 #define MSTR_GRAPHICS_FLIP_X "flipX"
 #define MSTR_GRAPHICS_FLIP_Y "flipY"
 #endif /* __GRAPHICS_MAGIC_STRINGS_H */
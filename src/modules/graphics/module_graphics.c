@@ -22,6 +22,7 @@
 #include "module_graphics.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "font.h"
 #include "gc.h"
@@ -38,9 +39,96 @@ gc_font_t custom_font;
 
 static void gc_handle_freecb(void *handle) { free(handle); }
 
+static void gc_buffer_freecb(void *buffer) { free(buffer); }
+
 static const jerry_object_native_info_t gc_handle_info = {.free_cb =
                                                               gc_handle_freecb};
 
+/**
+ * Start a new display list of a banded context, e.g. on clearScreen()
+ */
+static void gc_band_reset(gc_handle_t *gc_handle, jerry_value_t this_val) {
+  if (gc_handle->band.rows > 0 && !gc_handle->band.replaying) {
+    jerry_value_t list = jerry_create_array(0);
+    jerryxx_set_property(this_val, MSTR_GRAPHICS_DISPLAY_LIST, list);
+    jerry_release_value(list);
+    gc_save_state(gc_handle, &gc_handle->band.state);
+  }
+}
+
+/**
+ * Limits of the display list of a banded context. Calls are kept on the JS
+ * heap until the next clearScreen() or fillScreen().
+ */
+#define GC_BAND_MAX_OPS 1024
+#define GC_BAND_MAX_ARGS 8
+
+/**
+ * Append a call to the display list of a banded context, as an array of the
+ * function and the arguments. Returns true if recorded, false if not banded
+ * or an error if the call can not be recorded.
+ */
+static jerry_value_t gc_band_record(gc_handle_t *gc_handle,
+                                    jerry_value_t this_val,
+                                    jerry_value_t func_value,
+                                    const jerry_value_t args_p[],
+                                    const jerry_length_t args_cnt) {
+  if (gc_handle->band.rows == 0 || gc_handle->band.replaying) {
+    return jerry_create_boolean(false);
+  }
+  if (args_cnt > GC_BAND_MAX_ARGS) {
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Too many arguments in banded mode.");
+  }
+  jerry_value_t list =
+      jerryxx_get_property(this_val, MSTR_GRAPHICS_DISPLAY_LIST);
+  uint32_t count = jerry_get_array_length(list);
+  if (count >= GC_BAND_MAX_OPS) {
+    jerry_release_value(list);
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Display list is full in banded mode.");
+  }
+  jerry_value_t op = jerry_create_array(args_cnt + 1);
+  jerry_release_value(jerry_set_property_by_index(op, 0, func_value));
+  for (jerry_length_t i = 0; i < args_cnt; i++) {
+    jerry_release_value(jerry_set_property_by_index(op, i + 1, args_p[i]));
+  }
+  jerry_release_value(jerry_set_property_by_index(list, count, op));
+  jerry_release_value(list);
+  jerry_release_value(op);
+  gc_handle->band.changed = true;
+  return jerry_create_boolean(true);
+}
+
+/**
+ * Record the drawing call instead of drawing in a banded context
+ */
+#define GC_BAND_RECORD()                                                    \
+  {                                                                         \
+    jerry_value_t recorded =                                                \
+        gc_band_record(gc_handle, this_val, func_value, args_p, args_cnt); \
+    if (jerry_value_is_error(recorded)) {                                   \
+      return recorded;                                                      \
+    }                                                                       \
+    if (jerry_get_boolean_value(recorded)) {                                \
+      return jerry_create_undefined();                                      \
+    }                                                                       \
+  }
+
+/**
+ * Record the state change in a banded context, and apply it as well
+ */
+#define GC_BAND_RECORD_STATE()                                              \
+  {                                                                         \
+    jerry_value_t recorded =                                                \
+        gc_band_record(gc_handle, this_val, func_value, args_p, args_cnt); \
+    if (jerry_value_is_error(recorded)) {                                   \
+      return recorded;                                                      \
+    }                                                                       \
+  }
+
 /* ************************************************************************** */
 /*                            GRAPHIC CONTEXT CLASS                           */
 /* ************************************************************************** */
@@ -59,8 +147,15 @@ JERRYXX_FUN(gc_ctor_fn) {
   gc_handle->fill_color = 1;
   gc_handle->font = NULL;
   gc_handle->font_color = 1;
+  gc_handle->font_background = false;
   gc_handle->font_scale_x = 1;
   gc_handle->font_scale_y = 1;
+  gc_handle->partial = false;
+  gc_clear_dirty(gc_handle);
+  gc_handle->band.rows = 0;
+  gc_handle->band.replaying = false;
+  gc_handle->rects = NULL;
+  gc_handle->rects_count = 0;
   jerry_set_object_native_pointer(this_val, gc_handle, &gc_handle_info);
 
   // read parameters
@@ -101,6 +196,29 @@ JERRYXX_FUN(gc_ctor_fn) {
       gc_handle->fill_rect_js_cb =
           fill_rect_js_cb;  // reference without acquire
       jerry_release_value(fill_rect_js_cb);
+
+      // fillRects callback (batched rects)
+      jerry_value_t fill_rects_js_cb =
+          jerryxx_get_property(options, MSTR_GRAPHICS_FILL_RECTS);
+      if (jerry_value_is_function(fill_rects_js_cb)) {
+        jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_FILLRECTS_CB,
+                             fill_rects_js_cb);
+        gc_handle->fill_rects_js_cb =
+            fill_rects_js_cb;  // reference without acquire
+        jerry_value_t rects = jerry_create_typedarray(
+            JERRY_TYPEDARRAY_UINT16, GC_CB_RECTS_MAX * 5);
+        jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_RECTS, rects);
+        gc_handle->rects_js = rects;  // reference without acquire
+        jerry_length_t byteOffset = 0;
+        jerry_length_t byteLength = 0;
+        jerry_value_t buffer =
+            jerry_get_typedarray_buffer(rects, &byteOffset, &byteLength);
+        gc_handle->rects =
+            (uint16_t *)(jerry_get_arraybuffer_pointer(buffer) + byteOffset);
+        jerry_release_value(buffer);
+        jerry_release_value(rects);
+      }
+      jerry_release_value(fill_rects_js_cb);
     }
   }
 
@@ -111,6 +229,7 @@ JERRYXX_FUN(gc_ctor_fn) {
   gc_handle->draw_vline_cb = gc_prim_cb_draw_vline;
   gc_handle->fill_rect_cb = gc_prim_cb_fill_rect;
   gc_handle->fill_screen_cb = gc_prim_cb_fill_screen;
+  gc_handle->copy_rect_cb = NULL;
 
   return jerry_create_undefined();
 }
@@ -153,7 +272,10 @@ JERRYXX_FUN(gc_color16_fn) {
  */
 JERRYXX_FUN(gc_clear_screen_fn) {
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  gc_band_reset(gc_handle, this_val);
+  GC_BAND_RECORD()
   gc_clear_screen(gc_handle);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -164,7 +286,10 @@ JERRYXX_FUN(gc_fill_screen_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "color")
   uint16_t color = (uint16_t)JERRYXX_GET_ARG_NUMBER(0);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  gc_band_reset(gc_handle, this_val);
+  GC_BAND_RECORD()
   gc_fill_screen(gc_handle, color);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -175,6 +300,7 @@ JERRYXX_FUN(gc_set_rotation_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "rotation")
   uint8_t rotation = (uint8_t)JERRYXX_GET_ARG_NUMBER(0);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD_STATE()
   gc_set_rotation(gc_handle, rotation);
   return jerry_create_undefined();
 }
@@ -195,6 +321,7 @@ JERRYXX_FUN(gc_set_color_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "color")
   uint16_t color = (uint16_t)JERRYXX_GET_ARG_NUMBER(0);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD_STATE()
   gc_set_color(gc_handle, color);
   return jerry_create_undefined();
 }
@@ -215,6 +342,7 @@ JERRYXX_FUN(gc_set_fill_color_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "color")
   uint16_t color = (uint16_t)JERRYXX_GET_ARG_NUMBER(0);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD_STATE()
   gc_set_fill_color(gc_handle, color);
   return jerry_create_undefined();
 }
@@ -229,13 +357,26 @@ JERRYXX_FUN(gc_get_fill_color_fn) {
 }
 
 /**
- * GraphicsContext.prototype.setFontColor(color)
+ * GraphicsContext.prototype.setFontColor(color, background)
+ * - background: fill text cells with the color (transparent if omitted)
  */
 JERRYXX_FUN(gc_set_font_color_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "color")
   uint16_t color = (uint16_t)JERRYXX_GET_ARG_NUMBER(0);
+  // undefined background is the same as omitted (transparent)
+  bool background =
+      JERRYXX_HAS_ARG(1) && !jerry_value_is_undefined(JERRYXX_GET_ARG(1));
+  if (background && !jerry_value_is_number(JERRYXX_GET_ARG(1))) {
+    return jerry_create_error(
+        JERRY_ERROR_TYPE,
+        (const jerry_char_t *)"\"background\" argument must be a number");
+  }
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD_STATE()
   gc_set_font_color(gc_handle, color);
+  gc_set_font_background(
+      gc_handle, background,
+      background ? (uint16_t)JERRYXX_GET_ARG_NUMBER(1) : 0);
   return jerry_create_undefined();
 }
 
@@ -256,18 +397,20 @@ JERRYXX_FUN(gc_set_font_fn) {
   if (JERRYXX_HAS_ARG(0)) {
     jerry_value_t font = JERRYXX_GET_ARG(0);
     JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+    GC_BAND_RECORD_STATE()
     if (jerry_value_is_object(font)) {
-      custom_font.first =
+      gc_font_t value = {0};
+      value.first =
           (uint8_t)jerryxx_get_property_number(font, MSTR_GRAPHICS_FIRST, 0);
-      custom_font.last =
+      value.last =
           (uint8_t)jerryxx_get_property_number(font, MSTR_GRAPHICS_LAST, 0);
-      custom_font.width =
+      value.width =
           (uint8_t)jerryxx_get_property_number(font, MSTR_GRAPHICS_WIDTH, 0);
-      custom_font.height =
+      value.height =
           (uint8_t)jerryxx_get_property_number(font, MSTR_GRAPHICS_HEIGHT, 0);
-      custom_font.advance_x = (uint8_t)jerryxx_get_property_number(
+      value.advance_x = (uint8_t)jerryxx_get_property_number(
           font, MSTR_GRAPHICS_ADVANCE_X, 0);
-      custom_font.advance_y = (uint8_t)jerryxx_get_property_number(
+      value.advance_y = (uint8_t)jerryxx_get_property_number(
           font, MSTR_GRAPHICS_ADVANCE_Y, 0);
       // get bitmap buffer
       jerry_value_t bitmap = jerryxx_get_property(font, MSTR_GRAPHICS_BITMAP);
@@ -278,11 +421,12 @@ JERRYXX_FUN(gc_set_font_fn) {
         jerry_length_t byteOffset = 0;
         jerry_value_t buffer =
             jerry_get_typedarray_buffer(bitmap, &byteOffset, &byteLength);
-        custom_font.bitmap = jerry_get_arraybuffer_pointer(buffer);
+        value.bitmap = jerry_get_arraybuffer_pointer(buffer);
         jerry_release_value(buffer);
         // } else if (jerry_value_is_string(bitmap)) {
-        //   custom_font.bitmap = NULL;
+        //   value.bitmap = NULL;
       } else {
+        jerry_release_value(bitmap);
         return jerry_create_error(
             JERRY_ERROR_TYPE,
             (const jerry_char_t *)"font.bitmap must be Uint8Array.");
@@ -296,13 +440,25 @@ JERRYXX_FUN(gc_set_font_fn) {
         jerry_length_t byteOffset = 0;
         jerry_value_t buffer =
             jerry_get_typedarray_buffer(glyphs, &byteOffset, &byteLength);
-        custom_font.glyphs =
+        value.glyphs =
             (gc_font_glyph_t *)jerry_get_arraybuffer_pointer(buffer);
         jerry_release_value(buffer);
         // } else if (jerry_value_is_string(glyphs)) {
-        //   custom_font.glyphs = NULL;
+        //   value.glyphs = NULL;
       }
       jerry_release_value(glyphs);
+      // setFont() is replayed for each band and fonts are often switched
+      // every frame, so keep the cached glyphs unless the font changed
+      bool changed = value.bitmap != custom_font.bitmap ||
+                     value.glyphs != custom_font.glyphs ||
+                     value.first != custom_font.first ||
+                     value.last != custom_font.last ||
+                     value.width != custom_font.width ||
+                     value.height != custom_font.height;
+      custom_font = value;
+      if (changed) {
+        gc_glyph_cache_invalidate(&custom_font);
+      }
       gc_handle->font = &custom_font;
     } else {
       gc_handle->font = NULL;
@@ -311,6 +467,18 @@ JERRYXX_FUN(gc_set_font_fn) {
   return jerry_create_undefined();
 }
 
+/**
+ * glyphCacheStats() -> {hits, misses}
+ */
+JERRYXX_FUN(glyph_cache_stats_fn) {
+  uint32_t hits, misses;
+  gc_glyph_cache_stats(&hits, &misses);
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, MSTR_GRAPHICS_HITS, hits);
+  jerryxx_set_property_number(obj, MSTR_GRAPHICS_MISSES, misses);
+  return obj;
+}
+
 /**
  * GraphicsContext.prototype.setFontScale(scaleX, scaleY)
  */
@@ -320,6 +488,7 @@ JERRYXX_FUN(gc_set_font_scale_fn) {
   int8_t scale_x = (int8_t)JERRYXX_GET_ARG_NUMBER(0);
   int8_t scale_y = (int8_t)JERRYXX_GET_ARG_NUMBER(1);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD_STATE()
   gc_set_font_scale(gc_handle, scale_x, scale_y);
   return jerry_create_undefined();
 }
@@ -335,7 +504,9 @@ JERRYXX_FUN(gc_set_pixel_fn) {
   int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
   uint16_t color = (uint16_t)JERRYXX_GET_ARG_NUMBER(2);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_set_pixel(gc_handle, x, y, color);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -365,7 +536,9 @@ JERRYXX_FUN(gc_draw_line_fn) {
   int16_t x1 = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
   int16_t y1 = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_draw_line(gc_handle, x0, y0, x1, y1);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -382,7 +555,9 @@ JERRYXX_FUN(gc_draw_rect_fn) {
   int16_t w = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
   int16_t h = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_draw_rect(gc_handle, x, y, w, h);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -399,7 +574,9 @@ JERRYXX_FUN(gc_fill_rect_fn) {
   int16_t w = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
   int16_t h = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_fill_rect(gc_handle, x, y, w, h);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -414,7 +591,9 @@ JERRYXX_FUN(gc_draw_circle_fn) {
   int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
   int16_t r = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_draw_circle(gc_handle, x, y, r);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -429,7 +608,142 @@ JERRYXX_FUN(gc_fill_circle_fn) {
   int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
   int16_t r = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_fill_circle(gc_handle, x, y, r);
+  gc_prim_cb_flush(gc_handle);
+  return jerry_create_undefined();
+}
+
+/**
+ * Get the points (x, y pairs) of Int16Array without copy, or of an array of
+ * numbers copied to a new allocation (*copied is set).
+ */
+static int16_t *gc_get_points(jerry_value_t points, uint16_t *n,
+                              bool *copied) {
+  *n = 0;
+  *copied = false;
+  if (jerry_value_is_typedarray(points)) {
+    if (jerry_get_typedarray_type(points) != JERRY_TYPEDARRAY_INT16) {
+      return NULL;
+    }
+    jerry_length_t byteOffset = 0;
+    jerry_length_t byteLength = 0;
+    jerry_value_t buffer =
+        jerry_get_typedarray_buffer(points, &byteOffset, &byteLength);
+    int16_t *data =
+        (int16_t *)(jerry_get_arraybuffer_pointer(buffer) + byteOffset);
+    jerry_release_value(buffer);
+    *n = (uint16_t)MIN(byteLength / 4, UINT16_MAX);
+    return data;
+  }
+  if (!jerry_value_is_array(points)) {
+    return NULL;
+  }
+  uint32_t len = MIN(jerry_get_array_length(points) / 2, UINT16_MAX);
+  int16_t *data = (int16_t *)malloc(len * 2 * sizeof(int16_t));
+  if (data == NULL) {
+    return NULL;
+  }
+  for (uint32_t i = 0; i < len * 2; i++) {
+    jerry_value_t value = jerry_get_property_by_index(points, i);
+    data[i] = (int16_t)jerry_get_number_value(value);
+    jerry_release_value(value);
+  }
+  *n = (uint16_t)len;
+  *copied = true;
+  return data;
+}
+
+/**
+ * GraphicsContext.prototype.fillPolygon(points)
+ * - points: Int16Array (or array) of x, y pairs
+ */
+JERRYXX_FUN(gc_fill_polygon_fn) {
+  JERRYXX_CHECK_ARG(0, "points")
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
+  uint16_t n;
+  bool copied;
+  int16_t *points = gc_get_points(JERRYXX_GET_ARG(0), &n, &copied);
+  if (points != NULL) {
+    gc_fill_polygon(gc_handle, points, n);
+    gc_prim_cb_flush(gc_handle);
+  }
+  if (copied) {
+    free(points);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * GraphicsContext.prototype.fillTriangle(x0, y0, x1, y1, x2, y2)
+ */
+JERRYXX_FUN(gc_fill_triangle_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "x0")
+  JERRYXX_CHECK_ARG_NUMBER(1, "y0")
+  JERRYXX_CHECK_ARG_NUMBER(2, "x1")
+  JERRYXX_CHECK_ARG_NUMBER(3, "y1")
+  JERRYXX_CHECK_ARG_NUMBER(4, "x2")
+  JERRYXX_CHECK_ARG_NUMBER(5, "y2")
+  int16_t x0 = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t y0 = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  int16_t x1 = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
+  int16_t y1 = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
+  int16_t x2 = (int16_t)JERRYXX_GET_ARG_NUMBER(4);
+  int16_t y2 = (int16_t)JERRYXX_GET_ARG_NUMBER(5);
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
+  gc_fill_triangle(gc_handle, x0, y0, x1, y1, x2, y2);
+  gc_prim_cb_flush(gc_handle);
+  return jerry_create_undefined();
+}
+
+/**
+ * GraphicsContext.prototype.drawPolyline(points, thickness)
+ * - points: Int16Array (or array) of x, y pairs
+ * - thickness: line thickness in pixels (default: 1)
+ */
+JERRYXX_FUN(gc_draw_polyline_fn) {
+  JERRYXX_CHECK_ARG(0, "points")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(1, "thickness")
+  uint16_t thickness = (uint16_t)JERRYXX_GET_ARG_NUMBER_OPT(1, 1);
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
+  uint16_t n;
+  bool copied;
+  int16_t *points = gc_get_points(JERRYXX_GET_ARG(0), &n, &copied);
+  if (points != NULL) {
+    gc_draw_polyline(gc_handle, points, n, thickness);
+    gc_prim_cb_flush(gc_handle);
+  }
+  if (copied) {
+    free(points);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * GraphicsContext.prototype.drawArc(x, y, r, startAngle, endAngle, thickness)
+ * - startAngle, endAngle: degrees, clockwise from 3 o'clock
+ * - thickness: line thickness in pixels (default: 1)
+ */
+JERRYXX_FUN(gc_draw_arc_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "x")
+  JERRYXX_CHECK_ARG_NUMBER(1, "y")
+  JERRYXX_CHECK_ARG_NUMBER(2, "r")
+  JERRYXX_CHECK_ARG_NUMBER(3, "startAngle")
+  JERRYXX_CHECK_ARG_NUMBER(4, "endAngle")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(5, "thickness")
+  int16_t x = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  int16_t r = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
+  float start_angle = (float)JERRYXX_GET_ARG_NUMBER(3);
+  float end_angle = (float)JERRYXX_GET_ARG_NUMBER(4);
+  uint16_t thickness = (uint16_t)JERRYXX_GET_ARG_NUMBER_OPT(5, 1);
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
+  gc_draw_arc(gc_handle, x, y, r, start_angle, end_angle, thickness);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -448,7 +762,9 @@ JERRYXX_FUN(gc_draw_roundrect_fn) {
   int16_t h = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
   int16_t r = (int16_t)JERRYXX_GET_ARG_NUMBER(4);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_draw_roundrect(gc_handle, x, y, w, h, r);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -467,7 +783,9 @@ JERRYXX_FUN(gc_fill_roundrect_fn) {
   int16_t h = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
   int16_t r = (int16_t)JERRYXX_GET_ARG_NUMBER(4);
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_fill_roundrect(gc_handle, x, y, w, h, r);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -482,7 +800,9 @@ JERRYXX_FUN(gc_draw_text_fn) {
   int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
   JERRYXX_GET_ARG_STRING_AS_CHAR(2, text)
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
   gc_draw_text(gc_handle, x, y, text);
+  gc_prim_cb_flush(gc_handle);
   return jerry_create_undefined();
 }
 
@@ -556,8 +876,11 @@ JERRYXX_FUN(gc_draw_bitmap_fn) {
         }
       }
 
-      // draw bitmap
+      // draw bitmap (if the data is large enough)
+      uint32_t bitmap_size =
+          bpp == 16 ? (uint32_t)w * h * 2 : (uint32_t)((w + 7) / 8) * h;
       JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+      GC_BAND_RECORD()
       jerry_value_t data = jerryxx_get_property(bitmap, MSTR_GRAPHICS_DATA);
       if (jerry_value_is_typedarray(data) &&
           jerry_get_typedarray_type(data) ==
@@ -566,9 +889,11 @@ JERRYXX_FUN(gc_draw_bitmap_fn) {
         jerry_length_t byteOffset = 0;
         jerry_value_t buffer =
             jerry_get_typedarray_buffer(data, &byteOffset, &byteLength);
-        uint8_t *buf = jerry_get_arraybuffer_pointer(buffer);
-        gc_draw_bitmap(gc_handle, x, y, buf, w, h, bpp, color, transparent,
-                       transparent_color, scale_x, scale_y, flip_x, flip_y);
+        uint8_t *buf = jerry_get_arraybuffer_pointer(buffer) + byteOffset;
+        if (byteLength >= bitmap_size) {
+          gc_draw_bitmap(gc_handle, x, y, buf, w, h, bpp, color, transparent,
+                         transparent_color, scale_x, scale_y, flip_x, flip_y);
+        }
         jerry_release_value(buffer);
       } else if (jerry_value_is_string(data)) { /* decode base64 string */
         jerry_value_t global = jerry_get_global_object();
@@ -580,9 +905,11 @@ JERRYXX_FUN(gc_draw_bitmap_fn) {
         jerry_length_t byteOffset = 0;
         jerry_value_t buffer =
             jerry_get_typedarray_buffer(decoded, &byteOffset, &byteLength);
-        uint8_t *buf = jerry_get_arraybuffer_pointer(buffer);
-        gc_draw_bitmap(gc_handle, x, y, buf, w, h, bpp, color, transparent,
-                       transparent_color, scale_x, scale_y, flip_x, flip_y);
+        uint8_t *buf = jerry_get_arraybuffer_pointer(buffer) + byteOffset;
+        if (byteLength >= bitmap_size) {
+          gc_draw_bitmap(gc_handle, x, y, buf, w, h, bpp, color, transparent,
+                         transparent_color, scale_x, scale_y, flip_x, flip_y);
+        }
         jerry_release_value(buffer);
         jerry_release_value(decoded);
         jerry_release_value(this_val);
@@ -594,23 +921,509 @@ JERRYXX_FUN(gc_draw_bitmap_fn) {
             (const jerry_char_t *)"bitmap.data must be Uint8Array or string.");
       }
       jerry_release_value(data);
+      gc_prim_cb_flush(gc_handle);
     }
   }
   return jerry_create_undefined();
 }
 
+/* ************************************************************************** */
+/*                      TILE MAP AND SPRITE LAYER CLASSES                     */
+/* ************************************************************************** */
+
+static const jerry_object_native_info_t gc_tilemap_info = {
+    .free_cb = gc_handle_freecb};
+
+static const jerry_object_native_info_t gc_sprite_layer_info = {
+    .free_cb = gc_handle_freecb};
+
+/**
+ * Pointer to the data of a typed array of the type with at least size bytes,
+ * or NULL
+ */
+static uint8_t *gc_typedarray_pointer(jerry_value_t array,
+                                      jerry_typedarray_type_t type,
+                                      uint32_t size) {
+  if (!jerry_value_is_typedarray(array) ||
+      jerry_get_typedarray_type(array) != type) {
+    return NULL;
+  }
+  jerry_length_t byteOffset = 0;
+  jerry_length_t byteLength = 0;
+  jerry_value_t buffer =
+      jerry_get_typedarray_buffer(array, &byteOffset, &byteLength);
+  uint8_t *pointer = jerry_get_arraybuffer_pointer(buffer) + byteOffset;
+  jerry_release_value(buffer);
+  return byteLength >= size ? pointer : NULL;
+}
+
+/**
+ * Read a bitmap ({width, height, bpp, data: Uint8Array}) and the color
+ * options of a layer. The data pointer is taken again before drawing.
+ */
+static bool gc_layer_bitmap(jerry_value_t bitmap, jerry_value_t options,
+                            gc_bitmap_t *bm) {
+  if (!jerry_value_is_object(bitmap)) {
+    return false;
+  }
+  bm->width = (int16_t)jerryxx_get_property_number(bitmap,
+                                                   MSTR_GRAPHICS_WIDTH, 0);
+  bm->height = (int16_t)jerryxx_get_property_number(bitmap,
+                                                    MSTR_GRAPHICS_HEIGHT, 0);
+  bm->bpp = (uint8_t)jerryxx_get_property_number(bitmap, MSTR_GRAPHICS_BPP, 1);
+  bm->color = (uint16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_COLOR, 0xffff);
+  jerry_value_t tp = jerryxx_get_property(options, MSTR_GRAPHICS_TRANSPARENT);
+  bm->transparent = jerry_value_is_number(tp);
+  bm->transparent_color =
+      bm->transparent ? (uint16_t)jerry_get_number_value(tp) : 0;
+  jerry_release_value(tp);
+  return (bm->bpp == 1 || bm->bpp == 16) && bm->width > 0 && bm->height > 0;
+}
+
+/**
+ * Take the data pointer of the bitmap in the property of a layer
+ */
+static bool gc_layer_bitmap_data(jerry_value_t layer, const char *name,
+                                 gc_bitmap_t *bm) {
+  jerry_value_t bitmap = jerryxx_get_property(layer, name);
+  jerry_value_t data = jerryxx_get_property(bitmap, MSTR_GRAPHICS_DATA);
+  uint32_t size = bm->bpp == 16 ? (uint32_t)bm->width * bm->height * 2
+                                : (uint32_t)((bm->width + 7) / 8) * bm->height;
+  bm->data = gc_typedarray_pointer(data, JERRY_TYPEDARRAY_UINT8, size);
+  jerry_release_value(data);
+  jerry_release_value(bitmap);
+  return bm->data != NULL;
+}
+
+/**
+ * Viewport of a TileMap or a SpriteLayer object, or NULL
+ */
+static gc_viewport_t *gc_get_viewport(jerry_value_t layer) {
+  void *pointer;
+  if (jerry_get_object_native_pointer(layer, &pointer, &gc_tilemap_info)) {
+    return &((gc_tilemap_t *)pointer)->view;
+  }
+  if (jerry_get_object_native_pointer(layer, &pointer,
+                                      &gc_sprite_layer_info)) {
+    return &((gc_sprite_layer_t *)pointer)->view;
+  }
+  return NULL;
+}
+
+/**
+ * TileMap(tileset, options) constructor
+ * - tileset: bitmap {width, height, bpp, data: Uint8Array}
+ * - options: {tileWidth, tileHeight, columns, rows, tiles, wrap, color,
+ *   transparent}. tiles is Uint8Array or Uint16Array of columns x rows tile
+ *   indexes (default: Uint16Array of empty tiles, 0xffff)
+ */
+JERRYXX_FUN(gc_tilemap_ctor_fn) {
+  JERRYXX_CHECK_ARG_OBJECT(0, "tileset")
+  JERRYXX_CHECK_ARG_OBJECT(1, "options")
+  jerry_value_t tileset = JERRYXX_GET_ARG(0);
+  jerry_value_t options = JERRYXX_GET_ARG(1);
+  gc_tilemap_t *map = (gc_tilemap_t *)calloc(1, sizeof(gc_tilemap_t));
+  if (map == NULL) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Not enough memory.");
+  }
+  jerry_set_object_native_pointer(this_val, map, &gc_tilemap_info);
+  map->tile_width = (int16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_TILE_WIDTH, 8);
+  map->tile_height = (int16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_TILE_HEIGHT, 8);
+  map->columns = (int16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_COLUMNS, 0);
+  map->rows =
+      (int16_t)jerryxx_get_property_number(options, MSTR_GRAPHICS_ROWS, 0);
+  map->wrap =
+      jerryxx_get_property_boolean(options, MSTR_GRAPHICS_WRAP, false);
+  if (!gc_layer_bitmap(tileset, options, &map->tileset) ||
+      map->tile_width <= 0 || map->tile_height <= 0 || map->columns <= 0 ||
+      map->rows <= 0) {
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Invalid tileset or map size.");
+  }
+  jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_TILESET, tileset);
+  uint32_t count = (uint32_t)map->columns * map->rows;
+  jerry_value_t tiles = jerryxx_get_property(options, MSTR_GRAPHICS_TILES);
+  if (!jerry_value_is_typedarray(tiles)) {
+    jerry_release_value(tiles);
+    tiles = jerry_create_typedarray(JERRY_TYPEDARRAY_UINT16, count);
+    uint8_t *pointer =
+        gc_typedarray_pointer(tiles, JERRY_TYPEDARRAY_UINT16, count * 2);
+    if (pointer != NULL) {
+      memset(pointer, 0xFF, count * 2);
+    }
+  }
+  jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_TILES, tiles);
+  jerry_release_value(tiles);
+  return jerry_create_undefined();
+}
+
+/**
+ * Take the pointer of the tiles of a tile map. Returns false if the tiles
+ * are not Uint8Array or Uint16Array of columns x rows.
+ */
+static bool gc_tilemap_tiles(jerry_value_t this_val, gc_tilemap_t *map) {
+  uint32_t count = (uint32_t)map->columns * map->rows;
+  jerry_value_t tiles = jerryxx_get_property(this_val, MSTR_GRAPHICS_TILES);
+  map->tile_bytes = 2;
+  map->tiles = gc_typedarray_pointer(tiles, JERRY_TYPEDARRAY_UINT16, count * 2);
+  if (map->tiles == NULL) {
+    map->tile_bytes = 1;
+    map->tiles = gc_typedarray_pointer(tiles, JERRY_TYPEDARRAY_UINT8, count);
+  }
+  jerry_release_value(tiles);
+  return map->tiles != NULL;
+}
+
+/**
+ * TileMap.prototype.setTile(column, row, index)
+ */
+JERRYXX_FUN(gc_tilemap_set_tile_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "column")
+  JERRYXX_CHECK_ARG_NUMBER(1, "row")
+  JERRYXX_CHECK_ARG_NUMBER(2, "index")
+  int16_t column = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t row = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  uint16_t index = (uint16_t)JERRYXX_GET_ARG_NUMBER(2);
+  JERRYXX_GET_NATIVE_HANDLE(map, gc_tilemap_t, gc_tilemap_info);
+  if (column >= 0 && column < map->columns && row >= 0 && row < map->rows &&
+      gc_tilemap_tiles(this_val, map)) {
+    uint32_t i = row * map->columns + column;
+    if (map->tile_bytes == 2) {
+      ((uint16_t *)map->tiles)[i] = index;
+    } else {
+      ((uint8_t *)map->tiles)[i] = (uint8_t)index;
+    }
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * TileMap.prototype.getTile(column, row) -> index (-1 if out of the map)
+ */
+JERRYXX_FUN(gc_tilemap_get_tile_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "column")
+  JERRYXX_CHECK_ARG_NUMBER(1, "row")
+  int16_t column = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t row = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  JERRYXX_GET_NATIVE_HANDLE(map, gc_tilemap_t, gc_tilemap_info);
+  if (column >= 0 && column < map->columns && row >= 0 && row < map->rows &&
+      gc_tilemap_tiles(this_val, map)) {
+    uint32_t i = row * map->columns + column;
+    return jerry_create_number(map->tile_bytes == 2
+                                   ? ((uint16_t *)map->tiles)[i]
+                                   : ((uint8_t *)map->tiles)[i]);
+  }
+  return jerry_create_number(-1);
+}
+
+/**
+ * SpriteLayer(sheet, options) constructor
+ * - sheet: bitmap {width, height, bpp, data: Uint8Array} of frames
+ * - options: {frameWidth, frameHeight, count, color, transparent}
+ * The sprites property is Int16Array of count records of (x, y, frame,
+ * flags, z). flags is VISIBLE | FLIP_X | FLIP_Y.
+ */
+JERRYXX_FUN(gc_sprite_layer_ctor_fn) {
+  JERRYXX_CHECK_ARG_OBJECT(0, "sheet")
+  JERRYXX_CHECK_ARG_OBJECT(1, "options")
+  jerry_value_t sheet = JERRYXX_GET_ARG(0);
+  jerry_value_t options = JERRYXX_GET_ARG(1);
+  gc_sprite_layer_t *layer =
+      (gc_sprite_layer_t *)calloc(1, sizeof(gc_sprite_layer_t));
+  if (layer == NULL) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Not enough memory.");
+  }
+  jerry_set_object_native_pointer(this_val, layer, &gc_sprite_layer_info);
+  layer->frame_width = (int16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_FRAME_WIDTH, 8);
+  layer->frame_height = (int16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_FRAME_HEIGHT, 8);
+  layer->count = (uint16_t)jerryxx_get_property_number(
+      options, MSTR_GRAPHICS_COUNT, 16);
+  if (!gc_layer_bitmap(sheet, options, &layer->sheet) ||
+      layer->frame_width <= 0 || layer->frame_height <= 0) {
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Invalid sheet or frame size.");
+  }
+  jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_SHEET, sheet);
+  jerry_value_t sprites = jerry_create_typedarray(
+      JERRY_TYPEDARRAY_INT16, layer->count * GC_SPRITE_FIELDS);
+  jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_SPRITES, sprites);
+  jerry_release_value(sprites);
+  return jerry_create_undefined();
+}
+
+/**
+ * SpriteLayer.prototype.setSprite(i, x, y, frame, flags, z)
+ * - flags: default VISIBLE
+ * - z: default 0
+ */
+JERRYXX_FUN(gc_sprite_layer_set_sprite_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "i")
+  JERRYXX_CHECK_ARG_NUMBER(1, "x")
+  JERRYXX_CHECK_ARG_NUMBER(2, "y")
+  JERRYXX_CHECK_ARG_NUMBER(3, "frame")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "flags")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(5, "z")
+  uint16_t i = (uint16_t)JERRYXX_GET_ARG_NUMBER(0);
+  JERRYXX_GET_NATIVE_HANDLE(layer, gc_sprite_layer_t, gc_sprite_layer_info);
+  jerry_value_t sprites =
+      jerryxx_get_property(this_val, MSTR_GRAPHICS_SPRITES);
+  int16_t *records = (int16_t *)gc_typedarray_pointer(
+      sprites, JERRY_TYPEDARRAY_INT16,
+      layer->count * GC_SPRITE_FIELDS * sizeof(int16_t));
+  jerry_release_value(sprites);
+  if (records != NULL && i < layer->count) {
+    int16_t *sprite = records + i * GC_SPRITE_FIELDS;
+    sprite[0] = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+    sprite[1] = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
+    sprite[2] = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
+    sprite[3] = (int16_t)JERRYXX_GET_ARG_NUMBER_OPT(4, GC_SPRITE_VISIBLE);
+    sprite[4] = (int16_t)JERRYXX_GET_ARG_NUMBER_OPT(5, 0);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * TileMap.prototype.setScroll(x, y), SpriteLayer.prototype.setScroll(x, y)
+ * Set the point of the layer shown at the top-left of the viewport.
+ */
+JERRYXX_FUN(gc_layer_set_scroll_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "x")
+  JERRYXX_CHECK_ARG_NUMBER(1, "y")
+  gc_viewport_t *view = gc_get_viewport(this_val);
+  if (view == NULL) {
+    return jerry_create_error(
+        JERRY_ERROR_REFERENCE,
+        (const jerry_char_t *)"Failed to get native handle");
+  }
+  view->scroll_x = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  view->scroll_y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  return jerry_create_undefined();
+}
+
+/**
+ * TileMap.prototype.setViewport(x, y, w, h),
+ * SpriteLayer.prototype.setViewport(x, y, w, h)
+ * Clip the layer to the rect of the screen (the whole screen if w is 0).
+ */
+JERRYXX_FUN(gc_layer_set_viewport_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "x")
+  JERRYXX_CHECK_ARG_NUMBER(1, "y")
+  JERRYXX_CHECK_ARG_NUMBER(2, "w")
+  JERRYXX_CHECK_ARG_NUMBER(3, "h")
+  gc_viewport_t *view = gc_get_viewport(this_val);
+  if (view == NULL) {
+    return jerry_create_error(
+        JERRY_ERROR_REFERENCE,
+        (const jerry_char_t *)"Failed to get native handle");
+  }
+  view->x = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  view->y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  view->width = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
+  view->height = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
+  return jerry_create_undefined();
+}
+
+/**
+ * GraphicsContext.prototype.drawTileMap(map)
+ */
+JERRYXX_FUN(gc_draw_tilemap_fn) {
+  JERRYXX_CHECK_ARG_OBJECT(0, "map")
+  jerry_value_t map_val = JERRYXX_GET_ARG(0);
+  void *pointer;
+  if (!jerry_get_object_native_pointer(map_val, &pointer, &gc_tilemap_info)) {
+    return jerry_create_error(JERRY_ERROR_TYPE,
+                              (const jerry_char_t *)"map must be TileMap.");
+  }
+  gc_tilemap_t *map = (gc_tilemap_t *)pointer;
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
+  if (gc_layer_bitmap_data(map_val, MSTR_GRAPHICS_TILESET, &map->tileset) &&
+      gc_tilemap_tiles(map_val, map)) {
+    gc_draw_tilemap(gc_handle, map);
+    gc_prim_cb_flush(gc_handle);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * GraphicsContext.prototype.drawSpriteLayer(layer)
+ */
+JERRYXX_FUN(gc_draw_sprite_layer_fn) {
+  JERRYXX_CHECK_ARG_OBJECT(0, "layer")
+  jerry_value_t layer_val = JERRYXX_GET_ARG(0);
+  void *pointer;
+  if (!jerry_get_object_native_pointer(layer_val, &pointer,
+                                       &gc_sprite_layer_info)) {
+    return jerry_create_error(
+        JERRY_ERROR_TYPE, (const jerry_char_t *)"layer must be SpriteLayer.");
+  }
+  gc_sprite_layer_t *layer = (gc_sprite_layer_t *)pointer;
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  GC_BAND_RECORD()
+  jerry_value_t sprites =
+      jerryxx_get_property(layer_val, MSTR_GRAPHICS_SPRITES);
+  layer->sprites = (int16_t *)gc_typedarray_pointer(
+      sprites, JERRY_TYPEDARRAY_INT16,
+      layer->count * GC_SPRITE_FIELDS * sizeof(int16_t));
+  jerry_release_value(sprites);
+  if (layer->sprites != NULL &&
+      gc_layer_bitmap_data(layer_val, MSTR_GRAPHICS_SHEET, &layer->sheet)) {
+    gc_draw_sprite_layer(gc_handle, layer);
+    gc_prim_cb_flush(gc_handle);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Create the dirty region object passed to the display callback. The region
+ * is in device space and its data is a view of the rows in the buffer (pages
+ * of 8 rows for 1-bit buffer, so y and height are aligned to 8). The rows
+ * must be in the current band.
+ */
+static jerry_value_t create_dirty_region(gc_handle_t *gc_handle,
+                                         jerry_value_t buffer, int16_t x,
+                                         int16_t y, int16_t w, int16_t h) {
+  uint32_t stride;
+  uint32_t offset;
+  uint32_t length;
+  if (gc_handle->bpp == 1) {
+    int16_t y1 = MIN(((y + h + 7) / 8) * 8, gc_handle->device_height);
+    y = (y / 8) * 8;
+    h = y1 - y;
+    stride = gc_handle->device_width;
+    offset = ((y - gc_handle->band.y) / 8) * stride;
+    length = ((h + 7) / 8) * stride;
+  } else {
+    stride = gc_handle->bpp == 3 ? gc_handle->device_width / 2
+                                 : gc_handle->device_width * 2;
+    offset = (y - gc_handle->band.y) * stride;
+    length = h * stride;
+  }
+  jerry_value_t region = jerry_create_object();
+  jerryxx_set_property_number(region, MSTR_GRAPHICS_X, x);
+  jerryxx_set_property_number(region, MSTR_GRAPHICS_Y, y);
+  jerryxx_set_property_number(region, MSTR_GRAPHICS_WIDTH, w);
+  jerryxx_set_property_number(region, MSTR_GRAPHICS_HEIGHT, h);
+  jerryxx_set_property_number(region, MSTR_GRAPHICS_STRIDE, stride);
+  jerry_length_t byteOffset = 0;
+  jerry_length_t byteLength = 0;
+  jerry_value_t arraybuffer =
+      jerry_get_typedarray_buffer(buffer, &byteOffset, &byteLength);
+  jerry_value_t data = jerry_create_typedarray_for_arraybuffer_sz(
+      JERRY_TYPEDARRAY_UINT8, arraybuffer, byteOffset + offset, length);
+  jerryxx_set_property(region, MSTR_GRAPHICS_DATA, data);
+  jerry_release_value(data);
+  jerry_release_value(arraybuffer);
+  return region;
+}
+
+/**
+ * Render the display list for each band of rows and pass each band to the
+ * display callback.
+ */
+static jerry_value_t gc_display_bands(gc_handle_t *gc_handle,
+                                      jerry_value_t this_val,
+                                      jerry_value_t buffer) {
+  jerry_value_t ret_val = jerry_create_undefined();
+  jerry_value_t list =
+      jerryxx_get_property(this_val, MSTR_GRAPHICS_DISPLAY_LIST);
+  uint32_t count = jerry_get_array_length(list);
+  gc_state_t state;
+  gc_save_state(gc_handle, &state);
+  gc_handle->band.replaying = true;
+  for (int16_t y = 0; y < gc_handle->device_height;
+       y += gc_handle->band.rows) {
+    gc_handle->band.y = y;
+    gc_handle->band.height =
+        MIN(gc_handle->band.rows, gc_handle->device_height - y);
+    memset(gc_handle->buffer, 0, gc_handle->buffer_size);
+    gc_restore_state(gc_handle, &gc_handle->band.state);
+    for (uint32_t i = 0; i < count && !jerry_value_is_error(ret_val); i++) {
+      jerry_value_t op = jerry_get_property_by_index(list, i);
+      jerry_value_t fn = jerry_get_property_by_index(op, 0);
+      jerry_value_t args[GC_BAND_MAX_ARGS];
+      jerry_length_t args_cnt =
+          MIN(jerry_get_array_length(op) - 1, GC_BAND_MAX_ARGS);
+      for (jerry_length_t k = 0; k < args_cnt; k++) {
+        args[k] = jerry_get_property_by_index(op, k + 1);
+      }
+      jerry_release_value(ret_val);
+      ret_val = jerry_call_function(fn, this_val, args, args_cnt);
+      for (jerry_length_t k = 0; k < args_cnt; k++) {
+        jerry_release_value(args[k]);
+      }
+      jerry_release_value(fn);
+      jerry_release_value(op);
+    }
+    if (jerry_value_is_error(ret_val)) {
+      break;
+    }
+    jerry_value_t this_ = jerry_create_undefined();
+    jerry_value_t args[] = {buffer,
+                            create_dirty_region(gc_handle, buffer, 0, y,
+                                                gc_handle->device_width,
+                                                gc_handle->band.height)};
+    jerry_release_value(ret_val);
+    ret_val = jerry_call_function(gc_handle->display_js_cb, this_, args, 2);
+    jerry_release_value(args[1]);
+    jerry_release_value(this_);
+    if (jerry_value_is_error(ret_val)) {
+      break;
+    }
+  }
+  gc_handle->band.replaying = false;
+  gc_handle->band.changed = false;
+  gc_handle->band.y = 0;
+  gc_handle->band.height = gc_handle->band.rows;
+  gc_restore_state(gc_handle, &state);
+  jerry_release_value(list);
+  return ret_val;
+}
+
 /**
  * GraphicsContext.prototype.display() function
  */
 JERRYXX_FUN(gc_display_fn) {
   JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
   if (jerry_value_is_function(gc_handle->display_js_cb)) {
+    if (gc_handle->band.rows > 0) {
+      if (!gc_handle->band.changed) {
+        return jerry_create_undefined();  // nothing changed
+      }
+      jerry_value_t buffer =
+          jerryxx_get_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_BUFFER);
+      jerry_value_t ret_val =
+          gc_display_bands(gc_handle, JERRYXX_GET_THIS, buffer);
+      jerry_release_value(buffer);
+      return ret_val;
+    }
+    int16_t x, y, w, h;
+    if (gc_handle->partial && !gc_get_dirty(gc_handle, &x, &y, &w, &h)) {
+      return jerry_create_undefined();  // nothing changed
+    }
     jerry_value_t buffer =
         jerryxx_get_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_BUFFER);
     jerry_value_t this_ = jerry_create_undefined();
-    jerry_value_t args[] = {buffer};
+    jerry_value_t args[] = {buffer, jerry_create_undefined()};
+    jerry_size_t args_cnt = 1;
+    if (gc_handle->partial) {
+      args[1] = create_dirty_region(gc_handle, buffer, x, y, w, h);
+      args_cnt = 2;
+    }
+    gc_clear_dirty(gc_handle);
     jerry_value_t ret_val =
-        jerry_call_function(gc_handle->display_js_cb, this_, args, 1);
+        jerry_call_function(gc_handle->display_js_cb, this_, args, args_cnt);
+    jerry_release_value(args[1]);
     jerry_release_value(buffer);
     jerry_release_value(this_);
     return ret_val;
@@ -619,6 +1432,106 @@ JERRYXX_FUN(gc_display_fn) {
   }
 }
 
+/**
+ * BufferedGraphicsContext.prototype.invalidate() function. Mark the whole
+ * buffer dirty, e.g. after writing to the buffer directly.
+ */
+JERRYXX_FUN(gc_invalidate_fn) {
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  gc_mark_dirty_all(gc_handle);
+  gc_handle->band.changed = true;
+  return jerry_create_undefined();
+}
+
+/**
+ * Error for the buffer operations not supported in banded mode (the buffer
+ * holds only a band of rows)
+ */
+static jerry_value_t gc_band_error() {
+  return jerry_create_error(
+      JERRY_ERROR_COMMON,
+      (const jerry_char_t *)"Not supported in banded mode.");
+}
+
+/**
+ * BufferedGraphicsContext.prototype.scroll(dx, dy, color) function. Move the
+ * screen by (dx, dy) and fill the uncovered area with the color (default: 0).
+ */
+JERRYXX_FUN(gc_scroll_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "dx")
+  JERRYXX_CHECK_ARG_NUMBER(1, "dy")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "color")
+  int16_t dx = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t dy = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  uint16_t color = (uint16_t)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  if (gc_handle->band.rows > 0) {
+    return gc_band_error();
+  }
+  gc_scroll(gc_handle, dx, dy, color);
+  return jerry_create_undefined();
+}
+
+/**
+ * BufferedGraphicsContext.prototype.copyRect(sx, sy, w, h, dx, dy) function.
+ * Overlapping rects are copied safely.
+ */
+JERRYXX_FUN(gc_copy_rect_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "sx")
+  JERRYXX_CHECK_ARG_NUMBER(1, "sy")
+  JERRYXX_CHECK_ARG_NUMBER(2, "w")
+  JERRYXX_CHECK_ARG_NUMBER(3, "h")
+  JERRYXX_CHECK_ARG_NUMBER(4, "dx")
+  JERRYXX_CHECK_ARG_NUMBER(5, "dy")
+  int16_t sx = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t sy = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  int16_t w = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
+  int16_t h = (int16_t)JERRYXX_GET_ARG_NUMBER(3);
+  int16_t dx = (int16_t)JERRYXX_GET_ARG_NUMBER(4);
+  int16_t dy = (int16_t)JERRYXX_GET_ARG_NUMBER(5);
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  if (gc_handle->band.rows > 0) {
+    return gc_band_error();
+  }
+  gc_copy_rect(gc_handle, gc_handle, sx, sy, w, h, dx, dy);
+  return jerry_create_undefined();
+}
+
+/**
+ * BufferedGraphicsContext.prototype.blit(src, x, y, sx, sy, w, h) function.
+ * Copy a rect of another buffered context (default: the whole) to (x, y).
+ */
+JERRYXX_FUN(gc_blit_fn) {
+  JERRYXX_CHECK_ARG_OBJECT(0, "src")
+  JERRYXX_CHECK_ARG_NUMBER(1, "x")
+  JERRYXX_CHECK_ARG_NUMBER(2, "y")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(3, "sx")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "sy")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(5, "w")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(6, "h")
+  void *src_pointer;
+  if (!jerry_get_object_native_pointer(JERRYXX_GET_ARG(0), &src_pointer,
+                                       &gc_handle_info) ||
+      ((gc_handle_t *)src_pointer)->copy_rect_cb == NULL) {
+    return jerry_create_error(
+        JERRY_ERROR_TYPE,
+        (const jerry_char_t *)"src must be BufferedGraphicsContext.");
+  }
+  gc_handle_t *src = (gc_handle_t *)src_pointer;
+  int16_t x = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(2);
+  int16_t sx = (int16_t)JERRYXX_GET_ARG_NUMBER_OPT(3, 0);
+  int16_t sy = (int16_t)JERRYXX_GET_ARG_NUMBER_OPT(4, 0);
+  int16_t w = (int16_t)JERRYXX_GET_ARG_NUMBER_OPT(5, src->width);
+  int16_t h = (int16_t)JERRYXX_GET_ARG_NUMBER_OPT(6, src->height);
+  JERRYXX_GET_NATIVE_HANDLE(gc_handle, gc_handle_t, gc_handle_info);
+  if (gc_handle->band.rows > 0 || src->band.rows > 0) {
+    return gc_band_error();
+  }
+  gc_copy_rect(gc_handle, src, sx, sy, w, h, x, y);
+  return jerry_create_undefined();
+}
+
 /* ************************************************************************** */
 /*                       BUFFERED GRAPHIC CONTEXT CLASS                       */
 /* ************************************************************************** */
@@ -637,8 +1550,15 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
   gc_handle->fill_color = 1;
   gc_handle->font = NULL;
   gc_handle->font_color = 1;
+  gc_handle->font_background = false;
   gc_handle->font_scale_x = 1;
   gc_handle->font_scale_y = 1;
+  gc_handle->partial = true;
+  gc_handle->band.rows = 0;
+  gc_handle->band.replaying = false;
+  gc_handle->rects = NULL;
+  gc_handle->rects_count = 0;
+  gc_handle->band.changed = true;
   jerry_set_object_native_pointer(this_val, gc_handle, &gc_handle_info);
 
   // read parameters
@@ -663,12 +1583,25 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
         gc_handle->bpp = 1;
       }
 
+      // banded rendering
+      gc_handle->band.rows = (int16_t)jerryxx_get_property_number(
+          options, MSTR_GRAPHICS_BAND_HEIGHT, 0);
+
       // display callback
       jerry_value_t display_js_cb =
           jerryxx_get_property(options, MSTR_GRAPHICS_DISPLAY);
       jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_DISPLAY_CB,
                            display_js_cb);
       gc_handle->display_js_cb = display_js_cb;  // reference without acquire
+
+      // partial display (dirty region). Callbacks declared with only the
+      // buffer parameter get the full frame on every display() as before,
+      // since they may rely on writes to the buffer made outside of gc.
+      bool region_arg = jerry_value_is_function(display_js_cb) &&
+                        jerryxx_get_property_number(
+                            display_js_cb, MSTR_GRAPHICS_LENGTH, 0) >= 2;
+      gc_handle->partial = jerryxx_get_property_boolean(
+          options, MSTR_GRAPHICS_PARTIAL, region_arg);
       jerry_release_value(display_js_cb);
     }
   }
@@ -681,6 +1614,7 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
     gc_handle->draw_vline_cb = gc_prim_1bit_draw_vline;
     gc_handle->fill_rect_cb = gc_prim_1bit_fill_rect;
     gc_handle->fill_screen_cb = gc_prim_1bit_fill_screen;
+    gc_handle->copy_rect_cb = gc_prim_1bit_copy_rect;
   } else if (gc_handle->bpp == 3) {
     gc_handle->set_pixel_cb = gc_prim_3bit_set_pixel;
     gc_handle->get_pixel_cb = gc_prim_3bit_get_pixel;
@@ -688,6 +1622,7 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
     gc_handle->draw_vline_cb = gc_prim_3bit_draw_vline;
     gc_handle->fill_rect_cb = gc_prim_3bit_fill_rect;
     gc_handle->fill_screen_cb = gc_prim_3bit_fill_screen;
+    gc_handle->copy_rect_cb = gc_prim_3bit_copy_rect;
   } else {
     gc_handle->set_pixel_cb = gc_prim_16bit_set_pixel;
     gc_handle->get_pixel_cb = gc_prim_16bit_get_pixel;
@@ -695,10 +1630,25 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
     gc_handle->draw_vline_cb = gc_prim_16bit_draw_vline;
     gc_handle->fill_rect_cb = gc_prim_16bit_fill_rect;
     gc_handle->fill_screen_cb = gc_prim_16bit_fill_screen;
+    gc_handle->copy_rect_cb = gc_prim_16bit_copy_rect;
   }
 
-  // allocate buffer
-  size_t size = gc_handle->device_width * gc_handle->device_height;
+  // band of rows (multiple of 8 rows for 1-bit pages)
+  if (gc_handle->band.rows <= 0 ||
+      gc_handle->band.rows >= gc_handle->device_height) {
+    gc_handle->band.rows = 0;
+    gc_handle->band.height = gc_handle->device_height;
+  } else {
+    if (gc_handle->bpp == 1) {
+      gc_handle->band.rows = ((gc_handle->band.rows + 7) / 8) * 8;
+    }
+    gc_handle->band.height = gc_handle->band.rows;
+  }
+  gc_handle->band.y = 0;
+  gc_band_reset(gc_handle, JERRYXX_GET_THIS);
+
+  // allocate buffer from system memory (outside of the JS heap)
+  uint32_t size = (uint32_t)gc_handle->device_width * gc_handle->band.height;
   if (gc_handle->bpp == 1) {
     size = size / 8;
   } else if (gc_handle->bpp == 3) {
@@ -706,16 +1656,24 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
   } else {
     size = size * 2;
   }
-  jerry_value_t buffer = jerry_create_typedarray(JERRY_TYPEDARRAY_UINT8, size);
+  uint8_t *fb = (uint8_t *)calloc(size, 1);
+  if (fb == NULL) {
+    gc_handle->buffer = NULL;
+    gc_handle->buffer_size = 0;
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Not enough memory for the buffer.");
+  }
+  jerry_value_t arraybuffer =
+      jerry_create_arraybuffer_external(size, fb, gc_buffer_freecb);
+  jerry_value_t buffer = jerry_create_typedarray_for_arraybuffer(
+      JERRY_TYPEDARRAY_UINT8, arraybuffer);
   jerryxx_set_property(JERRYXX_GET_THIS, MSTR_GRAPHICS_BUFFER, buffer);
-  jerry_length_t byteOffset = 0;
-  jerry_length_t byteLength = 0;
-  jerry_value_t buf =
-      jerry_get_typedarray_buffer(buffer, &byteOffset, &byteLength);
-  gc_handle->buffer = jerry_get_arraybuffer_pointer(buf);
+  gc_handle->buffer = fb;
   gc_handle->buffer_size = size;
-  jerry_release_value(buf);
+  gc_mark_dirty_all(gc_handle);
   jerry_release_value(buffer);
+  jerry_release_value(arraybuffer);
   return jerry_create_undefined();
 }
 
@@ -773,6 +1731,14 @@ jerry_value_t module_graphics_init() {
                                 gc_draw_circle_fn);
   jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_FILL_CIRCLE,
                                 gc_fill_circle_fn);
+  jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_FILL_POLYGON,
+                                gc_fill_polygon_fn);
+  jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_FILL_TRIANGLE,
+                                gc_fill_triangle_fn);
+  jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_DRAW_POLYLINE,
+                                gc_draw_polyline_fn);
+  jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_DRAW_ARC,
+                                gc_draw_arc_fn);
   jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_DRAW_ROUNDRECT,
                                 gc_draw_roundrect_fn);
   jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_FILL_ROUNDRECT,
@@ -781,6 +1747,10 @@ jerry_value_t module_graphics_init() {
                                 gc_draw_text_fn);
   jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_MEASURE_TEXT,
                                 gc_measure_text_fn);
+  jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_DRAW_TILE_MAP,
+                                gc_draw_tilemap_fn);
+  jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_DRAW_SPRITE_LAYER,
+                                gc_draw_sprite_layer_fn);
   jerryxx_set_property_function(gc_prototype, MSTR_GRAPHICS_DRAW_BITMAP,
                                 gc_draw_bitmap_fn);
   jerry_release_value(gc_prototype);
@@ -839,6 +1809,17 @@ jerry_value_t module_graphics_init() {
                                 MSTR_GRAPHICS_DRAW_CIRCLE, gc_draw_circle_fn);
   jerryxx_set_property_function(buffered_gc_prototype,
                                 MSTR_GRAPHICS_FILL_CIRCLE, gc_fill_circle_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_FILL_POLYGON,
+                                gc_fill_polygon_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_FILL_TRIANGLE,
+                                gc_fill_triangle_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_DRAW_POLYLINE,
+                                gc_draw_polyline_fn);
+  jerryxx_set_property_function(buffered_gc_prototype, MSTR_GRAPHICS_DRAW_ARC,
+                                gc_draw_arc_fn);
   jerryxx_set_property_function(buffered_gc_prototype,
                                 MSTR_GRAPHICS_DRAW_ROUNDRECT,
                                 gc_draw_roundrect_fn);
@@ -851,17 +1832,74 @@ jerry_value_t module_graphics_init() {
                                 MSTR_GRAPHICS_MEASURE_TEXT, gc_measure_text_fn);
   jerryxx_set_property_function(buffered_gc_prototype,
                                 MSTR_GRAPHICS_DRAW_BITMAP, gc_draw_bitmap_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_DRAW_TILE_MAP,
+                                gc_draw_tilemap_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_DRAW_SPRITE_LAYER,
+                                gc_draw_sprite_layer_fn);
   jerryxx_set_property_function(buffered_gc_prototype, MSTR_GRAPHICS_DISPLAY,
                                 gc_display_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_INVALIDATE, gc_invalidate_fn);
+  jerryxx_set_property_function(buffered_gc_prototype, MSTR_GRAPHICS_SCROLL,
+                                gc_scroll_fn);
+  jerryxx_set_property_function(buffered_gc_prototype,
+                                MSTR_GRAPHICS_COPY_RECT, gc_copy_rect_fn);
+  jerryxx_set_property_function(buffered_gc_prototype, MSTR_GRAPHICS_BLIT,
+                                gc_blit_fn);
   jerry_release_value(buffered_gc_prototype);
 
+  /* TileMap class */
+  jerry_value_t tilemap_ctor =
+      jerry_create_external_function(gc_tilemap_ctor_fn);
+  jerry_value_t tilemap_prototype = jerry_create_object();
+  jerryxx_set_property(tilemap_ctor, "prototype", tilemap_prototype);
+  jerryxx_set_property_function(tilemap_prototype, MSTR_GRAPHICS_SET_TILE,
+                                gc_tilemap_set_tile_fn);
+  jerryxx_set_property_function(tilemap_prototype, MSTR_GRAPHICS_GET_TILE,
+                                gc_tilemap_get_tile_fn);
+  jerryxx_set_property_function(tilemap_prototype, MSTR_GRAPHICS_SET_SCROLL,
+                                gc_layer_set_scroll_fn);
+  jerryxx_set_property_function(tilemap_prototype, MSTR_GRAPHICS_SET_VIEWPORT,
+                                gc_layer_set_viewport_fn);
+  jerry_release_value(tilemap_prototype);
+
+  /* SpriteLayer class */
+  jerry_value_t sprite_layer_ctor =
+      jerry_create_external_function(gc_sprite_layer_ctor_fn);
+  jerry_value_t sprite_layer_prototype = jerry_create_object();
+  jerryxx_set_property(sprite_layer_ctor, "prototype", sprite_layer_prototype);
+  jerryxx_set_property_function(sprite_layer_prototype,
+                                MSTR_GRAPHICS_SET_SPRITE,
+                                gc_sprite_layer_set_sprite_fn);
+  jerryxx_set_property_function(sprite_layer_prototype,
+                                MSTR_GRAPHICS_SET_SCROLL,
+                                gc_layer_set_scroll_fn);
+  jerryxx_set_property_function(sprite_layer_prototype,
+                                MSTR_GRAPHICS_SET_VIEWPORT,
+                                gc_layer_set_viewport_fn);
+  jerryxx_set_property_number(sprite_layer_ctor, MSTR_GRAPHICS_SPRITE_VISIBLE,
+                              GC_SPRITE_VISIBLE);
+  jerryxx_set_property_number(sprite_layer_ctor, MSTR_GRAPHICS_SPRITE_FLIP_X,
+                              GC_SPRITE_FLIP_X);
+  jerryxx_set_property_number(sprite_layer_ctor, MSTR_GRAPHICS_SPRITE_FLIP_Y,
+                              GC_SPRITE_FLIP_Y);
+  jerry_release_value(sprite_layer_prototype);
+
   /* graphics module exports */
   jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property_function(exports, MSTR_GRAPHICS_GLYPH_CACHE_STATS,
+                                glyph_cache_stats_fn);
   jerryxx_set_property(exports, MSTR_GRAPHICS_GRAPHICS_CONTEXT, gc_ctor);
   jerryxx_set_property(exports, MSTR_GRAPHICS_BUFFERED_GRAPHICS_CONTEXT,
                        buffered_gc_ctor);
+  jerryxx_set_property(exports, MSTR_GRAPHICS_TILE_MAP, tilemap_ctor);
+  jerryxx_set_property(exports, MSTR_GRAPHICS_SPRITE_LAYER, sprite_layer_ctor);
   jerry_release_value(gc_ctor);
   jerry_release_value(buffered_gc_ctor);
+  jerry_release_value(tilemap_ctor);
+  jerry_release_value(sprite_layer_ctor);
 
   return exports;
 }
@@ -1,5 +1,6 @@
 var stream = require('stream');
 var net = require('net');
+var {Buffer} = require('buffer');
 
 /**
  * HTTPParser class
@@ -24,7 +25,7 @@ class HTTPParser {
    */
   push(chunk) {
     if (chunk instanceof Uint8Array) {
-      this._buf += String.fromCharCode.apply(null, chunk);
+      this._buf += Buffer.prototype.toString.call(chunk, 'latin1');
     } else {
       this._buf += chunk;
     }
@@ -83,8 +84,7 @@ class HTTPParser {
           if (cl > 0) {
             if (this._buf.length >= idx + cl + 2) { // chunk received
               var chunk = this._buf.substr(idx + 2, cl)
-              var encoder = new TextEncoder('ascii');
-              this.incoming.push(encoder.encode(chunk));
+              this.incoming.push(Buffer.from(chunk, 'latin1'));
               this.body += chunk;
               this._buf = this._buf.substr(idx + 2 + cl + 2);
             } else { // data not received yet
@@ -102,8 +102,7 @@ class HTTPParser {
       if (this._buf.length >= len) {
         this.body = this._buf;
         this._buf = '';
-        var encoder = new TextEncoder('ascii');
-        this.incoming.push(encoder.encode(this.body));
+        this.incoming.push(Buffer.from(this.body, 'latin1'));
         this.end();
       }
     }
@@ -116,8 +115,7 @@ class HTTPParser {
   end() {
     if (!this.incoming.complete) {
       if (this._buf.length > 0) {
-        var encoder = new TextEncoder('ascii');
-        this.incoming.push(encoder.encode(this._buf));
+        this.incoming.push(Buffer.from(this._buf, 'latin1'));
         this._buf = '';
       }
       this.incoming.complete = true;
@@ -174,12 +172,14 @@ class OutgoingMessage extends stream.Writable {
   /**
    * Encode chunk
    * @param {Uint8Array|string} chunk
-   * @return {string}
+   * @return {Uint8Array|string}
    */
   _encodeChunk(chunk) {
-    if (chunk instanceof Uint8Array)
-      chunk = String.fromCharCode.apply(null, chunk);
-    return chunk.length.toString(16) + '\r\n' + chunk + '\r\n';
+    var head = chunk.length.toString(16) + '\r\n';
+    if (chunk instanceof Uint8Array) {
+      return Buffer.concat([Buffer.from(head), chunk, Buffer.from('\r\n')]);
+    }
+    return head + chunk + '\r\n';
   }
 
   /**
@@ -266,11 +266,12 @@ class ClientRequest extends OutgoingMessage {
       // Host header is required for HTTP/1.1
       this.setHeader('host', this.options.host)
     }
-    this._wbuf += `${this.options.method} ${this.path} HTTP/1.1\r\n`;
+    var head = `${this.options.method} ${this.path} HTTP/1.1\r\n`;
     for (var key in this.headers) {
-      this._wbuf += `${key}: ${this.headers[key]}\r\n`;
+      head += `${key}: ${this.headers[key]}\r\n`;
     }
-    this._wbuf += '\r\n'; // end of header
+    head += '\r\n'; // end of header
+    this._append(head);
   }
 
   /**
@@ -286,12 +287,10 @@ class ClientRequest extends OutgoingMessage {
       this.headersSent = true;
     }
     if (chunk) {
-      if (chunk instanceof Uint8Array)
-        chunk = String.fromCharCode.apply(null, chunk);
       if (this._isTransferChunked()) {
-        this._wbuf += this._encodeChunk(chunk);
+        this._append(this._encodeChunk(chunk));
       } else {
-        this._wbuf += chunk;
+        this._append(chunk);
       }
     }
     if (cb) cb();
@@ -311,12 +310,10 @@ class ClientRequest extends OutgoingMessage {
       this.headersSent = true;
     }
     if (chunk) {
-      if (chunk instanceof Uint8Array)
-        chunk = String.fromCharCode.apply(null, chunk);
       if (this._isTransferChunked()) {
-        this._wbuf += this._encodeChunk(chunk);
+        this._append(this._encodeChunk(chunk));
       } else {
-        this._wbuf += chunk;
+        this._append(chunk);
       }
     }
     this.socket.connect(this.options, () => {
@@ -389,7 +386,8 @@ class ServerResponse extends OutgoingMessage {
     }
     if (this._isTransferChunked()) {
       if (chunk) {
-        chunk = this._encodeChunk(chunk, true) + '0\r\n\r\n'; // end of body
+        this._append(this._encodeChunk(chunk));
+        chunk = '0\r\n\r\n'; // end of body
       } else {
         chunk = '0\r\n\r\n'; // end of body
       }
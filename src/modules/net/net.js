@@ -1,5 +1,6 @@
 var EventEmitter = require('events').EventEmitter;
 var stream = require('stream');
+var {Buffer} = require('buffer');
 
 /**
  * Socket class
@@ -37,7 +38,9 @@ class Socket extends stream.Duplex {
           this.emit('connect');
         }
         sck.close_cb = () => { this._afterDestroy() }
-        sck.read_cb = (data) => { this.push(data) }
+        sck.read_cb = (data) => {
+          this.push(Buffer.from(data.buffer, data.byteOffset, data.length));
+        }
         sck.shutdown_cb = () => { this._afterEnd() }
       }
     } else {
@@ -102,6 +105,12 @@ class Socket extends stream.Duplex {
    */
   _write(chunk, cb) {
     if (this._dev) {
+      // netdev.write(fd, data, cb) takes a string, or also a Uint8Array if
+      // the device sets binaryWrite (bytes are passed as latin1 otherwise)
+      if (typeof chunk !== 'string' && !this._dev.binaryWrite) {
+        chunk = Buffer.from(chunk.buffer, chunk.byteOffset, chunk.length)
+          .toString('latin1');
+      }
       this._dev.write(this._fd, chunk, (err) => {
         if (err) {
           if (cb) cb(new SystemError(this._dev.errno)); // eslint-disable-line
@@ -175,6 +175,18 @@ void km_cyw43_infinite_loop() {
   }
 }
 
+/**
+ * Wait for CYW43 work (or any other event) up to msec. Returns false if the
+ * driver is not initialized.
+ */
+bool km_cyw43_wait_for_work(uint32_t msec) {
+  if (__cyw43_drv.status_flag & KM_CYW43_STATUS_INIT) {
+    cyw43_arch_wait_for_work_until(make_timeout_time_ms(msec));
+    return true;
+  }
+  return false;
+}
+
 static int __cyw43_init() {
   int ret = 0;
   if (__cyw43_drv.status_flag == KM_CYW43_STATUS_DISABLED) {
@@ -1013,17 +1025,35 @@ JERRYXX_FUN(pico_cyw43_network_connect) {
 
 JERRYXX_FUN(pico_cyw43_network_write) {
   JERRYXX_CHECK_ARG_NUMBER(0, "fd");
-  JERRYXX_CHECK_ARG_STRING(1, "data");
+  JERRYXX_CHECK_ARG(1, "data");
   JERRYXX_CHECK_ARG_FUNCTION_OPT(2, "callback");
   int8_t fd = JERRYXX_GET_ARG_NUMBER(0);
   jerry_value_t data = JERRYXX_GET_ARG(1);
+  if (!jerry_value_is_string(data) && !jerry_value_is_typedarray(data)) {
+    return jerry_create_error(
+        JERRY_ERROR_TYPE,
+        (const jerry_char_t *)"The data argument must be Uint8Array or string.");
+  }
   if (km_is_valid_fd(fd) && (((__socket_info.socket[fd].ptcl == NET_SOCKET_DGRAM) &&
                           (__socket_info.socket[fd].state != NET_SOCKET_STATE_CLOSED)) ||
                          ((__socket_info.socket[fd].ptcl == NET_SOCKET_STREAM) &&
                           (__socket_info.socket[fd].state >= NET_SOCKET_STATE_CONNECTED)))) {
-    jerry_size_t data_str_sz = jerryxx_get_ascii_string_size(data);
-    char *data_str = calloc(1, data_str_sz + 1);
-    jerryxx_string_to_ascii_char_buffer(data, (uint8_t *)data_str, data_str_sz);
+    jerry_size_t data_str_sz = 0;
+    char *data_str = NULL;
+    char *data_alloc = NULL;
+    if (jerry_value_is_typedarray(data)) {
+      // send from the buffer memory directly (copied by lwip)
+      jerry_length_t byte_offset = 0;
+      jerry_value_t arrbuf =
+          jerry_get_typedarray_buffer(data, &byte_offset, &data_str_sz);
+      data_str = (char *)jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+      jerry_release_value(arrbuf);
+    } else {
+      data_str_sz = jerryxx_get_ascii_string_size(data);
+      data_alloc = data_str = calloc(1, data_str_sz + 1);
+      jerryxx_string_to_ascii_char_buffer(data, (uint8_t *)data_str,
+                                          data_str_sz);
+    }
     err_t err = ERR_OK;
     cyw43_arch_lwip_begin();
     if (__socket_info.socket[fd].ptcl == NET_SOCKET_STREAM) {
@@ -1048,7 +1078,7 @@ JERRYXX_FUN(pico_cyw43_network_write) {
       jerryxx_set_property_number(JERRYXX_GET_THIS,
                                   MSTR_PICO_CYW43_NETWORK_ERRNO, 0);
     }
-    free(data_str);
+    free(data_alloc);
   } else {
     jerryxx_set_property_number(JERRYXX_GET_THIS,
                                 MSTR_PICO_CYW43_NETWORK_ERRNO, -1);
@@ -1553,6 +1583,11 @@ jerry_value_t module_pico_cyw43_init() {
   jerryxx_set_property_function(network_prototype,
                                 MSTR_PICO_CYW43_NETWORK_WRITE,
                                 pico_cyw43_network_write);
+  // write() takes Uint8Array as well as string
+  jerry_value_t binary_write = jerry_create_boolean(true);
+  jerryxx_set_property(network_prototype, MSTR_PICO_CYW43_NETWORK_BINARY_WRITE,
+                       binary_write);
+  jerry_release_value(binary_write);
   jerryxx_set_property_function(network_prototype,
                                 MSTR_PICO_CYW43_NETWORK_CLOSE,
                                 pico_cyw43_network_close);
@@ -45,6 +45,7 @@
 #define MSTR_PICO_CYW43_NETWORK_GET "get"
 #define MSTR_PICO_CYW43_NETWORK_CONNECT "connect"
 #define MSTR_PICO_CYW43_NETWORK_WRITE "write"
+#define MSTR_PICO_CYW43_NETWORK_BINARY_WRITE "binaryWrite"
 #define MSTR_PICO_CYW43_NETWORK_CLOSE "close"
 #define MSTR_PICO_CYW43_NETWORK_SHUTDOWN "shutdown"
 #define MSTR_PICO_CYW43_NETWORK_BIND "bind"
@@ -22,7 +22,9 @@
 #include "module_sdcard.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "blkdev.h"
 #include "board.h"
 #include "err.h"
 #include "gpio.h"
@@ -85,8 +87,14 @@
 
 #define SD_STATUS_INIT 0x01
 
-#define SLOW_BAUDRATE 400000   /* 400 kHZ */
-#define FAST_BAUDRATE 25000000 /* 25 MHZ */
+#define SLOW_BAUDRATE 400000         /* 400 kHZ */
+#define FAST_BAUDRATE 25000000       /* 25 MHZ */
+#define HIGH_SPEED_BAUDRATE 50000000 /* 50 MHZ (high speed mode) */
+
+#define SD_TOKEN_START 0xFE /* start of a single block or a read block */
+#define SD_TOKEN_MULTI 0xFC /* start of a block of CMD25 */
+#define SD_TOKEN_STOP 0xFD  /* stop of CMD25 */
+#define SD_TOKEN_POLL 8     /* bytes received at once to find a token */
 
 #define CS_HIGH km_gpio_write(__sdcard_handle.cs_pin, KM_GPIO_HIGH)
 #define CS_LOW km_gpio_write(__sdcard_handle.cs_pin, KM_GPIO_LOW)
@@ -98,18 +106,19 @@ typedef struct __sdcard_handle_s {
   uint8_t sd_type;
   int size;
   int count;
+  uint32_t baudrate;  // max SPI clock after init
 } __sdcard_handle_t;
 
 static __sdcard_handle_t __sdcard_handle;
 
 static int __wait_for_ready(uint32_t timeout_ms) {
-  uint8_t send = 0xFF;
-  uint8_t receive;
+  uint8_t receive[SD_TOKEN_POLL];
   uint64_t start_ms = km_gettime();
   do {
-    km_spi_sendrecv(__sdcard_handle.bus, &send, &receive, 1, 100);
-  } while ((receive != 0xFF) && (km_gettime() < start_ms + timeout_ms));
-  if (receive == 0xFF) {
+    km_spi_recv(__sdcard_handle.bus, 0xFF, receive, SD_TOKEN_POLL, 100);
+  } while ((receive[SD_TOKEN_POLL - 1] != 0xFF) &&
+           (km_gettime() < start_ms + timeout_ms));
+  if (receive[SD_TOKEN_POLL - 1] == 0xFF) {
     return 0;
   }
   return ETIMEDOUT;
@@ -121,6 +130,13 @@ static void __deselect(void) {
   km_spi_send(__sdcard_handle.bus, &send, 1, 100);  // dummy clock
 }
 
+static void __release(void) {
+  uint8_t send = 0xFF;
+  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
+  CS_HIGH;
+  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
+}
+
 static int __select(void) {
   uint8_t send = 0xFF;
   CS_LOW;
@@ -184,65 +200,78 @@ static int __send_command(uint8_t command, uint32_t arg, uint8_t crc) {
   return ret;
 }
 
+/**
+ * Receive a data block. The start token is polled SD_TOKEN_POLL bytes at a
+ * time, so the bytes after the token are already data.
+ */
 static int __receive_datablock(uint8_t *buff, unsigned int length) {
-  int ret = 0;
-  uint8_t send = 0xFF;
-  uint8_t tocken;
+  uint8_t poll[SD_TOKEN_POLL];
+  uint8_t crc[2];
+  unsigned int i;
   const uint32_t timeout_ms = 200;
   uint64_t start_ms = km_gettime();
   do {
-    km_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);
-  } while (tocken == 0xFF && km_gettime() < start_ms + timeout_ms);
-  if (tocken == 0xFE) {
-    km_spi_recv(__sdcard_handle.bus, 0xFF, buff, length, length * 10);
-    km_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);  // CRC
-    km_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);  // CRC
-  } else {
-    ret = ETIMEDOUT;
+    km_spi_recv(__sdcard_handle.bus, 0xFF, poll, SD_TOKEN_POLL, 10);
+    for (i = 0; i < SD_TOKEN_POLL && poll[i] == 0xFF; i++) {
+    }
+  } while (i == SD_TOKEN_POLL && km_gettime() < start_ms + timeout_ms);
+  if (i == SD_TOKEN_POLL) {
+    return ETIMEDOUT;
   }
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
-  CS_HIGH;
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
-  return ret;
+  if (poll[i] != SD_TOKEN_START) {  // error token
+    return EIO;
+  }
+  unsigned int n = SD_TOKEN_POLL - 1 - i;
+  memcpy(buff, poll + i + 1, n);
+  km_spi_recv(__sdcard_handle.bus, 0xFF, buff + n, length - n, length * 10);
+  km_spi_recv(__sdcard_handle.bus, 0xFF, crc, 2, 10);
+  return 0;
 }
 
-static int __send_datablock(uint8_t *buff, unsigned int length) {
-  int ret = 0;
-  uint8_t send = 0xFF;
-  uint8_t tocken = 0xFE;
-  km_spi_send(__sdcard_handle.bus, &tocken, 1, 100);  // Send start token
-  km_spi_send(__sdcard_handle.bus, buff, length,
-              length * 10);  // Send start token
-  const uint32_t timeout_ms = 300;
-  uint64_t start_ms = km_gettime();
+/**
+ * Send a data block with the token, and wait until it is programmed
+ */
+static int __send_datablock(const uint8_t *buff, unsigned int length,
+                            uint8_t token) {
+  uint8_t crc[2] = {0xFF, 0xFF};  // CRC is not checked
+  uint8_t response;
+  uint8_t retry = 10;
+  km_spi_send(__sdcard_handle.bus, &token, 1, 100);
+  km_spi_send(__sdcard_handle.bus, (uint8_t *)buff, length, length * 10);
+  km_spi_send(__sdcard_handle.bus, crc, 2, 100);
   do {
-    km_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);
-  } while (tocken == 0xFF && km_gettime() < start_ms + timeout_ms);
-  if ((tocken & 0x1F) == 0x05) {  // Dsta accepted
-    start_ms = km_gettime();
-    do {
-      km_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);
-    } while (tocken == 0x00 && km_gettime() < start_ms + timeout_ms);
-  } else {
-    ret = ETIMEDOUT;
+    km_spi_recv(__sdcard_handle.bus, 0xFF, &response, 1, 10);
+  } while (response == 0xFF && --retry);
+  if ((response & 0x1F) != 0x05) {  // data accepted
+    return EIO;
   }
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
-  CS_HIGH;
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
-  return ret;
+  return __wait_for_ready(500);
 }
 
 static int __erase_datablock(uint32_t start, uint32_t end) {
   int ret = 0;
-  uint8_t send = 0xFF;
   if ((__send_command(SD_CMD32, start, 0x00) != 0) ||
       (__send_command(SD_CMD33, end, 0x00) != 0) ||
       (__send_command(SD_CMD38, 0, 0x00) != 0)) {
     ret = ETIMEDOUT;
   }
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
-  CS_HIGH;
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
+  __release();
+  return ret;
+}
+
+/**
+ * Switch the card to high speed mode (CMD6), so that it can be clocked up
+ * to 50MHz
+ */
+static int __switch_high_speed(void) {
+  uint8_t status[64];
+  int ret = EIO;
+  if ((__send_command(SD_CMD6, 0x80FFFFF1, 0x00) == 0) &&
+      (__receive_datablock(status, sizeof(status)) == 0) &&
+      ((status[16] & 0x0F) == 1)) {
+    ret = 0;
+  }
+  __release();
   return ret;
 }
 
@@ -255,6 +284,7 @@ int __sdcard_init(void) {
   if ((__sdcard_handle.status & SD_STATUS_INIT)) {
     return EALREADY;
   }
+  km_set_spi_baudrate(__sdcard_handle.bus, SLOW_BAUDRATE);
   CS_HIGH;
   km_delay(1);                                        // 1ms delay
   for (int i = 0; i < 10; i++) {                      // 80 cycle clock
@@ -327,30 +357,155 @@ int __sdcard_init(void) {
       }
     }
   }
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
-  CS_HIGH;
-  km_spi_send(__sdcard_handle.bus, &send, 1, 100);
+  __release();
 
   if (__sdcard_handle.sd_type != SD_TYPE_NONE) {
     __sdcard_handle.status |= SD_STATUS_INIT;
-    km_set_spi_baudrate(__sdcard_handle.bus, FAST_BAUDRATE);
+    uint32_t baudrate = __sdcard_handle.baudrate;
+    if (baudrate > FAST_BAUDRATE) {
+      if ((__sdcard_handle.sd_type & (SD_TYPE_SDSC2 | SD_TYPE_SDHC)) &&
+          __switch_high_speed() == 0) {
+        if (baudrate > HIGH_SPEED_BAUDRATE) baudrate = HIGH_SPEED_BAUDRATE;
+      } else {
+        baudrate = FAST_BAUDRATE;
+      }
+    }
+    km_set_spi_baudrate(__sdcard_handle.bus, baudrate);
   }
   return (int)__sdcard_handle.status;
 }
 
 static void init_sd(void) {
-  __sdcard_handle.bus = 0;
-  __sdcard_handle.cs_pin = 0;
   __sdcard_handle.sd_type = SD_TYPE_NONE;
   __sdcard_handle.status = 0;
   __sdcard_handle.count = 0;
   __sdcard_handle.size = 0;
 }
+
+/**
+ * Read blocks, with CMD18 if more than one
+ */
+static int sdcard_blkdev_read(km_blkdev_t *dev, uint32_t block,
+                              uint32_t offset, uint8_t *buffer,
+                              uint32_t size) {
+  if (!(__sdcard_handle.status & SD_STATUS_INIT)) {
+    return ENODEV;
+  }
+  if (offset != 0 || size % __sdcard_handle.size) {
+    return EINVAL;
+  }
+  uint32_t count = size / __sdcard_handle.size;
+  int ret = 0;
+  if (count == 1) {
+    if ((__send_command(SD_CMD17, block, 0x00) != 0x00) ||
+        (__receive_datablock(buffer, size) < 0)) {
+      ret = EIO;
+    }
+  } else if (__send_command(SD_CMD18, block, 0x00) != 0x00) {
+    ret = EIO;
+  } else {
+    for (uint32_t i = 0; i < count; i++) {
+      if (__receive_datablock(buffer + i * __sdcard_handle.size,
+                              __sdcard_handle.size) < 0) {
+        ret = EIO;
+        break;
+      }
+    }
+    __send_command(SD_CMD12, 0, 0x00);
+    __wait_for_ready(500);
+  }
+  __release();
+  return ret;
+}
+
+/**
+ * Write blocks, with CMD25 if more than one (after the number of blocks to
+ * pre-erase is given by ACMD23)
+ */
+static int sdcard_blkdev_prog(km_blkdev_t *dev, uint32_t block,
+                              uint32_t offset, const uint8_t *buffer,
+                              uint32_t size) {
+  if (!(__sdcard_handle.status & SD_STATUS_INIT)) {
+    return ENODEV;
+  }
+  if (offset != 0 || size % __sdcard_handle.size) {
+    return EINVAL;
+  }
+  uint32_t count = size / __sdcard_handle.size;
+  int ret = 0;
+  if (count == 1) {
+    if ((__send_command(SD_CMD24, block, 0x00) != 0x00) ||
+        (__send_datablock(buffer, size, SD_TOKEN_START) < 0)) {
+      ret = EIO;
+    }
+  } else {
+    if (__sdcard_handle.sd_type != SD_TYPE_MMC) {
+      __send_command(SD_ACMD23, count, 0x00);  // a hint, may be rejected
+    }
+    if (__send_command(SD_CMD25, block, 0x00) != 0x00) {
+      ret = EIO;
+    } else {
+      uint8_t token = SD_TOKEN_STOP;
+      for (uint32_t i = 0; i < count; i++) {
+        if (__send_datablock(buffer + i * __sdcard_handle.size,
+                             __sdcard_handle.size, SD_TOKEN_MULTI) < 0) {
+          ret = EIO;
+          break;
+        }
+      }
+      km_spi_send(__sdcard_handle.bus, &token, 1, 100);
+      km_spi_recv(__sdcard_handle.bus, 0xFF, &token, 1, 10);  // stuff byte
+      if (__wait_for_ready(500) < 0) {
+        ret = EIO;
+      }
+    }
+  }
+  __release();
+  return ret;
+}
+
+static int sdcard_blkdev_erase(km_blkdev_t *dev, uint32_t block,
+                               uint32_t count) {
+  if (!(__sdcard_handle.status & SD_STATUS_INIT)) {
+    return ENODEV;
+  }
+  return __erase_datablock(block, block + count - 1) < 0 ? EIO : 0;
+}
+
+static int sdcard_blkdev_sync(km_blkdev_t *dev) { return 0; }
+
+static int sdcard_blkdev_ioctl(km_blkdev_t *dev, int op, int arg) {
+  switch (op) {
+    case KM_BLKDEV_INIT:
+      return __sdcard_init();
+    case KM_BLKDEV_SHUTDOWN:
+      init_sd();
+      return 0;
+    case KM_BLKDEV_BLOCK_COUNT:
+      return __sdcard_handle.count;
+    case KM_BLKDEV_BLOCK_SIZE:
+    case KM_BLKDEV_BUFFER_SIZE:
+      return __sdcard_handle.size;
+    default:
+      return EINVAL;
+  }
+}
+
+static const km_blkdev_ops_t sdcard_blkdev_ops = {
+    .read = sdcard_blkdev_read,
+    .prog = sdcard_blkdev_prog,
+    .erase = sdcard_blkdev_erase,
+    .sync = sdcard_blkdev_sync,
+    .ioctl = sdcard_blkdev_ioctl,
+};
+
 /**
  * Sdcard (block device) constructor
  * args:
  *   bus {number} SPI bus
  *   options (number) SPI options
+ *     baudrate {number} max SPI clock after init (default 25MHz). Above
+ *       25MHz the card is switched to high speed mode (up to 50MHz).
  */
 JERRYXX_FUN(sdcard_ctor_fn) {
   // check and get args
@@ -370,8 +525,11 @@ JERRYXX_FUN(sdcard_ctor_fn) {
   };
 
   uint8_t cs_pin = 0;
+  uint32_t max_baudrate = FAST_BAUDRATE;
   if (JERRYXX_HAS_ARG(1)) {
     jerry_value_t options = JERRYXX_GET_ARG(1);
+    max_baudrate = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_SDCARD_BAUDRATE, FAST_BAUDRATE);
     cs_pin =
         (int8_t)jerryxx_get_property_number(options, MSTR_SDCARD_SPI_CS, 0);
     pins.miso = (int8_t)jerryxx_get_property_number(
@@ -381,9 +539,17 @@ JERRYXX_FUN(sdcard_ctor_fn) {
     pins.sck = (int8_t)jerryxx_get_property_number(options, MSTR_SDCARD_SPI_SCK,
                                                    def_pins.sck);
   }
+  // native block device for the file systems
+  km_blkdev_t *dev = (km_blkdev_t *)malloc(sizeof(km_blkdev_t));
+  if (dev == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  dev->ops = &sdcard_blkdev_ops;
+
   // initialize the bus
   int ret = km_gpio_set_io_mode(cs_pin, KM_GPIO_IO_MODE_OUTPUT);
   if (ret < 0) {
+    free(dev);
     return jerry_create_error(
         JERRY_ERROR_COMMON,
         (const jerry_char_t *)"SD Card CS pin setup error.");
@@ -392,12 +558,15 @@ JERRYXX_FUN(sdcard_ctor_fn) {
   ret = km_spi_setup(bus, (km_spi_mode_t)mode, baudrate,
                      (km_spi_bitorder_t)bitorder, pins, KM_SPI_MISO_PULLUP);
   if (ret < 0) {
+    free(dev);
     return jerry_create_error(JERRY_ERROR_COMMON,
                               (const jerry_char_t *)"SD Card SPI setup error.");
   }
   init_sd();
   __sdcard_handle.bus = bus;
   __sdcard_handle.cs_pin = cs_pin;
+  __sdcard_handle.baudrate = max_baudrate;
+  km_blkdev_attach(JERRYXX_GET_THIS, dev);
   return jerry_create_undefined();
 }
 
@@ -405,7 +574,7 @@ JERRYXX_FUN(sdcard_ctor_fn) {
  * Sdcard.prototype.read()
  * args:
  *   block {number}
- *   buffer {Uint8Array}
+ *   buffer {Uint8Array} read as many blocks as the buffer holds
  *   offset {number}
  */
 JERRYXX_FUN(sdcard_read_fn) {
@@ -428,11 +597,16 @@ JERRYXX_FUN(sdcard_read_fn) {
     return jerry_create_error(
         JERRY_ERROR_COMMON, (const jerry_char_t *)"SDCard is not initialized.");
   }
-  if (__send_command(SD_CMD17, block, 0x00) != 0xFF) {
-    if (__receive_datablock(buffer_pointer, __sdcard_handle.size) < 0) {
-      return jerry_create_error(JERRY_ERROR_COMMON,
-                                (const jerry_char_t *)"SDCard read error.");
-    }
+  uint32_t count = buffer_length / __sdcard_handle.size;
+  if (count == 0) {
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Buffer is smaller than a block.");
+  }
+  if (sdcard_blkdev_read(NULL, block, 0, buffer_pointer + buffer_offset,
+                         count * __sdcard_handle.size) < 0) {
+    return jerry_create_error(JERRY_ERROR_COMMON,
+                              (const jerry_char_t *)"SDCard read error.");
   }
   return jerry_create_undefined();
 }
@@ -441,7 +615,7 @@ JERRYXX_FUN(sdcard_read_fn) {
  * Sdcard.prototype.write()
  * args:
  *   block {number}
- *   buffer {Uint8Array}
+ *   buffer {Uint8Array} write as many blocks as the buffer holds
  *   offset {number}
  */
 JERRYXX_FUN(sdcard_write_fn) {
@@ -464,8 +638,14 @@ JERRYXX_FUN(sdcard_write_fn) {
     return jerry_create_error(
         JERRY_ERROR_COMMON, (const jerry_char_t *)"SDCard is not initialized.");
   }
-  if ((__send_command(SD_CMD24, block, 0x00) != 0x00) ||
-      (__send_datablock(buffer_pointer, __sdcard_handle.size) < 0)) {
+  uint32_t count = buffer_length / __sdcard_handle.size;
+  if (count == 0) {
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Buffer is smaller than a block.");
+  }
+  if (sdcard_blkdev_prog(NULL, block, 0, buffer_pointer + buffer_offset,
+                         count * __sdcard_handle.size) < 0) {
     return jerry_create_error(JERRY_ERROR_COMMON,
                               (const jerry_char_t *)"SDCard write error.");
   }
@@ -509,7 +689,7 @@ JERRYXX_FUN(sdcard_ioctl_fn) {
             JERRY_ERROR_COMMON,
             (const jerry_char_t *)"SDCard is not initialized.");
       } else {
-        if (__erase_datablock(arg, arg) < 0) {
+        if (sdcard_blkdev_erase(NULL, arg, 1) < 0) {
           return jerry_create_error(
               JERRY_ERROR_COMMON, (const jerry_char_t *)"SDCard earse error.");
         }
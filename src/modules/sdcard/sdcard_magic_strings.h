@@ -30,4 +30,5 @@
 #define MSTR_SDCARD_SPI_MOSI "mosi"
 #define MSTR_SDCARD_SPI_SCK "sck"
 #define MSTR_SDCARD_SPI_CS "cs"
+#define MSTR_SDCARD_BAUDRATE "baudrate"
 #endif /* __SDCARD_MAGIC_STRINGS_H */
@@ -41,6 +41,18 @@ if (process.builtin_modules.indexOf("storage") > -1) {
   });
 }
 
+/**
+ * Buffer class
+ */
+
+if (process.builtin_modules.indexOf("buffer") > -1) {
+  Object.defineProperty(global, "Buffer", {
+    get: function () {
+      return Module.require("buffer").Buffer;
+    },
+  });
+}
+
 /**
  * Board object
  */
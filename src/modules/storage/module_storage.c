@@ -34,8 +34,16 @@ JERRYXX_FUN(storage_set_item_fn) {
   JERRYXX_CHECK_ARG_STRING(0, "key")
   JERRYXX_CHECK_ARG_STRING(1, "value")
   JERRYXX_GET_ARG_STRING_AS_CHAR(0, key)
-  JERRYXX_GET_ARG_STRING_AS_CHAR(1, value)
+  // values can be large, so not on the stack
+  jerry_size_t value_sz = jerry_get_string_size(args_p[1]);
+  char *value = (char *)malloc(value_sz + 1);
+  if (value == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  jerry_string_to_char_buffer(args_p[1], (jerry_char_t *)value, value_sz);
+  value[value_sz] = '\0';
   int ret = storage_set_item(key, value);
+  free(value);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
@@ -53,6 +61,9 @@ JERRYXX_FUN(storage_get_item_fn) {
     return jerry_create_null();
   }
   char *buf = (char *)malloc(len);
+  if (len > 0 && buf == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
   storage_get_value(key, buf);
   jerry_value_t value = jerry_create_string_sz((const jerry_char_t *)buf, len);
   free(buf);
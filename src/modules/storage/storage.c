@@ -1,4 +1,4 @@
-/* Copyright (c) 2017 Kaluma
+/* Copyright (c) 2017-2020 Kaluma
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -21,189 +21,736 @@
 
 #include "storage.h"
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "err.h"
 #include "flash.h"
+#include "utils.h"
 
-// int get_available_slot();
-// storage_slot_data_t *slot_get_data(int slot);
-// int slot_set_data(slot_data_t *, key, value);
-// int slot_write(slot, slot_data);
-// int slot_find(char *key);
-
-static int slot_new() {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(km_flash_addr + (SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE));
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot_data =
-        (storage_slot_data_t *)(STORAGE_ADDR + i * SLOT_SIZE);
-    if (slot_data->status == SS_EMPTY) {
-      return i;
+/**
+ * Log-structured storage:
+ *
+ * - setItem() and removeItem() append a record (RT_SET or RT_REMOVE with
+ *   CRC) to the active group. A record torn by a power loss fails its CRC
+ *   and is ignored, and the torn bytes are padded over when mounting.
+ * - When the active group is full, the other group is erased and becomes
+ *   the active one, with a header of the next sequence number. Then each
+ *   write copies the live records from a part of the old group, until all
+ *   are copied and the header is marked compacted. Until then the old group
+ *   is read first when mounting, so no state is lost at any point.
+ */
+
+#define HEADER_SIZE sizeof(storage_group_header_t)
+#define COMPACT_STEP 1024  // bytes of the old group scanned by each write
+#define INDEX_MIN_CAPACITY 16
+#define LOC_EMPTY 0xFFFFFFFF
+#define LOC_DELETED 0xFFFFFFFE
+
+// previous format (a key/value per page), migrated when first mounted
+#define LEGACY_SS_REMOVED 0x00
+#define LEGACY_SS_USE 0xF0
+#define LEGACY_SS_EMPTY 0xFF
+#define LEGACY_SLOT_SIZE KALUMA_FLASH_PAGE_SIZE
+#define LEGACY_SLOT_DATA_MAX (LEGACY_SLOT_SIZE - 3)
+#define LEGACY_SLOT_COUNT \
+  ((SECTOR_COUNT * KALUMA_FLASH_SECTOR_SIZE) / LEGACY_SLOT_SIZE)
+
+typedef struct {
+  uint8_t status;
+  uint8_t key_length;
+  uint8_t value_length;
+  char buffer[LEGACY_SLOT_DATA_MAX];
+} legacy_slot_t;
+
+typedef struct {
+  uint32_t hash;
+  uint32_t loc;  // offset of the record in the area, or LOC_EMPTY/DELETED
+} index_entry_t;
+
+static bool mounted = false;
+static uint8_t active;        // group to append to
+static uint32_t seq;          // sequence number of the active group
+static uint32_t end;          // offset of the next record in the active group
+static bool compacting;       // copying from the other group
+static uint32_t cursor;       // offset of the next record to copy
+static uint32_t source_end;   // end of the records in the other group
+static uint32_t pending;      // size of the live records not copied yet
+static index_entry_t *table;  // index: open addressing hash table
+static uint32_t index_capacity;
+static uint32_t index_used;  // live and deleted entries
+static uint32_t item_count;
+static uint32_t live_bytes;  // size of the live records
+static int iter_index = -1;  // last entry returned by index_at()
+static uint32_t iter_pos;
+
+static const uint8_t *area() {
+  return km_flash_addr + SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE;
+}
+
+static const storage_group_header_t *group_header(uint8_t group) {
+  return (const storage_group_header_t *)(area() + group * GROUP_SIZE);
+}
+
+static const storage_record_t *record_at(uint32_t loc) {
+  return (const storage_record_t *)(area() + loc);
+}
+
+static const char *record_key(const storage_record_t *rec) {
+  return (const char *)(rec + 1);
+}
+
+static const char *record_value(const storage_record_t *rec) {
+  return record_key(rec) + rec->key_length;
+}
+
+static uint32_t record_size(uint32_t key_length, uint32_t value_length) {
+  uint32_t size = sizeof(storage_record_t) + key_length + value_length;
+  return (size + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+}
+
+static uint32_t record_crc(const storage_record_t *rec, const char *key,
+                           const char *value) {
+  uint32_t crc = km_crc32(0, (const uint8_t *)rec, 4);
+  crc = km_crc32(crc, (const uint8_t *)key, rec->key_length);
+  return km_crc32(crc, (const uint8_t *)value, rec->value_length);
+}
+
+static uint32_t key_hash(const char *key, uint32_t len) {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (uint32_t i = 0; i < len; i++) {
+    hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * Program data at the offset of the storage area from the segments. The
+ * other bytes of the pages are programmed as 0xFF, which leaves them as
+ * they are.
+ */
+static int area_program(uint32_t offset, const uint8_t **segs,
+                        const uint32_t *lens, int count) {
+  uint8_t page[KALUMA_FLASH_PAGE_SIZE];
+  int seg = 0;
+  uint32_t seg_pos = 0;
+  while (seg < count) {
+    uint32_t page_base = offset - offset % KALUMA_FLASH_PAGE_SIZE;
+    uint32_t pos = offset - page_base;
+    memset(page, 0xFF, KALUMA_FLASH_PAGE_SIZE);
+    while (seg < count && pos < KALUMA_FLASH_PAGE_SIZE) {
+      uint32_t n = lens[seg] - seg_pos;
+      if (n > KALUMA_FLASH_PAGE_SIZE - pos) n = KALUMA_FLASH_PAGE_SIZE - pos;
+      memcpy(page + pos, segs[seg] + seg_pos, n);
+      pos += n;
+      seg_pos += n;
+      if (seg_pos == lens[seg]) {
+        seg++;
+        seg_pos = 0;
+      }
     }
+    int ret = km_flash_program(
+        SECTOR_BASE + page_base / KALUMA_FLASH_SECTOR_SIZE,
+        page_base % KALUMA_FLASH_SECTOR_SIZE, page, KALUMA_FLASH_PAGE_SIZE);
+    if (ret < 0) return ret;
+    offset = page_base + pos;
   }
-  return -1;  // storage full
+  return 0;
 }
 
-static storage_slot_data_t *slot_get_data(int slot) {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(km_flash_addr + (SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE));
-  return (storage_slot_data_t *)(STORAGE_ADDR + (slot * SLOT_SIZE));
+/*
+ * Index
+ */
+
+static void index_reset() {
+  free(table);
+  table = NULL;
+  index_capacity = 0;
+  index_used = 0;
+  item_count = 0;
+  live_bytes = 0;
+  pending = 0;
+  iter_index = -1;
 }
 
-static void slot_set_data(storage_slot_data_t *slot_data, char *key,
-                          char *value) {
-  size_t key_length = strlen(key);
-  size_t value_length = strlen(value);
-  memcpy(slot_data->buffer, key, key_length);
-  memcpy(slot_data->buffer + key_length, value, value_length);
-  slot_data->status = SS_USE;
-  slot_data->key_length = key_length;
-  slot_data->value_length = value_length;
-}
-
-static void slot_write(int slot, storage_slot_data_t *slot_data) {
-  int sector = (slot * SLOT_SIZE) / KALUMA_FLASH_SECTOR_SIZE;
-  int offset = (slot * SLOT_SIZE) % KALUMA_FLASH_SECTOR_SIZE;
-  km_flash_program(SECTOR_BASE + sector, offset, (uint8_t *)slot_data,
-                   SLOT_SIZE);
-}
-
-static int slot_find(char *key, int len) {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(km_flash_addr + (SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE));
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot_data =
-        (storage_slot_data_t *)(STORAGE_ADDR + i * SLOT_SIZE);
-    if (slot_data->status == SS_USE && slot_data->key_length == len &&
-        strncmp(slot_data->buffer, key, len) == 0) {
-      return i;
+/**
+ * Account that the record at loc is not live any more
+ */
+static void index_unlink(uint32_t loc) {
+  const storage_record_t *rec = record_at(loc);
+  uint32_t size = record_size(rec->key_length, rec->value_length);
+  live_bytes -= size;
+  if (compacting && loc / GROUP_SIZE != active) {
+    pending -= size;
+  }
+}
+
+static index_entry_t *index_find(const char *key, uint32_t len,
+                                 uint32_t hash) {
+  if (index_capacity == 0) return NULL;
+  uint32_t mask = index_capacity - 1;
+  for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+    index_entry_t *e = &table[i];
+    if (e->loc == LOC_EMPTY) return NULL;
+    if (e->loc != LOC_DELETED && e->hash == hash) {
+      const storage_record_t *rec = record_at(e->loc);
+      if (rec->key_length == len && memcmp(record_key(rec), key, len) == 0) {
+        return e;
+      }
+    }
+  }
+}
+
+static int index_resize(uint32_t capacity) {
+  index_entry_t *entries = malloc(capacity * sizeof(index_entry_t));
+  if (entries == NULL) return ENOMEM;
+  memset(entries, 0xFF, capacity * sizeof(index_entry_t));
+  for (uint32_t i = 0; i < index_capacity; i++) {
+    if (table[i].loc < LOC_DELETED) {
+      uint32_t j = table[i].hash & (capacity - 1);
+      while (entries[j].loc != LOC_EMPTY) j = (j + 1) & (capacity - 1);
+      entries[j] = table[i];
     }
   }
-  return -1;  // not found
+  free(table);
+  table = entries;
+  index_capacity = capacity;
+  index_used = item_count;
+  iter_index = -1;
+  return 0;
 }
 
 /**
- * Return index-th slot in USE status
+ * Point the key of the record to the record
  */
-static int slot_find_by_index(int index) {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(km_flash_addr + (SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE));
-  int pos = 0;
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot =
-        (storage_slot_data_t *)(STORAGE_ADDR + (i * SLOT_SIZE));
-    if (slot->status == SS_USE) {
-      if (pos == index) {
-        return i;
+static int index_set(uint32_t loc) {
+  const storage_record_t *rec = record_at(loc);
+  uint32_t size = record_size(rec->key_length, rec->value_length);
+  uint32_t hash = key_hash(record_key(rec), rec->key_length);
+  index_entry_t *e = index_find(record_key(rec), rec->key_length, hash);
+  if (e != NULL) {
+    index_unlink(e->loc);
+    live_bytes += size;
+    e->loc = loc;
+    return 0;
+  }
+  if ((index_used + 1) * 4 > index_capacity * 3) {
+    uint32_t capacity = INDEX_MIN_CAPACITY;
+    while ((item_count + 1) * 2 > capacity) capacity *= 2;
+    int ret = index_resize(capacity);
+    if (ret < 0) return ret;
+  }
+  uint32_t mask = index_capacity - 1;
+  uint32_t i = hash & mask;
+  while (table[i].loc < LOC_DELETED) i = (i + 1) & mask;
+  if (table[i].loc == LOC_EMPTY) index_used++;
+  table[i].hash = hash;
+  table[i].loc = loc;
+  item_count++;
+  live_bytes += size;
+  iter_index = -1;
+  return 0;
+}
+
+static void index_remove(index_entry_t *e) {
+  index_unlink(e->loc);
+  e->loc = LOC_DELETED;
+  item_count--;
+  iter_index = -1;
+}
+
+/**
+ * Return the pos-th live entry. Iterating in order takes a step per call.
+ */
+static index_entry_t *index_at(uint32_t pos) {
+  uint32_t i = 0;
+  uint32_t p = 0;
+  if (iter_index >= 0 && pos >= iter_pos) {
+    i = iter_index;
+    p = iter_pos;
+  }
+  for (; i < index_capacity; i++) {
+    if (table[i].loc < LOC_DELETED) {
+      if (p == pos) {
+        iter_index = i;
+        iter_pos = pos;
+        return &table[i];
       }
-      pos++;
+      p++;
     }
   }
-  return -1;
+  return NULL;
+}
+
+/*
+ * Groups
+ */
+
+static bool group_valid(uint8_t group) {
+  const storage_group_header_t *header = group_header(group);
+  return header->magic == STORAGE_MAGIC &&
+         header->crc == km_crc32(0, (const uint8_t *)header, 8);
 }
 
-static char *slot_get_key(storage_slot_data_t *slot_data) {
-  return (char *)(slot_data->buffer);
+static int group_begin(uint8_t group, uint32_t group_seq, bool compacted) {
+  storage_group_header_t header;
+  memset(&header, 0xFF, sizeof(header));
+  header.magic = STORAGE_MAGIC;
+  header.seq = group_seq;
+  header.crc = km_crc32(0, (const uint8_t *)&header, 8);
+  header.compacted = compacted ? 0x00 : 0xFF;
+  const uint8_t *segs[1] = {(const uint8_t *)&header};
+  uint32_t lens[1] = {HEADER_SIZE};
+  int ret = area_program(group * GROUP_SIZE, segs, lens, 1);
+  if (ret < 0) return ret;
+  active = group;
+  seq = group_seq;
+  end = HEADER_SIZE;
+  return 0;
 }
 
-static char *slot_get_value(storage_slot_data_t *slot_data) {
-  return (char *)(slot_data->buffer + slot_data->key_length);
+/**
+ * Return the size of the record at the offset of the group, or 0 at the
+ * end of the records (blank space, or a record torn by a power loss)
+ */
+static uint32_t group_next(uint8_t group, uint32_t offset) {
+  if (offset + sizeof(storage_record_t) > GROUP_SIZE) {
+    return 0;
+  }
+  const storage_record_t *rec = record_at(group * GROUP_SIZE + offset);
+  if (rec->type == RT_PAD) {
+    return RECORD_ALIGN;
+  }
+  uint32_t size = record_size(rec->key_length, rec->value_length);
+  if ((rec->type != RT_SET && rec->type != RT_REMOVE) ||
+      offset + size > GROUP_SIZE) {
+    return 0;
+  }
+  return size;
 }
 
-int storage_set_item(char *key, char *value) {
-  if (strlen(key) + strlen(value) > SLOT_DATA_MAX) {
-    return ESTGSIZE;
+/**
+ * Pad over the torn data after the end of the records, so that records can
+ * be appended to the group again. Returns the new end.
+ */
+static int group_repair(uint8_t group, uint32_t offset) {
+  static const uint8_t zeros[KALUMA_FLASH_PAGE_SIZE] = {0};
+  const uint8_t *p = area() + group * GROUP_SIZE;
+  uint32_t last = GROUP_SIZE;
+  while (last > offset && p[last - 1] == 0xFF) last--;
+  last = (last + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+  while (offset < last) {
+    const uint8_t *segs[1] = {zeros};
+    uint32_t lens[1] = {last - offset};
+    if (lens[0] > KALUMA_FLASH_PAGE_SIZE) lens[0] = KALUMA_FLASH_PAGE_SIZE;
+    int ret = area_program(group * GROUP_SIZE + offset, segs, lens, 1);
+    if (ret < 0) return ret;
+    offset += lens[0];
   }
-  storage_slot_data_t temp;
+  return offset;
+}
 
-  // if key found, remove it
-  int slot = slot_find(key, strlen(key));
-  if (slot >= 0) {
-    storage_slot_data_t *old_slot_data = slot_get_data(slot);
-    memcpy(&temp, old_slot_data, sizeof(storage_slot_data_t));
-    temp.status = SS_REMOVED;
-    slot_write(slot, &temp);
+static bool record_valid(const storage_record_t *rec) {
+  return (rec->type == RT_SET || rec->type == RT_REMOVE) &&
+         rec->crc == record_crc(rec, record_key(rec), record_value(rec));
+}
+
+/**
+ * Apply the records of the group to the index. Returns the end of the
+ * records, or a negative error.
+ */
+static int group_scan(uint8_t group) {
+  uint32_t offset = HEADER_SIZE;
+  uint32_t size;
+  while ((size = group_next(group, offset)) > 0) {
+    uint32_t loc = group * GROUP_SIZE + offset;
+    const storage_record_t *rec = record_at(loc);
+    if (size == record_size(rec->key_length, rec->value_length) &&
+        record_valid(rec)) {
+      if (rec->type == RT_SET) {
+        int ret = index_set(loc);
+        if (ret < 0) return ret;
+      } else {
+        index_entry_t *e = index_find(
+            record_key(rec), rec->key_length,
+            key_hash(record_key(rec), rec->key_length));
+        if (e != NULL) index_remove(e);
+      }
+    }
+    offset += size;
   }
+  return offset;
+}
 
-  // create new slot
-  int new_slot = slot_new();
-  if (new_slot < 0) {
+/*
+ * Records
+ */
+
+static int record_append(uint8_t type, const char *key, uint32_t key_length,
+                         const char *value, uint32_t value_length,
+                         uint32_t *loc) {
+  uint32_t size = record_size(key_length, value_length);
+  if (end + size > GROUP_SIZE) {
     return ESTGFULL;
+  }
+  storage_record_t rec;
+  rec.type = type;
+  rec.key_length = key_length;
+  rec.value_length = value_length;
+  rec.crc = record_crc(&rec, key, value);
+  const uint8_t *segs[3] = {(const uint8_t *)&rec, (const uint8_t *)key,
+                            (const uint8_t *)value};
+  uint32_t lens[3] = {sizeof(rec), key_length, value_length};
+  *loc = active * GROUP_SIZE + end;
+  int ret = area_program(*loc, segs, lens, value_length > 0 ? 3 : 2);
+  end += size;  // skip the space even if failed
+  return ret;
+}
+
+/**
+ * Copy the live records from the old group, until scanned more than budget
+ * bytes. When all are copied, mark the active group compacted.
+ */
+static int compact_step(uint32_t budget) {
+  uint8_t source = 1 - active;
+  uint32_t scanned = 0;
+  while (compacting && scanned < budget) {
+    uint32_t size = cursor < source_end ? group_next(source, cursor) : 0;
+    if (size == 0) {
+      uint8_t done = 0x00;
+      const uint8_t *segs[1] = {&done};
+      uint32_t lens[1] = {1};
+      int ret = area_program(
+          active * GROUP_SIZE + offsetof(storage_group_header_t, compacted),
+          segs, lens, 1);
+      if (ret < 0) return ret;
+      compacting = false;
+      break;
+    }
+    uint32_t loc = source * GROUP_SIZE + cursor;
+    const storage_record_t *rec = record_at(loc);
+    if (rec->type == RT_SET &&
+        size == record_size(rec->key_length, rec->value_length)) {
+      index_entry_t *e = index_find(
+          record_key(rec), rec->key_length,
+          key_hash(record_key(rec), rec->key_length));
+      if (e != NULL && e->loc == loc) {
+        // the latest record of the key: copy as it is
+        if (end + size > GROUP_SIZE) break;
+        const uint8_t *segs[1] = {(const uint8_t *)rec};
+        uint32_t lens[1] = {size};
+        int ret = area_program(active * GROUP_SIZE + end, segs, lens, 1);
+        if (ret < 0) return ret;
+        e->loc = active * GROUP_SIZE + end;
+        end += size;
+        pending -= size;
+      }
+    }
+    cursor += size;
+    scanned += size;
+  }
+  return 0;
+}
+
+/**
+ * Erase the other group and make it active, to copy the live records of the
+ * current group to it
+ */
+static int compact_begin() {
+  uint8_t target = 1 - active;
+  int ret = km_flash_erase(SECTOR_BASE + target * GROUP_SECTORS,
+                           GROUP_SECTORS);
+  if (ret < 0) return ret;
+  source_end = end;
+  ret = group_begin(target, seq + 1, false);
+  if (ret < 0) return ret;
+  compacting = true;
+  cursor = HEADER_SIZE;
+  pending = live_bytes;
+  return 0;
+}
+
+/**
+ * Whether a record of the size can be appended, keeping the room to copy
+ * the pending records. The record of the entry (if any) is replaced by it.
+ * Only a record torn by a power loss while compacting can take this room,
+ * and then items need to be removed to complete the compaction.
+ */
+static bool has_room(uint32_t size, index_entry_t *e) {
+  uint32_t replaced = 0;
+  if (compacting && e != NULL && e->loc / GROUP_SIZE != active) {
+    const storage_record_t *rec = record_at(e->loc);
+    replaced = record_size(rec->key_length, rec->value_length);
+  }
+  return end + pending - replaced + size <= GROUP_SIZE;
+}
+
+/**
+ * Make room for a record of the size in the active group, replacing the
+ * record of the entry (if any)
+ */
+static int make_room(uint32_t size, index_entry_t *e) {
+  if (has_room(size, e)) return 0;
+  if (compacting) {
+    int ret = compact_step(GROUP_SIZE);
+    if (ret < 0) return ret;
+    if (has_room(size, e)) return 0;
+    if (compacting) return ESTGFULL;
+  }
+  int ret = compact_begin();
+  if (ret < 0) return ret;
+  return has_room(size, e) ? 0 : ESTGFULL;
+}
+
+/**
+ * Copy a step of the live records after a write. It is done after the
+ * write, not to copy the record just replaced.
+ */
+static int compact_after_write() {
+  return compacting ? compact_step(COMPACT_STEP) : 0;
+}
+
+/**
+ * Copy the items of the previous format into the (erased) area. Items are
+ * kept in RAM meanwhile, and dropped if out of memory.
+ */
+static void legacy_migrate(const legacy_slot_t **slots, uint32_t count) {
+  char *buffer = malloc(count * LEGACY_SLOT_DATA_MAX);
+  uint8_t *lengths = malloc(count * 2);
+  if (buffer != NULL && lengths != NULL) {
+    for (uint32_t i = 0; i < count; i++) {
+      memcpy(buffer + i * LEGACY_SLOT_DATA_MAX, slots[i]->buffer,
+             LEGACY_SLOT_DATA_MAX);
+      lengths[i * 2] = slots[i]->key_length;
+      lengths[i * 2 + 1] = slots[i]->value_length;
+    }
   } else {
-    slot_set_data(&temp, key, value);
-    slot_write(new_slot, &temp);
+    count = 0;
+  }
+  km_flash_erase(SECTOR_BASE, SECTOR_COUNT);
+  if (group_begin(0, 1, true) == 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      const char *key = buffer + i * LEGACY_SLOT_DATA_MAX;
+      uint32_t loc;
+      if (record_append(RT_SET, key, lengths[i * 2], key + lengths[i * 2],
+                        lengths[i * 2 + 1], &loc) < 0 ||
+          index_set(loc) < 0) {
+        break;
+      }
+    }
   }
+  free(lengths);
+  free(buffer);
+}
+
+/**
+ * Format the area, migrating the items if it is in the previous format
+ */
+static int storage_format() {
+  const legacy_slot_t **slots =
+      malloc(LEGACY_SLOT_COUNT * sizeof(legacy_slot_t *));
+  uint32_t count = 0;
+  bool legacy = slots != NULL;
+  for (uint32_t i = 0; legacy && i < LEGACY_SLOT_COUNT; i++) {
+    const legacy_slot_t *slot =
+        (const legacy_slot_t *)(area() + i * LEGACY_SLOT_SIZE);
+    if (slot->status == LEGACY_SS_USE &&
+        slot->key_length + slot->value_length <= LEGACY_SLOT_DATA_MAX) {
+      slots[count++] = slot;
+    } else if (slot->status != LEGACY_SS_REMOVED &&
+               slot->status != LEGACY_SS_EMPTY) {
+      legacy = false;
+    }
+  }
+  index_reset();
+  compacting = false;
+  if (legacy && count > 0) {
+    legacy_migrate(slots, count);
+    free(slots);
+    return 0;
+  }
+  free(slots);
+  int ret = km_flash_erase(SECTOR_BASE, SECTOR_COUNT);
+  if (ret < 0) return ret;
+  return group_begin(0, 1, true);
+}
+
+/**
+ * Build the index from the active group (and the group being compacted)
+ */
+static int storage_mount() {
+  if (mounted) return 0;
+  bool valid0 = group_valid(0);
+  bool valid1 = group_valid(1);
+  index_reset();
+  compacting = false;
+  if (!valid0 && !valid1) {
+    int ret = storage_format();
+    if (ret < 0) return ret;
+    mounted = true;
+    return 0;
+  }
+  if (valid0 && valid1) {
+    active = (int32_t)(group_header(1)->seq - group_header(0)->seq) > 0;
+  } else {
+    active = valid1;
+  }
+  seq = group_header(active)->seq;
+  uint8_t source = 1 - active;
+  bool resume = group_header(active)->compacted != 0x00 &&
+                group_valid(source) && group_header(source)->seq == seq - 1;
+  if (resume) {
+    int ret = group_scan(source);
+    if (ret < 0) return ret;
+    source_end = ret;
+    cursor = HEADER_SIZE;
+  }
+  int ret = group_scan(active);
+  if (ret < 0) return ret;
+  ret = group_repair(active, ret);
+  if (ret < 0) return ret;
+  end = ret;
+  compacting = resume;
+  for (uint32_t i = 0; compacting && i < index_capacity; i++) {
+    if (table[i].loc < LOC_DELETED && table[i].loc / GROUP_SIZE == source) {
+      const storage_record_t *rec = record_at(table[i].loc);
+      pending += record_size(rec->key_length, rec->value_length);
+    }
+  }
+  mounted = true;
   return 0;
 }
 
+/*
+ * API
+ */
+
+int storage_set_item(char *key, char *value) {
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  size_t key_length = strlen(key);
+  size_t value_length = strlen(value);
+  if (key_length > KEY_MAX || value_length > VALUE_MAX) {
+    return ESTGSIZE;
+  }
+  uint32_t size = record_size(key_length, value_length);
+  if (size > GROUP_SIZE - HEADER_SIZE) {
+    return ESTGSIZE;
+  }
+  uint32_t live = live_bytes + size;
+  index_entry_t *e = index_find(key, key_length, key_hash(key, key_length));
+  if (e != NULL) {
+    const storage_record_t *old = record_at(e->loc);
+    live -= record_size(old->key_length, old->value_length);
+  }
+  if (live > GROUP_SIZE - HEADER_SIZE) {
+    return ESTGFULL;
+  }
+  ret = make_room(size, e);
+  if (ret < 0) return ret;
+  uint32_t loc;
+  ret = record_append(RT_SET, key, key_length, value, value_length, &loc);
+  if (ret < 0) return ret;
+  ret = index_set(loc);
+  if (ret < 0) return ret;
+  return compact_after_write();
+}
+
 int storage_get_value_length(char *key) {
-  int slot = slot_find(key, strlen(key));
-  if (slot < 0) {
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  size_t len = strlen(key);
+  index_entry_t *e = index_find(key, len, key_hash(key, len));
+  if (e == NULL) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  return slot_data->value_length;
+  return record_at(e->loc)->value_length;
 }
 
 int storage_get_value(char *key, char *value) {
-  int slot = slot_find(key, strlen(key));
-  if (slot < 0) {
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  size_t len = strlen(key);
+  index_entry_t *e = index_find(key, len, key_hash(key, len));
+  if (e == NULL) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  strcpy(value, slot_get_value(slot_data));
+  const storage_record_t *rec = record_at(e->loc);
+  memcpy(value, record_value(rec), rec->value_length);
   return 0;
 }
 
 int storage_get_key_length(int index) {
-  int slot = slot_find_by_index(index);
-  if (slot < 0) {
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  index_entry_t *e = index < 0 ? NULL : index_at(index);
+  if (e == NULL) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  return slot_data->key_length;
+  return record_at(e->loc)->key_length;
 }
 
 int storage_get_key(int index, char *key) {
-  int slot = slot_find_by_index(index);
-  if (slot < 0) {
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  index_entry_t *e = index < 0 ? NULL : index_at(index);
+  if (e == NULL) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  strcpy(key, slot_get_key(slot_data));
+  const storage_record_t *rec = record_at(e->loc);
+  memcpy(key, record_key(rec), rec->key_length);
   return 0;
 }
 
 int storage_remove_item(char *key) {
-  int slot = slot_find(key, strlen(key));
-  if (slot < 0) {
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  size_t len = strlen(key);
+  index_entry_t *e = index_find(key, len, key_hash(key, len));
+  if (e == NULL) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  storage_slot_data_t temp;
-  memcpy(&temp, slot_data, sizeof(storage_slot_data_t));
-  temp.status = SS_REMOVED;
-  slot_write(slot, &temp);
-  return 0;
+  ret = make_room(record_size(len, 0), e);
+  if (ret < 0) return ret;
+  uint32_t loc;
+  ret = record_append(RT_REMOVE, key, len, NULL, 0, &loc);
+  if (ret < 0) return ret;
+  index_remove(e);
+  return compact_after_write();
 }
 
 int storage_clear() {
-  return km_flash_erase(KALUMA_STORAGE_SECTOR_BASE,
-                        KALUMA_STORAGE_SECTOR_COUNT);
+  int ret = storage_mount();
+  if (ret == 0 && compacting) {
+    ret = compact_step(GROUP_SIZE);
+  }
+  index_reset();
+  mounted = false;
+  if (ret == 0 && !compacting) {
+    // begin an empty group first, so a power loss keeps all or nothing
+    uint8_t current = active;
+    ret = km_flash_erase(SECTOR_BASE + (1 - current) * GROUP_SECTORS,
+                         GROUP_SECTORS);
+    if (ret < 0) return ret;
+    ret = group_begin(1 - current, seq + 1, true);
+    if (ret < 0) return ret;
+    ret = km_flash_erase(SECTOR_BASE + current * GROUP_SECTORS,
+                         GROUP_SECTORS);
+  } else {
+    compacting = false;
+    ret = km_flash_erase(SECTOR_BASE, SECTOR_COUNT);
+    if (ret == 0) ret = group_begin(0, 1, true);
+  }
+  if (ret < 0) return ret;
+  mounted = true;
+  return 0;
 }
 
 int storage_get_item_count() {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(km_flash_addr + (SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE));
-  int len = 0;
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot =
-        (storage_slot_data_t *)(STORAGE_ADDR + (i * SLOT_SIZE));
-    if (slot->status == SS_USE) {
-      len++;
-    }
-  }
-  return len;
+  int ret = storage_mount();
+  if (ret < 0) return ret;
+  return item_count;
 }
@@ -24,24 +24,57 @@
 #include "board.h"
 #include "flash.h"
 
+/**
+ * The storage area is split into two groups of sectors. Records are
+ * appended to the active group, and an index in RAM (built when the storage
+ * is first used) maps keys to their latest records. When the active group
+ * is full, the live records are copied to the other group a step at each
+ * write (see storage.c).
+ */
+
 #define SECTOR_BASE KALUMA_STORAGE_SECTOR_BASE
 #define SECTOR_COUNT KALUMA_STORAGE_SECTOR_COUNT
-#define SLOT_SIZE KALUMA_FLASH_PAGE_SIZE
-#define SLOT_DATA_MAX (SLOT_SIZE - 3)
-#define SLOT_COUNT ((SECTOR_COUNT * KALUMA_FLASH_SECTOR_SIZE) / SLOT_SIZE)
+#define GROUP_SECTORS (SECTOR_COUNT / 2)
+#define GROUP_SIZE (GROUP_SECTORS * KALUMA_FLASH_SECTOR_SIZE)
+#define RECORD_ALIGN 8
+#define KEY_MAX 255
+#define VALUE_MAX 0xFFFF
+
+#if SECTOR_COUNT < 2
+#error "KALUMA_STORAGE_SECTOR_COUNT should be 2 or more"
+#endif
+
+#define STORAGE_MAGIC 0x54534D4B  // "KMST"
 
 typedef enum {
-  SS_REMOVED = 0x00,
-  SS_USE = 0xF0,
-  SS_EMPTY = 0xFF,
-} storage_slot_status_t;
+  RT_PAD = 0x00,  // RECORD_ALIGN bytes over a torn record
+  RT_SET = 0x5A,
+  RT_REMOVE = 0x50,
+  RT_EMPTY = 0xFF,
+} storage_record_type_t;
 
+/**
+ * Header at the start of each group. compacted is programmed to 0x00 when
+ * all live records of the other group are copied.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;  // incremented by each compaction
+  uint32_t crc;  // of magic and seq
+  uint8_t compacted;
+  uint8_t reserved[3];
+} storage_group_header_t;
+
+/**
+ * Record header, followed by the key and the value (and padding to
+ * RECORD_ALIGN). A record may span multiple pages.
+ */
 typedef struct {
-  uint8_t status;
+  uint8_t type;
   uint8_t key_length;
-  uint8_t value_length;
-  char buffer[SLOT_DATA_MAX];
-} storage_slot_data_t;
+  uint16_t value_length;
+  uint32_t crc;  // of type, lengths, key and value
+} storage_record_t;
 
 int storage_set_item(char *key, char *value);
 int storage_get_value_length(char *key);
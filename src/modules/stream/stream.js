@@ -1,5 +1,6 @@
 const {StdInNative, StdOutNative} = process.binding(process.binding.stream);
 const {EventEmitter} = require('events');
+const {Buffer} = require('buffer');
 
 /**
  * Astract stream class
@@ -84,7 +85,8 @@ class Readable extends __Stream {
 class Writable extends __Stream {
   constructor() {
     super();
-    this._wbuf = '';
+    this._wbuf = [];
+    this._flushing = false;
     this.writableEnded = false;
     this.writableFinished = false;
   }
@@ -117,6 +119,37 @@ class Writable extends __Stream {
     }
   }
 
+  /**
+   * @protected
+   * Append a chunk of data to the internal buffer
+   * @param {Uint8Array|string} chunk
+   */
+  _append(chunk) {
+    if (chunk && chunk.length > 0) {
+      this._wbuf.push(chunk);
+    }
+  }
+
+  /**
+   * @protected
+   * Take out all data in the internal buffer. Strings are joined, and if
+   * there is any binary chunk all are concatenated into a Buffer (strings
+   * as latin1, same bytes as written by string)
+   * @return {Uint8Array|string}
+   */
+  _take() {
+    const chunks = this._wbuf;
+    this._wbuf = [];
+    if (chunks.length === 1) {
+      return chunks[0];
+    }
+    if (chunks.every((chunk) => typeof chunk === 'string')) {
+      return chunks.join('');
+    }
+    return Buffer.concat(chunks.map((chunk) =>
+      typeof chunk === 'string' ? Buffer.from(chunk, 'latin1') : chunk));
+  }
+
   /**
    * Write a chunk of data to the stream
    * @param {Uint8Array|string} chunk
@@ -125,14 +158,15 @@ class Writable extends __Stream {
    */
   write(chunk, cb) {
     if (!this.writableEnded) {
-      if (chunk) {
-        if (chunk instanceof Uint8Array) {
-          this._wbuf += String.fromCharCode.apply(null, chunk);
-        } else { // string
-          this._wbuf += chunk;
-        }
+      this._append(chunk);
+      // flush once for all chunks written in this tick
+      if (!this._flushing) {
+        this._flushing = true;
+        setImmediate(() => {
+          this._flushing = false;
+          this.flush();
+        });
       }
-      setTimeout(() => { this.flush(); }, 0);
       if (cb) cb();
     }
     return this._wbuf.length === 0;
@@ -149,13 +183,7 @@ class Writable extends __Stream {
       cb = chunk;
       chunk = undefined;
     }
-    if (chunk) {
-      if (chunk instanceof Uint8Array) {
-        this._wbuf += String.fromCharCode.apply(null, chunk);
-      } else { // string
-        this._wbuf += chunk;
-      }
-    }
+    this._append(chunk);
     if (cb) {
       this.once('finish', cb);
     }
@@ -178,20 +206,19 @@ class Writable extends __Stream {
   flush(cb) {
     if (!this.writableFinished) {
       if (this._wbuf.length > 0) {
-        this._write(this._wbuf, (err) => {
+        this._write(this._take(), (err) => {
           if (err) {
-            this._wbuf = '';
+            this._wbuf = [];
             this.emit('error', err);
           } else {
             if (this._wbuf.length > 0) {
-              setTimeout(() => { this.flush(cb); }, 0);
+              setImmediate(() => { this.flush(cb); });
             } else {
               this.emit('drain');
               if (cb) cb();
             }
           }
         })
-        this._wbuf = '';
       } else {
         if (cb) cb();
       }
@@ -44,13 +44,11 @@ static int uart_available_cb(km_io_uart_handle_t *handle) {
 static void uart_read_cb(km_io_uart_handle_t *handle, uint8_t *buf,
                          size_t len) {
   if (jerry_value_is_function(handle->read_js_cb)) {
+    // pass the ArrayBuffer, wrapped by a Buffer in uart.js
     jerry_value_t array_buffer = jerry_create_arraybuffer(len);
     jerry_arraybuffer_write(array_buffer, 0, buf, len);
-    jerry_value_t array = jerry_create_typedarray_for_arraybuffer(
-        JERRY_TYPEDARRAY_UINT8, array_buffer);
-    jerry_release_value(array_buffer);
     jerry_value_t this_val = jerry_create_undefined();
-    jerry_value_t args_p[1] = {array};
+    jerry_value_t args_p[1] = {array_buffer};
     jerry_value_t ret_val =
         jerry_call_function(handle->read_js_cb, this_val, args_p, 1);
     if (jerry_value_is_error(ret_val)) {
@@ -58,11 +56,13 @@ static void uart_read_cb(km_io_uart_handle_t *handle, uint8_t *buf,
     }
     jerry_release_value(ret_val);
     jerry_release_value(this_val);
-    jerry_release_value(array);
+    jerry_release_value(array_buffer);
   }
 }
 
-static void uart_close_cb(km_io_handle_t *handle) { free(handle); }
+static void uart_close_cb(km_io_handle_t *handle) {
+  km_io_handle_free(handle);
+}
 
 /**
  * uart_native constructor
@@ -103,10 +103,22 @@ JERRYXX_FUN(uart_ctor_fn) {
   pins.rts =
       (int8_t)jerryxx_get_property_number(options, MSTR_UART_RTS, def_pins.rts);
 
+  // allocate io handle before the port is set up
+  km_io_uart_handle_t *handle = km_io_handle_alloc(KM_IO_UART);
+  if (handle == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  km_io_uart_init(handle);
+  if (handle->base.id == KM_IO_INVALID_ID) {  // no free slot
+    km_io_handle_free((km_io_handle_t *)handle);
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+
   // initialize the port
   int ret = km_uart_setup(port, baudrate, bits, parity, stop, flow, buffer_size,
                           pins);
   if (ret < 0) {
+    km_io_handle_free((km_io_handle_t *)handle);
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
 
@@ -125,8 +137,6 @@ JERRYXX_FUN(uart_ctor_fn) {
   jerryxx_set_property(JERRYXX_GET_THIS, "callback", callback);
 
   // setup io handle
-  km_io_uart_handle_t *handle = malloc(sizeof(km_io_uart_handle_t));
-  km_io_uart_init(handle);
   handle->read_js_cb = jerry_acquire_value(callback);
   jerryxx_set_property_number(JERRYXX_GET_THIS, "handle_id", handle->base.id);
   km_io_uart_read_start(handle, port, uart_available_cb, uart_read_cb);
@@ -162,8 +172,8 @@ JERRYXX_FUN(uart_write_fn) {
     jerry_length_t byteOffset = 0;
     jerry_value_t array_buffer =
         jerry_get_typedarray_buffer(data, &byteOffset, &byteLength);
-    size_t len = jerry_get_arraybuffer_byte_length(array_buffer);
-    uint8_t *buf = jerry_get_arraybuffer_pointer(array_buffer);
+    size_t len = byteLength;
+    uint8_t *buf = jerry_get_arraybuffer_pointer(array_buffer) + byteOffset;
     for (int c = 0; c < count; c++) {
       ret = km_uart_write(port, buf, len);
       if (ret < 0) break;
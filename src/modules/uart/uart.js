@@ -1,12 +1,13 @@
 const uart_native = process.binding(process.binding.uart)
 const {EventEmitter} = require('events');
+const {Buffer} = require('buffer');
 
 function UART(port, options) {
   EventEmitter.call(this);
   let self = this;
   options = options || {};
   this._native = new uart_native.UART(port, options, function (data) {
-    self.emit('data', data);
+    self.emit('data', Buffer.from(data)); // data is ArrayBuffer
   });
 }
 
@@ -25,6 +25,8 @@
 #include <string.h>
 #include <time.h>
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "diskio.h"
 #include "err.h"
 #include "io.h"
@@ -41,6 +43,11 @@ extern vfs_fat_root_t vfs_fat_root;
 
 static void vfs_handle_freecb(void *handle) {
   vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)handle;
+  if (vfs_handle->cache != NULL) {
+    vfs_handle->blkdev = vfs_handle->cache->dev;
+    km_blkcache_free(vfs_handle->cache);
+  }
+  km_blkdev_close(vfs_handle->blkdev);
   jerry_release_value(vfs_handle->blkdev_js);
   vfs_fat_handle_remove(vfs_handle);
   free(vfs_handle->fat_fs);
@@ -50,23 +57,55 @@ static void vfs_handle_freecb(void *handle) {
 static const jerry_object_native_info_t vfs_handle_info = {
     .free_cb = vfs_handle_freecb};
 
-static int blkdev_ioctl(jerry_value_t blkdev_js, int op, int arg) {
-  // km_tty_printf("blkdev_ioctl(%d, %d)\r\n", op, arg);
-  jerry_value_t ioctl_js = jerryxx_get_property(blkdev_js, "ioctl");
-  jerry_value_t op_js = jerry_create_number(op);
-  jerry_value_t arg_js = jerry_create_number(arg);
-  jerry_value_t args[2] = {op_js, arg_js};
-  jerry_value_t ret = jerry_call_function(ioctl_js, blkdev_js, args, 2);
-  int ret_value = 0;
-  if (jerry_value_is_number(ret)) {
-    ret_value = (int)jerry_get_number_value(ret);
-  }
-  jerry_release_value(ret);
-  jerry_release_value(arg_js);
-  jerry_release_value(op_js);
-  jerry_release_value(ioctl_js);
-  // km_tty_printf("blkdev_ioctl() ->  %d\r\n", ret_value);
-  return ret_value;
+static int blkdev_ioctl(vfs_fat_handle_t *vfs_handle, int op, int arg) {
+  return km_blkdev_ioctl(vfs_handle->blkdev, op, arg);
+}
+
+/**
+ * Block size of the device, queried once (after the device is initialized)
+ */
+static int blkdev_block_size(vfs_fat_handle_t *vfs_handle) {
+  if (vfs_handle->block_size == 0) {
+    int size = blkdev_ioctl(vfs_handle, 5, 0);
+    vfs_handle->block_size = size > 0 ? size : 0;
+  }
+  return vfs_handle->block_size;
+}
+
+/**
+ * Initialize the block device, and put a block cache of sector lines on it
+ * if the cacheSize option is given
+ */
+static int blkdev_open(vfs_fat_handle_t *vfs_handle) {
+  int ret = blkdev_ioctl(vfs_handle, KM_BLKDEV_INIT, 0);
+  // a cache already in front failed to write back its dirty lines
+  if (ret < 0 && vfs_handle->cache != NULL) {
+    return ret;
+  }
+  if (vfs_handle->cache_size > 0 && vfs_handle->cache == NULL) {
+    vfs_handle->cache = km_blkcache_create(
+        vfs_handle->blkdev, blkdev_block_size(vfs_handle),
+        vfs_handle->cache_size, vfs_handle->read_ahead);
+    if (vfs_handle->cache == NULL) {
+      return ENOMEM;
+    }
+    vfs_handle->blkdev = &vfs_handle->cache->blkdev;
+  }
+  return 0;
+}
+
+/**
+ * Shutdown the block device (the cache writes back the dirty lines), and
+ * remove the block cache. Returns the shutdown error, if any.
+ */
+static int blkdev_close(vfs_fat_handle_t *vfs_handle) {
+  int ret = blkdev_ioctl(vfs_handle, KM_BLKDEV_SHUTDOWN, 0);
+  if (vfs_handle->cache != NULL) {
+    vfs_handle->blkdev = vfs_handle->cache->dev;
+    km_blkcache_free(vfs_handle->cache);
+    vfs_handle->cache = NULL;
+  }
+  return ret;
 }
 
 static int ret_conversion(int ret) {
@@ -109,24 +148,10 @@ DRESULT disk_read(void *drv,    /* [IN] Physical drive nmuber (0..) */
   }
   // get native vfs handle
   vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)drv;
-  int block_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  jerry_value_t arraybuffer = jerry_create_arraybuffer_external(
-      count * block_size, (uint8_t *)buff, NULL);
-  jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
-      JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t read_js = jerryxx_get_property(vfs_handle->blkdev_js, "read");
-  jerry_value_t block_js = jerry_create_number(sector);
-  jerry_value_t offset_js = jerry_create_number(0);
-  jerry_value_t args[3] = {block_js, buffer_js, offset_js};
-  jerry_value_t ret =
-      jerry_call_function(read_js, vfs_handle->blkdev_js, args, 3);
-  jerry_release_value(ret);
-  jerry_release_value(offset_js);
-  jerry_release_value(block_js);
-  jerry_release_value(read_js);
-  jerry_release_value(buffer_js);
-  jerry_release_value(arraybuffer);
-  return RES_OK;
+  int block_size = blkdev_block_size(vfs_handle);
+  int ret = vfs_handle->blkdev->ops->read(vfs_handle->blkdev, sector, 0, buff,
+                                          count * block_size);
+  return ret < 0 ? RES_ERROR : RES_OK;
 }
 
 DRESULT disk_write(
@@ -140,24 +165,10 @@ DRESULT disk_write(
   }
   // get native vfs handle
   vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)drv;
-  int block_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  jerry_value_t arraybuffer = jerry_create_arraybuffer_external(
-      count * block_size, (uint8_t *)buff, NULL);
-  jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
-      JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t write_js = jerryxx_get_property(vfs_handle->blkdev_js, "write");
-  jerry_value_t block_js = jerry_create_number(sector);
-  jerry_value_t offset_js = jerry_create_number(0);
-  jerry_value_t args[3] = {block_js, buffer_js, offset_js};
-  jerry_value_t ret =
-      jerry_call_function(write_js, vfs_handle->blkdev_js, args, 3);
-  jerry_release_value(ret);
-  jerry_release_value(offset_js);
-  jerry_release_value(block_js);
-  jerry_release_value(write_js);
-  jerry_release_value(buffer_js);
-  jerry_release_value(arraybuffer);
-  return RES_OK;
+  int block_size = blkdev_block_size(vfs_handle);
+  int ret = vfs_handle->blkdev->ops->prog(vfs_handle->blkdev, sector, 0, buff,
+                                          count * block_size);
+  return ret < 0 ? RES_ERROR : RES_OK;
 }
 
 DRESULT disk_ioctl(void *drv, /* [IN] Physical drive nmuber (0..) */
@@ -173,18 +184,18 @@ DRESULT disk_ioctl(void *drv, /* [IN] Physical drive nmuber (0..) */
   switch (cmd) {
     int res;
     case CTRL_SYNC:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 3, 0);
+      res = blkdev_ioctl(vfs_handle, 3, 0);
       if (res == 0) {
         ret = RES_OK;
       }
       break;
     case GET_SECTOR_COUNT:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 4, 0);
+      res = blkdev_ioctl(vfs_handle, 4, 0);
       *(DWORD *)buff = (DWORD)res;
       ret = RES_OK;
       break;
     case GET_SECTOR_SIZE:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
+      res = blkdev_block_size(vfs_handle);
       *(WORD *)buff = (WORD)res;
       ret = RES_OK;
       break;
@@ -197,11 +208,12 @@ DRESULT disk_ioctl(void *drv, /* [IN] Physical drive nmuber (0..) */
       ret = RES_OK;
       break;
     case IOCTL_INIT:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
+      res = blkdev_ioctl(vfs_handle, 1, 0);
       if (res < 0) {
         break;
       }
       vfs_handle->status &= ~STA_NOINIT;
+      vfs_handle->block_size = 0;  // query again
       *(DSTATUS *)buff = (DSTATUS)vfs_handle->status;
       ret = RES_OK;
       break;
@@ -240,11 +252,28 @@ DWORD get_fattime(void) {
  * VFSFAT constructor
  * args:
  *   blockdev {object}
+ *   options {object}
+ *     cacheSize {number} Bytes of block cache (default: 0, no cache)
+ *     readAhead {number} Sectors the block cache reads ahead (default: 4)
  */
 JERRYXX_FUN(vfsfat_ctor_fn) {
   // check and get args
   JERRYXX_CHECK_ARG_OBJECT(0, "blkdev")
+  JERRYXX_CHECK_ARG_OBJECT_OPT(1, "options")
   jerry_value_t blkdev = JERRYXX_GET_ARG(0);
+  uint32_t cache_size = 0;
+  uint32_t read_ahead = KM_BLKCACHE_DEFAULT_READ_AHEAD;
+  if (JERRYXX_HAS_ARG(1)) {
+    jerry_value_t options = JERRYXX_GET_ARG(1);
+    cache_size = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_VFS_FAT_CACHE_SIZE, 0);
+    read_ahead = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_VFS_FAT_READ_AHEAD, KM_BLKCACHE_DEFAULT_READ_AHEAD);
+  }
+  km_blkdev_t *dev = km_blkdev_open(blkdev);
+  if (dev == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
 
   // initialize vfs native handle
   vfs_fat_handle_t *vfs_handle =
@@ -253,6 +282,11 @@ JERRYXX_FUN(vfsfat_ctor_fn) {
   vfs_fat_handle_add(vfs_handle);
   vfs_handle->blkdev_js = blkdev;
   jerry_acquire_value(vfs_handle->blkdev_js);
+  vfs_handle->blkdev = dev;
+  vfs_handle->cache = NULL;
+  vfs_handle->cache_size = cache_size;
+  vfs_handle->read_ahead = read_ahead;
+  vfs_handle->block_size = 0;
   vfs_handle->fat_fs = (FATFS *)malloc(sizeof(FATFS));
   vfs_handle->fat_fs->drv = (void *)vfs_handle;
   vfs_handle->status = STA_NOINIT;
@@ -269,13 +303,16 @@ JERRYXX_FUN(vfs_fat_mkfs_fn) {
   JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
 
   // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
-  int32_t buff_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
+  int err = blkdev_open(vfs_handle);
+  if (err < 0) {
+    return jerry_create_error_from_value(create_system_error(err), true);
+  }
+  int32_t buff_size = blkdev_block_size(vfs_handle);
   BYTE *buff = (BYTE *)malloc(sizeof(BYTE) * buff_size);
   // make fs (format)
   FRESULT ret = f_mkfs(vfs_handle->fat_fs, FM_ANY, 0, buff, buff_size);
   free(buff);
-  int err = ret_conversion(ret);
+  err = ret_conversion(ret);
   if (err < 0) {
     return jerry_create_error_from_value(create_system_error(err), true);
   }
@@ -290,10 +327,13 @@ JERRYXX_FUN(vfs_fat_mount_fn) {
   JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
 
   // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
+  int err = blkdev_open(vfs_handle);
+  if (err < 0) {
+    return jerry_create_error_from_value(create_system_error(err), true);
+  }
 
   FRESULT ret = f_mount(vfs_handle->fat_fs);
-  int err = ret_conversion(ret);
+  err = ret_conversion(ret);
   if (err < 0) {
     return jerry_create_error_from_value(create_system_error(err), true);
   }
@@ -314,10 +354,44 @@ JERRYXX_FUN(vfs_fat_unmount_fn) {
   }
 
   // shutdown block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 2, 0);
+  int close_ret = blkdev_close(vfs_handle);
+  vfs_handle->block_size = 0;
+  if (close_ret < 0) {
+    return jerry_create_error_from_value(create_system_error(close_ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * VFSFAT.prototype.flush()
+ * Write back the dirty lines of the block cache and sync the device
+ */
+JERRYXX_FUN(vfs_fat_flush_fn) {
+  // get native vfs handle
+  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
+
+  int ret = vfs_handle->blkdev->ops->sync(vfs_handle->blkdev);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
   return jerry_create_undefined();
 }
 
+/**
+ * VFSFAT.prototype.cacheStats()
+ * returns {object} - size and counters of the block cache, or undefined if
+ *   the block cache is not used
+ */
+JERRYXX_FUN(vfs_fat_cache_stats_fn) {
+  // get native vfs handle
+  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
+
+  if (vfs_handle->cache == NULL) {
+    return jerry_create_undefined();
+  }
+  return km_blkcache_create_stats_object(vfs_handle->cache);
+}
+
 /**
  * VFSFAT.prototype.open()
  * args:
@@ -390,7 +464,7 @@ JERRYXX_FUN(vfs_fat_write_fn) {
   jerry_length_t buf_offset = 0;
   jerry_value_t arrbuf =
       jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
+  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf) + buf_offset;
   jerry_release_value(arrbuf);
   UINT offset = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
   UINT length = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
@@ -445,7 +519,7 @@ JERRYXX_FUN(vfs_fat_read_fn) {
   jerry_length_t buf_offset = 0;
   jerry_value_t arrbuf =
       jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
+  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf) + buf_offset;
   jerry_release_value(arrbuf);
   UINT offset = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
   UINT length = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
@@ -688,6 +762,10 @@ jerry_value_t module_vfs_fat_init() {
                                 vfs_fat_mount_fn);
   jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_UNMOUNT,
                                 vfs_fat_unmount_fn);
+  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_FLUSH,
+                                vfs_fat_flush_fn);
+  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_CACHE_STATS,
+                                vfs_fat_cache_stats_fn);
   jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_OPEN,
                                 vfs_fat_open_fn);
   jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_WRITE,
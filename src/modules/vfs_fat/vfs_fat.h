@@ -24,6 +24,8 @@
 
 #include "diskio.h"
 #include "ff.h"
+#include "blkcache.h"
+#include "blkdev.h"
 #include "jerryscript.h"
 #include "utils.h"
 
@@ -61,6 +63,11 @@ struct vfs_fat_root_s {
 struct vfs_fat_handle_s {
   km_list_node_t base;
   jerry_value_t blkdev_js;
+  km_blkdev_t *blkdev;   // the cache, or the device if no cache
+  km_blkcache_t *cache;  // NULL if no cache
+  uint32_t cache_size;
+  uint32_t read_ahead;
+  uint32_t block_size;
   km_list_t file_handles;
   FATFS *fat_fs;
   DSTATUS status;
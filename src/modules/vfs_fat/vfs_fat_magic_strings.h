@@ -48,5 +48,9 @@
 #define MSTR_VFS_FAT_POSITION "position"
 #define MSTR_VFS_FAT_TYPE "type"
 #define MSTR_VFS_FAT_SIZE "size"
+#define MSTR_VFS_FAT_FLUSH "flush"
+#define MSTR_VFS_FAT_CACHE_STATS "cacheStats"
+#define MSTR_VFS_FAT_CACHE_SIZE "cacheSize"
+#define MSTR_VFS_FAT_READ_AHEAD "readAhead"
 
 #endif /* __VFS_FAT_MAGIC_STRINGS_H */
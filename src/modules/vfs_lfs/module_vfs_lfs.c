@@ -23,6 +23,8 @@
 
 #include <stdlib.h>
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "err.h"
 #include "io.h"
 #include "jerryscript.h"
@@ -37,6 +39,12 @@ static void vfs_handle_freecb(void *handle) {
   free(vfs_handle->config.lookahead_buffer);
   free(vfs_handle->config.prog_buffer);
   free(vfs_handle->config.read_buffer);
+  vfs_lfs_file_pool_cleanup(vfs_handle);
+  if (vfs_handle->cache != NULL) {
+    vfs_handle->blkdev = vfs_handle->cache->dev;
+    km_blkcache_free(vfs_handle->cache);
+  }
+  km_blkdev_close(vfs_handle->blkdev);
   jerry_release_value(vfs_handle->blkdev_js);
   vfs_lfs_handle_remove(handle);
   free(handle);
@@ -45,86 +53,96 @@ static void vfs_handle_freecb(void *handle) {
 static const jerry_object_native_info_t vfs_handle_info = {
     .free_cb = vfs_handle_freecb};
 
-static int blkdev_ioctl(jerry_value_t blkdev_js, int op, int arg) {
-  // km_tty_printf("blkdev_ioctl(%d, %d)\r\n", op, arg);
-  jerry_value_t ioctl_js = jerryxx_get_property(blkdev_js, "ioctl");
-  jerry_value_t op_js = jerry_create_number(op);
-  jerry_value_t arg_js = jerry_create_number(arg);
-  jerry_value_t args[2] = {op_js, arg_js};
-  jerry_value_t ret = jerry_call_function(ioctl_js, blkdev_js, args, 2);
-  int ret_value = 0;
-  if (jerry_value_is_number(ret)) {
-    ret_value = (int)jerry_get_number_value(ret);
-  }
-  jerry_release_value(ret);
-  jerry_release_value(arg_js);
-  jerry_release_value(op_js);
-  jerry_release_value(ioctl_js);
-  // km_tty_printf("blkdev_ioctl() ->  %d\r\n", ret_value);
-  return ret_value;
-}
-
 static int blkdev_read(const struct lfs_config *c, lfs_block_t block,
                        lfs_off_t off, void *buffer, lfs_size_t size) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
-  // call blockdev.read(block, buffer, offset)
-  // km_tty_printf("blkdev_read(lfs_config, %d, %d, buffer, %d)\r\n", block,
-  // off, size);
-  jerry_value_t arraybuffer =
-      jerry_create_arraybuffer_external(size, (uint8_t *)buffer, NULL);
-  jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
-      JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t read_js = jerryxx_get_property(vfs_handle->blkdev_js, "read");
-  jerry_value_t block_js = jerry_create_number(block);
-  jerry_value_t offset_js = jerry_create_number(off);
-  jerry_value_t args[3] = {block_js, buffer_js, offset_js};
-  jerry_value_t ret =
-      jerry_call_function(read_js, vfs_handle->blkdev_js, args, 3);
-  jerry_release_value(ret);
-  jerry_release_value(offset_js);
-  jerry_release_value(block_js);
-  jerry_release_value(read_js);
-  jerry_release_value(buffer_js);
-  jerry_release_value(arraybuffer);
-  return 0;
+  km_blkdev_t *blkdev = ((vfs_lfs_handle_t *)c->context)->blkdev;
+  int ret = blkdev->ops->read(blkdev, block, off, buffer, size);
+  return ret < 0 ? LFS_ERR_IO : 0;
 }
 
 static int blkdev_prog(const struct lfs_config *c, lfs_block_t block,
                        lfs_off_t off, const void *buffer, lfs_size_t size) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
-  // call blockdev.write(block, buffer, offset)
-  // km_tty_printf("blkdev_prog(lfs_config, %d, %d, buffer, %d)\r\n", block,
-  // off, size);
-  jerry_value_t arraybuffer =
-      jerry_create_arraybuffer_external(size, (uint8_t *)buffer, NULL);
-  jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
-      JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t write_js = jerryxx_get_property(vfs_handle->blkdev_js, "write");
-  jerry_value_t block_js = jerry_create_number(block);
-  jerry_value_t offset_js = jerry_create_number(off);
-  jerry_value_t args[3] = {block_js, buffer_js, offset_js};
-  jerry_value_t ret =
-      jerry_call_function(write_js, vfs_handle->blkdev_js, args, 3);
-  jerry_release_value(ret);
-  jerry_release_value(offset_js);
-  jerry_release_value(block_js);
-  jerry_release_value(write_js);
-  jerry_release_value(buffer_js);
-  jerry_release_value(arraybuffer);
-  return 0;
+  km_blkdev_t *blkdev = ((vfs_lfs_handle_t *)c->context)->blkdev;
+  int ret = blkdev->ops->prog(blkdev, block, off, buffer, size);
+  return ret < 0 ? LFS_ERR_IO : 0;
 }
 
 static int blkdev_erase(const struct lfs_config *c, lfs_block_t block) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
-  // km_tty_printf("blkdev_erase(lfs_config, %d)\r\n", block);
-  blkdev_ioctl(vfs_handle->blkdev_js, 6, block);
-  return 0;
+  km_blkdev_t *blkdev = ((vfs_lfs_handle_t *)c->context)->blkdev;
+  int ret = blkdev->ops->erase(blkdev, block, 1);
+  return ret < 0 ? LFS_ERR_IO : 0;
 }
 
 static int blkdev_sync(const struct lfs_config *c) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
-  // km_tty_printf("blkdev_sync(lfs_config)\r\n");
-  blkdev_ioctl(vfs_handle->blkdev_js, 3, 0);
+  km_blkdev_t *blkdev = ((vfs_lfs_handle_t *)c->context)->blkdev;
+  int ret = blkdev->ops->sync(blkdev);
+  return ret < 0 ? LFS_ERR_IO : 0;
+}
+
+/**
+ * Initialize the block device, and put a block cache of prog_size lines on
+ * it if the cacheSize option is given
+ */
+static int blkdev_open(vfs_lfs_handle_t *vfs_handle) {
+  int ret = km_blkdev_ioctl(vfs_handle->blkdev, KM_BLKDEV_INIT, 0);
+  // a cache already in front failed to write back its dirty lines
+  if (ret < 0 && vfs_handle->cache != NULL) {
+    return ret;
+  }
+  if (vfs_handle->cache_size > 0 && vfs_handle->cache == NULL) {
+    vfs_handle->cache = km_blkcache_create(
+        vfs_handle->blkdev, vfs_handle->config.prog_size,
+        vfs_handle->cache_size, vfs_handle->read_ahead);
+    if (vfs_handle->cache == NULL) {
+      return ENOMEM;
+    }
+    vfs_handle->blkdev = &vfs_handle->cache->blkdev;
+  }
+  return 0;
+}
+
+/**
+ * Shutdown the block device (the cache writes back the dirty lines), and
+ * remove the block cache. Returns the shutdown error, if any.
+ */
+static int blkdev_close(vfs_lfs_handle_t *vfs_handle) {
+  int ret = km_blkdev_ioctl(vfs_handle->blkdev, KM_BLKDEV_SHUTDOWN, 0);
+  if (vfs_handle->cache != NULL) {
+    vfs_handle->blkdev = vfs_handle->cache->dev;
+    km_blkcache_free(vfs_handle->cache);
+    vfs_handle->cache = NULL;
+  }
+  return ret;
+}
+
+/**
+ * Check the littlefs configuration against the block device
+ */
+static int config_check(const struct lfs_config *c) {
+  if (c->read_size == 0 || c->prog_size == 0 || c->block_size == 0 ||
+      c->block_count == 0 || c->cache_size == 0 ||
+      c->cache_size % c->read_size != 0 ||
+      c->cache_size % c->prog_size != 0 ||
+      c->block_size % c->cache_size != 0) {
+    return EINVAL;
+  }
+  if (c->lookahead_size == 0 || c->lookahead_size % 8 != 0) {
+    return EINVAL;
+  }
+  if (c->block_cycles == 0 || c->block_cycles < -1) {
+    return EINVAL;
+  }
+  if (c->name_max == 0 || c->name_max > LFS_NAME_MAX || c->attr_max == 0 ||
+      c->attr_max > LFS_ATTR_MAX) {
+    return EINVAL;
+  }
+#if LFS_VERSION >= 0x00020009
+  if (c->inline_max != (lfs_size_t)-1 &&
+      (c->inline_max > c->cache_size || c->inline_max > c->attr_max ||
+       c->inline_max > c->block_size / 8)) {
+    return EINVAL;
+  }
+#endif
   return 0;
 }
 
@@ -132,11 +150,86 @@ static int blkdev_sync(const struct lfs_config *c) {
  * VFSLittleFS constructor
  * args:
  *   blockdev {object}
+ *   options {object}
+ *     cacheSize {number} Bytes of block cache (default: 0, no cache)
+ *     readAhead {number} Lines the block cache reads ahead (default: 4)
+ *     bufferSize {number} Bytes of the read, prog and per-file buffers of
+ *       littlefs (cache_size). A multiple of the device buffer size, and a
+ *       divisor of the block size (default: the device buffer size)
+ *     lookaheadSize {number} Bytes of the lookahead buffer, a multiple of 8
+ *       (default: the device buffer size)
+ *     blockCycles {number} Erase cycles before moving metadata, or -1 to
+ *       disable wear leveling (default: 500)
+ *     inlineMax {number} Max bytes of a file inlined in its directory, or -1
+ *       to disable (default: 0, littlefs default)
+ *     attrMax {number} Max bytes of custom attributes (default: 512)
+ *     nameMax {number} Max bytes of file names (default: 255)
  */
 JERRYXX_FUN(vfslfs_ctor_fn) {
   // check and get args
   JERRYXX_CHECK_ARG_OBJECT(0, "blkdev")
+  JERRYXX_CHECK_ARG_OBJECT_OPT(1, "options")
   jerry_value_t blkdev = JERRYXX_GET_ARG(0);
+  km_blkdev_t *dev = km_blkdev_open(blkdev);
+  if (dev == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+
+  // littlefs configuration
+  int block_count = km_blkdev_ioctl(dev, KM_BLKDEV_BLOCK_COUNT, 0);
+  int block_size = km_blkdev_ioctl(dev, KM_BLKDEV_BLOCK_SIZE, 0);
+  int unit_size = km_blkdev_ioctl(dev, KM_BLKDEV_BUFFER_SIZE, 0);
+  struct lfs_config config = {0};
+  config.read_size = unit_size > 0 ? unit_size : 0;
+  config.prog_size = config.read_size;
+  config.block_size = block_size > 0 ? block_size : 0;
+  config.block_count = block_count > 0 ? block_count : 0;
+  config.cache_size = config.read_size;
+  config.lookahead_size = config.read_size;
+  config.name_max = LFS_NAME_MAX;
+  config.file_max = 1024 * 1024 * 16;  // 16MB
+  config.attr_max = 512;
+  config.block_cycles = 500;
+  uint32_t cache_size = 0;
+  uint32_t read_ahead = KM_BLKCACHE_DEFAULT_READ_AHEAD;
+  if (JERRYXX_HAS_ARG(1)) {
+    jerry_value_t options = JERRYXX_GET_ARG(1);
+    cache_size = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_CACHE_SIZE, 0);
+    read_ahead = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_READ_AHEAD, KM_BLKCACHE_DEFAULT_READ_AHEAD);
+    config.cache_size = (lfs_size_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_BUFFER_SIZE, config.cache_size);
+    config.lookahead_size = (lfs_size_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_LOOKAHEAD_SIZE, config.lookahead_size);
+    config.block_cycles = (int32_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_BLOCK_CYCLES, config.block_cycles);
+    config.attr_max = (lfs_size_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_ATTR_MAX, config.attr_max);
+    config.name_max = (lfs_size_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_NAME_MAX, config.name_max);
+#if LFS_VERSION >= 0x00020009
+    config.inline_max = (lfs_size_t)(int32_t)jerryxx_get_property_number(
+        options, MSTR_VFS_LFS_INLINE_MAX, 0);
+#endif
+  }
+  int ret = config_check(&config);
+  if (ret == 0) {
+    config.read_buffer = malloc(config.cache_size);
+    config.prog_buffer = malloc(config.cache_size);
+    config.lookahead_buffer = malloc(config.lookahead_size);
+    if (config.read_buffer == NULL || config.prog_buffer == NULL ||
+        config.lookahead_buffer == NULL) {
+      free(config.lookahead_buffer);
+      free(config.prog_buffer);
+      free(config.read_buffer);
+      ret = ENOMEM;
+    }
+  }
+  if (ret < 0) {
+    km_blkdev_close(dev);
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
 
   // initialize vfs native handle
   vfs_lfs_handle_t *vfs_handle =
@@ -145,28 +238,16 @@ JERRYXX_FUN(vfslfs_ctor_fn) {
   vfs_lfs_handle_add(vfs_handle);
   vfs_handle->blkdev_js = blkdev;
   jerry_acquire_value(vfs_handle->blkdev_js);
+  vfs_handle->blkdev = dev;
+  vfs_handle->cache = NULL;
+  vfs_handle->cache_size = cache_size;
+  vfs_handle->read_ahead = read_ahead;
+  vfs_handle->config = config;
   vfs_handle->config.context = vfs_handle;
   vfs_handle->config.read = blkdev_read;
   vfs_handle->config.prog = blkdev_prog;
   vfs_handle->config.erase = blkdev_erase;
   vfs_handle->config.sync = blkdev_sync;
-  int block_count = blkdev_ioctl(vfs_handle->blkdev_js, 4, 0);
-  int block_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  int unit_size = blkdev_ioctl(vfs_handle->blkdev_js, 7, 0);
-  vfs_handle->config.read_size = unit_size;
-  vfs_handle->config.prog_size = unit_size;
-  vfs_handle->config.block_size = block_size;
-  vfs_handle->config.block_count = block_count;
-  vfs_handle->config.cache_size = unit_size;
-  vfs_handle->config.lookahead_size = unit_size;
-  vfs_handle->config.name_max = 255;
-  vfs_handle->config.file_max = 1024 * 1024 * 16;  // 16MB
-  vfs_handle->config.attr_max = 512;
-  vfs_handle->config.block_cycles = 500;
-  vfs_handle->config.read_buffer = malloc(vfs_handle->config.cache_size);
-  vfs_handle->config.prog_buffer = malloc(vfs_handle->config.cache_size);
-  vfs_handle->config.lookahead_buffer =
-      malloc(vfs_handle->config.lookahead_size);
 
   // assign native handle in js object
   jerry_set_object_native_pointer(this_val, vfs_handle, &vfs_handle_info);
@@ -182,10 +263,13 @@ JERRYXX_FUN(vfs_lfs_mkfs_fn) {
   JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
 
   // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
+  int ret = blkdev_open(vfs_handle);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
 
   // make fs (format)
-  int ret = lfs_format(&vfs_handle->lfs, &vfs_handle->config);
+  ret = lfs_format(&vfs_handle->lfs, &vfs_handle->config);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
@@ -200,10 +284,13 @@ JERRYXX_FUN(vfs_lfs_mount_fn) {
   JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
 
   // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
+  int ret = blkdev_open(vfs_handle);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
 
   // mount vfs
-  int ret = lfs_mount(&vfs_handle->lfs, &vfs_handle->config);
+  ret = lfs_mount(&vfs_handle->lfs, &vfs_handle->config);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
@@ -224,7 +311,84 @@ JERRYXX_FUN(vfs_lfs_unmount_fn) {
   }
 
   // shutdown block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 2, 0);
+  int close_ret = blkdev_close(vfs_handle);
+  if (close_ret < 0) {
+    return jerry_create_error_from_value(create_system_error(close_ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * VFSLittleFS.prototype.flush()
+ * Write back the dirty lines of the block cache and sync the device
+ */
+JERRYXX_FUN(vfs_lfs_flush_fn) {
+  // get native vfs handle
+  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
+
+  int ret = vfs_handle->blkdev->ops->sync(vfs_handle->blkdev);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * VFSLittleFS.prototype.cacheStats()
+ * returns {object} - size and counters of the block cache, or undefined if
+ *   the block cache is not used
+ */
+JERRYXX_FUN(vfs_lfs_cache_stats_fn) {
+  // get native vfs handle
+  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
+
+  if (vfs_handle->cache == NULL) {
+    return jerry_create_undefined();
+  }
+  return km_blkcache_create_stats_object(vfs_handle->cache);
+}
+
+/**
+ * VFSLittleFS.prototype.statfs()
+ * returns {object} - {bsize, blocks, bfree, bavail}. Traverses the file
+ *   system to count the blocks in use.
+ */
+JERRYXX_FUN(vfs_lfs_statfs_fn) {
+  // get native vfs handle
+  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
+
+  lfs_ssize_t used = lfs_fs_size(&vfs_handle->lfs);
+  if (used < 0) {
+    return jerry_create_error_from_value(create_system_error(used), true);
+  }
+  uint32_t free_blocks = vfs_handle->config.block_count - used;
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, MSTR_VFS_LFS_BSIZE,
+                              vfs_handle->config.block_size);
+  jerryxx_set_property_number(obj, MSTR_VFS_LFS_BLOCKS,
+                              vfs_handle->config.block_count);
+  jerryxx_set_property_number(obj, MSTR_VFS_LFS_BFREE, free_blocks);
+  jerryxx_set_property_number(obj, MSTR_VFS_LFS_BAVAIL, free_blocks);
+  return obj;
+}
+
+/**
+ * VFSLittleFS.prototype.gc()
+ * Find free blocks (and compact metadata) ahead, so that it is not done
+ * while writing
+ */
+JERRYXX_FUN(vfs_lfs_gc_fn) {
+  // get native vfs handle
+  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
+
+#if LFS_VERSION >= 0x00020008
+  int ret = lfs_fs_gc(&vfs_handle->lfs);
+#else
+  int ret = ENOSYS;
+#endif
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
   return jerry_create_undefined();
 }
 
@@ -257,12 +421,17 @@ JERRYXX_FUN(vfs_lfs_open_fn) {
   // get native vfs handle
   JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
 
-  // create file handle
-  vfs_lfs_file_handle_t *file = malloc(sizeof(vfs_lfs_file_handle_t));
+  // create file handle (with the file buffer)
+  vfs_lfs_file_handle_t *file = vfs_lfs_file_alloc(vfs_handle);
+  if (file == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
 
   // file open
-  int ret = lfs_file_open(&vfs_handle->lfs, &file->lfs_file, path, lfs_flags);
+  int ret = lfs_file_opencfg(&vfs_handle->lfs, &file->lfs_file, path,
+                             lfs_flags, &file->config);
   if (ret < 0) {
+    vfs_lfs_file_free(vfs_handle, file);
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
 
@@ -295,7 +464,7 @@ JERRYXX_FUN(vfs_lfs_write_fn) {
   jerry_length_t buf_offset = 0;
   jerry_value_t arrbuf =
       jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
+  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf) + buf_offset;
   jerry_release_value(arrbuf);
   int offset = (int)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
   int length = (int)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
@@ -348,7 +517,7 @@ JERRYXX_FUN(vfs_lfs_read_fn) {
   jerry_length_t buf_offset = 0;
   jerry_value_t arrbuf =
       jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
+  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf) + buf_offset;
   jerry_release_value(arrbuf);
   int offset = (int)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
   int length = (int)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
@@ -400,7 +569,7 @@ JERRYXX_FUN(vfs_lfs_close_fn) {
 
   // remote file handle
   vfs_lfs_file_remove(vfs_handle, file);
-  free(file);
+  vfs_lfs_file_free(vfs_handle, file);
 
   // return
   return jerry_create_undefined();
@@ -581,6 +750,14 @@ jerry_value_t module_vfs_lfs_init() {
                                 vfs_lfs_mount_fn);
   jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_UNMOUNT,
                                 vfs_lfs_unmount_fn);
+  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_FLUSH,
+                                vfs_lfs_flush_fn);
+  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_CACHE_STATS,
+                                vfs_lfs_cache_stats_fn);
+  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_STATFS,
+                                vfs_lfs_statfs_fn);
+  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_GC,
+                                vfs_lfs_gc_fn);
   jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_OPEN,
                                 vfs_lfs_open_fn);
   jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_WRITE,
@@ -47,6 +47,8 @@ void vfs_lfs_cleanup() {
 
 void vfs_lfs_handle_init(vfs_lfs_handle_t *handle) {
   km_list_init(&handle->file_handles);
+  km_list_init(&handle->file_pool);
+  handle->file_pool_count = 0;
 }
 
 void vfs_lfs_handle_add(vfs_lfs_handle_t *handle) {
@@ -80,3 +82,48 @@ vfs_lfs_file_handle_t *vfs_lfs_file_get_by_id(vfs_lfs_handle_t *handle,
   }
   return NULL;
 }
+
+/**
+ * Get a file handle with a buffer of cache_size, from the pool if any
+ */
+vfs_lfs_file_handle_t *vfs_lfs_file_alloc(vfs_lfs_handle_t *handle) {
+  vfs_lfs_file_handle_t *file =
+      (vfs_lfs_file_handle_t *)handle->file_pool.head;
+  if (file != NULL) {
+    km_list_remove(&handle->file_pool, (km_list_node_t *)file);
+    handle->file_pool_count--;
+    return file;
+  }
+  file = malloc(sizeof(vfs_lfs_file_handle_t) + handle->config.cache_size);
+  if (file != NULL) {
+    file->config.buffer = (uint8_t *)(file + 1);
+    file->config.attrs = NULL;
+    file->config.attr_count = 0;
+  }
+  return file;
+}
+
+/**
+ * Return a file handle (not in the file handles) to the pool
+ */
+void vfs_lfs_file_free(vfs_lfs_handle_t *handle, vfs_lfs_file_handle_t *file) {
+  if (handle->file_pool_count < VFS_LFS_FILE_POOL_MAX) {
+    km_list_append(&handle->file_pool, (km_list_node_t *)file);
+    handle->file_pool_count++;
+  } else {
+    free(file);
+  }
+}
+
+void vfs_lfs_file_pool_cleanup(vfs_lfs_handle_t *handle) {
+  vfs_lfs_file_handle_t *file =
+      (vfs_lfs_file_handle_t *)handle->file_pool.head;
+  while (file != NULL) {
+    vfs_lfs_file_handle_t *next =
+        (vfs_lfs_file_handle_t *)((km_list_node_t *)file)->next;
+    free(file);
+    file = next;
+  }
+  km_list_init(&handle->file_pool);
+  handle->file_pool_count = 0;
+}
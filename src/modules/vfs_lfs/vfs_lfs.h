@@ -22,6 +22,8 @@
 #ifndef __VFSLFS_H
 #define __VFSLFS_H
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "jerryscript.h"
 #include "lfs.h"
 #include "utils.h"
@@ -32,6 +34,8 @@
     return jerry_create_error_from_value(create_system_error(-9), true); \
   }
 
+#define VFS_LFS_FILE_POOL_MAX 4  // closed file handles kept for reuse
+
 typedef struct vfs_lfs_root_s vfs_lfs_root_t;
 typedef struct vfs_lfs_handle_s vfs_lfs_handle_t;
 typedef struct vfs_lfs_file_handle_s vfs_lfs_file_handle_t;
@@ -56,13 +60,20 @@ struct vfs_lfs_handle_s {
   lfs_t lfs;
   struct lfs_config config;
   km_list_t file_handles;
+  km_list_t file_pool;  // closed file handles (with buffers) to reuse
+  uint32_t file_pool_count;
   jerry_value_t blkdev_js;
+  km_blkdev_t *blkdev;   // the cache, or the device if no cache
+  km_blkcache_t *cache;  // NULL if no cache
+  uint32_t cache_size;
+  uint32_t read_ahead;
 };
 
 struct vfs_lfs_file_handle_s {
   km_list_node_t base;
   uint32_t id;
   lfs_file_t lfs_file;
+  struct lfs_file_config config;  // buffer of config.cache_size follows
 };
 
 void vfs_lfs_init();
@@ -73,5 +84,8 @@ void vfs_lfs_handle_remove(vfs_lfs_handle_t *);
 void vfs_lfs_file_add(vfs_lfs_handle_t *, vfs_lfs_file_handle_t *);
 void vfs_lfs_file_remove(vfs_lfs_handle_t *, vfs_lfs_file_handle_t *);
 vfs_lfs_file_handle_t *vfs_lfs_file_get_by_id(vfs_lfs_handle_t *, uint32_t);
+vfs_lfs_file_handle_t *vfs_lfs_file_alloc(vfs_lfs_handle_t *);
+void vfs_lfs_file_free(vfs_lfs_handle_t *, vfs_lfs_file_handle_t *);
+void vfs_lfs_file_pool_cleanup(vfs_lfs_handle_t *);
 
 #endif /* __VFSLFS_H */
\ No newline at end of file
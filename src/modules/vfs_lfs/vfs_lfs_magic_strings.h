@@ -48,5 +48,21 @@
 #define MSTR_VFS_LFS_POSITION "position"
 #define MSTR_VFS_LFS_TYPE "type"
 #define MSTR_VFS_LFS_SIZE "size"
+#define MSTR_VFS_LFS_FLUSH "flush"
+#define MSTR_VFS_LFS_CACHE_STATS "cacheStats"
+#define MSTR_VFS_LFS_CACHE_SIZE "cacheSize"
+#define MSTR_VFS_LFS_READ_AHEAD "readAhead"
+#define MSTR_VFS_LFS_BUFFER_SIZE "bufferSize"
+#define MSTR_VFS_LFS_LOOKAHEAD_SIZE "lookaheadSize"
+#define MSTR_VFS_LFS_BLOCK_CYCLES "blockCycles"
+#define MSTR_VFS_LFS_INLINE_MAX "inlineMax"
+#define MSTR_VFS_LFS_ATTR_MAX "attrMax"
+#define MSTR_VFS_LFS_NAME_MAX "nameMax"
+#define MSTR_VFS_LFS_STATFS "statfs"
+#define MSTR_VFS_LFS_GC "gc"
+#define MSTR_VFS_LFS_BSIZE "bsize"
+#define MSTR_VFS_LFS_BLOCKS "blocks"
+#define MSTR_VFS_LFS_BFREE "bfree"
+#define MSTR_VFS_LFS_BAVAIL "bavail"
 
 #endif /* __VFS_LFS_MAGIC_STRINGS_H */
@@ -0,0 +1,5 @@
+list(APPEND SOURCES
+  ${SRC_DIR}/modules/virtual_display/module_virtual_display.c)
+
+include_directories(
+  ${SRC_DIR}/modules/virtual_display)
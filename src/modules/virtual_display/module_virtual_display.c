@@ -0,0 +1,425 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "module_virtual_display.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "jerryscript.h"
+#include "jerryxx.h"
+#include "magic_strings.h"
+#include "system.h"
+#include "utils.h"
+#include "virtual_display_magic_strings.h"
+
+/**
+ * Virtual display. The frame is kept as a binary PPM image (RGB 8-8-8) which
+ * is either a memory-mapped file updated in place, or in memory and written
+ * to a new file for each frame when the output path has "%d".
+ *
+ * Transfers are accounted as a SPI panel would take them: command bytes to
+ * set the address window followed by the pixel data of the region (whole
+ * pages for 1-bit and whole rows for 3-bit panels).
+ */
+typedef struct {
+  int16_t width;
+  int16_t height;
+  uint8_t bpp;
+  uint32_t spi_clock;
+  uint32_t command_bytes;
+  bool realtime;
+  char *output;  // path of the image, or of the frames if it has "%d"
+  bool sequence;
+  bool mapped;
+  uint8_t *image;  // PPM header + pixels
+  uint32_t image_size;
+  uint32_t header_size;
+  uint32_t frames;
+  uint32_t transfers;
+  uint64_t bytes;
+  uint64_t frame_bytes;  // bytes of the current frame
+  uint64_t last_frame_bytes;
+} vd_handle_t;
+
+static void vd_handle_freecb(void *handle) {
+  vd_handle_t *vd = (vd_handle_t *)handle;
+  if (vd->mapped) {
+    munmap(vd->image, vd->image_size);
+  } else {
+    free(vd->image);
+  }
+  free(vd->output);
+  free(vd);
+}
+
+static const jerry_object_native_info_t vd_handle_info = {
+    .free_cb = vd_handle_freecb};
+
+/**
+ * Transfer time in microseconds of the bytes at the SPI clock
+ */
+static double vd_transfer_time(vd_handle_t *vd, uint64_t bytes) {
+  return (double)bytes * 8 * 1000000 / vd->spi_clock;
+}
+
+/**
+ * Allocate the image, or map the output file as the image
+ */
+static bool vd_image_open(vd_handle_t *vd) {
+  char header[32];
+  vd->header_size = (uint32_t)snprintf(header, sizeof(header),
+                                       "P6\n%d %d\n255\n", vd->width,
+                                       vd->height);
+  vd->image_size = vd->header_size + (uint32_t)vd->width * vd->height * 3;
+  if (vd->output != NULL && !vd->sequence) {
+    int fd = open(vd->output, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return false;
+    }
+    if (ftruncate(fd, vd->image_size) < 0) {
+      close(fd);
+      return false;
+    }
+    void *addr = mmap(NULL, vd->image_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      return false;
+    }
+    vd->image = (uint8_t *)addr;
+    vd->mapped = true;
+  } else {
+    vd->image = (uint8_t *)malloc(vd->image_size);
+    if (vd->image == NULL) {
+      return false;
+    }
+  }
+  memcpy(vd->image, header, vd->header_size);
+  memset(vd->image + vd->header_size, 0, vd->image_size - vd->header_size);
+  return true;
+}
+
+/**
+ * Write the image to the file of the frame number
+ */
+static bool vd_image_write(vd_handle_t *vd, uint32_t frame) {
+  char path[PATH_MAX];
+  const char *mark = strstr(vd->output, "%d");
+  int len = snprintf(path, sizeof(path), "%.*s%05u%s",
+                     (int)(mark - vd->output), vd->output, frame, mark + 2);
+  if (len < 0 || len >= (int)sizeof(path)) {
+    return false;
+  }
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = fwrite(vd->image, 1, vd->image_size, file) == vd->image_size;
+  return fclose(file) == 0 && ok;
+}
+
+/**
+ * Convert the rows of the buffer to RGB 8-8-8 in the image
+ * @param data    Rows of the region (from row y)
+ * @param stride  Bytes per row (per page of 8 rows for 1-bit)
+ */
+static void vd_convert(vd_handle_t *vd, const uint8_t *data, uint32_t stride,
+                       int16_t x, int16_t y, int16_t w, int16_t h) {
+  for (int16_t yy = y; yy < y + h; yy++) {
+    uint8_t *rgb = vd->image + vd->header_size +
+                   ((uint32_t)yy * vd->width + x) * 3;
+    for (int16_t xx = x; xx < x + w; xx++, rgb += 3) {
+      if (vd->bpp == 16) {
+        const uint8_t *p = data + (yy - y) * stride + xx * 2;
+        uint16_t c = (p[0] << 8) | p[1];  // big-endian RGB 5-6-5
+        rgb[0] = ((c >> 8) & 0xF8) | (c >> 13);
+        rgb[1] = ((c >> 3) & 0xFC) | ((c >> 9) & 0x03);
+        rgb[2] = ((c << 3) & 0xF8) | ((c >> 2) & 0x07);
+      } else if (vd->bpp == 3) {
+        uint8_t b = data[(yy - y) * stride + xx / 2];
+        uint8_t c = xx % 2 ? b & 0x07 : (b >> 3) & 0x07;  // 0 is on
+        rgb[0] = c & 0x04 ? 0 : 0xFF;
+        rgb[1] = c & 0x02 ? 0 : 0xFF;
+        rgb[2] = c & 0x01 ? 0 : 0xFF;
+      } else {
+        uint8_t b = data[(yy / 8 - y / 8) * stride + xx];
+        rgb[0] = rgb[1] = rgb[2] = b & (1 << (yy % 8)) ? 0xFF : 0;
+      }
+    }
+  }
+}
+
+/**
+ * Display(width, height, options) constructor
+ * args:
+ *   width {number}
+ *   height {number}
+ *   options {object}
+ *     bpp {number} 1, 3 or 16. default: 16
+ *     spiClock {number} SPI clock in Hz. default: 40000000
+ *     commandBytes {number} bytes sent before the pixels of each transfer.
+ *       default: 11 (column/row address and memory write commands)
+ *     realtime {boolean} take as long as the transfers. default: false
+ *     output {string} path of the image (PPM), or of the frames if it has
+ *       "%d" (replaced by the frame number). default: no output
+ */
+JERRYXX_FUN(vd_ctor_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "width")
+  JERRYXX_CHECK_ARG_NUMBER(1, "height")
+  JERRYXX_CHECK_ARG_OBJECT_OPT(2, "options")
+  vd_handle_t *vd = (vd_handle_t *)calloc(1, sizeof(vd_handle_t));
+  if (vd == NULL) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Not enough memory.");
+  }
+  jerry_set_object_native_pointer(this_val, vd, &vd_handle_info);
+  vd->width = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  vd->height = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  vd->bpp = 16;
+  vd->spi_clock = 40000000;
+  vd->command_bytes = 11;
+  if (JERRYXX_HAS_ARG(2)) {
+    jerry_value_t options = JERRYXX_GET_ARG(2);
+    vd->bpp = (uint8_t)jerryxx_get_property_number(
+        options, MSTR_VIRTUAL_DISPLAY_BPP, 16);
+    vd->spi_clock = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_VIRTUAL_DISPLAY_SPI_CLOCK, 40000000);
+    vd->command_bytes = (uint32_t)jerryxx_get_property_number(
+        options, MSTR_VIRTUAL_DISPLAY_COMMAND_BYTES, 11);
+    vd->realtime = jerryxx_get_property_boolean(
+        options, MSTR_VIRTUAL_DISPLAY_REALTIME, false);
+    jerry_value_t output =
+        jerryxx_get_property(options, MSTR_VIRTUAL_DISPLAY_OUTPUT);
+    if (jerry_value_is_string(output)) {
+      jerry_size_t len = jerryxx_get_ascii_string_size(output);
+      vd->output = (char *)malloc(len + 1);
+      if (vd->output != NULL) {
+        jerryxx_string_to_ascii_char_buffer(output, (uint8_t *)vd->output,
+                                            len);
+        vd->output[len] = '\0';
+        vd->sequence = strstr(vd->output, "%d") != NULL;
+      }
+    }
+    jerry_release_value(output);
+  }
+  if (vd->width <= 0 || vd->height <= 0 || vd->spi_clock == 0 ||
+      (vd->bpp != 1 && vd->bpp != 3 && vd->bpp != 16)) {
+    return jerry_create_error(
+        JERRY_ERROR_RANGE,
+        (const jerry_char_t *)"Invalid size, bpp or spiClock.");
+  }
+  if (!vd_image_open(vd)) {
+    return jerry_create_error(
+        JERRY_ERROR_COMMON, (const jerry_char_t *)"Failed to open output.");
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Display.prototype.update(buffer, region)
+ * Take the region passed to the display callback of BufferedGraphicsContext.
+ * args:
+ *   buffer {Uint8Array} whole buffer
+ *   region {object} dirty region (device space) with rows in data. The
+ *     whole buffer if not given.
+ */
+JERRYXX_FUN(vd_update_fn) {
+  JERRYXX_CHECK_ARG_TYPEDARRAY(0, "buffer")
+  JERRYXX_GET_NATIVE_HANDLE(vd, vd_handle_t, vd_handle_info);
+  jerry_value_t data = JERRYXX_GET_ARG(0);
+  int16_t x = 0;
+  int16_t y = 0;
+  int16_t w = vd->width;
+  int16_t h = vd->height;
+  uint32_t stride = vd->bpp == 16  ? vd->width * 2
+                    : vd->bpp == 3 ? vd->width / 2
+                                   : vd->width;
+  if (JERRYXX_HAS_ARG(1) && jerry_value_is_object(JERRYXX_GET_ARG(1))) {
+    jerry_value_t region = JERRYXX_GET_ARG(1);
+    x = (int16_t)jerryxx_get_property_number(region, MSTR_VIRTUAL_DISPLAY_X,
+                                             0);
+    y = (int16_t)jerryxx_get_property_number(region, MSTR_VIRTUAL_DISPLAY_Y,
+                                             0);
+    w = (int16_t)jerryxx_get_property_number(region,
+                                             MSTR_VIRTUAL_DISPLAY_WIDTH, 0);
+    h = (int16_t)jerryxx_get_property_number(region,
+                                             MSTR_VIRTUAL_DISPLAY_HEIGHT, 0);
+    stride = (uint32_t)jerryxx_get_property_number(
+        region, MSTR_VIRTUAL_DISPLAY_STRIDE, stride);
+    data = jerryxx_get_property(region, MSTR_VIRTUAL_DISPLAY_DATA);
+  } else {
+    data = jerry_acquire_value(data);
+  }
+  if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > vd->width ||
+      y + h > vd->height || !jerry_value_is_typedarray(data)) {
+    jerry_release_value(data);
+    return jerry_create_undefined();
+  }
+  jerry_length_t byteOffset = 0;
+  jerry_length_t byteLength = 0;
+  jerry_value_t arraybuffer =
+      jerry_get_typedarray_buffer(data, &byteOffset, &byteLength);
+  const uint8_t *pointer = jerry_get_arraybuffer_pointer(arraybuffer);
+  jerry_release_value(arraybuffer);
+  jerry_release_value(data);
+  uint32_t rows = vd->bpp == 1 ? (uint32_t)((y + h + 7) / 8 - y / 8) : h;
+  if (byteLength < rows * stride) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Region out of buffer.");
+  }
+  vd_convert(vd, pointer + byteOffset, stride, x, y, w, h);
+
+  // bytes on the wire: whole pages for 1-bit and whole rows for 3-bit
+  uint64_t bytes = vd->command_bytes;
+  if (vd->bpp == 16) {
+    bytes += (uint64_t)w * h * 2;
+  } else if (vd->bpp == 3) {
+    bytes += (uint64_t)h * stride;
+  } else {
+    bytes += (uint64_t)w * rows;
+  }
+  vd->transfers++;
+  vd->bytes += bytes;
+  vd->frame_bytes += bytes;
+  if (vd->realtime) {
+    km_micro_delay((uint32_t)vd_transfer_time(vd, bytes));
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Display.prototype.endFrame()
+ * Count a frame and write it if the output is a sequence of files.
+ */
+JERRYXX_FUN(vd_end_frame_fn) {
+  JERRYXX_GET_NATIVE_HANDLE(vd, vd_handle_t, vd_handle_info);
+  uint32_t frame = vd->frames++;
+  vd->last_frame_bytes = vd->frame_bytes;
+  vd->frame_bytes = 0;
+  if (vd->sequence && !vd_image_write(vd, frame)) {
+    return jerry_create_error(
+        JERRY_ERROR_COMMON, (const jerry_char_t *)"Failed to write frame.");
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Display.prototype.getPixel(x, y)
+ * returns:
+ *   {number} color of the pixel shown in RGB 8-8-8 (0xRRGGBB), or -1
+ */
+JERRYXX_FUN(vd_get_pixel_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "x")
+  JERRYXX_CHECK_ARG_NUMBER(1, "y")
+  int16_t x = (int16_t)JERRYXX_GET_ARG_NUMBER(0);
+  int16_t y = (int16_t)JERRYXX_GET_ARG_NUMBER(1);
+  JERRYXX_GET_NATIVE_HANDLE(vd, vd_handle_t, vd_handle_info);
+  if (x < 0 || y < 0 || x >= vd->width || y >= vd->height) {
+    return jerry_create_number(-1);
+  }
+  uint8_t *rgb =
+      vd->image + vd->header_size + ((uint32_t)y * vd->width + x) * 3;
+  return jerry_create_number((rgb[0] << 16) | (rgb[1] << 8) | rgb[2]);
+}
+
+/**
+ * Display.prototype.checksum()
+ * returns:
+ *   {number} CRC32 of the pixels shown, to compare frames in tests
+ */
+JERRYXX_FUN(vd_checksum_fn) {
+  JERRYXX_GET_NATIVE_HANDLE(vd, vd_handle_t, vd_handle_info);
+  return jerry_create_number(km_crc32(0, vd->image + vd->header_size,
+                                      vd->image_size - vd->header_size));
+}
+
+/**
+ * Display.prototype.stats()
+ * returns:
+ *   {object} frames, transfers, bytes sent and the time to send them (us)
+ *     since start or the last reset, and the same for the last frame
+ */
+JERRYXX_FUN(vd_stats_fn) {
+  JERRYXX_GET_NATIVE_HANDLE(vd, vd_handle_t, vd_handle_info);
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, MSTR_VIRTUAL_DISPLAY_FRAMES, vd->frames);
+  jerryxx_set_property_number(obj, MSTR_VIRTUAL_DISPLAY_TRANSFERS,
+                              vd->transfers);
+  jerryxx_set_property_number(obj, MSTR_VIRTUAL_DISPLAY_BYTES,
+                              (double)vd->bytes);
+  jerryxx_set_property_number(obj, MSTR_VIRTUAL_DISPLAY_BUSY_TIME,
+                              vd_transfer_time(vd, vd->bytes));
+  jerryxx_set_property_number(obj, MSTR_VIRTUAL_DISPLAY_LAST_FRAME_BYTES,
+                              (double)vd->last_frame_bytes);
+  jerryxx_set_property_number(obj, MSTR_VIRTUAL_DISPLAY_LAST_FRAME_TIME,
+                              vd_transfer_time(vd, vd->last_frame_bytes));
+  return obj;
+}
+
+/**
+ * Display.prototype.resetStats()
+ */
+JERRYXX_FUN(vd_reset_stats_fn) {
+  JERRYXX_GET_NATIVE_HANDLE(vd, vd_handle_t, vd_handle_info);
+  vd->frames = 0;
+  vd->transfers = 0;
+  vd->bytes = 0;
+  vd->frame_bytes = 0;
+  vd->last_frame_bytes = 0;
+  return jerry_create_undefined();
+}
+
+/**
+ * Initialize 'virtual_display' module and return exports
+ */
+jerry_value_t module_virtual_display_init() {
+  /* Display class */
+  jerry_value_t vd_ctor = jerry_create_external_function(vd_ctor_fn);
+  jerry_value_t vd_prototype = jerry_create_object();
+  jerryxx_set_property(vd_ctor, MSTR_PROTOTYPE, vd_prototype);
+  jerryxx_set_property_function(vd_prototype, MSTR_VIRTUAL_DISPLAY_UPDATE,
+                                vd_update_fn);
+  jerryxx_set_property_function(vd_prototype, MSTR_VIRTUAL_DISPLAY_END_FRAME,
+                                vd_end_frame_fn);
+  jerryxx_set_property_function(vd_prototype, MSTR_VIRTUAL_DISPLAY_GET_PIXEL,
+                                vd_get_pixel_fn);
+  jerryxx_set_property_function(vd_prototype, MSTR_VIRTUAL_DISPLAY_CHECKSUM,
+                                vd_checksum_fn);
+  jerryxx_set_property_function(vd_prototype, MSTR_VIRTUAL_DISPLAY_STATS,
+                                vd_stats_fn);
+  jerryxx_set_property_function(vd_prototype,
+                                MSTR_VIRTUAL_DISPLAY_RESET_STATS,
+                                vd_reset_stats_fn);
+  jerry_release_value(vd_prototype);
+
+  /* virtual_display module exports */
+  jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property(exports, MSTR_VIRTUAL_DISPLAY_DISPLAY, vd_ctor);
+  jerry_release_value(vd_ctor);
+  return exports;
+}
@@ -0,0 +1,93 @@
+const vd_native = process.binding(process.binding.virtual_display);
+const { BufferedGraphicsContext } = require("graphics");
+
+/**
+ * Virtual display for the Linux target. Shows the frames of a
+ * BufferedGraphicsContext in a PPM image (or a sequence of images) and counts
+ * the bytes a SPI panel would take at the clock.
+ */
+class VirtualDisplay {
+  /**
+   * @param {number} width
+   * @param {number} height
+   * @param {object} options
+   *   bpp {number} 1, 3 or 16. default: 16
+   *   spiClock {number} SPI clock in Hz. default: 40000000
+   *   commandBytes {number} bytes sent before the pixels of each transfer.
+   *     default: 11
+   *   realtime {boolean} take as long as the transfers. default: false
+   *   output {string} path of the image updated in place (e.g. in /dev/shm),
+   *     or of the frames if it has "%d". default: no output
+   */
+  constructor(width, height, options) {
+    options = Object.assign({ bpp: 16 }, options);
+    this.width = width;
+    this.height = height;
+    this.bpp = options.bpp;
+    this._display = new vd_native.Display(width, height, options);
+  }
+
+  /**
+   * Create a graphics context drawing on this display. display() of the
+   * context sends the dirty region (or the bands) and ends a frame, unless
+   * nothing changed.
+   * @param {object} options options of BufferedGraphicsContext except bpp
+   *   and display
+   * @return {BufferedGraphicsContext}
+   */
+  getContext(options) {
+    const display = this._display;
+    let transfers = 0;
+    const gc = new BufferedGraphicsContext(
+      this.width,
+      this.height,
+      Object.assign({}, options, {
+        bpp: this.bpp,
+        display: (buffer, region) => {
+          transfers++;
+          display.update(buffer, region);
+        },
+      })
+    );
+    const gcDisplay = gc.display;
+    gc.display = function () {
+      transfers = 0;
+      gcDisplay.call(gc);
+      // nothing changed: no frame was sent
+      if (transfers > 0) {
+        display.endFrame();
+      }
+    };
+    return gc;
+  }
+
+  /**
+   * @param {number} x
+   * @param {number} y
+   * @return {number} color shown at the pixel in 0xRRGGBB
+   */
+  getPixel(x, y) {
+    return this._display.getPixel(x, y);
+  }
+
+  /**
+   * @return {number} CRC32 of the pixels shown
+   */
+  checksum() {
+    return this._display.checksum();
+  }
+
+  /**
+   * @return {object} {frames, transfers, bytes, busyTime, lastFrameBytes,
+   *   lastFrameTime}, times in microseconds
+   */
+  stats() {
+    return this._display.stats();
+  }
+
+  resetStats() {
+    this._display.resetStats();
+  }
+}
+
+exports.VirtualDisplay = VirtualDisplay;
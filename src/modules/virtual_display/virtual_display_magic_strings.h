@@ -0,0 +1,50 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __VIRTUAL_DISPLAY_MAGIC_STRINGS_H
+#define __VIRTUAL_DISPLAY_MAGIC_STRINGS_H
+
+#define MSTR_VIRTUAL_DISPLAY_DISPLAY "Display"
+#define MSTR_VIRTUAL_DISPLAY_UPDATE "update"
+#define MSTR_VIRTUAL_DISPLAY_END_FRAME "endFrame"
+#define MSTR_VIRTUAL_DISPLAY_GET_PIXEL "getPixel"
+#define MSTR_VIRTUAL_DISPLAY_CHECKSUM "checksum"
+#define MSTR_VIRTUAL_DISPLAY_STATS "stats"
+#define MSTR_VIRTUAL_DISPLAY_RESET_STATS "resetStats"
+#define MSTR_VIRTUAL_DISPLAY_BPP "bpp"
+#define MSTR_VIRTUAL_DISPLAY_SPI_CLOCK "spiClock"
+#define MSTR_VIRTUAL_DISPLAY_COMMAND_BYTES "commandBytes"
+#define MSTR_VIRTUAL_DISPLAY_REALTIME "realtime"
+#define MSTR_VIRTUAL_DISPLAY_OUTPUT "output"
+#define MSTR_VIRTUAL_DISPLAY_X "x"
+#define MSTR_VIRTUAL_DISPLAY_Y "y"
+#define MSTR_VIRTUAL_DISPLAY_WIDTH "width"
+#define MSTR_VIRTUAL_DISPLAY_HEIGHT "height"
+#define MSTR_VIRTUAL_DISPLAY_STRIDE "stride"
+#define MSTR_VIRTUAL_DISPLAY_DATA "data"
+#define MSTR_VIRTUAL_DISPLAY_FRAMES "frames"
+#define MSTR_VIRTUAL_DISPLAY_TRANSFERS "transfers"
+#define MSTR_VIRTUAL_DISPLAY_BYTES "bytes"
+#define MSTR_VIRTUAL_DISPLAY_BUSY_TIME "busyTime"
+#define MSTR_VIRTUAL_DISPLAY_LAST_FRAME_BYTES "lastFrameBytes"
+#define MSTR_VIRTUAL_DISPLAY_LAST_FRAME_TIME "lastFrameTime"
+
+#endif /* __VIRTUAL_DISPLAY_MAGIC_STRINGS_H */
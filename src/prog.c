@@ -1,42 +1,71 @@
 #include "prog.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "board.h"
 #include "flash.h"
+#include "utils.h"
+
+#define KM_PROG_SNAPSHOT_MAGIC 0x5952524A  // "JRRY" (JerryScript snapshot)
 
 static uint8_t *page_buffer = NULL;
+static uint8_t *first_page = NULL;  // programmed last with the header
 static uint32_t page_written = 0;
-static uint32_t total_written = 0;
+static uint32_t total_written = 0;  // including header
+static uint32_t payload_crc = 0;
+
+// the first bytes received, to check the image has a header or not
+static uint8_t head[KM_PROG_HEADER_SIZE];
+static uint32_t head_len = 0;
+static bool head_checked = false;
+static bool has_header = false;
 
 static const uint32_t KALUMA_PROG_MAX =
     (KALUMA_PROG_SECTOR_COUNT * KALUMA_FLASH_SECTOR_SIZE);
 
+static const km_prog_header_t *prog_header() {
+  return (const km_prog_header_t *)(km_flash_addr +
+                                    (KALUMA_PROG_SECTOR_BASE *
+                                     KALUMA_FLASH_SECTOR_SIZE));
+}
+
+static bool prog_has_header() {
+  const km_prog_header_t *header = prog_header();
+  return (header->magic == KM_PROG_MAGIC &&
+          header->version == KM_PROG_VERSION &&
+          header->size <= KALUMA_PROG_MAX - KM_PROG_HEADER_SIZE);
+}
+
 static int page_buffer_flush() {
-  int sector = (total_written - 1) / KALUMA_FLASH_SECTOR_SIZE;
-  int offset = (((total_written - 1) % KALUMA_FLASH_SECTOR_SIZE) /
-                KALUMA_FLASH_PAGE_SIZE) *
-               KALUMA_FLASH_PAGE_SIZE;
-  int ret = km_flash_program(KALUMA_PROG_SECTOR_BASE + sector, offset,
-                             page_buffer, KALUMA_FLASH_PAGE_SIZE);
-  if (ret < 0) return ret;
+  uint32_t page_base = ((total_written - 1) / KALUMA_FLASH_PAGE_SIZE) *
+                       KALUMA_FLASH_PAGE_SIZE;
+  if (page_base == 0) {
+    memcpy(first_page, page_buffer, KALUMA_FLASH_PAGE_SIZE);
+  } else {
+    int sector = page_base / KALUMA_FLASH_SECTOR_SIZE;
+    int offset = page_base % KALUMA_FLASH_SECTOR_SIZE;
+    int ret = km_flash_program(KALUMA_PROG_SECTOR_BASE + sector, offset,
+                               page_buffer, KALUMA_FLASH_PAGE_SIZE);
+    if (ret < 0) return ret;
+  }
   memset(page_buffer, 0, KALUMA_FLASH_PAGE_SIZE);
   page_written = 0;
   return 0;
 }
 
 static int page_buffer_push(uint8_t byte) {
-  page_buffer[page_written] = byte;
-  page_written++;
-  total_written++;
-
   // flash quota exceeded
   if (total_written >= KALUMA_PROG_MAX) {
     return -122;  // EDQUOT
   }
 
+  page_buffer[page_written] = byte;
+  page_written++;
+  total_written++;
+
   // flush when page_buffer is full
   if (page_written >= KALUMA_FLASH_PAGE_SIZE) {
     int ret = page_buffer_flush();
@@ -45,58 +74,154 @@ static int page_buffer_push(uint8_t byte) {
   return 0;
 }
 
+static int payload_write(uint8_t *buffer, int size) {
+  payload_crc = km_crc32(payload_crc, buffer, size);
+  for (int i = 0; i < size; i++) {
+    int ret = page_buffer_push(buffer[i]);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
+static void free_buffers() {
+  if (page_buffer != NULL) {
+    free(page_buffer);
+    page_buffer = NULL;
+  }
+  if (first_page != NULL) {
+    free(first_page);
+    first_page = NULL;
+  }
+}
+
 void km_prog_clear() {
   km_flash_erase(KALUMA_PROG_SECTOR_BASE, KALUMA_PROG_SECTOR_COUNT);
 }
 
 void km_prog_begin() {
   km_prog_clear();
+  free_buffers();
   page_buffer = malloc(KALUMA_FLASH_PAGE_SIZE);
+  first_page = malloc(KALUMA_FLASH_PAGE_SIZE);
   memset(page_buffer, 0, KALUMA_FLASH_PAGE_SIZE);
-  page_written = 0;
-  total_written = 0;
+  // reserve space for the header
+  page_written = KM_PROG_HEADER_SIZE;
+  total_written = KM_PROG_HEADER_SIZE;
+  payload_crc = 0;
+  head_len = 0;
+  head_checked = false;
+  has_header = false;
 }
 
 int km_prog_write(uint8_t *buffer, int size) {
-  for (int i = 0; i < size; i++) {
-    int ret = page_buffer_push(buffer[i]);
-    if (ret < 0) {
-      return ret;
+  int i = 0;
+  if (!head_checked) {
+    while (head_len < KM_PROG_HEADER_SIZE && i < size) {
+      head[head_len++] = buffer[i++];
+    }
+    if (head_len < KM_PROG_HEADER_SIZE) {
+      return 0;
+    }
+    head_checked = true;
+    uint32_t magic;
+    memcpy(&magic, head, sizeof(magic));  // head may be unaligned
+    if (magic == KM_PROG_MAGIC) {
+      has_header = true;  // image built by host tool
+    } else {
+      int ret = payload_write(head, head_len);
+      if (ret < 0) return ret;
     }
   }
-  return 0;
+  return payload_write(buffer + i, size - i);
 }
 
 int km_prog_end() {
-  // push end of string
-  page_buffer_push(0);
+  int ret = 0;
+  if (!head_checked) {
+    head_checked = true;
+    ret = payload_write(head, head_len);
+  }
+
+  // fill the header
+  km_prog_header_t header;
+  uint32_t size = total_written - KM_PROG_HEADER_SIZE;
+  if (has_header) {
+    memcpy(&header, head, KM_PROG_HEADER_SIZE);
+    if (header.version != KM_PROG_VERSION || header.size != size ||
+        header.crc != payload_crc) {
+      ret = -1;  // verification failed
+    }
+  } else {
+    header.magic = KM_PROG_MAGIC;
+    header.version = KM_PROG_VERSION;
+    header.format = KM_PROG_FORMAT_SOURCE;
+    uint32_t magic = 0;
+    if (head_len >= sizeof(magic)) {
+      memcpy(&magic, head, sizeof(magic));
+    }
+    if (magic == KM_PROG_SNAPSHOT_MAGIC) {
+      header.format = KM_PROG_FORMAT_SNAPSHOT;
+    }
+    header.reserved = 0;
+    header.size = size;
+    header.crc = payload_crc;
+  }
 
   // flush if buffer has data
-  if (page_written > 0) {
-    int ret = page_buffer_flush();
-    if (ret < 0) return -1;
+  if (ret == 0 && page_written > 0) {
+    ret = page_buffer_flush();
   }
 
-  if (page_buffer != NULL) {
-    free(page_buffer);
+  // program the first page with the header
+  if (ret == 0) {
+    memcpy(first_page, &header, KM_PROG_HEADER_SIZE);
+    ret = km_flash_program(KALUMA_PROG_SECTOR_BASE, 0, first_page,
+                           KALUMA_FLASH_PAGE_SIZE);
   }
+
+  free_buffers();
   total_written = 0;
-  return 0;
+  return ret < 0 ? -1 : 0;
 }
 
 uint32_t km_prog_get_size() {
-  char *prog = (char *)km_prog_addr();
+  if (prog_has_header()) {
+    return prog_header()->size;
+  }
+  char *prog = (char *)prog_header();
   if (prog[0] == '\xFF') {  // flash erased (no code written)
     return 0;
   }
-  return strlen(prog);
+  return strnlen(prog, KALUMA_PROG_MAX);  // null-terminated source
 }
 
 uint32_t km_prog_max_size() {
-  return (KALUMA_PROG_SECTOR_COUNT * KALUMA_FLASH_SECTOR_SIZE);
+  return (KALUMA_PROG_SECTOR_COUNT * KALUMA_FLASH_SECTOR_SIZE) -
+         KM_PROG_HEADER_SIZE;
 }
 
 uint8_t *km_prog_addr() {
-  return (uint8_t *)(km_flash_addr +
-                     (KALUMA_PROG_SECTOR_BASE * KALUMA_FLASH_SECTOR_SIZE));
+  uint8_t *addr = (uint8_t *)prog_header();
+  if (prog_has_header()) {
+    return addr + KM_PROG_HEADER_SIZE;
+  }
+  return addr;
+}
+
+km_prog_format_t km_prog_get_format() {
+  if (prog_has_header()) {
+    return (km_prog_format_t)prog_header()->format;
+  }
+  return km_prog_get_size() > 0 ? KM_PROG_FORMAT_SOURCE : KM_PROG_FORMAT_NONE;
+}
+
+int km_prog_verify() {
+  if (prog_has_header()) {
+    const km_prog_header_t *header = prog_header();
+    uint32_t crc = km_crc32(0, km_prog_addr(), header->size);
+    return crc == header->crc ? 0 : -1;
+  }
+  return 0;
 }
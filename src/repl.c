@@ -442,6 +442,7 @@ static void cmd_reset(km_repl_state_t *state, char *arg) {
 }
 
 static size_t bytes_remained = 0;
+static int prog_result = 0;
 
 static int header_cb(uint8_t *file_name, size_t file_size) {
   km_prog_begin();
@@ -464,7 +465,7 @@ static int packet_cb(uint8_t *data, size_t len) {
 }
 
 static void footer_cb() {
-  km_prog_end();
+  prog_result = km_prog_end();
   bytes_remained = 0;
 }
 
@@ -491,6 +492,10 @@ static void cmd_flash(km_repl_state_t *state, char *arg) {
   } else if (strcmp(arg, "-r") == 0) {
     uint32_t sz = km_prog_get_size();
     uint8_t *ptr = km_prog_addr();
+    if (km_prog_get_format() == KM_PROG_FORMAT_SNAPSHOT) {
+      km_repl_printf("[Snapshot: %u bytes]\r\n", sz);
+      return;
+    }
     for (int i = 0; i < sz; i++) {
       if (ptr[i] == '\n') { /* convert "\n" to "\r\n" */
         km_repl_putc('\r');
@@ -503,8 +508,12 @@ static void cmd_flash(km_repl_state_t *state, char *arg) {
     state->ymodem_state = 1;  // transfering
     km_tty_printf("Transfer a file via YMODEM... (press 'a' to abort)\r\n");
     km_io_tty_read_stop(&tty);
+    prog_result = 0;
     km_ymodem_status_t result =
         km_ymodem_receive(header_cb, packet_cb, footer_cb);
+    if (result == KM_YMODEM_OK && prog_result < 0) {
+      result = KM_YMODEM_DATA;  // invalid program image
+    }
     km_io_tty_read_start(&tty, tty_read_cb);
     km_delay(500);
     switch (result) {
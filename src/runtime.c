@@ -48,11 +48,6 @@
  */
 static uint8_t km_runtime_vm_stop = 0;
 
-/**
- * idle handle for processing enqueued jobs
- */
-static km_io_idle_handle_t idler;
-
 // --------------------------------------------------------------------------
 // PRIVATE FUNCTIONS
 // --------------------------------------------------------------------------
@@ -65,7 +60,11 @@ static jerry_value_t vm_exec_stop_callback(void *user_p) {
   return jerry_create_undefined();
 }
 
-static void idler_cb() {
+/**
+ * Run enqueued jobs (promise reactions, queueMicrotask callbacks). Called by
+ * the I/O loop after callbacks.
+ */
+static void jobs_cb() {
   jerry_value_t ret_val = jerry_run_all_enqueued_jobs();
   if (jerry_value_is_error(ret_val)) {
     jerryxx_print_error(ret_val, true);
@@ -93,13 +92,15 @@ void km_runtime_init(bool load, bool first) {
     km_runtime_load();
   }
   if (first) {
-    // Initialize idler handle for queued jobs in jerryscript
-    km_io_idle_init(&idler);
-    km_io_idle_start(&idler, idler_cb);
+    // Run queued jobs in jerryscript after callbacks
+    km_io_jobs_start(jobs_cb);
   }
+  // jobs queued by the program (or a script run before the loop)
+  km_io_jobs_schedule();
 }
 
 void km_runtime_cleanup() {
+  jerryxx_key_cleanup();
   jerry_cleanup();
   km_system_cleanup();
   km_io_cleanup();
@@ -109,21 +110,33 @@ void km_runtime_load() {
   uint32_t size = km_prog_get_size();
   if (size > 0) {
     uint8_t *script = km_prog_addr();
-    jerry_value_t parsed_code =
-        jerry_parse(NULL, 0, script, size, JERRY_PARSE_STRICT_MODE);
-    if (!jerry_value_is_error(parsed_code)) {
-      jerry_value_t ret_value = jerry_run(parsed_code);
-      if (jerry_value_is_error(ret_value)) {
-        jerryxx_print_error(ret_value, true);
-        km_runtime_cleanup();
-        km_runtime_init(false, false);
+    jerry_value_t ret_value;
+    if (km_prog_get_format() == KM_PROG_FORMAT_SNAPSHOT) {
+      if (km_prog_verify() < 0) {
+        km_tty_printf("Program image is corrupted\r\n");
         return;
       }
-      jerry_release_value(ret_value);
+      // run in place from flash as builtin modules
+      ret_value = jerry_exec_snapshot((const uint32_t *)script, size, 0,
+                                      JERRY_SNAPSHOT_EXEC_ALLOW_STATIC);
     } else {
-      jerryxx_print_error(parsed_code, true);
+      jerry_value_t parsed_code =
+          jerry_parse(NULL, 0, script, size, JERRY_PARSE_STRICT_MODE);
+      if (jerry_value_is_error(parsed_code)) {
+        jerryxx_print_error(parsed_code, true);
+        jerry_release_value(parsed_code);
+        return;
+      }
+      ret_value = jerry_run(parsed_code);
+      jerry_release_value(parsed_code);
+    }
+    if (jerry_value_is_error(ret_value)) {
+      jerryxx_print_error(ret_value, true);
+      km_runtime_cleanup();
+      km_runtime_init(false, false);
+      return;
     }
-    jerry_release_value(parsed_code);
+    jerry_release_value(ret_value);
   }
 }
 
@@ -0,0 +1,75 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __KM_FLASH_SIM_H
+#define __KM_FLASH_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Flash emulation of the Linux target.
+ *
+ * Program always ANDs the data into flash (it can only clear bits, as in
+ * NOR flash). By default flash is a RAM buffer erased on every start. If
+ * the KALUMA_FLASH_IMAGE environment variable is set, the file is mapped
+ * as the flash image (created and erased if it doesn't exist), so the
+ * contents persist between runs, and per-sector erase counters are kept
+ * in "<image>.wear". If KALUMA_FLASH_TIMING is set, erase and program
+ * take as long as typical NOR flash (see below).
+ */
+
+#define KM_FLASH_SIM_IMAGE_ENV "KALUMA_FLASH_IMAGE"
+#define KM_FLASH_SIM_TIMING_ENV "KALUMA_FLASH_TIMING"
+
+/* typical timings of a QSPI NOR flash (usec) */
+
+#define KM_FLASH_SIM_SECTOR_ERASE_TIME 45000
+#define KM_FLASH_SIM_PAGE_PROGRAM_TIME 700
+
+typedef struct {
+  uint32_t erases;           // number of sectors erased
+  uint32_t programs;         // number of program operations
+  uint64_t bytes_programmed;
+  uint64_t busy_time;        // emulated busy time (usec)
+} km_flash_sim_stats_t;
+
+/**
+ * Return true if flash is mapped to a persistent image file
+ */
+bool km_flash_sim_is_persistent();
+
+/**
+ * Return the number of times the sector has been erased. The counters
+ * persist with the image file.
+ *
+ * @param sector sector number
+ */
+uint32_t km_flash_sim_erase_count(uint32_t sector);
+
+/**
+ * Get the operation statistics since start or the last reset
+ */
+void km_flash_sim_get_stats(km_flash_sim_stats_t *stats);
+
+void km_flash_sim_reset_stats();
+
+#endif /* __KM_FLASH_SIM_H */
@@ -0,0 +1,40 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __KM_GPIO_SIM_H
+#define __KM_GPIO_SIM_H
+
+#include <stdint.h>
+
+#include "gpio.h"
+
+/**
+ * Simulate an interrupt on a pin. The interrupt callback is called
+ * synchronously, as an ISR would be, if the pin is attached for the given
+ * events and interrupts are enabled.
+ *
+ * @param pin pin number
+ * @param events interrupt events (KM_IO_WATCH_MODE_FALLING or RISING)
+ * @return 1 if the interrupt was raised, 0 if it was masked
+ */
+int km_gpio_sim_irq(uint8_t pin, uint8_t events);
+
+#endif /* __KM_GPIO_SIM_H */
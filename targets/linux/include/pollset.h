@@ -0,0 +1,54 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __KM_POLLSET_H
+#define __KM_POLLSET_H
+
+#include <stdint.h>
+
+#define KM_POLLSET_MAX 8
+
+/**
+ * Add a file descriptor to the poll set of the event loop. The loop wakes up
+ * when the file descriptor becomes readable.
+ *
+ * @param fd file descriptor
+ * @return 0 on success or -1 if the poll set is full
+ */
+int km_pollset_add(int fd);
+
+/**
+ * Remove a file descriptor from the poll set of the event loop.
+ *
+ * @param fd file descriptor
+ */
+void km_pollset_remove(int fd);
+
+/**
+ * Wait until one of file descriptors in the poll set becomes readable or
+ * timeout expires.
+ *
+ * @param msec timeout in milliseconds
+ * @return the number of ready file descriptors, 0 on timeout, -1 on error
+ */
+int km_pollset_wait(uint32_t msec);
+
+#endif /* __KM_POLLSET_H */
@@ -0,0 +1,108 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __KM_SDCARD_SIM_H
+#define __KM_SDCARD_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * SD card emulation of the Linux target.
+ *
+ * An SDHC card in RAM can be attached to a SPI bus and a chip select pin.
+ * It answers the SPI mode protocol on the bytes clocked by km_spi_*():
+ * initialization (CMD0, CMD8, ACMD41, CMD58, CMD9), the high speed switch
+ * (CMD6), single and multiple block read and write (CMD17, CMD18 with
+ * CMD12, CMD24, CMD25 with the stop token), the pre-erase hint (ACMD23) and
+ * erase (CMD32, CMD33, CMD38). CRC is not checked.
+ *
+ * Time is emulated: each km_spi_*() call takes the transfer time at the SPI
+ * clock plus a fixed overhead, and the card answers 0xFF (read access) or
+ * 0x00 (busy) until its access or program time has passed.
+ */
+
+/* typical timings of a class 10 card, and of a km_spi_*() call (usec) */
+
+#define KM_SDCARD_SIM_READ_ACCESS_TIME 100
+#define KM_SDCARD_SIM_READ_NEXT_TIME 5       // next block of CMD18
+#define KM_SDCARD_SIM_WRITE_TIME 500         // CMD24
+#define KM_SDCARD_SIM_WRITE_NEXT_TIME 150    // each block of CMD25
+#define KM_SDCARD_SIM_WRITE_ERASED_TIME 60   // ... pre-erased by ACMD23
+#define KM_SDCARD_SIM_ERASE_TIME 1000        // CMD38
+#define KM_SDCARD_SIM_CALL_TIME 2
+
+typedef struct {
+  uint32_t commands;
+  uint32_t single_reads;   // CMD17
+  uint32_t multi_reads;    // CMD18
+  uint32_t single_writes;  // CMD24
+  uint32_t multi_writes;   // CMD25
+  uint32_t pre_erases;     // ACMD23
+  uint32_t blocks_read;
+  uint32_t blocks_written;
+  uint32_t transfers;  // km_spi_*() calls
+  uint64_t bytes;      // bytes clocked
+  uint64_t bus_time;   // emulated time (usec)
+  uint32_t clock;      // current SPI clock (Hz)
+  bool high_speed;     // switched to high speed by CMD6
+} km_sdcard_sim_stats_t;
+
+/**
+ * Attach a card (erased to 0xFF). A card already attached is replaced.
+ *
+ * @param bus SPI bus
+ * @param cs_pin chip select pin
+ * @param block_count number of 512-byte blocks (rounded up to 1024)
+ * @return negative on error
+ */
+int km_sdcard_sim_attach(uint8_t bus, uint8_t cs_pin, uint32_t block_count);
+
+void km_sdcard_sim_detach();
+
+/**
+ * Clock bytes to the card if it is attached to the bus. tx is NULL to send
+ * send_byte, rx is NULL to discard the received bytes.
+ *
+ * @return false if no card is attached to the bus
+ */
+bool km_sdcard_sim_transfer(uint8_t bus, const uint8_t *tx, uint8_t send_byte,
+                            uint8_t *rx, size_t len);
+
+/**
+ * Called by the SPI driver when the clock of a bus changes
+ */
+void km_sdcard_sim_set_clock(uint8_t bus, uint32_t clock);
+
+/**
+ * Called by the GPIO driver when a pin is written
+ */
+void km_sdcard_sim_set_pin(uint8_t pin, uint8_t value);
+
+/**
+ * Get the statistics since attach or the last reset
+ */
+void km_sdcard_sim_get_stats(km_sdcard_sim_stats_t *stats);
+
+void km_sdcard_sim_reset_stats();
+
+#endif /* __KM_SDCARD_SIM_H */
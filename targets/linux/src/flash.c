@@ -21,41 +21,144 @@
 
 #include "flash.h"
 
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "board.h"
+#include "flash_sim.h"
+#include "system.h"
 
-//  Flash implementation on RAM
+#define FLASH_SIZE (KALUMA_FLASH_SECTOR_SIZE * KALUMA_FLASH_SECTOR_COUNT)
+#define FLASH_WEAR_SIZE (sizeof(uint32_t) * KALUMA_FLASH_SECTOR_COUNT)
 
-const size_t __flash_size =
-    KALUMA_FLASH_SECTOR_SIZE * KALUMA_FLASH_SECTOR_COUNT;
-uint8_t __flash_buffer[KALUMA_FLASH_SECTOR_SIZE * KALUMA_FLASH_SECTOR_COUNT];
+//  Flash implementation on RAM, or on a memory-mapped image file
+//  (see flash_sim.h)
 
-const uint8_t *km_flash_addr = (const uint8_t *)(__flash_buffer);
+static uint8_t __flash_ram[FLASH_SIZE];
+static uint32_t __flash_ram_wear[KALUMA_FLASH_SECTOR_COUNT];
+static uint8_t *__flash_buffer = __flash_ram;
+static uint32_t *__flash_wear = __flash_ram_wear;
+static bool __flash_persistent = false;
+static bool __flash_timing = false;
+static km_flash_sim_stats_t __flash_stats;
+
+const uint8_t *km_flash_addr = (const uint8_t *)(__flash_ram);
+
+/**
+ * Map a file of the given size (extended with the fill value if shorter)
+ */
+static void *__flash_map(const char *path, size_t size, uint8_t fill) {
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 ||
+      ((size_t)st.st_size < size && ftruncate(fd, size) < 0)) {
+    close(fd);
+    return NULL;
+  }
+  uint8_t *addr =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return NULL;
+  }
+  if ((size_t)st.st_size < size) {
+    memset(addr + st.st_size, fill, size - st.st_size);
+  }
+  return addr;
+}
+
+static void __flash_busy(uint32_t usec) {
+  __flash_stats.busy_time += usec;
+  if (__flash_timing) {
+    km_micro_delay(usec);
+  }
+}
 
 void km_flash_init() {
-  for (int i = 0; i < __flash_size; i++) {
-    __flash_buffer[i] = 0xFF;
+  const char *image = getenv(KM_FLASH_SIM_IMAGE_ENV);
+  __flash_timing = getenv(KM_FLASH_SIM_TIMING_ENV) != NULL;
+  km_flash_sim_reset_stats();
+  if (image != NULL && image[0] != '\0') {
+    char wear_path[PATH_MAX];
+    snprintf(wear_path, sizeof(wear_path), "%s.wear", image);
+    uint8_t *buffer = __flash_map(image, FLASH_SIZE, 0xFF);
+    uint32_t *wear = __flash_map(wear_path, FLASH_WEAR_SIZE, 0);
+    if (buffer != NULL && wear != NULL) {
+      __flash_buffer = buffer;
+      __flash_wear = wear;
+      __flash_persistent = true;
+      km_flash_addr = (const uint8_t *)buffer;
+      return;
+    }
+    if (buffer != NULL) munmap(buffer, FLASH_SIZE);
+    if (wear != NULL) munmap(wear, FLASH_WEAR_SIZE);
+    fprintf(stderr, "Failed to map flash image: %s\n", image);
   }
+  memset(__flash_ram, 0xFF, FLASH_SIZE);
 }
 
-void km_flash_cleanup() {}
+void km_flash_cleanup() {
+  if (__flash_persistent) {
+    msync(__flash_buffer, FLASH_SIZE, MS_ASYNC);
+    msync(__flash_wear, FLASH_WEAR_SIZE, MS_ASYNC);
+  }
+}
 
 int km_flash_program(uint32_t sector, uint32_t offset, uint8_t *buffer,
                      size_t size) {
   const uint32_t _base = (sector * KALUMA_FLASH_SECTOR_SIZE) + offset;
-  for (int i = 0; i < size; i++) {
-    __flash_buffer[_base + i] = buffer[i];
+  if (sector >= KALUMA_FLASH_SECTOR_COUNT || _base + size > FLASH_SIZE) {
+    return -1;
+  }
+  uint8_t *dest = __flash_buffer + _base;
+  // NOR flash: program can only clear bits
+  for (size_t i = 0; i < size; i++) {
+    dest[i] &= buffer[i];
   }
+  __flash_stats.programs++;
+  __flash_stats.bytes_programmed += size;
+  __flash_busy(((size + KALUMA_FLASH_PAGE_SIZE - 1) / KALUMA_FLASH_PAGE_SIZE) *
+               KM_FLASH_SIM_PAGE_PROGRAM_TIME);
   return 0;
 }
 
 int km_flash_erase(uint32_t sector, size_t count) {
-  const uint32_t _base = sector * KALUMA_FLASH_SECTOR_SIZE;
-  for (int i = 0; i < (count * KALUMA_FLASH_SECTOR_SIZE); i++) {
-    __flash_buffer[_base + i] = 0xFF;
+  if (sector + count > KALUMA_FLASH_SECTOR_COUNT) {
+    return -1;
+  }
+  memset(__flash_buffer + (sector * KALUMA_FLASH_SECTOR_SIZE), 0xFF,
+         count * KALUMA_FLASH_SECTOR_SIZE);
+  for (size_t i = 0; i < count; i++) {
+    __flash_wear[sector + i]++;
   }
+  __flash_stats.erases += count;
+  __flash_busy(count * KM_FLASH_SIM_SECTOR_ERASE_TIME);
   return 0;
 }
+
+bool km_flash_sim_is_persistent() { return __flash_persistent; }
+
+uint32_t km_flash_sim_erase_count(uint32_t sector) {
+  if (sector >= KALUMA_FLASH_SECTOR_COUNT) {
+    return 0;
+  }
+  return __flash_wear[sector];
+}
+
+void km_flash_sim_get_stats(km_flash_sim_stats_t *stats) {
+  *stats = __flash_stats;
+}
+
+void km_flash_sim_reset_stats() {
+  memset(&__flash_stats, 0, sizeof(km_flash_sim_stats_t));
+}
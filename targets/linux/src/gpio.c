@@ -21,26 +21,64 @@
 
 #include "gpio.h"
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "global.h"
+#include "gpio_sim.h"
+#include "sdcard_sim.h"
+
+static km_gpio_irq_callback_t __gpio_irq_cb = NULL;
+static uint8_t __gpio_irq_events[GPIO_MAX];
+static bool __gpio_irq_enabled = true;
+
 void km_gpio_init() {}
 
-void km_gpio_cleanup() {}
+void km_gpio_cleanup() {
+  for (int i = 0; i < GPIO_MAX; i++) {
+    __gpio_irq_events[i] = 0;
+  }
+  __gpio_irq_enabled = true;
+}
 
 int km_gpio_set_io_mode(uint8_t pin, km_gpio_io_mode_t mode) { return 0; }
 
-int km_gpio_write(uint8_t pin, uint8_t value) { return 0; }
+int km_gpio_write(uint8_t pin, uint8_t value) {
+  km_sdcard_sim_set_pin(pin, value);
+  return 0;
+}
 
 int km_gpio_read(uint8_t pin) { return 0; }
 
 int km_gpio_toggle(uint8_t pin) { return 0; }
 
-void km_gpio_irq_set_callback(km_gpio_irq_callback_t cb) {}
+void km_gpio_irq_set_callback(km_gpio_irq_callback_t cb) { __gpio_irq_cb = cb; }
+
+int km_gpio_irq_attach(uint8_t pin, uint8_t events) {
+  if (pin >= GPIO_MAX) return -1;
+  __gpio_irq_events[pin] = events;
+  return 0;
+}
 
-int km_gpio_irq_attach(uint8_t pin, uint8_t events) { return 0; }
+int km_gpio_irq_detach(uint8_t pin) {
+  if (pin >= GPIO_MAX) return -1;
+  __gpio_irq_events[pin] = 0;
+  return 0;
+}
 
-int km_gpio_irq_detach(uint8_t pin) { return 0; }
+void km_gpio_irq_enable() { __gpio_irq_enabled = true; }
 
-void km_gpio_irq_enable() {}
+void km_gpio_irq_disable() { __gpio_irq_enabled = false; }
 
-void km_gpio_irq_disable() {}
+int km_gpio_sim_irq(uint8_t pin, uint8_t events) {
+  if (pin >= GPIO_MAX || !__gpio_irq_enabled || __gpio_irq_cb == NULL) {
+    return 0;
+  }
+  events &= __gpio_irq_events[pin];
+  if (events == 0) {
+    return 0;
+  }
+  __gpio_irq_cb(pin, (km_gpio_io_mode_t)events);
+  return 1;
+}
@@ -27,6 +27,7 @@
 #include "io.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "prog.h"
 #include "repl.h"
 #include "runtime.h"
 #include "system.h"
@@ -52,12 +53,28 @@ int main(int argc, char* argv[]) {
     script[size] = '\0';
     fclose(f);
 
+    // program image (see tools/prog_image.js): flash and load it as on boot
+    if (size >= KM_PROG_HEADER_SIZE &&
+        ((km_prog_header_t*)script)->magic == KM_PROG_MAGIC) {
+      km_prog_begin();
+      km_prog_write((uint8_t*)script, size);
+      free(script);
+      if (km_prog_end() < 0) {
+        km_tty_printf("Invalid program image\r\n");
+        return 0;
+      }
+      km_runtime_load();
+      km_io_run(false);
+      return 0;
+    }
+
     // printf("%s\r\n", buffer);
     jerry_value_t parsed_code = jerry_parse(NULL, 0, (jerry_char_t*)script,
                                             size, JERRY_PARSE_STRICT_MODE);
+    free(script);
     if (!jerry_value_is_error(parsed_code)) {
-      jerry_release_value(parsed_code);
       jerry_value_t ret_value = jerry_run(parsed_code);
+      jerry_release_value(parsed_code);
       if (jerry_value_is_error(ret_value)) {
         jerryxx_print_error(ret_value, true);
         jerry_release_value(ret_value);
@@ -68,9 +85,8 @@ int main(int argc, char* argv[]) {
       jerry_release_value(ret_value);
     } else {
       jerryxx_print_error(parsed_code, true);
+      jerry_release_value(parsed_code);
     }
-    jerry_release_value(parsed_code);
   }
-  free(script);
   km_io_run(argc < 2);
 }
@@ -0,0 +1,436 @@
+/* Copyright (c) 2017 Kaluma
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sdcard_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SD_BLOCK 512
+#define SD_BUS_MAX 8
+#define SD_DEFAULT_CLOCK 400000
+
+#define SD_TOKEN_START 0xFE
+#define SD_TOKEN_MULTI 0xFC
+#define SD_TOKEN_STOP 0xFD
+
+#define R1_IDLE 0x01
+#define R1_ILLEGAL_CMD 0x04
+#define R1_ADDRESS_ERROR 0x20
+
+typedef enum {
+  SD_MODE_NONE,
+  SD_MODE_READ_SINGLE,
+  SD_MODE_READ_MULTI,
+  SD_MODE_WRITE_SINGLE,
+  SD_MODE_WRITE_MULTI,
+} sd_mode_t;
+
+static struct {
+  bool attached;
+  uint8_t bus;
+  uint8_t cs_pin;
+  bool selected;
+  uint8_t *data;
+  uint32_t block_count;
+  // card state
+  bool idle;
+  bool app_cmd;
+  uint8_t init_polls;
+  bool high_speed;
+  sd_mode_t mode;
+  uint32_t addr;       // next block to transfer
+  uint32_t pre_erase;  // blocks left of ACMD23
+  uint32_t erase_start;
+  uint32_t erase_end;
+  bool busy;           // answer 0x00 until ready_at
+  bool block_sent;     // a block of CMD18 is queued
+  uint64_t ready_at;   // ns
+  // command being received
+  uint8_t cmd[6];
+  uint8_t cmd_len;
+  // data block being received (token, data and CRC)
+  bool receiving;
+  uint8_t rx[SD_BLOCK + 2];
+  uint16_t rx_len;
+  // bytes to send
+  uint8_t out[SD_BLOCK + 16];
+  uint16_t out_len;
+  uint16_t out_pos;
+  // emulated time (ns)
+  uint64_t now;
+  uint64_t stats_start;
+  km_sdcard_sim_stats_t stats;
+} __sd;
+
+static uint32_t __sd_clocks[SD_BUS_MAX];
+
+static void __sd_queue(uint8_t byte) {
+  if (__sd.out_len < sizeof(__sd.out)) {
+    __sd.out[__sd.out_len++] = byte;
+  }
+}
+
+static void __sd_queue_data(const uint8_t *data, size_t len) {
+  __sd_queue(SD_TOKEN_START);
+  for (size_t i = 0; i < len; i++) {
+    __sd_queue(data[i]);
+  }
+  __sd_queue(0xFF);  // CRC
+  __sd_queue(0xFF);
+}
+
+static void __sd_set_busy(uint32_t usec) {
+  __sd.busy = true;
+  __sd.ready_at = __sd.now + (uint64_t)usec * 1000;
+}
+
+static void __sd_command() {
+  uint8_t index = __sd.cmd[0] & 0x3F;
+  uint32_t arg = ((uint32_t)__sd.cmd[1] << 24) | (__sd.cmd[2] << 16) |
+                 (__sd.cmd[3] << 8) | __sd.cmd[4];
+  bool app = __sd.app_cmd;
+  uint8_t r1 = __sd.idle ? R1_IDLE : 0;
+  __sd.app_cmd = false;
+  __sd.out_len = 0;
+  __sd.out_pos = 0;
+  __sd.mode = SD_MODE_NONE;
+  __sd.block_sent = false;
+  __sd.stats.commands++;
+  __sd_queue(0xFF);  // NCR (and the stuff byte of CMD12)
+  if (__sd.idle && index != 0 && index != 8 && index != 55 && index != 58 &&
+      !(app && index == 41)) {
+    __sd_queue(r1 | R1_ILLEGAL_CMD);
+    return;
+  }
+  switch (index) {
+    case 0:  // GO_IDLE_STATE
+      __sd.idle = true;
+      __sd.init_polls = 0;
+      __sd.high_speed = false;
+      __sd.busy = false;
+      __sd_queue(R1_IDLE);
+      break;
+    case 8:  // SEND_IF_COND (R7)
+      __sd_queue(r1);
+      __sd_queue(0x00);
+      __sd_queue(0x00);
+      __sd_queue((arg >> 8) & 0x0F);
+      __sd_queue(arg & 0xFF);
+      break;
+    case 55:  // APP_CMD
+      __sd.app_cmd = true;
+      __sd_queue(r1);
+      break;
+    case 41:  // APP_SEND_OP_COND (ready at the second poll)
+      if (++__sd.init_polls >= 2) {
+        __sd.idle = false;
+      }
+      __sd_queue(__sd.idle ? R1_IDLE : 0);
+      break;
+    case 58: {  // READ_OCR (R3): powered up, CCS (SDHC)
+      const uint8_t ocr[4] = {0xC0, 0xFF, 0x80, 0x00};
+      __sd_queue(r1);
+      for (int i = 0; i < 4; i++) __sd_queue(ocr[i]);
+      break;
+    }
+    case 9: {  // SEND_CSD (CSD version 2.0)
+      uint8_t csd[16] = {0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59};
+      uint32_t c_size = __sd.block_count / 1024 - 1;
+      csd[7] = (c_size >> 16) & 0x3F;
+      csd[8] = (c_size >> 8) & 0xFF;
+      csd[9] = c_size & 0xFF;
+      __sd_queue(r1);
+      __sd_queue_data(csd, sizeof(csd));
+      break;
+    }
+    case 6: {  // SWITCH_FUNC: only function 1 (high speed) of group 1
+      uint8_t status[64] = {0};
+      uint8_t fn = arg & 0x0F;
+      status[1] = 100;     // max current (mA)
+      status[12] = 0x80;   // supported functions of group 1: 0, 1 and 15
+      status[13] = 0x03;
+      if (fn == 0x0F) {
+        fn = __sd.high_speed ? 1 : 0;
+      } else if (fn > 1) {
+        fn = 0x0F;  // not supported
+      } else if (arg & 0x80000000) {
+        __sd.high_speed = fn == 1;
+      }
+      status[16] = fn;
+      __sd_queue(r1);
+      __sd_queue_data(status, sizeof(status));
+      break;
+    }
+    case 12:  // STOP_TRANSMISSION (R1b)
+      __sd_queue(r1);
+      __sd_set_busy(1);
+      break;
+    case 13:  // SEND_STATUS (R2)
+      __sd_queue(r1);
+      __sd_queue(0x00);
+      break;
+    case 16:  // SET_BLOCKLEN
+      __sd_queue(arg == SD_BLOCK ? r1 : r1 | R1_ADDRESS_ERROR);
+      break;
+    case 17:  // READ_SINGLE_BLOCK
+    case 18:  // READ_MULTIPLE_BLOCK
+      if (arg >= __sd.block_count) {
+        __sd_queue(r1 | R1_ADDRESS_ERROR);
+        break;
+      }
+      __sd_queue(r1);
+      if (index == 17) {
+        __sd.stats.single_reads++;
+        __sd.mode = SD_MODE_READ_SINGLE;
+      } else {
+        __sd.stats.multi_reads++;
+        __sd.mode = SD_MODE_READ_MULTI;
+      }
+      __sd.addr = arg;
+      __sd.ready_at = __sd.now + KM_SDCARD_SIM_READ_ACCESS_TIME * 1000;
+      break;
+    case 23:  // SET_WR_BLK_ERASE_COUNT (ACMD23 only)
+      if (!app) {
+        __sd_queue(r1 | R1_ILLEGAL_CMD);
+        break;
+      }
+      __sd.pre_erase = arg & 0x7FFFFF;
+      __sd.stats.pre_erases++;
+      __sd_queue(r1);
+      break;
+    case 24:  // WRITE_BLOCK
+    case 25:  // WRITE_MULTIPLE_BLOCK
+      if (arg >= __sd.block_count) {
+        __sd_queue(r1 | R1_ADDRESS_ERROR);
+        break;
+      }
+      __sd_queue(r1);
+      if (index == 24) {
+        __sd.stats.single_writes++;
+        __sd.mode = SD_MODE_WRITE_SINGLE;
+      } else {
+        __sd.stats.multi_writes++;
+        __sd.mode = SD_MODE_WRITE_MULTI;
+      }
+      __sd.addr = arg;
+      break;
+    case 32:  // ERASE_WR_BLK_START
+      __sd.erase_start = arg;
+      __sd_queue(r1);
+      break;
+    case 33:  // ERASE_WR_BLK_END
+      __sd.erase_end = arg;
+      __sd_queue(r1);
+      break;
+    case 38:  // ERASE (R1b)
+      if (__sd.erase_start > __sd.erase_end ||
+          __sd.erase_end >= __sd.block_count) {
+        __sd_queue(r1 | R1_ADDRESS_ERROR);
+        break;
+      }
+      memset(__sd.data + (size_t)__sd.erase_start * SD_BLOCK, 0xFF,
+             (size_t)(__sd.erase_end - __sd.erase_start + 1) * SD_BLOCK);
+      __sd_queue(r1);
+      __sd_set_busy(KM_SDCARD_SIM_ERASE_TIME);
+      break;
+    default:
+      __sd_queue(r1 | R1_ILLEGAL_CMD);
+      break;
+  }
+}
+
+/**
+ * A data block of CMD24 or CMD25 is received
+ */
+static void __sd_block_received() {
+  bool multi = __sd.mode == SD_MODE_WRITE_MULTI;
+  __sd.out_len = 0;
+  __sd.out_pos = 0;
+  if (__sd.addr >= __sd.block_count) {
+    __sd_queue(0x0D);  // write error
+    __sd.mode = SD_MODE_NONE;
+    return;
+  }
+  memcpy(__sd.data + (size_t)__sd.addr * SD_BLOCK, __sd.rx, SD_BLOCK);
+  __sd.addr++;
+  __sd.stats.blocks_written++;
+  __sd_queue(0x05);  // data accepted
+  if (!multi) {
+    __sd.mode = SD_MODE_NONE;
+    __sd_set_busy(KM_SDCARD_SIM_WRITE_TIME);
+  } else if (__sd.pre_erase > 0) {
+    __sd.pre_erase--;
+    __sd_set_busy(KM_SDCARD_SIM_WRITE_ERASED_TIME);
+  } else {
+    __sd_set_busy(KM_SDCARD_SIM_WRITE_NEXT_TIME);
+  }
+}
+
+/**
+ * Exchange a byte with the card
+ */
+static uint8_t __sd_exchange(uint8_t mosi) {
+  if (!__sd.selected) {
+    return 0xFF;
+  }
+
+  // output
+  uint8_t miso = 0xFF;
+  if (__sd.out_pos < __sd.out_len) {
+    miso = __sd.out[__sd.out_pos++];
+  } else if (__sd.busy) {
+    if (__sd.now < __sd.ready_at) {
+      miso = 0x00;
+    } else {
+      __sd.busy = false;
+    }
+  } else if (__sd.mode == SD_MODE_READ_MULTI && __sd.block_sent) {
+    // the queued block is sent, the next one takes a while
+    __sd.block_sent = false;
+    __sd.ready_at = __sd.now + KM_SDCARD_SIM_READ_NEXT_TIME * 1000;
+  } else if ((__sd.mode == SD_MODE_READ_SINGLE ||
+              __sd.mode == SD_MODE_READ_MULTI) &&
+             __sd.now >= __sd.ready_at) {
+    if (__sd.addr >= __sd.block_count) {
+      miso = 0x08;  // data error token: out of range
+      __sd.mode = SD_MODE_NONE;
+    } else {
+      __sd.out_len = 0;
+      __sd.out_pos = 0;
+      __sd_queue_data(__sd.data + (size_t)__sd.addr * SD_BLOCK, SD_BLOCK);
+      __sd.addr++;
+      __sd.stats.blocks_read++;
+      miso = __sd.out[__sd.out_pos++];
+      if (__sd.mode == SD_MODE_READ_SINGLE) {
+        __sd.mode = SD_MODE_NONE;
+      } else {
+        __sd.block_sent = true;
+      }
+    }
+  }
+
+  // input
+  if (__sd.receiving) {
+    __sd.rx[__sd.rx_len++] = mosi;
+    if (__sd.rx_len == sizeof(__sd.rx)) {
+      __sd.receiving = false;
+      __sd_block_received();
+    }
+  } else if (__sd.cmd_len > 0 || (mosi & 0xC0) == 0x40) {
+    __sd.cmd[__sd.cmd_len++] = mosi;
+    if (__sd.cmd_len == sizeof(__sd.cmd)) {
+      __sd.cmd_len = 0;
+      __sd_command();
+    }
+  } else if (!__sd.busy && ((__sd.mode == SD_MODE_WRITE_SINGLE &&
+                             mosi == SD_TOKEN_START) ||
+                            (__sd.mode == SD_MODE_WRITE_MULTI &&
+                             mosi == SD_TOKEN_MULTI))) {
+    __sd.receiving = true;
+    __sd.rx_len = 0;
+  } else if (!__sd.busy && __sd.mode == SD_MODE_WRITE_MULTI &&
+             mosi == SD_TOKEN_STOP) {
+    __sd.mode = SD_MODE_NONE;
+    __sd.out_len = 0;
+    __sd.out_pos = 0;
+    __sd_queue(0xFF);
+    __sd_set_busy(1);
+  }
+  return miso;
+}
+
+int km_sdcard_sim_attach(uint8_t bus, uint8_t cs_pin, uint32_t block_count) {
+  km_sdcard_sim_detach();
+  block_count = (block_count + 1023) / 1024 * 1024;
+  if (bus >= SD_BUS_MAX || block_count == 0) {
+    return -1;
+  }
+  __sd.data = malloc((size_t)block_count * SD_BLOCK);
+  if (__sd.data == NULL) {
+    return -1;
+  }
+  memset(__sd.data, 0xFF, (size_t)block_count * SD_BLOCK);
+  __sd.attached = true;
+  __sd.bus = bus;
+  __sd.cs_pin = cs_pin;
+  __sd.block_count = block_count;
+  __sd.idle = true;
+  km_sdcard_sim_reset_stats();
+  return 0;
+}
+
+void km_sdcard_sim_detach() {
+  free(__sd.data);
+  memset(&__sd, 0, sizeof(__sd));
+}
+
+bool km_sdcard_sim_transfer(uint8_t bus, const uint8_t *tx, uint8_t send_byte,
+                            uint8_t *rx, size_t len) {
+  if (!__sd.attached || bus != __sd.bus) {
+    return false;
+  }
+  uint32_t clock = __sd_clocks[bus] ? __sd_clocks[bus] : SD_DEFAULT_CLOCK;
+  uint64_t byte_time = 8000000000ULL / clock;
+  __sd.now += KM_SDCARD_SIM_CALL_TIME * 1000;
+  for (size_t i = 0; i < len; i++) {
+    __sd.now += byte_time;
+    uint8_t miso = __sd_exchange(tx != NULL ? tx[i] : send_byte);
+    if (rx != NULL) {
+      rx[i] = miso;
+    }
+  }
+  __sd.stats.transfers++;
+  __sd.stats.bytes += len;
+  return true;
+}
+
+void km_sdcard_sim_set_clock(uint8_t bus, uint32_t clock) {
+  if (bus < SD_BUS_MAX) {
+    __sd_clocks[bus] = clock;
+  }
+}
+
+void km_sdcard_sim_set_pin(uint8_t pin, uint8_t value) {
+  if (!__sd.attached || pin != __sd.cs_pin) {
+    return;
+  }
+  __sd.selected = (value == 0);
+  if (!__sd.selected) {
+    // deselecting aborts a command or a data block being transferred
+    __sd.cmd_len = 0;
+    __sd.receiving = false;
+    __sd.out_len = 0;
+    __sd.out_pos = 0;
+  }
+}
+
+void km_sdcard_sim_get_stats(km_sdcard_sim_stats_t *stats) {
+  *stats = __sd.stats;
+  stats->bus_time = (__sd.now - __sd.stats_start) / 1000;
+  stats->clock = __sd.attached ? __sd_clocks[__sd.bus] : 0;
+  stats->high_speed = __sd.high_speed;
+}
+
+void km_sdcard_sim_reset_stats() {
+  memset(&__sd.stats, 0, sizeof(__sd.stats));
+  __sd.stats_start = __sd.now;
+}
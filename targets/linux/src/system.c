@@ -21,12 +21,15 @@
 
 #include "system.h"
 
+#include <poll.h>
+#include <stdio.h>
 #include <time.h>
 
 #include "adc.h"
 #include "flash.h"
 #include "gpio.h"
 #include "i2c.h"
+#include "pollset.h"
 #include "pwm.h"
 #include "rtc.h"
 #include "spi.h"
@@ -38,7 +41,50 @@ const char km_system_platform[] = "linux";
 
 /**
  */
-void km_delay(uint32_t msec) {}
+void km_delay(uint32_t msec) {
+  struct timespec req = {.tv_sec = msec / 1000,
+                         .tv_nsec = (msec % 1000) * 1000000L};
+  nanosleep(&req, NULL);
+}
+
+static struct pollfd __pollset[KM_POLLSET_MAX];
+static int __pollset_count = 0;
+
+int km_pollset_add(int fd) {
+  for (int i = 0; i < __pollset_count; i++) {
+    if (__pollset[i].fd == fd) {
+      return 0;
+    }
+  }
+  if (__pollset_count >= KM_POLLSET_MAX) {
+    return -1;
+  }
+  __pollset[__pollset_count].fd = fd;
+  __pollset[__pollset_count].events = POLLIN;
+  __pollset[__pollset_count].revents = 0;
+  __pollset_count++;
+  return 0;
+}
+
+void km_pollset_remove(int fd) {
+  for (int i = 0; i < __pollset_count; i++) {
+    if (__pollset[i].fd == fd) {
+      __pollset[i] = __pollset[__pollset_count - 1];
+      __pollset_count--;
+      return;
+    }
+  }
+}
+
+int km_pollset_wait(uint32_t msec) {
+  fflush(stdout);  // flush buffered TTY output before sleeping
+  return poll(__pollset, __pollset_count, (int)msec);
+}
+
+/**
+ * Wait for a file descriptor in the poll set (e.g. TTY input) or timeout
+ */
+void km_wait_event(uint32_t msec) { km_pollset_wait(msec); }
 
 /**
  */
@@ -76,7 +122,11 @@ uint64_t km_micro_gettime() {
 /**
  * micro secoded delay
  */
-void km_micro_delay(uint32_t usec) {}
+void km_micro_delay(uint32_t usec) {
+  struct timespec req = {.tv_sec = usec / 1000000,
+                         .tv_nsec = (usec % 1000000) * 1000L};
+  nanosleep(&req, NULL);
+}
 
 /**
  * Kaluma Hardware System Initializations
@@ -21,6 +21,7 @@
 #include "tty.h"
 
 #include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -30,13 +31,17 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "pollset.h"
 #include "ringbuffer.h"
 #include "system.h"
 
-#define TTY_RX_RINGBUFFER_SIZE 2048
+#define TTY_RX_RINGBUFFER_SIZE 8192
+#define TTY_TX_BUFFER_SIZE 8192
 
 static unsigned char __tty_rx_buffer[TTY_RX_RINGBUFFER_SIZE];
 static ringbuffer_t __tty_rx_ringbuffer;
+static char __tty_tx_buffer[TTY_TX_BUFFER_SIZE];
+static bool __tty_eof = false;
 
 void km_tty_init() {
   ringbuffer_init(&__tty_rx_ringbuffer, __tty_rx_buffer,
@@ -45,15 +50,41 @@ void km_tty_init() {
   int fd = STDIN_FILENO;  // stdin
   int flags = fcntl(fd, F_GETFL, 0);
   fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  km_pollset_add(fd);
+
+  // buffered output (flushed when polling input or waiting for events)
+  setvbuf(stdout, __tty_tx_buffer, _IOFBF, sizeof(__tty_tx_buffer));
 }
 
-uint32_t km_tty_available() {
-  unsigned char ch[1];
-  int sz = read(STDIN_FILENO, ch, 1);
-  // printf("sz=%d\r\n", sz);
-  while (sz > 0) {
-    ringbuffer_write(&__tty_rx_ringbuffer, ch, 1);
+/**
+ * Read all bytes ready in stdin into the read buffer
+ */
+static void __tty_fill_ringbuffer() {
+  if (__tty_eof) {
+    return;
+  }
+  // keep one byte free, a full ringbuffer is seen as empty
+  uint32_t space = ringbuffer_freespace(&__tty_rx_ringbuffer) - 1;
+  while (space > 0) {
+    uint8_t buf[space];
+    ssize_t sz = read(STDIN_FILENO, buf, space);
+    if (sz > 0) {
+      ringbuffer_write(&__tty_rx_ringbuffer, buf, sz);
+      space -= sz;
+    } else {
+      if (sz == 0 || (errno != EAGAIN && errno != EINTR)) {
+        // end of input, stop polling stdin
+        __tty_eof = true;
+        km_pollset_remove(STDIN_FILENO);
+      }
+      break;
+    }
   }
+}
+
+uint32_t km_tty_available() {
+  fflush(stdout);  // flush pending output before reading input
+  __tty_fill_ringbuffer();
   return ringbuffer_length(&__tty_rx_ringbuffer);
 }
 
@@ -69,9 +100,10 @@ uint32_t km_tty_read(uint8_t *buf, size_t len) {
 uint32_t km_tty_read_sync(uint8_t *buf, size_t len, uint32_t timeout) {
   uint32_t sz;
   uint64_t to = km_gettime() + timeout;
-  do {
-    sz = km_tty_available();
-  } while (km_gettime() < to && sz < len);
+  uint64_t now;
+  while ((sz = km_tty_available()) < len && (now = km_gettime()) < to) {
+    km_pollset_wait(to - now);
+  }
   if (sz >= len) {
     ringbuffer_read(&__tty_rx_ringbuffer, buf, len);
     return len;
@@ -88,7 +120,7 @@ uint8_t km_tty_getc() {
   return c;
 }
 
-void km_tty_putc(char ch) { printf("%c", ch); }
+void km_tty_putc(char ch) { putchar(ch); }
 
 /**
  * Print formatted string to TTY
@@ -8,6 +8,11 @@ set(DEBUG 1)
 # optimization
 # set(OPT -Og)
 
+# event loop statistics (process.loopStats)
+if(NOT DEFINED KM_IO_STATS)
+  set(KM_IO_STATS ON)
+endif()
+
 # default board: default
 if(NOT BOARD)
   set(BOARD "default")
@@ -17,6 +22,7 @@ endif()
 if(NOT MODULES)
   set(MODULES 
     events
+    buffer
     gpio
     led
     button
@@ -26,6 +32,7 @@ if(NOT MODULES)
     spi
     uart
     graphics
+    virtual_display
     at
     storage
     wifi
@@ -36,6 +43,7 @@ if(NOT MODULES)
     rtc
     path
     flash
+    sdcard
     fs
     vfs_lfs
     vfs_fat
@@ -62,6 +70,7 @@ set(SOURCES
   ${TARGET_SRC_DIR}/uart.c
   ${TARGET_SRC_DIR}/i2c.c
   ${TARGET_SRC_DIR}/spi.c
+  ${TARGET_SRC_DIR}/sdcard_sim.c
   ${TARGET_SRC_DIR}/rtc.c
   ${TARGET_SRC_DIR}/main.c
   ${BOARD_DIR}/board.c)
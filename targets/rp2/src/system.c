@@ -53,6 +53,18 @@ static char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
  */
 void km_delay(uint32_t msec) { sleep_ms(msec); }
 
+/**
+ * Wait for an event (interrupt) or timeout
+ */
+void km_wait_event(uint32_t msec) {
+#ifdef PICO_CYW43
+  if (km_cyw43_wait_for_work(msec)) {
+    return;
+  }
+#endif
+  best_effort_wfe_or_timeout(make_timeout_time_ms(msec));
+}
+
 /**
  * Return current time (UNIX timestamp in milliseconds)
  */
@@ -29,6 +29,7 @@ endif()
 if(NOT MODULES)
   set(MODULES
     events
+    buffer
     gpio
     led
     button
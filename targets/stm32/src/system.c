@@ -179,6 +179,15 @@ void __inc_tick() { tick_count++; }
  */
 void km_delay(uint32_t msec) { HAL_Delay(msec); }
 
+/**
+ * Sleep until the next interrupt (SysTick wakes up every 1msec)
+ */
+void km_wait_event(uint32_t msec) {
+  if (msec > 0) {
+    __WFI();
+  }
+}
+
 /**
  */
 uint64_t km_gettime() { return tick_count; }
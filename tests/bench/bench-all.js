@@ -0,0 +1,121 @@
+const childProcess = require("child_process");
+const fs = require("fs");
+
+function cmd(cmd, args) {
+  childProcess.spawnSync(cmd, args, { stdio: "inherit" });
+}
+
+// Measure CPU time (user + sys) of the child process using sh's `times`
+function cpu(script) {
+  const ret = childProcess.spawnSync(
+    "sh",
+    ["-c", `../../build/kaluma ${script} > /dev/null; times`],
+    { encoding: "utf8" }
+  );
+  const lines = ret.stdout.trim().split("\n");
+  const secs = lines[lines.length - 1].match(/[\d.]+m[\d.]+s/g).map((t) => {
+    const [m, s] = t.split("m");
+    return parseFloat(m) * 60 + parseFloat(s);
+  });
+  return secs[0] + secs[1];
+}
+
+// idle CPU while N timers are armed for 2 seconds
+[10, 1000, 10000].forEach((count) => {
+  const script = `_idle_${count}.js`;
+  fs.writeFileSync(
+    script,
+    `for (let i = 0; i < ${count}; i++) setTimeout(() => {}, 2000 + i % 10);`
+  );
+  const secs = cpu(script);
+  console.log(
+    `[idle] armed=${count} cpu=${secs.toFixed(3)}s (${Math.round(
+      (secs / 2) * 100
+    )}%)`
+  );
+  fs.unlinkSync(script);
+});
+
+// feed a 1MB script through the REPL (stdin pipe), the REPL doesn't exit so
+// stop it when the marker printed after the last line is seen.
+function repl(size, next) {
+  const line = "var x = [1, 2, 3].map((v) => v * 2);\r";
+  const marker = "__REPL_BENCH_DONE__";
+  // split the marker so that the echoed input doesn't match it
+  const input =
+    line.repeat(Math.ceil(size / line.length)) +
+    `print('__REPL_BENCH' + '_DONE__');\r`;
+  const t = process.hrtime.bigint();
+  const child = childProcess.spawn("../../build/kaluma", []);
+  let tail = "";
+  child.stdout.on("data", (data) => {
+    tail = (tail + data.toString()).slice(-64);
+    if (tail.includes(marker)) {
+      const ms = Number(process.hrtime.bigint() - t) / 1e6;
+      console.log(`[repl] input=${input.length}B ${ms.toFixed(1)}ms`);
+      child.kill();
+    }
+  });
+  child.on("exit", next);
+  child.stdin.end(input);
+}
+
+// boot-to-first-statement time of a large program image (source/snapshot)
+function boot(format) {
+  const app = "_boot_app.js";
+  const image = `_boot_app_${format}.kmp`;
+  let src = "print('__BOOT_' + 'FIRST__');\n";
+  for (let i = 0; i < 5000; i++) {
+    src += `function f${i}(a, b) { return a * ${i} + b - ${i}; }\n`;
+  }
+  fs.writeFileSync(app, src);
+  const args = ["../../tools/prog_image.js", app, "-o", image];
+  if (format === "snapshot") args.push("--snapshot");
+  const ret = childProcess.spawnSync("node", args, { stdio: "inherit" });
+  fs.unlinkSync(app);
+  if (ret.status !== 0) {
+    console.log(`[boot] ${format}: failed to generate the image`);
+    return;
+  }
+  const t = process.hrtime.bigint();
+  const out = childProcess.spawnSync("../../build/kaluma", [image], {
+    encoding: "utf8",
+  });
+  const ms = Number(process.hrtime.bigint() - t) / 1e6;
+  const ok = out.stdout && out.stdout.includes("__BOOT_FIRST__");
+  console.log(`[boot] ${format}: ${ok ? ms.toFixed(1) + "ms" : "failed"}`);
+  fs.unlinkSync(image);
+}
+
+// flash on RAM, then on a persistent image (twice, to see wear accumulate)
+// and with emulated NOR timing
+function flash() {
+  const image = "_flash.img";
+  const run = (env) =>
+    childProcess.spawnSync("../../build/kaluma", ["flash.bench.js"], {
+      stdio: "inherit",
+      env: Object.assign({}, process.env, env),
+    });
+  run({});
+  run({ KALUMA_FLASH_IMAGE: image });
+  run({ KALUMA_FLASH_IMAGE: image });
+  run({ KALUMA_FLASH_IMAGE: image, KALUMA_FLASH_TIMING: "1" });
+  fs.unlinkSync(image);
+  fs.unlinkSync(image + ".wear");
+}
+
+repl(1024 * 1024, () => {
+  boot("source");
+  boot("snapshot");
+  cmd("../../build/kaluma", ["timers.bench.js"]);
+  cmd("../../build/kaluma", ["interrupt.bench.js"]);
+  cmd("../../build/kaluma", ["churn.bench.js"]);
+  cmd("../../build/kaluma", ["immediate.bench.js"]);
+  cmd("../../build/kaluma", ["native.bench.js"]);
+  cmd("../../build/kaluma", ["graphics.bench.js"]);
+  cmd("../../build/kaluma", ["display.bench.js"]);
+  cmd("../../build/kaluma", ["fs.bench.js"]);
+  cmd("../../build/kaluma", ["sdcard.bench.js"]);
+  cmd("../../build/kaluma", ["storage.bench.js"]);
+  flash();
+});
@@ -0,0 +1,37 @@
+// Timer create/clear churn.
+// N timeouts are created and then cleared (in creation and reverse order),
+// repeated ROUNDS times, to measure id lookup and handle allocation cost.
+
+const COUNTS = [100, 1000, 5000];
+const ROUNDS = 10;
+
+function bench(count, reverse) {
+  const ids = new Array(count);
+  let create = 0;
+  let clear = 0;
+  for (let r = 0; r < ROUNDS; r++) {
+    let t = micros();
+    for (let i = 0; i < count; i++) {
+      ids[i] = setTimeout(() => {}, 60000);
+    }
+    create += micros() - t;
+    t = micros();
+    if (reverse) {
+      for (let i = count - 1; i >= 0; i--) clearTimeout(ids[i]);
+    } else {
+      for (let i = 0; i < count; i++) clearTimeout(ids[i]);
+    }
+    clear += micros() - t;
+  }
+  const ops = count * ROUNDS;
+  console.log(
+    `[churn] timers=${count} ${reverse ? "reverse" : "forward"} ` +
+      `create=${(create / ops).toFixed(2)}us/op ` +
+      `clear=${(clear / ops).toFixed(2)}us/op`
+  );
+}
+
+COUNTS.forEach((count) => {
+  bench(count, false);
+  bench(count, true);
+});
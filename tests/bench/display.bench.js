@@ -0,0 +1,56 @@
+// Frame time of graphics workloads on the virtual display: CPU time to draw
+// and convert a frame, and the time a 320x240 SPI panel at 40MHz would take
+// to receive it (16 bpp) or a 128x64 panel at 8MHz (1 bpp).
+
+const { VirtualDisplay } = require("virtual_display");
+
+const FRAMES = 60;
+
+function bench(label, vd, gc, draw) {
+  vd.resetStats();
+  const t = micros();
+  for (let i = 0; i < FRAMES; i++) {
+    draw(gc, i);
+    gc.display();
+  }
+  const cpu = (micros() - t) / FRAMES;
+  const stats = vd.stats();
+  const wire = stats.busyTime / FRAMES;
+  const fps = 1000000 / Math.max(cpu, wire);
+  console.log(
+    `[display] ${label}: cpu=${cpu.toFixed(0)}us wire=${wire.toFixed(0)}us ` +
+      `${(stats.bytes / FRAMES).toFixed(0)}B/frame ${fps.toFixed(1)}fps`
+  );
+}
+
+const workloads = {
+  "full redraw": (gc, i) => {
+    gc.fillScreen(i & 1 ? 0x001f : 0);
+    gc.fillCircle(100 + i, 60, 40);
+  },
+  "moving 16x16": (gc, i) => {
+    gc.fillRect(i * 4, 20, 16, 16); // leaves a trail, dirty region only
+  },
+  text: (gc, i) => {
+    gc.fillRect(0, 0, 120, 8);
+    gc.drawText(0, 0, `frame ${i}`);
+  },
+};
+
+[
+  { width: 320, height: 240, bpp: 16, spiClock: 40000000 },
+  { width: 128, height: 64, bpp: 1, spiClock: 8000000, commandBytes: 6 },
+].forEach((options) => {
+  [0, 16].forEach((bandHeight) => {
+    const vd = new VirtualDisplay(options.width, options.height, options);
+    const gc = vd.getContext({ bandHeight });
+    gc.setColor(0xffff);
+    gc.setFillColor(0xf800);
+    const tag = `${options.width}x${options.height}x${options.bpp}${
+      bandHeight ? " banded" : ""
+    }`;
+    Object.keys(workloads).forEach((name) => {
+      bench(`${tag} ${name}`, vd, gc, workloads[name]);
+    });
+  });
+});
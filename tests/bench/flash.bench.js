@@ -0,0 +1,47 @@
+// Persistent flash throughput and wear.
+// Run with KALUMA_FLASH_IMAGE set to map flash to a file (and
+// KALUMA_FLASH_TIMING to emulate NOR erase/program time). Writes storage
+// items and littlefs files, then reports operation counts and the erase
+// counts of the busiest sectors.
+
+const { Flash } = require("flash");
+const { VFSLittleFS } = require("vfs_lfs");
+const { flashStats, resetFlashStats } = require("__test_utils");
+const fs = require("fs");
+
+const STORAGE_WRITES = 200;
+const FILE_WRITES = 100;
+const FILE_SIZE = 1024;
+const LFS_BASE = 132; // sectors after the user program area
+const LFS_COUNT = 128;
+
+function report(name, t) {
+  const stats = flashStats();
+  const wear = stats.eraseCounts.slice().sort((a, b) => b - a);
+  console.log(
+    `[flash] ${name}: ${Math.round((micros() - t) / 1000)}ms ` +
+      `erases=${stats.erases} programs=${stats.programs} ` +
+      `bytes=${stats.bytesProgrammed} busy=${Math.round(
+        stats.busyTime / 1000
+      )}ms maxWear=${wear[0]} persistent=${stats.persistent}`
+  );
+}
+
+resetFlashStats();
+let t = micros();
+for (let i = 0; i < STORAGE_WRITES; i++) {
+  storage.setItem("key" + (i % 10), "value" + i);
+}
+report("storage", t);
+
+fs.register("lfs", VFSLittleFS);
+fs.mount("/", new Flash(LFS_BASE, LFS_COUNT), "lfs", true);
+const data = new Uint8Array(FILE_SIZE);
+resetFlashStats();
+t = micros();
+for (let i = 0; i < FILE_WRITES; i++) {
+  data.fill(i & 0xff);
+  fs.writeFile("/bench" + (i % 5) + ".bin", data);
+}
+report("lfs", t);
+fs.unmount("/");
@@ -0,0 +1,160 @@
+// littlefs file throughput on the same RAM-backed flash (Linux target),
+// accessed through the native block device of Flash and through the JS
+// block device protocol (a wrapper object around the same Flash), and on
+// RAMBlockDev (pure JS) without and with a block cache. Prints KB per
+// second.
+// Then littlefs geometry options on a 1MB RAMBlockDev half filled: 64-byte
+// appends, whole file writes, and the first write after mounting (which
+// scans for free blocks) without and with fs.gc() ahead.
+// Then FAT on the simulated SD card without and with a block cache: a
+// directory walk and small reads at random positions, in emulated SPI bus
+// time.
+
+const { Flash } = require("flash");
+const { SDCard } = require("sdcard");
+const { VFSLittleFS } = require("vfs_lfs");
+const { VFSFatFS } = require("vfs_fat");
+const {
+  RAMBlockDev,
+  attachSDCard,
+  sdcardStats,
+  resetSDCardStats,
+} = require("__test_utils");
+const fs = require("fs");
+
+const LFS_BASE = 132; // sectors after the user program area
+const LFS_COUNT = 64;
+const FILE_SIZE = 16 * 1024;
+const FILES = 8;
+const ROUNDS = 4;
+
+function jsWrapper(dev) {
+  return {
+    read: (block, buffer, offset) => dev.read(block, buffer, offset),
+    write: (block, buffer, offset) => dev.write(block, buffer, offset),
+    ioctl: (op, arg) => dev.ioctl(op, arg),
+  };
+}
+
+function bench(label, blkdev, options) {
+  fs.mount("/", blkdev, "lfs", true, options);
+  const data = new Uint8Array(FILE_SIZE).map((v, i) => i);
+  const bytes = FILE_SIZE * FILES * ROUNDS;
+  let t = micros();
+  for (let r = 0; r < ROUNDS; r++) {
+    for (let i = 0; i < FILES; i++) {
+      fs.writeFile("/file" + i + ".bin", data);
+    }
+  }
+  const wt = micros() - t;
+  t = micros();
+  for (let r = 0; r < ROUNDS; r++) {
+    for (let i = 0; i < FILES; i++) {
+      fs.readFile("/file" + i + ".bin");
+    }
+  }
+  const rt = micros() - t;
+  const stats = fs.cacheStats("/");
+  fs.unmount("/");
+  console.log(
+    `[fs] ${label}: write ${Math.round((bytes * 1e6) / wt / 1024)}KB/s ` +
+      `read ${Math.round((bytes * 1e6) / rt / 1024)}KB/s` +
+      (stats ? ` hits=${stats.hits} misses=${stats.misses}` : "")
+  );
+}
+
+function benchGeometry(label, options) {
+  const bd = new RAMBlockDev(4096, 256, 256);
+  fs.mount("/", bd, "lfs", true, options);
+  const data = new Uint8Array(FILE_SIZE).map((v, i) => i);
+  for (let i = 0; i < 32; i++) {
+    fs.writeFile("/fill" + i + ".bin", data); // 512KB
+  }
+  const record = new Uint8Array(64);
+  let t = micros();
+  const fd = fs.open("/log.bin", "a");
+  for (let i = 0; i < 256; i++) {
+    fs.write(fd, record);
+  }
+  fs.close(fd);
+  const at = micros() - t;
+  t = micros();
+  for (let i = 0; i < FILES; i++) {
+    fs.writeFile("/file" + i + ".bin", data);
+  }
+  const wt = micros() - t;
+  const first = (gc) => {
+    fs.unmount("/");
+    fs.mount("/", bd, "lfs", false, options);
+    if (gc) fs.gc("/");
+    const t0 = micros();
+    fs.writeFile("/first.bin", record);
+    return micros() - t0;
+  };
+  const cold = first(false);
+  const warm = first(true);
+  const st = fs.statfs("/");
+  fs.unmount("/");
+  console.log(
+    `[fs] lfs ${label}: append ${Math.round((256 * 64 * 1e6) / at / 1024)}` +
+      `KB/s write ${Math.round((FILE_SIZE * FILES * 1e6) / wt / 1024)}KB/s ` +
+      `first write ${Math.round(cold / 1000)}ms (after gc ` +
+      `${Math.round(warm / 1000)}ms) free=${st.bfree}/${st.blocks}`
+  );
+}
+
+function benchSD(label, options) {
+  attachSDCard(1, 5, 16384); // 8MB
+  fs.mount("/", new SDCard(1, { cs: 5 }), "fat", true, options);
+  fs.mkdir("/dir");
+  const one = new Uint8Array(1);
+  for (let i = 0; i < 64; i++) {
+    fs.writeFile("/dir/file" + i + ".txt", one);
+  }
+  fs.writeFile("/big.bin", new Uint8Array(64 * 1024));
+  resetSDCardStats();
+  for (let r = 0; r < ROUNDS; r++) {
+    fs.readdir("/dir").forEach((name) => fs.stat("/dir/" + name));
+  }
+  const walk = sdcardStats().busTime;
+  resetSDCardStats();
+  const fd = fs.open("/big.bin", "r");
+  const buffer = new Uint8Array(64);
+  let seed = 1;
+  for (let i = 0; i < 256; i++) {
+    seed = (seed * 48271) % 0x7fffffff;
+    fs.read(fd, buffer, 0, buffer.length, seed % (63 * 1024));
+  }
+  fs.close(fd);
+  const random = sdcardStats().busTime;
+  const stats = fs.cacheStats("/");
+  fs.unmount("/");
+  console.log(
+    `[fs] SD FAT ${label}: walk ${Math.round(walk / 1000)}ms ` +
+      `random reads ${Math.round(random / 1000)}ms` +
+      (stats ? ` hits=${stats.hits} misses=${stats.misses}` : "")
+  );
+}
+
+fs.register("lfs", VFSLittleFS);
+bench("Flash (native)", new Flash(LFS_BASE, LFS_COUNT));
+bench("Flash (JS protocol)", jsWrapper(new Flash(LFS_BASE, LFS_COUNT)));
+bench("RAMBlockDev", new RAMBlockDev(4096, LFS_COUNT, 256));
+bench("RAMBlockDev, 8KB block cache", new RAMBlockDev(4096, LFS_COUNT, 256), {
+  cacheSize: 8192,
+});
+
+benchGeometry("defaults");
+benchGeometry("bufferSize 1KB", { bufferSize: 1024 });
+benchGeometry("bufferSize 4KB", { bufferSize: 4096 });
+benchGeometry("lookaheadSize 8", { lookaheadSize: 8 });
+benchGeometry("lookaheadSize 32", { lookaheadSize: 32 });
+benchGeometry("bufferSize 1KB, lookaheadSize 32, blockCycles -1", {
+  bufferSize: 1024,
+  lookaheadSize: 32,
+  blockCycles: -1,
+});
+
+fs.register("fat", VFSFatFS);
+benchSD("no cache");
+benchSD("8KB block cache", { cacheSize: 8192 });
@@ -0,0 +1,136 @@
+// Pixel throughput of the buffered graphics primitives for each pixel
+// format (1, 3 and 16 bpp) and rotation. Prints pixels per second (vertices
+// per second for the chart entries).
+// drawBitmap has direct blitters for unscaled bitmaps on 1 and 16 bpp, so
+// the 3 bpp and scaled cases show the generic path (runs of fillRect).
+
+const { BufferedGraphicsContext, TileMap, SpriteLayer } = require("graphics");
+
+const SPRITE16 = {
+  width: 32,
+  height: 32,
+  bpp: 16,
+  data: new Uint8Array(32 * 32 * 2).map((v, i) => (i % 14 < 4 ? 0 : i)),
+};
+const SPRITE1 = {
+  width: 32,
+  height: 32,
+  bpp: 1,
+  data: new Uint8Array(32 * 4).map((v, i) => i * 37),
+};
+// 40x40 map of the 16 8x8 tiles of SPRITE16 (covers the whole screen) and
+// 32 sprites of 16x16 frames
+const MAP = new TileMap(SPRITE16, {
+  tileWidth: 8,
+  tileHeight: 8,
+  columns: 40,
+  rows: 40,
+  tiles: new Uint8Array(40 * 40).map((v, i) => i & 15),
+});
+const SPRITES = new SpriteLayer(SPRITE16, {
+  frameWidth: 16,
+  frameHeight: 16,
+  count: 32,
+  transparent: 0,
+});
+for (let i = 0; i < 32; i++) {
+  SPRITES.setSprite(i, (i * 37) % 300, (i * 53) % 300, i & 3, 1, i & 7);
+}
+// 1000-vertex chart across the screen, and the area under it
+const CHART = new Int16Array(1000 * 2).map((v, i) =>
+  i & 1 ? 160 + Math.round(100 * Math.sin(i / 40)) : Math.floor((i >> 1) * 0.32)
+);
+const AREA = new Int16Array(CHART.length + 4);
+AREA.set(CHART);
+AREA.set([319, 319, 0, 319], CHART.length);
+
+const W = 320;
+const H = 320;
+const MS = 300; // run each primitive for about this long
+
+function bench(label, pixels, fn) {
+  let n = 0;
+  const t = micros();
+  let elapsed = 0;
+  while (elapsed < MS * 1000) {
+    fn(n++);
+    elapsed = micros() - t;
+  }
+  const mpps = (n * pixels) / elapsed; // pixels per us = Mpixels per s
+  console.log(`[graphics] ${label}: ${mpps.toFixed(2)}Mpx/s`);
+}
+
+[1, 3, 16].forEach((bpp) => {
+  [0, 1].forEach((rotation) => {
+    const gc = new BufferedGraphicsContext(W, H, { bpp, rotation });
+    const tag = `${bpp}bpp rot${rotation}`;
+    gc.setColor(1);
+    gc.setFillColor(0xf800);
+    bench(`${tag} fillScreen`, W * H, (i) => gc.fillScreen(i & 1));
+    bench(`${tag} fillRect 200x200`, 200 * 200, (i) =>
+      gc.fillRect(i % 40, i % 50, 200, 200)
+    );
+    bench(`${tag} fillRect 8x8`, 8 * 8, (i) =>
+      gc.fillRect(i % 300, (i >> 3) % 300, 8, 8)
+    );
+    bench(`${tag} drawRect 200x200`, 2 * (200 + 198), (i) =>
+      gc.drawRect(i % 40, i % 50, 200, 200)
+    );
+    bench(`${tag} fillCircle r=100`, Math.round(Math.PI * 100 * 100), (i) =>
+      gc.fillCircle(150 + (i % 10), 150, 100)
+    );
+    bench(`${tag} drawText x1`, 34 * 6 * 8, (i) =>
+      gc.drawText(i % 100, i % 300, "The quick brown fox jumps over 123")
+    );
+    gc.setFontScale(3, 3);
+    bench(`${tag} drawText x3`, 34 * 18 * 24, (i) =>
+      gc.drawText(i % 100, i % 300, "The quick brown fox jumps over 123")
+    );
+    gc.setFontScale(1, 1);
+    const px = 32 * 32;
+    bench(`${tag} drawBitmap 16bpp`, px, (i) =>
+      gc.drawBitmap(i % 280, (i >> 3) % 280, SPRITE16)
+    );
+    bench(`${tag} drawBitmap 16bpp transparent`, px, (i) =>
+      gc.drawBitmap(i % 280, (i >> 3) % 280, SPRITE16, { transparent: 0 })
+    );
+    bench(`${tag} drawBitmap 16bpp flipX`, px, (i) =>
+      gc.drawBitmap(i % 280, (i >> 3) % 280, SPRITE16, { flipX: true })
+    );
+    bench(`${tag} drawBitmap 16bpp scale 2`, px * 4, (i) =>
+      gc.drawBitmap(i % 280, (i >> 3) % 280, SPRITE16, {
+        scaleX: 2,
+        scaleY: 2,
+      })
+    );
+    bench(`${tag} drawBitmap 1bpp`, px, (i) =>
+      gc.drawBitmap(i % 280, (i >> 3) % 280, SPRITE1, { color: 1 })
+    );
+    bench(`${tag} scroll 8 rows`, W * H, () => gc.scroll(0, -8));
+    bench(`${tag} copyRect 100x100`, 100 * 100, (i) =>
+      gc.copyRect(i % 50, 10, 100, 100, 150, i % 100)
+    );
+    bench(`${tag} drawTileMap 320x320`, W * H, (i) => {
+      MAP.setScroll(i % 8, 0);
+      gc.drawTileMap(MAP);
+    });
+    bench(`${tag} drawSpriteLayer 32x16x16`, 32 * 16 * 16, () =>
+      gc.drawSpriteLayer(SPRITES)
+    );
+    bench(`${tag} chart 1000 drawLine (JS)`, 1000, () => {
+      for (let k = 0; k < 999 * 2; k += 2) {
+        gc.drawLine(CHART[k], CHART[k + 1], CHART[k + 2], CHART[k + 3]);
+      }
+    });
+    bench(`${tag} chart 1000 drawPolyline`, 1000, () =>
+      gc.drawPolyline(CHART)
+    );
+    bench(`${tag} chart 1000 drawPolyline 3px`, 1000, () =>
+      gc.drawPolyline(CHART, 3)
+    );
+    bench(`${tag} chart 1000 fillPolygon area`, 1000, () =>
+      gc.fillPolygon(AREA)
+    );
+    bench(`${tag} setPixel`, 1, (i) => gc.setPixel(i % W, (i >> 8) % H, 1));
+  });
+});
@@ -0,0 +1,28 @@
+// Yield cost: a chain of N callbacks scheduled with setTimeout(fn, 0),
+// setImmediate(fn) and queueMicrotask(fn).
+
+const N = 10000;
+
+function chain(name, schedule, next) {
+  let count = 0;
+  const t = micros();
+  const step = () => {
+    count++;
+    if (count < N) {
+      schedule(step);
+    } else {
+      const elapsed = micros() - t;
+      console.log(
+        `[immediate] ${name}: ${(elapsed / N).toFixed(2)}us/callback`
+      );
+      next();
+    }
+  };
+  schedule(step);
+}
+
+chain("setTimeout(0)", (fn) => setTimeout(fn, 0), () => {
+  chain("setImmediate", (fn) => setImmediate(fn), () => {
+    chain("queueMicrotask", (fn) => queueMicrotask(fn), () => {});
+  });
+});
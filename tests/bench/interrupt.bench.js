@@ -0,0 +1,42 @@
+// Interrupt dispatch throughput and overflow with synthetic edges.
+// BURST edges are raised per tick (as a fast signal would between two loop
+// iterations) and counted in the JS callback.
+
+const { simulateInterrupt } = require("__test_utils");
+
+const BURSTS = [16, 64, 256];
+const TICKS = 200;
+const PIN = 2;
+
+function bench(burst, next) {
+  let count = 0;
+  let ticks = 0;
+  const overflow = getInterruptOverflow();
+  attachInterrupt(PIN, () => count++, CHANGE);
+  const t = micros();
+  const id = setInterval(() => {
+    simulateInterrupt(PIN, RISING, burst);
+    ticks++;
+    if (ticks === TICKS) {
+      clearInterval(id);
+      setTimeout(() => {
+        const elapsed = micros() - t;
+        const dropped = getInterruptOverflow() - overflow;
+        detachInterrupt(PIN);
+        console.log(
+          `[interrupt] burst=${burst} delivered=${count} dropped=${dropped} ` +
+            `rate=${Math.round((count * 1000000) / elapsed)}/s`
+        );
+        next();
+      }, 10);
+    }
+  }, 0);
+}
+
+function run(i) {
+  if (i < BURSTS.length) {
+    bench(BURSTS[i], () => run(i + 1));
+  }
+}
+
+run(0);
@@ -0,0 +1,19 @@
+// Native call overhead: a native function without property access
+// (millis), with property reads (Flash.ioctl reads "base" and "count") and
+// with property writes (Flash constructor sets "base", "count" and "size").
+
+const { Flash } = require("flash");
+
+const N = 20000;
+
+function bench(name, fn) {
+  const t = micros();
+  for (let i = 0; i < N; i++) fn();
+  const elapsed = micros() - t;
+  console.log(`[native] ${name}: ${(elapsed / N).toFixed(2)}us/call`);
+}
+
+const bd = new Flash(0, 1);
+bench("millis()", () => millis());
+bench("flash.ioctl(4)", () => bd.ioctl(4));
+bench("new Flash()", () => new Flash(0, 1));
@@ -0,0 +1,45 @@
+// SD card throughput on the simulated card of the Linux target, from the
+// emulated SPI bus time (see targets/linux/include/sdcard_sim.h): block by
+// block (CMD17/CMD24) and multiple blocks at once (CMD18/CMD25), at 25MHz
+// and in high speed mode at 50MHz. Prints KB per second.
+
+const { SDCard } = require("sdcard");
+const { attachSDCard, sdcardStats, resetSDCardStats } = require("__test_utils");
+
+const BUS = 1;
+const CS = 5;
+const BLOCK_SIZE = 512;
+const BLOCKS = 512; // 256KB
+const CHUNK = 64; // blocks per call of the multi-block case
+
+function run(label, fn) {
+  resetSDCardStats();
+  fn();
+  const stats = sdcardStats();
+  const kbps = (BLOCKS * BLOCK_SIZE * 1e6) / stats.busTime / 1024;
+  console.log(
+    `[sdcard] ${label}: ${Math.round(kbps)}KB/s ` +
+      `transfers=${stats.transfers} bytes=${stats.bytes}`
+  );
+}
+
+[25000000, 50000000].forEach((baudrate) => {
+  attachSDCard(BUS, CS, 4096);
+  const sd = new SDCard(BUS, { cs: CS, baudrate });
+  sd.ioctl(1);
+  const tag = `${baudrate / 1000000}MHz`;
+  const one = new Uint8Array(BLOCK_SIZE).fill(0x5a);
+  const chunk = new Uint8Array(BLOCK_SIZE * CHUNK).fill(0xa5);
+  run(`${tag} write by block`, () => {
+    for (let i = 0; i < BLOCKS; i++) sd.write(i, one);
+  });
+  run(`${tag} write ${CHUNK} blocks`, () => {
+    for (let i = 0; i < BLOCKS; i += CHUNK) sd.write(i, chunk);
+  });
+  run(`${tag} read by block`, () => {
+    for (let i = 0; i < BLOCKS; i++) sd.read(i, one);
+  });
+  run(`${tag} read ${CHUNK} blocks`, () => {
+    for (let i = 0; i < BLOCKS; i += CHUNK) sd.read(i, chunk);
+  });
+});
@@ -0,0 +1,52 @@
+// Throughput of the storage module (Linux target, RAM-backed flash): set,
+// get, overwrite (which compacts the storage area from time to time) and
+// remove of small items, then set/get of large values. Prints operations
+// per second and the emulated NOR flash busy time per operation.
+
+const { flashStats, resetFlashStats } = require("__test_utils");
+
+const KEYS = 100;
+const MS = 300; // run each operation for about this long
+
+function bench(label, fn) {
+  resetFlashStats();
+  let n = 0;
+  const t = micros();
+  let elapsed = 0;
+  while (elapsed < MS * 1000) {
+    fn(n++);
+    elapsed = micros() - t;
+  }
+  const stats = flashStats();
+  console.log(
+    `[storage] ${label}: ${Math.round((n * 1e6) / elapsed)}ops/s ` +
+      `flash=${(stats.busyTime / n).toFixed(1)}us/op ` +
+      `erases=${stats.erases} programs=${stats.programs}`
+  );
+}
+
+const keys = [];
+for (let i = 0; i < KEYS; i++) keys.push("key-" + i);
+const large = "0123456789abcdef".repeat(128); // 2KB
+
+storage.clear();
+bench(`setItem ${KEYS} keys`, (i) => {
+  if (i % KEYS === 0) storage.clear();
+  storage.setItem(keys[i % KEYS], "value-" + i);
+});
+bench(`getItem ${KEYS} keys`, (i) => storage.getItem(keys[(i * 37) % KEYS]));
+bench("getItem missing key", () => storage.getItem("missing"));
+bench(`setItem overwrite ${KEYS} keys`, (i) =>
+  storage.setItem(keys[(i * 37) % KEYS], "value-" + i)
+);
+bench(`key() iterate ${KEYS} keys`, (i) => storage.key(i % KEYS));
+bench(`removeItem ${KEYS} keys`, (i) => {
+  if (i % KEYS === 0) {
+    for (let k = 0; k < KEYS; k++) storage.setItem(keys[k], "value");
+  }
+  storage.removeItem(keys[i % KEYS]);
+});
+storage.clear();
+bench("setItem 2KB value", (i) => storage.setItem("large" + (i % 2), large));
+bench("getItem 2KB value", (i) => storage.getItem("large" + (i % 2)));
+storage.clear();
@@ -0,0 +1,44 @@
+// Timer firing jitter with 10, 1k and 10k armed timers.
+// A 10ms interval is sampled while N long timeouts are armed in the queue.
+
+const COUNTS = [10, 1000, 10000];
+const PERIOD = 10; // msec
+const SAMPLES = 100;
+
+function bench(count, next) {
+  const armed = [];
+  for (let i = 0; i < count; i++) {
+    armed.push(setTimeout(() => {}, 60000 + i));
+  }
+  let samples = 0;
+  let sum = 0;
+  let max = 0;
+  let last = micros();
+  const id = setInterval(() => {
+    const now = micros();
+    const jitter = Math.abs(now - last - PERIOD * 1000);
+    last = now;
+    sum += jitter;
+    if (jitter > max) max = jitter;
+    samples++;
+    if (samples === SAMPLES) {
+      clearInterval(id);
+      const t = micros();
+      armed.forEach((timer) => clearTimeout(timer));
+      const clear = micros() - t;
+      console.log(
+        `[timers] armed=${count} jitter avg=${Math.round(sum / SAMPLES)}us ` +
+          `max=${max}us clearAll=${clear}us`
+      );
+      next();
+    }
+  }, PERIOD);
+}
+
+function run(i) {
+  if (i < COUNTS.length) {
+    bench(COUNTS[i], () => run(i + 1));
+  }
+}
+
+run(0);
@@ -0,0 +1,76 @@
+const { test, start, expect } = require("__ujest");
+const { Buffer } = require("buffer");
+
+test("[buffer] from() and toString() with encodings", (done) => {
+  const buf = Buffer.from("hello world");
+  expect(buf instanceof Uint8Array).toBe(true);
+  expect(Buffer.isBuffer(buf)).toBe(true);
+  expect(buf.length).toBe(11);
+  expect(buf.toString()).toBe("hello world");
+  expect(buf.toString("hex", 0, 5)).toBe("68656c6c6f");
+  expect(buf.toString("base64")).toBe("aGVsbG8gd29ybGQ=");
+  expect(Buffer.from("68656c6c6f", "hex").toString()).toBe("hello");
+  expect(Buffer.from("aGVsbG8=", "base64").toString()).toBe("hello");
+  expect(Buffer.from("é", "latin1")[0]).toBe(0xe9);
+  expect(Buffer.from([0xe9]).toString("latin1")).toBe("é");
+  expect(Buffer.from("€").length).toBe(3);
+  expect(Buffer.byteLength("€")).toBe(3);
+  done();
+});
+
+test("[buffer] slice() shares memory", (done) => {
+  const buf = Buffer.from("abcdef");
+  const part = buf.slice(2, 4);
+  expect(part instanceof Buffer).toBe(true);
+  expect(part.toString()).toBe("cd");
+  part[0] = 0x58; // 'X'
+  expect(buf.toString()).toBe("abXdef");
+  expect(buf.slice(-2).toString()).toBe("ef");
+  done();
+});
+
+test("[buffer] concat(), indexOf() and includes()", (done) => {
+  const buf = Buffer.concat([Buffer.from("GET / "), new Uint8Array([0x48, 0x54])]);
+  expect(buf.toString()).toBe("GET / HT");
+  expect(buf.indexOf("/")).toBe(4);
+  expect(buf.indexOf(0x48)).toBe(6);
+  expect(buf.indexOf(Buffer.from("HT"))).toBe(6);
+  expect(buf.indexOf("GET", 1)).toBe(-1);
+  expect(buf.includes("T / H")).toBe(true);
+  expect(Buffer.concat([buf], 3).toString()).toBe("GET");
+  done();
+});
+
+test("[buffer] read/write integers and floats", (done) => {
+  const buf = Buffer.alloc(8);
+  expect(buf.writeUInt16LE(0x1234, 0)).toBe(2);
+  expect(buf.readUInt16LE(0)).toBe(0x1234);
+  expect(buf.readUInt16BE(0)).toBe(0x3412);
+  buf.writeInt32BE(-2, 4);
+  expect(buf.readInt32BE(4)).toBe(-2);
+  expect(buf.readUInt32BE(4)).toBe(0xfffffffe);
+  expect(buf.readInt8(7)).toBe(-2);
+  buf.writeDoubleLE(1.5, 0);
+  expect(buf.readDoubleLE(0)).toBe(1.5);
+  expect(() => buf.readUInt32LE(5)).toThrow();
+  done();
+});
+
+test("[buffer] write(), equals() and compare()", (done) => {
+  const buf = Buffer.alloc(6, "ab");
+  expect(buf.toString()).toBe("ababab");
+  expect(buf.write("xyz", 4)).toBe(2);
+  expect(buf.toString()).toBe("ababxy");
+  expect(buf.equals(Buffer.from("ababxy"))).toBe(true);
+  expect(Buffer.compare(Buffer.from("a"), Buffer.from("b"))).toBe(-1);
+  done();
+});
+
+test("[buffer] alloc() - fill decoding to nothing", (done) => {
+  const buf = Buffer.alloc(4, "zz", "hex");
+  expect(buf.length).toBe(4);
+  expect(buf.join(",")).toBe("0,0,0,0");
+  done();
+});
+
+start(); // start to test
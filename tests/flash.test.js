@@ -1,5 +1,6 @@
 const { test, start, expect } = require("__ujest");
 const { Flash } = require("flash");
+const { VFSLittleFS } = require("vfs_lfs");
 
 const BLOCK_BASE = 0;
 const BLOCK_COUNT = 260;
@@ -62,4 +63,47 @@ test("[flash] ioctl(6) - erase block", (done) => {
   done();
 });
 
+test("[flash] read() - into a subarray", (done) => {
+  const flash = new Flash(BLOCK_BASE, BLOCK_COUNT);
+  let buf1 = new Uint8Array(BLOCK_SIZE);
+  buf1.fill(33);
+  flash.write(0, buf1);
+
+  // only the view of the subarray is filled
+  let buf2 = new Uint8Array(16);
+  flash.read(0, buf2.subarray(4, 8), 0);
+  expect(buf2.join(",")).toBe("0,0,0,0,33,33,33,33,0,0,0,0,0,0,0,0");
+  done();
+});
+
+test("[flash] native block device with littlefs", (done) => {
+  const flash = new Flash(BLOCK_BASE, 16);
+  const data = new Uint8Array(10000).map((v, i) => i * 7);
+
+  // write through the native fast path
+  let vfs = new VFSLittleFS(flash);
+  vfs.mkfs();
+  vfs.mount();
+  let id = vfs.open("/data.bin", 2 | 4, 0); // write | create
+  vfs.write(id, data, 0, data.length, 0);
+  vfs.close(id);
+  vfs.unmount();
+
+  // read back through the JS block device protocol
+  const wrapper = {
+    read: (block, buffer, offset) => flash.read(block, buffer, offset),
+    write: (block, buffer, offset) => flash.write(block, buffer, offset),
+    ioctl: (op, arg) => flash.ioctl(op, arg),
+  };
+  vfs = new VFSLittleFS(wrapper);
+  vfs.mount();
+  const buf = new Uint8Array(data.length);
+  id = vfs.open("/data.bin", 1, 0); // read
+  vfs.read(id, buf, 0, buf.length, 0);
+  vfs.close(id);
+  vfs.unmount();
+  expect(buf.join(",")).toBe(data.join(","));
+  done();
+});
+
 start(); // start to test
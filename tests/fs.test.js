@@ -581,6 +581,66 @@ test("[fs] write/readFile()", (done) => {
   done();
 });
 
+test("[fs] mount() - with block cache", (done) => {
+  const data = new Uint8Array(3000).map((v, i) => i * 7);
+  const bd_fat1 = new RAMBlockDev(BLOCK_SIZE, BLOCK_COUNT, BUFFER_SIZE);
+  const devs = [
+    { bd: new RAMBlockDev(), fstype: 'lfs' },
+    { bd: bd_fat1, fstype: 'fat' },
+  ];
+  devs.forEach((dev) => {
+    fs.mount('/', dev.bd, dev.fstype, true, { cacheSize: 4096 });
+    fs.mkdir('/dir1');
+    fs.writeFile('/dir1/data.bin', data);
+    for (let i = 0; i < 3; i++) {
+      expect(fs.readFile('/dir1/data.bin').join(',')).toBe(data.join(','));
+    }
+    const stats = fs.cacheStats('/');
+    expect(stats.size).toBe(4096);
+    expect(stats.hits > 0).toBe(true);
+    expect(stats.writeBacks > 0).toBe(true);
+    fs.flush('/');
+    fs.unmount('/');
+
+    // read back without cache
+    fs.mount('/', dev.bd, dev.fstype);
+    expect(fs.cacheStats('/')).toBe(undefined);
+    expect(fs.readFile('/dir1/data.bin').join(',')).toBe(data.join(','));
+    fs.unmount('/');
+  });
+  done();
+});
+
+test("[fs] mount() - littlefs options", (done) => {
+  const data = new Uint8Array(3000).map((v, i) => i * 7);
+  const bd = new RAMBlockDev(4096, 64, 256);
+  fs.mount('/', bd, 'lfs', true, {
+    bufferSize: 1024,
+    lookaheadSize: 16,
+    blockCycles: 100,
+    nameMax: 64,
+  });
+  fs.writeFile('/data.bin', data);
+  expect(fs.readFile('/data.bin').join(',')).toBe(data.join(','));
+  const st = fs.statfs('/');
+  expect(st.bsize).toBe(4096);
+  expect(st.blocks).toBe(64);
+  expect(st.bfree > 0 && st.bfree < 64).toBe(true);
+  fs.gc('/');
+  fs.unlink('/data.bin');
+  expect(fs.statfs('/').bfree > st.bfree).toBe(true);
+  fs.unmount('/');
+
+  // invalid options (not a divisor of the block size, not a multiple of 8)
+  expect(() => {
+    fs.mount('/', bd, 'lfs', false, { bufferSize: 768 });
+  }).toThrow();
+  expect(() => {
+    fs.mount('/', bd, 'lfs', false, { lookaheadSize: 12 });
+  }).toThrow();
+  done();
+});
+
 // TODO: test for offset, length, position
 // TODO: test for flags (wx, w+, r+, rs+, a, ax, a+, as, as+, ...)
 // TODO: test for exceptions (e.g. try to read for non-exists file)
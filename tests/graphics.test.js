@@ -0,0 +1,351 @@
+const { test, start, expect } = require("__ujest");
+const {
+  GraphicsContext,
+  BufferedGraphicsContext,
+  TileMap,
+  SpriteLayer,
+} = require("graphics");
+
+test("[graphics] display() passes the dirty region", (done) => {
+  const calls = [];
+  const gc = new BufferedGraphicsContext(32, 16, {
+    bpp: 16,
+    display: (buffer, region) => calls.push(region),
+  });
+  gc.display(); // whole buffer is dirty initially
+  expect(calls.length).toBe(1);
+  expect(calls[0].width).toBe(32);
+  expect(calls[0].height).toBe(16);
+  expect(calls[0].data.length).toBe(32 * 16 * 2);
+  gc.display(); // nothing changed
+  expect(calls.length).toBe(1);
+  gc.setFillColor(0xffff);
+  gc.fillRect(4, 2, 3, 5);
+  gc.setPixel(10, 3, 0xffff);
+  gc.display();
+  const r = calls[1];
+  expect([r.x, r.y, r.width, r.height, r.stride].join(",")).toBe(
+    "4,2,7,5,64"
+  );
+  expect(r.data.length).toBe(5 * 64);
+  expect(r.data.buffer).toBe(gc.buffer.buffer); // no copy
+  expect(r.data[4 * 2]).toBe(0xff);
+  gc.invalidate();
+  gc.display();
+  expect(calls[2].width).toBe(32);
+  done();
+});
+
+test("[graphics] display() with partial: false", (done) => {
+  let args = null;
+  const gc = new BufferedGraphicsContext(16, 16, {
+    bpp: 1,
+    partial: false,
+    display: function () {
+      args = arguments;
+    },
+  });
+  gc.display();
+  expect(args.length).toBe(1);
+  args = null;
+  gc.display(); // called even if nothing changed
+  expect(args.length).toBe(1);
+  done();
+});
+
+test("[graphics] display() with a legacy one-argument callback", (done) => {
+  let count = 0;
+  const gc = new BufferedGraphicsContext(16, 16, {
+    bpp: 1,
+    display: function (buffer) {
+      expect(arguments.length).toBe(1);
+      expect(buffer.length).toBe(16 * 2);
+      count++;
+    },
+  });
+  gc.getBuffer()[0] = 0xff; // written directly, not tracked as dirty
+  gc.display();
+  gc.display();
+  expect(count).toBe(2); // full frame on every display()
+  done();
+});
+
+test("[graphics] banded rendering replays the display list", (done) => {
+  const bands = [];
+  const gc = new BufferedGraphicsContext(16, 16, {
+    bpp: 16,
+    bandHeight: 4,
+    display: (buffer, region) => {
+      expect(buffer.length).toBe(16 * 4 * 2);
+      // first pixel of the band
+      bands.push(`${region.y}:${region.height}:${region.data[0]}`);
+    },
+  });
+  gc.clearScreen();
+  gc.setFillColor(0xffff);
+  gc.fillRect(0, 4, 16, 8); // rows 4..11
+  gc.setFillColor(0);
+  gc.display();
+  expect(bands.join(",")).toBe("0:4:0,4:4:255,8:4:255,12:4:0");
+  expect(gc.getFillColor()).toBe(0);
+  bands.length = 0;
+  gc.display(); // nothing recorded
+  expect(bands.length).toBe(0);
+  done();
+});
+
+test("[graphics] banded display list is limited", (done) => {
+  const gc = new BufferedGraphicsContext(16, 16, {
+    bpp: 16,
+    bandHeight: 4,
+    display: () => {},
+  });
+  gc.clearScreen();
+  expect(() => gc.setPixel(0, 0, 1, 2, 3, 4, 5, 6, 7)).toThrow();
+  for (let i = 1; i < 1024; i++) {
+    gc.setPixel(0, 0, 1);
+  }
+  expect(() => gc.setPixel(0, 0, 1)).toThrow();
+  gc.clearScreen(); // starts a new list
+  gc.setPixel(0, 0, 1);
+  done();
+});
+
+test("[graphics] fillRects batches rects and pixels", (done) => {
+  const calls = [];
+  const gc = new GraphicsContext(32, 16, {
+    fillRects: (rects, count) => {
+      calls.push(Array.prototype.slice.call(rects, 0, count * 5).join(","));
+    },
+  });
+  gc.setFillColor(7);
+  gc.fillRect(-2, 1, 4, 3); // clipped
+  gc.setColor(5);
+  gc.drawLine(0, 10, 9, 10); // ten pixels coalesced into a span
+  gc.drawText(0, 0, "Hello");
+  expect(calls.length).toBe(3);
+  expect(calls[0]).toBe("0,1,2,3,7");
+  expect(calls[1]).toBe("0,10,10,1,5");
+  done();
+});
+
+test("[graphics] fillRect() and lines match setPixel()", (done) => {
+  let seed = 1;
+  const random = (n) => {
+    seed = (seed * 16807) % 2147483647;
+    return seed % n;
+  };
+  [1, 3, 16].forEach((bpp) => {
+    // odd sizes for partial 1-bit pages (3-bit rows are whole bytes)
+    const width = bpp === 3 ? 14 : 13;
+    for (let rotation = 0; rotation < 4; rotation++) {
+      const options = { bpp: bpp, rotation: rotation };
+      const gc = new BufferedGraphicsContext(width, 11, options);
+      const ref = new BufferedGraphicsContext(width, 11, options);
+      const w = gc.getWidth();
+      const h = gc.getHeight();
+      const colors = bpp === 16 ? 0x10000 : 1 << bpp;
+      for (let i = 0; i < 40; i++) {
+        const kind = random(3); // rect, horizontal or vertical line
+        const x = random(w + 8) - 4;
+        const y = random(h + 8) - 4;
+        const rw = kind === 2 ? 1 : random(w + 4) + 1;
+        const rh = kind === 1 ? 1 : random(h + 4) + 1;
+        const color = random(colors);
+        if (kind === 0) {
+          gc.setFillColor(color);
+          gc.fillRect(x, y, rw, rh);
+        } else {
+          gc.setColor(color);
+          gc.drawLine(x, y, x + rw - 1, y + rh - 1);
+        }
+        for (let yy = y; yy < y + rh; yy++) {
+          for (let xx = x; xx < x + rw; xx++) {
+            if (xx >= 0 && xx < w && yy >= 0 && yy < h) {
+              ref.setPixel(xx, yy, color);
+            }
+          }
+        }
+      }
+      expect(gc.getBuffer().join(",")).toBe(ref.getBuffer().join(","));
+    }
+  });
+  done();
+});
+
+test("[graphics] setFontColor() with a background fills the text cells", (done) => {
+  const gc = new BufferedGraphicsContext(16, 8, { bpp: 16 });
+  const buffer = gc.getBuffer();
+  gc.setFontColor(0xffff);
+  gc.drawText(0, 0, " ");
+  expect(buffer[0]).toBe(0); // transparent
+  gc.setFontColor(0xffff, 0x1234);
+  gc.drawText(0, 0, " ");
+  expect(buffer[0]).toBe(0x12);
+  expect(buffer[(6 * 8 - 1) * 2 + 1]).toBe(0); // outside of the 6x8 cell
+  expect(buffer[(7 * 16 + 5) * 2 + 1]).toBe(0x34); // last pixel of the cell
+  gc.clearScreen();
+  gc.setFontColor(0xffff, undefined);
+  gc.drawText(0, 0, " ");
+  expect(buffer[0]).toBe(0); // transparent as if omitted
+  const size = gc.measureText("A\r\nB");
+  expect(size.width).toBe(6);
+  expect(size.height).toBe(16);
+  done();
+});
+
+test("[graphics] custom font glyphs stay cached across setFont() and bands", (done) => {
+  const { glyphCacheStats } = require("graphics");
+  const font = (bits) => {
+    const bitmap = new Uint8Array(16);
+    bitmap.fill(bits);
+    return {
+      bitmap: bitmap,
+      width: 8,
+      height: 8,
+      first: 65, // "A".."B"
+      last: 66,
+      advanceX: 8,
+      advanceY: 8,
+    };
+  };
+  const fontA = font(0x81);
+  const fontB = font(0x3c);
+  const gc = new BufferedGraphicsContext(32, 16, {
+    bpp: 16,
+    bandHeight: 4,
+    display: (buffer, region) => {},
+  });
+  const frame = () => {
+    gc.clearScreen();
+    gc.setFont(fontA);
+    gc.drawText(0, 0, "AB");
+    gc.setFont(fontB); // switched every frame
+    gc.drawText(0, 8, "AB");
+    gc.display(); // replayed for each band
+  };
+  frame();
+  const before = glyphCacheStats();
+  frame();
+  frame();
+  const after = glyphCacheStats();
+  expect(after.misses).toBe(before.misses);
+  expect(after.hits).toBeGreaterThan(before.hits);
+  done();
+});
+
+test("[graphics] scroll(), copyRect() and blit() move pixels", (done) => {
+  let region = null;
+  const gc = new BufferedGraphicsContext(16, 16, {
+    bpp: 1,
+    display: (buffer, r) => {
+      region = r;
+    },
+  });
+  const buffer = gc.getBuffer();
+  gc.setPixel(0, 0, 1);
+  gc.display();
+  gc.scroll(0, 8, 0); // one page down
+  expect(buffer[0]).toBe(0);
+  expect(buffer[16]).toBe(1);
+  gc.display();
+  expect(region.height).toBe(16);
+  gc.copyRect(0, 8, 1, 1, 3, 9); // bit 0 to bit 1 of the page
+  expect(buffer[16 + 3]).toBe(2);
+  gc.display();
+  expect(`${region.x},${region.y},${region.width}`).toBe("3,8,1");
+  const sprite = new BufferedGraphicsContext(4, 8, { bpp: 1 });
+  sprite.fillScreen(1);
+  gc.blit(sprite, 12, 0);
+  expect(buffer[12]).toBe(0xff);
+  expect(buffer[11]).toBe(0);
+  expect(() => gc.blit({}, 0, 0)).toThrow();
+  done();
+});
+
+test("[graphics] drawBitmap() with flipX and transparent color", (done) => {
+  const gc = new BufferedGraphicsContext(4, 1, { bpp: 16 });
+  const buffer = gc.getBuffer();
+  const bitmap = {
+    width: 3,
+    height: 1,
+    bpp: 16,
+    data: new Uint8Array([0x12, 0x34, 0, 0, 0x56, 0x78]),
+  };
+  gc.fillScreen(0xffff);
+  gc.drawBitmap(0, 0, bitmap, { flipX: true, transparent: 0 });
+  expect(Array.prototype.slice.call(buffer).join(",")).toBe(
+    "86,120,255,255,18,52,255,255"
+  );
+  done();
+});
+
+test("[graphics] drawTileMap() and drawSpriteLayer()", (done) => {
+  const gc = new BufferedGraphicsContext(8, 4, { bpp: 16 });
+  const buffer = gc.getBuffer();
+  const pixel = (x, y) => buffer[(y * 8 + x) * 2];
+  // two 2x2 tiles: 0x0101 and 0x0202
+  const tileset = {
+    width: 4,
+    height: 2,
+    bpp: 16,
+    data: new Uint8Array([1, 1, 1, 1, 2, 2, 2, 2, 1, 1, 1, 1, 2, 2, 2, 2]),
+  };
+  const map = new TileMap(tileset, {
+    tileWidth: 2,
+    tileHeight: 2,
+    columns: 4,
+    rows: 2,
+    tiles: new Uint8Array([0, 1, 0, 1, 1, 0, 1, 0]),
+  });
+  gc.drawTileMap(map);
+  expect(`${pixel(0, 0)},${pixel(2, 0)},${pixel(0, 2)}`).toBe("1,2,2");
+  gc.fillScreen(0);
+  map.setScroll(2, 0);
+  map.setTile(1, 0, 0);
+  expect(map.getTile(1, 0)).toBe(0);
+  expect(map.getTile(4, 0)).toBe(-1);
+  gc.drawTileMap(map);
+  expect(`${pixel(0, 0)},${pixel(2, 0)},${pixel(6, 0)}`).toBe("1,1,0");
+  gc.fillScreen(0);
+  const layer = new SpriteLayer(tileset, { frameWidth: 2, frameHeight: 2 });
+  layer.setSprite(0, 0, 0, 1, SpriteLayer.VISIBLE, 1);
+  layer.setSprite(1, 1, 0, 0, SpriteLayer.VISIBLE, 0);
+  layer.setViewport(0, 0, 8, 1);
+  gc.drawSpriteLayer(layer);
+  expect(`${pixel(0, 0)},${pixel(1, 0)},${pixel(2, 0)}`).toBe("2,2,1");
+  expect(pixel(0, 1)).toBe(0); // clipped by the viewport
+  done();
+});
+
+test("[graphics] fillPolygon(), drawPolyline() and drawArc()", (done) => {
+  const gc = new BufferedGraphicsContext(16, 16, { bpp: 1 });
+  const count = () => {
+    let n = 0;
+    for (let y = 0; y < 16; y++) {
+      for (let x = 0; x < 16; x++) n += gc.getPixel(x, y) ? 1 : 0;
+    }
+    return n;
+  };
+  gc.setFillColor(1);
+  gc.fillPolygon(new Int16Array([2, 2, 6, 2, 6, 5, 2, 5])); // same as fillRect
+  expect(count()).toBe(4 * 3);
+  expect(gc.getPixel(5, 4)).toBe(1);
+  expect(gc.getPixel(6, 4)).toBe(0);
+  gc.clearScreen();
+  gc.fillTriangle(0, 0, 8, 0, 0, 8);
+  expect(count()).toBe(7 + 6 + 5 + 4 + 3 + 2 + 1); // centers inside
+  gc.clearScreen();
+  gc.setColor(1);
+  gc.drawPolyline([1, 8, 14, 8], 3); // 3 rows, ends included as drawLine
+  expect(gc.getPixel(1, 7) + gc.getPixel(14, 9)).toBe(2);
+  expect(count()).toBe(14 * 3);
+  gc.clearScreen();
+  gc.drawArc(8, 8, 6, 0, 90); // lower right quarter
+  expect(gc.getPixel(14, 8)).toBe(1);
+  expect(gc.getPixel(8, 14)).toBe(1);
+  expect(gc.getPixel(2, 8)).toBe(0);
+  done();
+});
+
+start(); // start to test
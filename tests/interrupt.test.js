@@ -0,0 +1,52 @@
+const { test, start, expect } = require("__ujest");
+const { simulateInterrupt } = require("__test_utils");
+
+test("[interrupt] callbacks are deferred to the event loop", (done) => {
+  var calls = [];
+  attachInterrupt(
+    2,
+    (pin, events, time) => calls.push([pin, events, time]),
+    FALLING
+  );
+  expect(simulateInterrupt(2, FALLING, 10)).toBe(10);
+  expect(calls.length).toBe(0);
+  setTimeout(() => {
+    expect(calls.length).toBe(10);
+    for (var i = 0; i < calls.length; i++) {
+      expect(calls[i][0]).toBe(2);
+      expect(calls[i][1]).toBe(FALLING);
+      if (i > 0) {
+        expect(calls[i][2]).toBeGreaterThanOrEqual(calls[i - 1][2]);
+      }
+    }
+    detachInterrupt(2);
+    done();
+  }, 10);
+});
+
+test("[interrupt] masked events are not raised", (done) => {
+  attachInterrupt(3, () => {}, RISING);
+  expect(simulateInterrupt(3, FALLING)).toBe(0);
+  expect(simulateInterrupt(4, RISING)).toBe(0);
+  disableInterrupts();
+  expect(simulateInterrupt(3, RISING)).toBe(0);
+  enableInterrupts();
+  detachInterrupt(3);
+  done();
+});
+
+test("[interrupt] overflow is counted when the queue is full", (done) => {
+  var count = 0;
+  var overflow = getInterruptOverflow();
+  attachInterrupt(5, () => count++, CHANGE);
+  expect(simulateInterrupt(5, RISING, 1000)).toBe(1000);
+  setTimeout(() => {
+    var dropped = getInterruptOverflow() - overflow;
+    expect(dropped).toBeGreaterThan(0);
+    expect(count + dropped).toBe(1000);
+    detachInterrupt(5);
+    done();
+  }, 10);
+});
+
+start(); // start to test
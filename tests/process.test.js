@@ -24,6 +24,29 @@ test("[process] process.memoryUsage()", (done) => {
   done();
 });
 
+test("[process] process.loopStats()", (done) => {
+  process.resetLoopStats();
+  setTimeout(() => {
+    // read from a second timer, so the first one has been counted
+    setTimeout(() => {
+      const stats = process.loopStats();
+      expect(stats.iterations).toBeGreaterThan(0);
+      expect(stats.elapsed).toBeGreaterThanOrEqual(10);
+      expect(stats.callbacks.timer).toBeGreaterThanOrEqual(1);
+      expect(stats.phases.timer.time).toBeGreaterThanOrEqual(0);
+      expect(stats.timerLateness.length).toBe(8);
+      // lateness is recorded before the callback runs and the callback is
+      // counted after it returns, so this timer is only in the histogram
+      const fired = stats.timerLateness.reduce((a, b) => a + b, 0);
+      expect(fired).toBeGreaterThanOrEqual(2);
+      expect(fired).toBeGreaterThanOrEqual(stats.callbacks.timer);
+      process.resetLoopStats();
+      expect(process.loopStats().iterations).toBe(0);
+      done();
+    }, 0);
+  }, 10);
+});
+
 test("[process] process.binding", (done) => {
   const natives = Object.keys(process.binding);
   const modules = process.builtin_modules;
@@ -0,0 +1,96 @@
+const { test, start, expect } = require("__ujest");
+const { SDCard } = require("sdcard");
+const { VFSFatFS } = require("vfs_fat");
+const {
+  attachSDCard,
+  sdcardStats,
+  resetSDCardStats,
+} = require("__test_utils");
+const fs = require("fs");
+
+// simulated SD card on SPI bus 1
+const BUS = 1;
+const CS = 5;
+const BLOCK_SIZE = 512;
+const BLOCK_COUNT = 16384; // 8MB (FAT with 4-block clusters)
+
+function init_sdcard(options) {
+  attachSDCard(BUS, CS, BLOCK_COUNT);
+  const sd = new SDCard(BUS, Object.assign({ cs: CS }, options));
+  sd.ioctl(1);
+  return sd;
+}
+
+test("[sdcard] ioctl() - init, block count and size", (done) => {
+  const sd = init_sdcard();
+  expect(sd.ioctl(4)).toBe(BLOCK_COUNT);
+  expect(sd.ioctl(5)).toBe(BLOCK_SIZE);
+  expect(sdcardStats().clock).toBe(25000000);
+  expect(sdcardStats().highSpeed).toBe(false);
+  done();
+});
+
+test("[sdcard] high speed mode", (done) => {
+  init_sdcard({ baudrate: 50000000 });
+  expect(sdcardStats().clock).toBe(50000000);
+  expect(sdcardStats().highSpeed).toBe(true);
+  done();
+});
+
+test("[sdcard] write() and read() - single block", (done) => {
+  const sd = init_sdcard();
+  const buf1 = new Uint8Array(BLOCK_SIZE).map((v, i) => i * 3);
+  const buf2 = new Uint8Array(BLOCK_SIZE);
+  resetSDCardStats();
+  sd.write(10, buf1);
+  sd.read(10, buf2);
+  expect(buf2.join(",")).toBe(buf1.join(","));
+  const stats = sdcardStats();
+  expect(stats.singleWrites).toBe(1);
+  expect(stats.singleReads).toBe(1);
+  done();
+});
+
+test("[sdcard] write() and read() - multiple blocks", (done) => {
+  const sd = init_sdcard();
+  const buf1 = new Uint8Array(BLOCK_SIZE * 16).map((v, i) => i * 7);
+  const buf2 = new Uint8Array(BLOCK_SIZE * 16);
+  resetSDCardStats();
+  sd.write(100, buf1);
+  sd.read(100, buf2);
+  expect(buf2.join(",")).toBe(buf1.join(","));
+  let stats = sdcardStats();
+  expect(stats.multiWrites).toBe(1);
+  expect(stats.preErases).toBe(1);
+  expect(stats.multiReads).toBe(1);
+  expect(stats.blocksWritten).toBe(16);
+  expect(stats.blocksRead).toBe(16);
+
+  // a part of them by blocks
+  const buf3 = new Uint8Array(BLOCK_SIZE * 2);
+  sd.read(105, buf3);
+  expect(buf3.join(",")).toBe(
+    buf1.subarray(BLOCK_SIZE * 5, BLOCK_SIZE * 7).join(",")
+  );
+  expect(() => {
+    sd.read(0, new Uint8Array(100));
+  }).toThrow();
+  done();
+});
+
+test("[sdcard] FAT file system", (done) => {
+  const sd = init_sdcard();
+  const data = new Uint8Array(20000).map((v, i) => i * 13);
+  fs.register("fat", VFSFatFS);
+  fs.mount("/sd", sd, "fat", true);
+  resetSDCardStats();
+  fs.writeFile("/sd/data.bin", data);
+  const read = fs.readFile("/sd/data.bin");
+  fs.unmount("/sd");
+  expect(read.join(",")).toBe(data.join(","));
+  expect(sdcardStats().multiWrites > 0).toBe(true);
+  expect(sdcardStats().multiReads > 0).toBe(true);
+  done();
+});
+
+start(); // start to test
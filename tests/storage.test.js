@@ -22,17 +22,16 @@ test("[storage] setItem() - long data", (done) => {
   storage.clear();
   const d = "0123456789abcdefghijklmnopqrstuvwxyz"; // 36
 
-  // total length: 252 (OK)
+  // value spanning multiple flash pages
   let k1 = d + d + d; // 108
-  let v1 = d + d + d + d; // 144
+  let v1 = d.repeat(40); // 1440
   storage.setItem(k1, v1);
   expect(storage.getItem(k1)).toBe(v1);
 
-  // total length: 254 (Overflow - MAX: 253)
-  let k2 = "!!" + d + d + d; // 110
-  let v2 = d + d + d + d; // 144
+  // key length overflow (MAX: 255)
+  let k2 = d.repeat(8); // 288
   expect(() => {
-    storage.setItem(k2, v2);
+    storage.setItem(k2, "value");
   }).toThrow();
   expect(storage.getItem(k2)).toBe(null);
   expect(storage.length).toBe(1);
@@ -166,49 +165,49 @@ test("[storage] length", (done) => {
 });
 
 test("[storage] length - max overflow", (done) => {
-  const MAX = 64;
+  const value = "value data...".repeat(80); // 1040
 
-  // push to max
+  // push until full
   storage.clear();
-  for (let i = 0; i < MAX; i++) {
-    try {
-      storage.setItem(`key-${i}`, "value data...");
-    } catch (err) {
-      console.log(err);
-    }
-  }
-  // console.log(storage.length);
-  // console.log(storage.key(0));
-  expect(storage.length).toBe(MAX);
-
-  // now, overflow
+  let count = 0;
   expect(() => {
-    storage.setItem("key", "value");
+    for (let i = 0; i < 1000; i++) {
+      storage.setItem(`key-${i}`, value);
+      count++;
+    }
   }).toThrow();
-
+  expect(count > 0).toBe(true);
+  expect(storage.length).toBe(count);
+  expect(storage.getItem(`key-${count - 1}`)).toBe(value);
+  expect(storage.getItem(`key-${count}`)).toBe(null);
   done();
 });
 
-test("[storage] length - sweeping", (done) => {
-  const MAX = 64;
+test("[storage] length - compaction", (done) => {
+  const value = "value data...".repeat(80); // 1040
 
-  // push to max
+  // push until full
   storage.clear();
-  for (let i = 0; i < MAX; i++) {
-    try {
-      storage.setItem(`key-${i}`, "value data...");
-    } catch (err) {
-      console.log(err);
+  let count = 0;
+  try {
+    for (let i = 0; i < 1000; i++) {
+      storage.setItem(`key-${i}`, value);
+      count++;
     }
-  }
-  expect(storage.length).toBe(MAX);
+  } catch (err) {}
+  expect(storage.length).toBe(count);
 
   // remove one
   storage.removeItem("key-0");
 
-  // add one
+  // add and overwrite many times over the size of the storage area
   storage.setItem("new-key", "new-value");
+  for (let i = 0; i < 100; i++) {
+    storage.setItem(`key-${i % (count - 1) + 1}`, `${i}` + value);
+  }
   expect(storage.getItem("new-key")).toBe("new-value");
+  expect(storage.getItem("key-0")).toBe(null);
+  expect(storage.length).toBe(count);
   done();
 });
 
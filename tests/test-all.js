@@ -5,10 +5,16 @@ function cmd(cmd, args) {
 }
 
 cmd("../build/kaluma", ["stream.test.js"]);
+cmd("../build/kaluma", ["buffer.test.js"]);
+cmd("../build/kaluma", ["graphics.test.js"]);
+cmd("../build/kaluma", ["virtual_display.test.js"]);
 cmd("../build/kaluma", ["path.test.js"]);
 cmd("../build/kaluma", ["process.test.js"]);
 cmd("../build/kaluma", ["storage.test.js"]);
 cmd("../build/kaluma", ["flash.test.js"]);
+cmd("../build/kaluma", ["sdcard.test.js"]);
 cmd("../build/kaluma", ["vfs_lfs.test.js"]);
 cmd("../build/kaluma", ["vfs_fat.test.js"]);
 cmd("../build/kaluma", ["fs.test.js"]);
+cmd("../build/kaluma", ["interrupt.test.js"]);
+cmd("../build/kaluma", ["timers.test.js"]);
@@ -0,0 +1,52 @@
+const { test, start, expect } = require("__ujest");
+
+test("[timers] setImmediate() runs callbacks in order", (done) => {
+  var order = [];
+  setImmediate(() => order.push(1));
+  setImmediate(() => order.push(2));
+  setImmediate(() => {
+    order.push(3);
+    expect(order.join(",")).toBe("1,2,3");
+    done();
+  });
+});
+
+test("[timers] clearImmediate()", (done) => {
+  var called = false;
+  var id = setImmediate(() => {
+    called = true;
+  });
+  clearImmediate(id);
+  clearImmediate(id); // clearing twice is harmless
+  setTimeout(() => {
+    expect(called).toBe(false);
+    done();
+  }, 10);
+});
+
+test("[timers] nested setImmediate() runs in the next tick", (done) => {
+  var order = [];
+  setImmediate(() => {
+    order.push("a");
+    setImmediate(() => {
+      order.push("c");
+      expect(order.join(",")).toBe("a,b,c");
+      done();
+    });
+  });
+  setImmediate(() => order.push("b"));
+});
+
+test("[timers] queueMicrotask() runs before setImmediate()", (done) => {
+  var order = [];
+  setImmediate(() => {
+    order.push("immediate");
+    expect(order.join(",")).toBe("sync,microtask,promise,immediate");
+    done();
+  });
+  queueMicrotask(() => order.push("microtask"));
+  Promise.resolve().then(() => order.push("promise"));
+  order.push("sync");
+});
+
+start(); // start to test
@@ -0,0 +1,44 @@
+const { test, start, expect } = require("__ujest");
+const { VirtualDisplay } = require("virtual_display");
+
+test("[virtual_display] counts the bytes sent for each frame", (done) => {
+  const vd = new VirtualDisplay(32, 16, { spiClock: 8000000 });
+  const gc = vd.getContext();
+  gc.display(); // whole buffer is dirty initially
+  gc.setFillColor(0xf800);
+  gc.fillRect(0, 0, 4, 4);
+  gc.display();
+  expect(vd.getPixel(0, 0)).toBe(0xff0000);
+  expect(vd.getPixel(4, 0)).toBe(0);
+  const stats = vd.stats();
+  expect(stats.frames).toBe(2);
+  expect(stats.transfers).toBe(2);
+  expect(stats.bytes).toBe(11 + 32 * 16 * 2 + 11 + 4 * 4 * 2);
+  expect(stats.lastFrameBytes).toBe(43);
+  expect(stats.busyTime).toBe(stats.bytes); // 1 byte per us at 8MHz
+  gc.display(); // nothing changed
+  expect(vd.stats().frames).toBe(2);
+  vd.resetStats();
+  expect(vd.stats().bytes).toBe(0);
+  done();
+});
+
+test("[virtual_display] banded frames show the same pixels", (done) => {
+  const draw = (gc) => {
+    gc.setColor(1);
+    gc.drawLine(0, 0, 15, 15);
+    gc.drawText(2, 4, "Hi");
+    gc.display();
+  };
+  const vd = new VirtualDisplay(16, 16, { bpp: 1, commandBytes: 0 });
+  draw(vd.getContext());
+  const banded = new VirtualDisplay(16, 16, { bpp: 1, commandBytes: 0 });
+  draw(banded.getContext({ bandHeight: 8 }));
+  expect(banded.checksum()).toBe(vd.checksum());
+  expect(vd.getPixel(15, 15)).toBe(0xffffff);
+  const stats = banded.stats();
+  expect(`${stats.frames},${stats.transfers},${stats.bytes}`).toBe("1,2,32");
+  done();
+});
+
+start(); // start to test
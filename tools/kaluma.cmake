@@ -48,6 +48,14 @@ set(KALUMA_GENERATED_H
 file(GLOB_RECURSE KALUMA_MODULE_SRC ${SRC_DIR}/modules/*)
 set(KALUMA_GENERATED ${KALUMA_GENERATED_C} ${KALUMA_GENERATED_H})
 
+# modules passing data as Buffer require the buffer module
+foreach(MOD at fs http net stream uart)
+  if(${MOD} IN_LIST MODULES AND NOT buffer IN_LIST MODULES)
+    message(STATUS "Adding the buffer module required by ${MOD}")
+    list(APPEND MODULES buffer)
+  endif()
+endforeach()
+
 string (REPLACE ";" " " MODULE_LIST "${MODULES}")
 
 set(JERRY_LIBS
@@ -71,6 +79,8 @@ include_directories(${KALUMA_INC} ${JERRY_INC})
 list(APPEND SOURCES
   ${SRC_DIR}/err.c
   ${SRC_DIR}/utils.c
+  ${SRC_DIR}/blkdev.c
+  ${SRC_DIR}/blkcache.c
   ${SRC_DIR}/base64.c
   ${SRC_DIR}/io.c
   ${SRC_DIR}/runtime.c
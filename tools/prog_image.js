@@ -0,0 +1,82 @@
+// Generate a program image to write into the user program area of flash
+//
+// Usage:
+//   node tools/prog_image.js app.js -o app.kmp [--snapshot]
+//
+// The image consists of a 16-byte header (see include/prog.h) followed by
+// the payload, which is either the JS source or a JerryScript snapshot
+// (--snapshot). A snapshot must be generated by jerry-snapshot of the same
+// JerryScript version as the firmware (lib/jerryscript/build/bin).
+
+const fs = require("fs-extra");
+const os = require("os");
+const path = require("path");
+const childProcess = require("child_process");
+const minimist = require("minimist");
+
+const KM_PROG_MAGIC = 0x504d4b2e; // ".KMP"
+const KM_PROG_VERSION = 1;
+const KM_PROG_FORMAT_SOURCE = 1;
+const KM_PROG_FORMAT_SNAPSHOT = 2;
+
+var argv = minimist(process.argv.slice(2), { boolean: ["snapshot"] });
+
+generateImage();
+
+function generateImage() {
+  const src = argv._[0];
+  if (!src) {
+    console.log("Usage: node prog_image.js <file.js> -o <output> [--snapshot]");
+    process.exit(1);
+  }
+  const output = argv.o || src.replace(/\.js$/, "") + ".kmp";
+  var format = KM_PROG_FORMAT_SOURCE;
+  var payload = fs.readFileSync(src);
+  if (argv.snapshot) {
+    payload = createSnapshot(src);
+    format = KM_PROG_FORMAT_SNAPSHOT;
+  }
+  const header = Buffer.alloc(16);
+  header.writeUInt32LE(KM_PROG_MAGIC, 0);
+  header.writeUInt8(KM_PROG_VERSION, 4);
+  header.writeUInt8(format, 5);
+  header.writeUInt16LE(0, 6);
+  header.writeUInt32LE(payload.length, 8);
+  header.writeUInt32LE(crc32(payload), 12);
+  fs.writeFileSync(output, Buffer.concat([header, payload]));
+  console.log(
+    `${output}: ${argv.snapshot ? "snapshot" : "source"}, ${
+      payload.length
+    } bytes`
+  );
+}
+
+function createSnapshot(src) {
+  const snapshot = path.join(os.tmpdir(), path.basename(src) + ".snapshot");
+  const tool =
+    argv.jerry_snapshot ||
+    path.join(__dirname, "../lib/jerryscript/build/bin/jerry-snapshot");
+  const ret = childProcess.spawnSync(
+    tool,
+    ["generate", src, "-o", snapshot],
+    { stdio: "inherit" }
+  );
+  if (ret.status !== 0) {
+    console.log("Failed to generate snapshot with " + tool);
+    process.exit(1);
+  }
+  const buffer = fs.readFileSync(snapshot);
+  fs.unlinkSync(snapshot);
+  return buffer;
+}
+
+function crc32(buffer) {
+  var crc = 0xffffffff;
+  for (var i = 0; i < buffer.length; i++) {
+    crc ^= buffer[i];
+    for (var k = 0; k < 8; k++) {
+      crc = crc & 1 ? (crc >>> 1) ^ 0xedb88320 : crc >>> 1;
+    }
+  }
+  return (crc ^ 0xffffffff) >>> 0;
+}